@@ -0,0 +1,751 @@
+// end to end benchmark: runs the app headless (DISPLAY_NULL, nothing is drawn) and replays scripted keys through
+// app_handle_key() on fixture files of a few sizes. Each scenario prints one json object per line:
+//   {"scenario": "search", "fixture": "medium", "lines": 20000, "keys": 412, "usec": 1234, "syntax_usec": 321,
+//    "allocations": 56, "allocated_bytes": 7890, "peak_rss_kb": 4321}
+// syntax_usec is the part of usec spent highlighting the visible views after each key, the way drawing a frame would.
+// The buffer_*, match_index_* and syntax_* scenarios skip the app and call into ce.c and ce_syntax.c directly, on
+// generated text; their keys are the number of calls timed.
+// build and run with 'make bench'. Pass file paths to use them as the fixtures instead of the generated ones.
+
+#include "ce_app.h"
+#include "ce_key_defines.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+// the Makefile links the bench with -Wl,--wrap for these, so every allocation the app makes passes through here
+static int64_t g_bench_allocations = 0;
+static int64_t g_bench_allocated_bytes = 0;
+static uint64_t g_bench_syntax_usec = 0;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+char* __real_strdup(const char* string);
+char* __real_strndup(const char* string, size_t size);
+
+void* __wrap_malloc(size_t size){
+     g_bench_allocations++;
+     g_bench_allocated_bytes += size;
+     return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size){
+     g_bench_allocations++;
+     g_bench_allocated_bytes += count * size;
+     return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size){
+     g_bench_allocations++;
+     g_bench_allocated_bytes += size;
+     return __real_realloc(ptr, size);
+}
+
+char* __wrap_strdup(const char* string){
+     g_bench_allocations++;
+     g_bench_allocated_bytes += strlen(string) + 1;
+     return __real_strdup(string);
+}
+
+char* __wrap_strndup(const char* string, size_t size){
+     g_bench_allocations++;
+     g_bench_allocated_bytes += strnlen(string, size) + 1;
+     return __real_strndup(string, size);
+}
+
+typedef struct{
+     const char* name;
+     char filepath[MAX_PATH_LEN];
+     int64_t line_count;
+}BenchFixture_t;
+
+typedef struct{
+     const char* name;
+     int64_t keys;
+     struct timespec start;
+     int64_t allocations;
+     int64_t allocated_bytes;
+     uint64_t syntax_usec;
+}BenchScenario_t;
+
+static uint64_t bench_now_usec(void){
+     struct timespec now = {};
+     clock_gettime(CLOCK_MONOTONIC, &now);
+     return (uint64_t)(now.tv_sec) * 1000000ULL + (uint64_t)(now.tv_nsec) / 1000ULL;
+}
+
+// linux resets the high water mark when "5" is written to clear_refs, so each scenario gets its own peak
+static void bench_reset_peak_rss(void){
+     FILE* file = fopen("/proc/self/clear_refs", "w");
+     if(!file) return;
+     fputs("5", file);
+     fclose(file);
+}
+
+static int64_t bench_peak_rss_kb(void){
+     FILE* file = fopen("/proc/self/status", "r");
+     if(file){
+          char line[256];
+          int64_t peak_kb = -1;
+          while(fgets(line, sizeof(line), file)){
+               if(sscanf(line, "VmHWM: %" SCNd64, &peak_kb) == 1) break;
+          }
+          fclose(file);
+          if(peak_kb >= 0) return peak_kb;
+     }
+
+     struct rusage usage = {};
+     getrusage(RUSAGE_SELF, &usage);
+     return usage.ru_maxrss;
+}
+
+static bool bench_write_fixture(const char* filepath, int64_t line_count){
+     FILE* file = fopen(filepath, "w");
+     if(!file){
+          fprintf(stderr, "failed to open '%s' to write a bench fixture: %s\n", filepath, strerror(errno));
+          return false;
+     }
+
+     for(int64_t i = 0; i < line_count; i++){
+          // every so often a line has something to search for
+          if((i % 50) == 0){
+               fprintf(file, "     // needle %" PRId64 ": look here\n", i);
+          }else{
+               fprintf(file, "     int64_t value_%" PRId64 " = compute(%" PRId64 ", \"row %" PRId64 "\");\n", i, i % 97, i);
+          }
+     }
+
+     fclose(file);
+     return true;
+}
+
+static int64_t bench_count_lines(const char* filepath){
+     FILE* file = fopen(filepath, "r");
+     if(!file) return 0;
+     int64_t line_count = 0;
+     int c;
+     while((c = fgetc(file)) != EOF){
+          if(c == '\n') line_count++;
+     }
+     fclose(file);
+     return line_count;
+}
+
+static CeView_t* bench_current_view(CeApp_t* app){
+     CeLayout_t* tab_layout = app->tab_list_layout->tab_list.current;
+     if(tab_layout->tab.current->type != CE_LAYOUT_TYPE_VIEW) return NULL;
+     return &tab_layout->tab.current->view;
+}
+
+// runs the highlighters the drawer would for each visible view, into the same lists it uses
+static void bench_highlight_layout(CeApp_t* app, CeLayout_t* layout){
+     switch(layout->type){
+     default:
+          break;
+     case CE_LAYOUT_TYPE_VIEW:
+     {
+          CeAppBufferData_t* buffer_data = layout->view.buffer->app_data;
+          if(!buffer_data || !buffer_data->syntax_function) break;
+          ce_draw_color_list_clear(&app->draw_color_list);
+          ce_range_list_clear(&app->draw_range_list);
+          buffer_data->syntax_function(&layout->view, &app->draw_range_list, &app->draw_color_list, app->syntax_defs,
+                                       layout->view.buffer->syntax_data);
+     } break;
+     case CE_LAYOUT_TYPE_LIST:
+          for(int64_t i = 0; i < layout->list.layout_count; i++){
+               bench_highlight_layout(app, layout->list.layouts[i]);
+          }
+          break;
+     case CE_LAYOUT_TYPE_TAB:
+          bench_highlight_layout(app, layout->tab.root);
+          break;
+     case CE_LAYOUT_TYPE_TAB_LIST:
+          bench_highlight_layout(app, layout->tab_list.current);
+          break;
+     }
+}
+
+// does what a wakeup in the main loop does for a key, minus putting anything on the screen
+static void bench_key(CeApp_t* app, int key){
+     CeView_t* view = bench_current_view(app);
+     if(!view) return;
+
+     app->message_mode = false;
+     app_handle_key(app, view, key);
+
+     view = bench_current_view(app);
+     if(view){
+          ce_view_follow_cursor(view, app->config_options.horizontal_scroll_off, app->config_options.vertical_scroll_off,
+                                app->config_options.tab_width);
+          if(app->input_complete_func) input_view_overlay(&app->input_view, view);
+     }
+
+     // the main loop keeps scanning while idle, so a scenario pays for the whole scan
+     while(ce_app_update_search_matches(app));
+
+     uint64_t syntax_start_usec = bench_now_usec();
+     bench_highlight_layout(app, app->tab_list_layout);
+     g_bench_syntax_usec += bench_now_usec() - syntax_start_usec;
+}
+
+static int64_t bench_keys(CeApp_t* app, const char* keys, int64_t repeat){
+     int64_t key_count = 0;
+     for(int64_t i = 0; i < repeat; i++){
+          for(const char* itr = keys; *itr; itr++){
+               bench_key(app, *itr);
+               key_count++;
+          }
+     }
+     return key_count;
+}
+
+static void bench_scenario_begin(BenchScenario_t* scenario, const char* name){
+     memset(scenario, 0, sizeof(*scenario));
+     scenario->name = name;
+     bench_reset_peak_rss();
+     scenario->allocations = g_bench_allocations;
+     scenario->allocated_bytes = g_bench_allocated_bytes;
+     scenario->syntax_usec = g_bench_syntax_usec;
+     clock_gettime(CLOCK_MONOTONIC, &scenario->start);
+}
+
+static void bench_scenario_end(BenchScenario_t* scenario, BenchFixture_t* fixture){
+     uint64_t start_usec = (uint64_t)(scenario->start.tv_sec) * 1000000ULL + (uint64_t)(scenario->start.tv_nsec) / 1000ULL;
+     uint64_t usec = bench_now_usec() - start_usec;
+     printf("{\"scenario\": \"%s\", \"fixture\": \"%s\", \"lines\": %" PRId64 ", \"keys\": %" PRId64 ", \"usec\": %" PRIu64
+            ", \"syntax_usec\": %" PRIu64 ", \"allocations\": %" PRId64 ", \"allocated_bytes\": %" PRId64
+            ", \"peak_rss_kb\": %" PRId64 "}\n",
+            scenario->name, fixture->name, fixture->line_count, scenario->keys, usec, g_bench_syntax_usec - scenario->syntax_usec,
+            g_bench_allocations - scenario->allocations, g_bench_allocated_bytes - scenario->allocated_bytes,
+            bench_peak_rss_kb());
+     fflush(stdout);
+}
+
+static CeBuffer_t* bench_load_fixture(CeApp_t* app, BenchFixture_t* fixture){
+     CeBuffer_t* buffer = new_buffer();
+     if(!ce_app_load_file(app, buffer, fixture->filepath)){
+          free(buffer->app_data);
+          free(buffer);
+          return NULL;
+     }
+
+     // big files load on a background thread, wait for it so every scenario starts from the whole file
+     CeAppBufferData_t* buffer_data = buffer->app_data;
+     while(buffer_data->loading){
+          ce_app_update_file_load(app);
+          usleep(1000);
+     }
+
+     ce_buffer_node_insert(&app->buffer_node_head, buffer);
+     determine_buffer_syntax(buffer);
+
+     CeView_t* view = bench_current_view(app);
+     ce_view_switch_buffer(view, buffer, &app->vim, &app->config_options, false);
+     view->cursor = (CePoint_t){0, 0};
+     view->scroll = (CePoint_t){0, 0};
+     return buffer;
+}
+
+static void bench_unload_fixture(CeApp_t* app, CeBuffer_t* buffer, CeBuffer_t* scratch_buffer){
+     // leave whatever mode or prompt the scenario ended in
+     bench_key(app, KEY_ESCAPE);
+     bench_key(app, KEY_ESCAPE);
+
+     CeView_t* view = bench_current_view(app);
+     ce_view_switch_buffer(view, scratch_buffer, &app->vim, &app->config_options, false);
+     ce_buffer_node_delete(&app->buffer_node_head, buffer);
+}
+
+static void bench_run_fixture(CeApp_t* app, BenchFixture_t* fixture, CeBuffer_t* scratch_buffer){
+     BenchScenario_t scenario;
+     char keys[128];
+
+     // how many times the scripted edits repeat, a fixture may be shorter than the script
+     int64_t edit_count = (fixture->line_count < 500) ? fixture->line_count : 500;
+     if(edit_count < 1) edit_count = 1;
+
+     bench_scenario_begin(&scenario, "load");
+     CeBuffer_t* buffer = bench_load_fixture(app, fixture);
+     bench_scenario_end(&scenario, fixture);
+     if(!buffer) return;
+     bench_unload_fixture(app, buffer, scratch_buffer);
+
+     buffer = bench_load_fixture(app, fixture);
+     bench_scenario_begin(&scenario, "search");
+     scenario.keys += bench_keys(app, "/needle\r", 1);
+     scenario.keys += bench_keys(app, "n", 200);
+     scenario.keys += bench_keys(app, "N", 200);
+     scenario.keys += bench_keys(app, "/value_1.*row\r", 1);
+     scenario.keys += bench_keys(app, "n", 200);
+     bench_scenario_end(&scenario, fixture);
+     bench_unload_fixture(app, buffer, scratch_buffer);
+
+     buffer = bench_load_fixture(app, fixture);
+     bench_scenario_begin(&scenario, "page");
+     scenario.keys += bench_keys(app, "\x06", 100); // ctrl+f
+     scenario.keys += bench_keys(app, "G", 1);
+     scenario.keys += bench_keys(app, "\x15", 200); // ctrl+u
+     scenario.keys += bench_keys(app, "gg", 1);
+     scenario.keys += bench_keys(app, "\x04", 200); // ctrl+d
+     bench_scenario_end(&scenario, fixture);
+     bench_unload_fixture(app, buffer, scratch_buffer);
+
+     buffer = bench_load_fixture(app, fixture);
+     bench_scenario_begin(&scenario, "macro");
+     scenario.keys += bench_keys(app, "qaI// \x1bjq", 1);
+     snprintf(keys, sizeof(keys), "%" PRId64 "@a", edit_count - 1);
+     scenario.keys += bench_keys(app, keys, 1);
+     scenario.keys += bench_keys(app, "gg.", 1); // replays with the same count
+     bench_scenario_end(&scenario, fixture);
+     bench_unload_fixture(app, buffer, scratch_buffer);
+
+     buffer = bench_load_fixture(app, fixture);
+     bench_scenario_begin(&scenario, "replace_all");
+     scenario.keys += bench_keys(app, ":replace_all value amount\r", 1);
+     scenario.keys += bench_keys(app, "gg:replace_all compute evaluate\r", 1);
+     scenario.keys += bench_keys(app, "u", 2);
+     bench_scenario_end(&scenario, fixture);
+     bench_unload_fixture(app, buffer, scratch_buffer);
+
+     buffer = bench_load_fixture(app, fixture);
+     bench_scenario_begin(&scenario, "undo");
+     scenario.keys += bench_keys(app, "xj", edit_count);
+     scenario.keys += bench_keys(app, "ggofixture\x1b", edit_count);
+     scenario.keys += bench_keys(app, "u", edit_count * 2);
+     snprintf(keys, sizeof(keys), "%c", KEY_REDO);
+     scenario.keys += bench_keys(app, keys, edit_count * 2);
+     bench_scenario_end(&scenario, fixture);
+     bench_unload_fixture(app, buffer, scratch_buffer);
+}
+
+// builds line_count lines, each line_len characters long
+static char* bench_build_string(int64_t line_count, int64_t line_len){
+     int64_t string_len = line_count * (line_len + 1);
+     char* string = malloc(string_len + 1);
+     for(int64_t y = 0; y < line_count; y++){
+          char* line = string + (y * (line_len + 1));
+          for(int64_t x = 0; x < line_len; x++) line[x] = 'a' + ((x + y) % 26);
+          line[line_len] = CE_NEWLINE;
+     }
+     string[string_len - 1] = 0;
+     return string;
+}
+
+static bool bench_load_string(CeBuffer_t* buffer, BenchFixture_t* fixture, int64_t line_len){
+     char* string = bench_build_string(fixture->line_count, line_len);
+     bool loaded = ce_buffer_load_string(buffer, string, fixture->name);
+     free(string);
+     return loaded;
+}
+
+static void bench_highlight_view(CeView_t* view, CeSyntaxHighlightFunc_t* highlight, CeSyntaxDef_t* syntax_defs){
+     CeRangeList_t range_list = {};
+     CeDrawColorList_t draw_color_list = {};
+     highlight(view, &range_list, &draw_color_list, syntax_defs, NULL);
+     ce_draw_color_list_free(&draw_color_list);
+     ce_range_list_free(&range_list);
+}
+
+static void bench_run_buffer_scenarios(CeApp_t* app, const char* directory){
+     BenchScenario_t scenario;
+     BenchFixture_t fixture = {"generated", "", 500000};
+     CeBuffer_t buffer = {};
+
+     snprintf(fixture.filepath, MAX_PATH_LEN, "%s/generated.txt", directory);
+     char* string = bench_build_string(fixture.line_count, 80);
+     FILE* file = fopen(fixture.filepath, "wb");
+     if(file){
+          fputs(string, file);
+          fclose(file);
+
+          bench_scenario_begin(&scenario, "buffer_load_file");
+          ce_buffer_load_file(&buffer, fixture.filepath);
+          scenario.keys = 1;
+          bench_scenario_end(&scenario, &fixture);
+          ce_buffer_free(&buffer);
+     }
+     free(string);
+
+     fixture.line_count = 1000000;
+     if(bench_load_string(&buffer, &fixture, 60)){
+          free(buffer.name);
+          buffer.name = strdup(fixture.filepath);
+          bench_scenario_begin(&scenario, "buffer_save");
+          ce_buffer_save(&buffer);
+          scenario.keys = 1;
+          bench_scenario_end(&scenario, &fixture);
+     }
+     ce_buffer_free(&buffer);
+     unlink(fixture.filepath);
+
+     // the pattern only appears on the last line, so every search has to scan the whole buffer
+     fixture.line_count = 200000;
+     if(bench_load_string(&buffer, &fixture, 40)){
+          ce_buffer_insert_string(&buffer, "needle", (CePoint_t){10, fixture.line_count - 1});
+          bench_scenario_begin(&scenario, "buffer_search_forward");
+          for(; scenario.keys < 10; scenario.keys++) ce_buffer_search_forward(&buffer, (CePoint_t){0, 0}, "needle");
+          bench_scenario_end(&scenario, &fixture);
+
+          bench_scenario_begin(&scenario, "buffer_search_backward");
+          for(; scenario.keys < 10; scenario.keys++) ce_buffer_search_backward(&buffer, ce_buffer_end_point(&buffer), "abcxyz");
+          bench_scenario_end(&scenario, &fixture);
+
+          // searching backward from above the last line's needle, the one at the top has every line matched against it
+          ce_buffer_insert_string(&buffer, "needle", (CePoint_t){10, 0});
+          CeRegex_t regex = NULL;
+          if(ce_regex_cache_get("ne+dle", &regex).error_message == NULL){
+               bench_scenario_begin(&scenario, "buffer_regex_search_backward");
+               for(; scenario.keys < 10; scenario.keys++){
+                    ce_buffer_regex_search_backward(&buffer, (CePoint_t){0, fixture.line_count - 2}, regex);
+               }
+               bench_scenario_end(&scenario, &fixture);
+          }
+     }
+     ce_buffer_free(&buffer);
+
+     // one long line full of matches, backward searches used to re-match it from every match
+     fixture.line_count = 1;
+     if(bench_load_string(&buffer, &fixture, 100000)){
+          CeRegex_t regex = NULL;
+          if(ce_regex_cache_get("a[b-z]", &regex).error_message == NULL){
+               bench_scenario_begin(&scenario, "buffer_regex_search_backward_long_line");
+               CePoint_t point = ce_buffer_end_point(&buffer);
+               for(; scenario.keys < 100; scenario.keys++){
+                    CeRegexSearchResult_t result = ce_buffer_regex_search_backward(&buffer, point, regex);
+                    if(result.point.x < 0) break;
+                    point = result.point;
+               }
+               bench_scenario_end(&scenario, &fixture);
+          }
+     }
+     ce_buffer_free(&buffer);
+     ce_regex_cache_clear();
+
+     fixture.line_count = 200000;
+     if(bench_load_string(&buffer, &fixture, 40)){
+          CeMatchIndex_t index = {};
+          bench_scenario_begin(&scenario, "match_index_scan");
+          ce_match_index_set_pattern(&index, &buffer, "abc", false);
+          ce_match_index_scan(&index, &buffer, buffer.line_count);
+          scenario.keys = 1;
+          bench_scenario_end(&scenario, &fixture);
+
+          // edit near the middle of the buffer, syncing after every change like the editor does between key presses
+          CePoint_t cursor = {};
+          bench_scenario_begin(&scenario, "match_index_sync");
+          for(; scenario.keys < 2000; scenario.keys++){
+               CePoint_t point = {5, (fixture.line_count / 2) + (scenario.keys % 64)};
+               ce_buffer_insert_string_change(&buffer, strdup((scenario.keys % 2) ? "abc\n" : "abc"), point, &cursor, point,
+                                              false);
+               ce_match_index_sync(&index, &buffer);
+          }
+          bench_scenario_end(&scenario, &fixture);
+
+          bench_scenario_begin(&scenario, "match_index_next");
+          CePoint_t point = {0, 0};
+          while((point = ce_match_index_next(&index, point)).x >= 0){
+               point.x++;
+               scenario.keys++;
+          }
+          bench_scenario_end(&scenario, &fixture);
+          ce_match_index_free(&index);
+     }
+     ce_buffer_free(&buffer);
+
+     // type lines of 79 runes and a newline, a rune per change like insert mode does, then undo it all at once
+     fixture.line_count = 1;
+     if(ce_buffer_load_string(&buffer, "", fixture.name)){
+          CePoint_t cursor = {};
+          bench_scenario_begin(&scenario, "buffer_typing");
+          for(; scenario.keys < 1000000; scenario.keys++){
+               bool newline = (scenario.keys % 80) == 79;
+               CePoint_t point = cursor;
+               CePoint_t after = newline ? (CePoint_t){0, cursor.y + 1} : (CePoint_t){cursor.x + 1, cursor.y};
+               ce_buffer_insert_string_change(&buffer, strdup(newline ? "\n" : "a"), point, &cursor, after,
+                                              scenario.keys > 0);
+          }
+          fixture.line_count = buffer.line_count;
+          bench_scenario_end(&scenario, &fixture);
+
+          bench_scenario_begin(&scenario, "buffer_typing_undo");
+          ce_buffer_undo(&buffer, &cursor);
+          scenario.keys = 1;
+          bench_scenario_end(&scenario, &fixture);
+     }
+     ce_buffer_free(&buffer);
+
+     // walk the cursor across a line with a multibyte rune every few, looking at each rune like a motion would
+     fixture.line_count = 1;
+     {
+          const int64_t rune_count = 10000;
+          char* line = malloc((rune_count * 2) + 1);
+          char* itr = line;
+          for(int64_t i = 0; i < rune_count; i++){
+               if(i % 4 == 0){
+                    memcpy(itr, "\xC2\xA2", 2);
+                    itr += 2;
+               }else{
+                    *itr = 'a' + (i % 26);
+                    itr++;
+               }
+          }
+          *itr = 0;
+
+          if(ce_buffer_load_string(&buffer, line, fixture.name)){
+               bench_scenario_begin(&scenario, "buffer_long_line_motion");
+               CePoint_t point = {0, 0};
+               for(; scenario.keys < rune_count; scenario.keys++){
+                    ce_buffer_get_rune(&buffer, point);
+                    point = ce_buffer_advance_point(&buffer, point, 1);
+               }
+               bench_scenario_end(&scenario, &fixture);
+          }
+          free(line);
+     }
+     ce_buffer_free(&buffer);
+
+     // split and re-join lines near the top of the buffer, then paste and undo multiline chunks there, then delete whole
+     // lines off the top and undo them all. Then split and join at the top and bottom in turn, which is as far as the
+     // line gap can be made to move. All of it under each way of storing the line pointers
+     const CeBufferStorage_t storages[] = {CE_BUFFER_STORAGE_LINE_ARRAY, CE_BUFFER_STORAGE_LINE_GAP};
+     const char* storage_names[] = {"line_array", "line_gap"};
+     char scenario_name[128];
+     fixture.line_count = 200000;
+     for(int64_t s = 0; s < (int64_t)(sizeof(storages) / sizeof(storages[0])); s++){
+          ce_buffer_set_storage(&buffer, storages[s]);
+          if(!bench_load_string(&buffer, &fixture, 40)) continue;
+
+          snprintf(scenario_name, sizeof(scenario_name), "buffer_split_join_%s", storage_names[s]);
+          bench_scenario_begin(&scenario, scenario_name);
+          for(; scenario.keys < 2000; scenario.keys++){
+               CePoint_t point = {scenario.keys % 40, scenario.keys % 16};
+               ce_buffer_insert_string(&buffer, "\n", point);
+               ce_buffer_remove_string(&buffer, point, 1);
+          }
+          bench_scenario_end(&scenario, &fixture);
+
+          CePoint_t cursor = {};
+          snprintf(scenario_name, sizeof(scenario_name), "buffer_paste_undo_%s", storage_names[s]);
+          bench_scenario_begin(&scenario, scenario_name);
+          for(; scenario.keys < 2000; scenario.keys++){
+               CePoint_t point = {0, scenario.keys % 16};
+               ce_buffer_insert_string_change(&buffer, strdup("one\ntwo\nthree\n"), point, &cursor, point, false);
+               ce_buffer_undo(&buffer, &cursor);
+          }
+          bench_scenario_end(&scenario, &fixture);
+
+          snprintf(scenario_name, sizeof(scenario_name), "buffer_delete_lines_undo_%s", storage_names[s]);
+          bench_scenario_begin(&scenario, scenario_name);
+          for(int64_t i = 0; i < 1000; i++){
+               ce_buffer_remove_string_change(&buffer, (CePoint_t){0, 0}, 41, &cursor, (CePoint_t){0, 0}, false);
+               scenario.keys++;
+          }
+          for(int64_t i = 0; i < 1000; i++){
+               ce_buffer_undo(&buffer, &cursor);
+               scenario.keys++;
+          }
+          bench_scenario_end(&scenario, &fixture);
+
+          snprintf(scenario_name, sizeof(scenario_name), "buffer_split_join_far_apart_%s", storage_names[s]);
+          bench_scenario_begin(&scenario, scenario_name);
+          for(; scenario.keys < 2000; scenario.keys++){
+               CePoint_t point = {scenario.keys % 40, (scenario.keys % 2) ? buffer.line_count - 2 : 0};
+               ce_buffer_insert_string(&buffer, "\n", point);
+               ce_buffer_remove_string(&buffer, point, 1);
+          }
+          bench_scenario_end(&scenario, &fixture);
+          ce_buffer_free(&buffer);
+     }
+
+     {
+          const char* code = "static int64_t count_lines(const char* str){ // counts \"lines\" 0x10\n"
+                             "     /* walk it\n"
+                             "        once */ return STR_COUNT;\n";
+          int64_t code_len = strlen(code);
+          int64_t repeat_count = 100000;
+          string = malloc((code_len * repeat_count) + 1);
+          for(int64_t i = 0; i < repeat_count; i++) memcpy(string + (i * code_len), code, code_len);
+          string[(code_len * repeat_count) - 1] = 0;
+          bool loaded = ce_buffer_load_string(&buffer, string, fixture.name);
+          free(string);
+
+          if(loaded){
+               fixture.line_count = buffer.line_count;
+               CeView_t view = {};
+               view.buffer = &buffer;
+               view.rect = (CeRect_t){0, 119, 0, 59};
+
+               // jumping to the end has to lex everything above it once
+               bench_scenario_begin(&scenario, "syntax_highlight_end");
+               view.scroll.y = buffer.line_count - 60;
+               bench_highlight_view(&view, ce_syntax_highlight_c, app->syntax_defs);
+               scenario.keys = 1;
+               bench_scenario_end(&scenario, &fixture);
+
+               bench_scenario_begin(&scenario, "syntax_highlight_pages");
+               for(; scenario.keys < 1000; scenario.keys++){
+                    view.scroll.y = (scenario.keys * 60) % buffer.line_count;
+                    bench_highlight_view(&view, ce_syntax_highlight_c, app->syntax_defs);
+               }
+               bench_scenario_end(&scenario, &fixture);
+
+               // typing near the bottom only re-lexes the line being typed on
+               CePoint_t cursor = {};
+               view.scroll.y = buffer.line_count - 60;
+               bench_scenario_begin(&scenario, "syntax_highlight_typing");
+               for(; scenario.keys < 1000; scenario.keys++){
+                    CePoint_t point = {scenario.keys, buffer.line_count - 30};
+                    ce_buffer_insert_string_change(&buffer, strdup("a"), point, &cursor, (CePoint_t){point.x + 1, point.y},
+                                                   scenario.keys > 0);
+                    view.cursor = (CePoint_t){point.x + 1, point.y};
+                    bench_highlight_view(&view, ce_syntax_highlight_c, app->syntax_defs);
+               }
+               bench_scenario_end(&scenario, &fixture);
+               ce_syntax_cache_free(&buffer);
+          }
+          ce_buffer_free(&buffer);
+     }
+
+     // generated code likes to put everything on one line
+     {
+          const char* code = "if(count_t > 0x10){ str = \"a \\\" \xC3\xA9\"; } else { return MAX_LEN; } /* c */ ";
+          int64_t code_len = strlen(code);
+          int64_t repeat_count = (100 * 1024) / code_len;
+          string = malloc((code_len * repeat_count) + 1);
+          for(int64_t i = 0; i < repeat_count; i++) memcpy(string + (i * code_len), code, code_len);
+          string[code_len * repeat_count] = 0;
+
+          struct{
+               const char* name;
+               CeSyntaxHighlightFunc_t* highlight;
+          }languages[] = {
+               {"syntax_long_line_c", ce_syntax_highlight_c},
+               {"syntax_long_line_cpp", ce_syntax_highlight_cpp},
+               {"syntax_long_line_java", ce_syntax_highlight_java},
+               {"syntax_long_line_python", ce_syntax_highlight_python},
+               {"syntax_long_line_bash", ce_syntax_highlight_bash},
+               {"syntax_long_line_config", ce_syntax_highlight_config},
+               {"syntax_long_line_diff", ce_syntax_highlight_diff},
+          };
+
+          fixture.line_count = 1;
+          for(size_t i = 0; i < sizeof(languages) / sizeof(languages[0]); i++){
+               if(!ce_buffer_load_string(&buffer, string, fixture.name)) continue;
+               CeView_t view = {};
+               view.buffer = &buffer;
+               view.rect = (CeRect_t){0, 119, 0, 59};
+
+               bench_scenario_begin(&scenario, languages[i].name);
+               bench_highlight_view(&view, languages[i].highlight, app->syntax_defs);
+               scenario.keys = 1;
+               bench_scenario_end(&scenario, &fixture);
+
+               ce_syntax_cache_free(&buffer);
+               ce_buffer_free(&buffer);
+          }
+          free(string);
+     }
+}
+
+int main(int argc, char* argv[]){
+     setlocale(LC_ALL, "");
+
+     CeApp_t* app = calloc(1, sizeof(*app));
+
+     g_ce_log_buffer = new_buffer();
+     ce_buffer_alloc(g_ce_log_buffer, 1, "[log]");
+     ce_buffer_node_insert(&app->buffer_node_head, g_ce_log_buffer);
+     g_ce_log_buffer->status = CE_BUFFER_STATUS_READONLY;
+     g_ce_log_buffer->no_line_numbers = true;
+     if(!ce_log_init("ce_bench.log")) return 1;
+
+     ce_app_init_default_config(app);
+     app->clangd_completion.start = (CePoint_t){-1, -1};
+     app->clangd_completion.initiate = (CePoint_t){-1, -1};
+     ce_app_init_buffers(app, false);
+     ce_app_init_default_commands(app);
+     ce_vim_init(&app->vim);
+
+     // the scratch buffer was inserted last
+     CeBuffer_t* scratch_buffer = app->buffer_node_head->buffer;
+
+     {
+          CeRect_t rect = {};
+          CeLayout_t* tab_layout = ce_layout_tab_init(scratch_buffer, rect);
+          app->tab_list_layout = ce_layout_tab_list_init(tab_layout);
+          ce_app_update_terminal_view(app, 200, 60);
+     }
+
+     {
+          CeBuffer_t* buffer = new_buffer();
+          ce_buffer_alloc(buffer, 1, "input");
+          app->input_view.buffer = buffer;
+          ce_buffer_node_insert(&app->buffer_node_head, buffer);
+
+          buffer = new_buffer();
+          ce_buffer_alloc(buffer, 1, "[message]");
+          app->message_view.buffer = buffer;
+          app->message_view.buffer->no_line_numbers = true;
+          ce_buffer_node_insert(&app->buffer_node_head, buffer);
+          app->message_view.buffer->status = CE_BUFFER_STATUS_READONLY;
+     }
+
+     int rc = 0;
+     if(argc > 1){
+          for(int i = 1; i < argc; i++){
+               BenchFixture_t fixture = {};
+               fixture.name = argv[i];
+               strncpy(fixture.filepath, argv[i], MAX_PATH_LEN - 1);
+               fixture.line_count = bench_count_lines(fixture.filepath);
+               bench_run_fixture(app, &fixture, scratch_buffer);
+          }
+     }else{
+          BenchFixture_t fixtures[] = {
+               {"small", "", 1000},
+               {"medium", "", 20000},
+               {"large", "", 100000},
+          };
+
+          char directory[] = "/tmp/ce_bench_XXXXXX";
+          if(!mkdtemp(directory)){
+               fprintf(stderr, "failed to create a directory for the bench fixtures: %s\n", strerror(errno));
+               return 1;
+          }
+
+          bench_run_buffer_scenarios(app, directory);
+
+          int64_t fixture_count = sizeof(fixtures) / sizeof(fixtures[0]);
+          for(int64_t i = 0; i < fixture_count; i++){
+               BenchFixture_t* fixture = fixtures + i;
+               snprintf(fixture->filepath, MAX_PATH_LEN, "%s/%s.c", directory, fixture->name);
+               if(!bench_write_fixture(fixture->filepath, fixture->line_count)){
+                    rc = 1;
+                    break;
+               }
+               bench_run_fixture(app, fixture, scratch_buffer);
+               unlink(fixture->filepath);
+          }
+
+          rmdir(directory);
+     }
+
+     ce_layout_free(&app->tab_list_layout);
+     ce_vim_free(&app->vim);
+     ce_macros_free(&app->macros);
+     ce_app_clear_filepath_cache(app);
+     ce_regex_cache_clear();
+     ce_buffer_node_free(&app->buffer_node_head);
+     ce_draw_color_list_free(&app->draw_color_list);
+     ce_range_list_free(&app->draw_range_list);
+     free(app->syntax_defs);
+     free(app);
+     return rc;
+}
@@ -17,6 +17,7 @@ pushd build\windows
   ..\..\ce_draw_gui.c ^
   ..\..\ce_layout.c ^
   ..\..\ce_macros.c ^
+  ..\..\ce_profile.c ^
   ..\..\ce_subprocess.c ^
   ..\..\ce_syntax.c ^
   ..\..\ce_vim.c ^
@@ -10,6 +10,7 @@ cl ^
   ..\..\ce.c ^
   ..\..\ce_app.c ^
   ..\..\ce_clangd.c ^
+  ..\..\ce_clangd_reader.c ^
   ..\..\ce_command.c ^
   ..\..\ce_commands.c ^
   ..\..\ce_complete.c ^
@@ -17,6 +18,8 @@ cl ^
   ..\..\ce_json.c ^
   ..\..\ce_layout.c ^
   ..\..\ce_macros.c ^
+  ..\..\ce_profile.c ^
+  ..\..\ce_regex_cache.c ^
   ..\..\ce_regex_windows.cpp ^
   ..\..\ce_subprocess.c ^
   ..\..\ce_syntax.c ^
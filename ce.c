@@ -17,21 +17,147 @@
     #include <inttypes.h>
 #else
     #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/uio.h>
+    #include <limits.h>
+    #include <signal.h>
+    #include <setjmp.h>
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+    #define CE_SPLIT_LINES_X86
+    #include <immintrin.h>
 #endif
 
 FILE* g_ce_log = NULL;
 CeBuffer_t* g_ce_log_buffer = NULL;
 
-static void ce_buffer_change_node_free(CeBufferChangeNode_t** head){
-     CeBufferChangeNode_t* itr = *head;
+static int64_t change_arena_align(int64_t size){
+     return (size + 7) & ~(int64_t)(7);
+}
+
+static void change_arena_unlink(CeChangeArena_t* arena, CeChangeArenaBlock_t* block){
+     if(block->prev) block->prev->next = block->next;
+     else arena->head = block->next;
+     if(block->next) block->next->prev = block->prev;
+     else arena->tail = block->prev;
+     arena->allocated_bytes -= sizeof(*block) + block->capacity;
+     free(block);
+}
+
+static void* change_arena_alloc(CeChangeArena_t* arena, int64_t size, CeChangeArenaBlock_t** block){
+     size = change_arena_align(size);
+     CeChangeArenaBlock_t* tail = arena->tail;
+     if(!tail || tail->used + size > tail->capacity){
+          int64_t capacity = (size > CE_CHANGE_ARENA_BLOCK_SIZE) ? size : CE_CHANGE_ARENA_BLOCK_SIZE;
+          CeChangeArenaBlock_t* new_tail = malloc(sizeof(*new_tail) + capacity);
+          if(!new_tail) return NULL;
+          new_tail->next = NULL;
+          new_tail->prev = tail;
+          new_tail->used = 0;
+          new_tail->capacity = capacity;
+          new_tail->live_count = 0;
+          new_tail->data = (char*)(new_tail + 1);
+          if(tail) tail->next = new_tail;
+          else arena->head = new_tail;
+          arena->tail = new_tail;
+          arena->allocated_bytes += sizeof(*new_tail) + capacity;
+
+          // the old tail is only kept around for reuse while it is the tail
+          if(tail && tail->live_count == 0) change_arena_unlink(arena, tail);
+          tail = new_tail;
+     }
+
+     void* result = tail->data + tail->used;
+     tail->used += size;
+     tail->live_count++;
+     *block = tail;
+     return result;
+}
+
+static void change_arena_release(CeChangeArena_t* arena, CeChangeArenaBlock_t* block){
+     block->live_count--;
+     if(block->live_count > 0) return;
+     if(block == arena->tail){
+          block->used = 0;
+     }else{
+          change_arena_unlink(arena, block);
+     }
+}
+
+static void change_arena_free(CeChangeArena_t* arena){
+     CeChangeArenaBlock_t* itr = arena->head;
      while(itr){
-          CeBufferChangeNode_t* tmp = itr;
+          CeChangeArenaBlock_t* tmp = itr;
           itr = itr->next;
-          free(tmp->change.string);
           free(tmp);
      }
+     memset(arena, 0, sizeof(*arena));
+}
 
-     *head = NULL;
+// grows a change's string so it can hold length bytes plus the terminator. While it is the last thing allocated, which
+// it is while typing, it just grows into the rest of the block
+static bool change_string_reserve(CeChangeArena_t* arena, CeBufferChangeNode_t* node, int64_t length){
+     int64_t size = length + 1;
+     if(size <= node->string_capacity) return true;
+
+     CeChangeArenaBlock_t* block = node->string_block;
+     int64_t new_size = change_arena_align(size);
+     if(block == arena->tail && node->change.string + node->string_capacity == block->data + block->used &&
+        block->used + (new_size - node->string_capacity) <= block->capacity){
+          block->used += new_size - node->string_capacity;
+          node->string_capacity = new_size;
+          return true;
+     }
+
+     CeChangeArenaBlock_t* new_block = NULL;
+     char* string = change_arena_alloc(arena, size * 2, &new_block);
+     if(!string) return false;
+     strcpy(string, node->change.string);
+     change_arena_release(arena, block);
+     node->change.string = string;
+     node->string_block = new_block;
+     node->string_capacity = change_arena_align(size * 2);
+     return true;
+}
+
+// copies the change's string into the arena, freeing the original
+static CeBufferChangeNode_t* change_node_alloc(CeBuffer_t* buffer, CeBufferChange_t* change){
+     CeChangeArenaBlock_t* block = NULL;
+     CeBufferChangeNode_t* node = change_arena_alloc(&buffer->change_arena, sizeof(*node), &block);
+     if(!node) return NULL;
+     memset(node, 0, sizeof(*node));
+     node->block = block;
+     if(!change) return node;
+
+     node->change = *change;
+     node->index = buffer->recorded_version;
+     if(change->string){
+          int64_t size = strlen(change->string) + 1;
+          node->change.string = change_arena_alloc(&buffer->change_arena, size, &node->string_block);
+          if(!node->change.string){
+               change_arena_release(&buffer->change_arena, block);
+               return NULL;
+          }
+          memcpy(node->change.string, change->string, size);
+          node->string_capacity = change_arena_align(size);
+          free(change->string);
+     }
+     return node;
+}
+
+static void change_node_release(CeBuffer_t* buffer, CeBufferChangeNode_t* node){
+     if(node->change.string) change_arena_release(&buffer->change_arena, node->string_block);
+     change_arena_release(&buffer->change_arena, node->block);
+}
+
+static void change_nodes_free(CeBuffer_t* buffer, CeBufferChangeNode_t* head){
+     while(head){
+          CeBufferChangeNode_t* next = head->next;
+          change_node_release(buffer, head);
+          head = next;
+     }
 }
 
 bool ce_log_init(const char* filename){
@@ -92,24 +218,310 @@ void ce_log(const char* fmt, ...){
      g_ce_log_buffer->status = CE_BUFFER_STATUS_READONLY;
 }
 
-// NOTE: we expect that if we are downsizing, the lines that will be overwritten are freed prior to calling this func
-static bool buffer_realloc_lines(CeBuffer_t* buffer, int64_t new_line_count){
-     // if we want to realloc 0 lines, clear everything
-     if(new_line_count == 0){
-          free(buffer->lines);
-          buffer->lines = NULL;
-          buffer->line_count = 0;
-          return true;
-     }else if(new_line_count == buffer->line_count){
-          return true;
+static void line_info_reset(CeLineInfo_t* line_info){
+     line_info->rune_count = -1;
+     line_info->checkpoints = NULL;
+     line_info->mapped_length = 0;
+}
+
+// line infos are kept in a gap buffer, so inserting or removing lines only has to move the infos between the last edit
+// and this one, rather than shifting the whole array
+static CeLineInfo_t* line_infos_get(CeLineInfos_t* line_infos, int64_t index){
+     if(index >= line_infos->gap_start) index += line_infos->gap_end - line_infos->gap_start;
+     return line_infos->infos + index;
+}
+
+static bool line_infos_init(CeLineInfos_t* line_infos, int64_t count){
+     int64_t capacity = count + CE_BUFFER_MIN_LINE_CAPACITY;
+     line_infos->infos = malloc(capacity * sizeof(*line_infos->infos));
+     if(!line_infos->infos) return false;
+     line_infos->capacity = capacity;
+     line_infos->gap_start = count;
+     line_infos->gap_end = capacity;
+     for(int64_t i = 0; i < count; i++){
+          line_info_reset(line_infos->infos + i);
      }
+     return true;
+}
 
-     buffer->lines = realloc(buffer->lines, new_line_count * sizeof(buffer->lines[0]));
-     if(buffer->lines == NULL) return false;
-     buffer->line_count = new_line_count;
+static void line_infos_free(CeLineInfos_t* line_infos){
+     for(int64_t i = 0; i < line_infos->capacity; i++){
+          if(i >= line_infos->gap_start && i < line_infos->gap_end) continue;
+          free(line_infos->infos[i].checkpoints);
+     }
+     free(line_infos->infos);
+     memset(line_infos, 0, sizeof(*line_infos));
+}
+
+static void line_infos_move_gap(CeLineInfos_t* line_infos, int64_t index){
+     int64_t gap_len = line_infos->gap_end - line_infos->gap_start;
+     if(index < line_infos->gap_start){
+          int64_t move_count = line_infos->gap_start - index;
+          memmove(line_infos->infos + index + gap_len, line_infos->infos + index, move_count * sizeof(*line_infos->infos));
+     }else if(index > line_infos->gap_start){
+          int64_t move_count = index - line_infos->gap_start;
+          memmove(line_infos->infos + line_infos->gap_start, line_infos->infos + line_infos->gap_end,
+                  move_count * sizeof(*line_infos->infos));
+     }
+     line_infos->gap_start = index;
+     line_infos->gap_end = index + gap_len;
+}
+
+static bool line_infos_insert(CeLineInfos_t* line_infos, int64_t index, int64_t count){
+     line_infos_move_gap(line_infos, index);
+
+     int64_t gap_len = line_infos->gap_end - line_infos->gap_start;
+     if(gap_len < count){
+          int64_t new_capacity = line_infos->capacity * 2;
+          if(new_capacity < line_infos->capacity + count) new_capacity = line_infos->capacity + count;
+          CeLineInfo_t* new_infos = realloc(line_infos->infos, new_capacity * sizeof(*new_infos));
+          if(!new_infos) return false;
+
+          // slide everything after the gap to the end of the new allocation
+          int64_t after_gap_count = line_infos->capacity - line_infos->gap_end;
+          int64_t new_gap_end = new_capacity - after_gap_count;
+          memmove(new_infos + new_gap_end, new_infos + line_infos->gap_end, after_gap_count * sizeof(*new_infos));
+          line_infos->infos = new_infos;
+          line_infos->capacity = new_capacity;
+          line_infos->gap_end = new_gap_end;
+     }
+
+     for(int64_t i = 0; i < count; i++){
+          line_info_reset(line_infos->infos + line_infos->gap_start + i);
+     }
+     line_infos->gap_start += count;
      return true;
 }
 
+static void line_infos_remove(CeLineInfos_t* line_infos, int64_t index, int64_t count){
+     line_infos_move_gap(line_infos, index);
+     for(int64_t i = 0; i < count; i++){
+          free(line_infos->infos[line_infos->gap_end + i].checkpoints);
+     }
+     line_infos->gap_end += count;
+}
+
+// the line pointers are kept in a gap buffer like the line infos. With CE_BUFFER_STORAGE_LINE_ARRAY the gap is always
+// at the end, so the array is in line order and every insert or remove shifts the lines after it
+static char** buffer_line_slot(CeBuffer_t* buffer, int64_t line){
+     if(line >= buffer->line_gap_start) line += buffer->line_gap_end - buffer->line_gap_start;
+     return buffer->lines + line;
+}
+
+// call whenever the contents of a line change so we re-count it next time it is asked about
+static void buffer_line_changed(CeBuffer_t* buffer, int64_t line){
+     CeLineInfo_t* line_info = line_infos_get(&buffer->line_infos, line);
+     free(line_info->checkpoints);
+     line_info->rune_count = -1;
+     line_info->checkpoints = NULL;
+}
+
+static CeLineInfo_t* buffer_line_info(CeBuffer_t* buffer, int64_t line){
+     CeLineInfo_t* line_info = line_infos_get(&buffer->line_infos, line);
+     if(line_info->rune_count >= 0) return line_info;
+
+     const char* string = ce_buffer_line(buffer, line);
+     line_info->rune_count = ce_utf8_strlen(string);
+
+     // only long lines get checkpoints, short ones are cheap enough to walk
+     int64_t checkpoint_count = line_info->rune_count / CE_LINE_CHECKPOINT_RUNES;
+     if(checkpoint_count > 0){
+          line_info->checkpoints = malloc(checkpoint_count * sizeof(*line_info->checkpoints));
+          if(!line_info->checkpoints) return line_info;
+
+          const char* itr = string;
+          int64_t rune_len = 0;
+          for(int64_t i = 0; i < checkpoint_count; i++){
+               for(int64_t r = 0; r < CE_LINE_CHECKPOINT_RUNES; r++){
+                    ce_utf8_decode(itr, &rune_len);
+                    itr += rune_len;
+               }
+               line_info->checkpoints[i] = itr - string;
+          }
+     }
+
+     return line_info;
+}
+
+#if !defined(PLATFORM_WINDOWS)
+// reading a page of a mapping past the end of a file that was truncated out from under us raises SIGBUS, so reads from
+// a mapping are made with this armed and the handler jumps back out of them. It is volatile so the compiler can't drop
+// the stores around a memcpy() it thinks can't look at them
+static __thread sigjmp_buf* volatile g_mapping_fault_jump;
+static struct sigaction g_mapping_fault_previous_action;
+static bool g_mapping_fault_handler_installed;
+
+static void mapping_fault_handler(int sig){
+     if(g_mapping_fault_jump) siglongjmp(*g_mapping_fault_jump, 1);
+
+     // not a read we were guarding, so put the old handler back and let the fault happen again when we return
+     sigaction(sig, &g_mapping_fault_previous_action, NULL);
+}
+
+static void mapping_fault_handler_install(){
+     if(g_mapping_fault_handler_installed) return;
+     struct sigaction action = {};
+     action.sa_handler = mapping_fault_handler;
+     action.sa_flags = SA_NODEFER; // we jump out of the handler, so don't leave SIGBUS blocked behind us
+     sigemptyset(&action.sa_mask);
+     if(sigaction(SIGBUS, &action, &g_mapping_fault_previous_action) != 0){
+          ce_log("%s() sigaction(SIGBUS) failed: '%s'\n", __FUNCTION__, strerror(errno));
+          return;
+     }
+     g_mapping_fault_handler_installed = true;
+}
+#endif
+
+// returns false if the mapping no longer has the bytes behind src
+static bool mapping_copy(char* dest, const char* src, int64_t size){
+#if !defined(PLATFORM_WINDOWS)
+     sigjmp_buf jump;
+     if(sigsetjmp(jump, 0)){
+          g_mapping_fault_jump = NULL;
+          return false;
+     }
+     g_mapping_fault_jump = &jump;
+     memcpy(dest, src, size);
+     g_mapping_fault_jump = NULL;
+#else
+     memcpy(dest, src, size);
+#endif
+     return true;
+}
+
+static bool buffer_line_is_mapped(CeBuffer_t* buffer, const char* line){
+     return buffer->mapping && line >= buffer->mapping && line < buffer->mapping + buffer->mapping_size;
+}
+
+static void buffer_line_free(CeBuffer_t* buffer, char* line){
+     if(!buffer_line_is_mapped(buffer, line)) free(line);
+}
+
+// the file shrank under us, so copy out the mapped lines that are still there and empty the ones that are gone. The
+// mapping stays around until the buffer lets go of it, a load may still be scanning it
+static void buffer_mapping_lost(CeBuffer_t* buffer){
+     ce_log("%s() '%s' was truncated on disk, lines past its new end are lost\n", __FUNCTION__, buffer->name);
+     bool lost = false;
+     for(int64_t i = 0; i < buffer->line_count; i++){
+          char** slot = buffer_line_slot(buffer, i);
+          if(!buffer_line_is_mapped(buffer, *slot)) continue;
+          int64_t length = line_infos_get(&buffer->line_infos, i)->mapped_length;
+          char* copy = malloc(length + 1);
+          if(!copy) continue;
+          if(lost || !mapping_copy(copy, *slot, length)){
+               lost = true;
+               length = 0;
+          }
+          copy[length] = 0;
+          *slot = copy;
+          buffer_line_changed(buffer, i);
+     }
+}
+
+// lines that still point into the file mapping are copied onto the heap the first time they are read or modified
+static bool buffer_line_make_writable(CeBuffer_t* buffer, int64_t line){
+     char** slot = buffer_line_slot(buffer, line);
+     if(!buffer_line_is_mapped(buffer, *slot)) return true;
+     int64_t length = line_infos_get(&buffer->line_infos, line)->mapped_length;
+     char* copy = malloc(length + 1);
+     if(!copy) return false;
+     if(!mapping_copy(copy, *slot, length)){
+          free(copy);
+          buffer_mapping_lost(buffer);
+          return !buffer_line_is_mapped(buffer, *slot);
+     }
+     copy[length] = 0;
+     *slot = copy;
+     return true;
+}
+
+char* ce_buffer_line(CeBuffer_t* buffer, int64_t line){
+     // callers can't handle a NULL line, so if we can't copy it out they get an empty one until we can
+     static char empty_line[1];
+     if(!buffer_line_make_writable(buffer, line)){
+          empty_line[0] = 0;
+          return empty_line;
+     }
+     return *buffer_line_slot(buffer, line);
+}
+
+static void buffer_unmap(CeBuffer_t* buffer){
+#if !defined(PLATFORM_WINDOWS)
+     if(buffer->mapping) munmap(buffer->mapping, buffer->mapping_size);
+#endif
+     buffer->mapping = NULL;
+     buffer->mapping_size = 0;
+}
+
+// the buffer takes over lines, which has room for capacity pointers, the first count of them set
+static void buffer_set_lines(CeBuffer_t* buffer, char** lines, int64_t count, int64_t capacity){
+     buffer->lines = lines;
+     buffer->line_count = count;
+     buffer->line_capacity = capacity;
+     buffer->line_gap_start = count;
+     buffer->line_gap_end = capacity;
+}
+
+static void buffer_lines_move_gap(CeBuffer_t* buffer, int64_t line){
+     int64_t gap_len = buffer->line_gap_end - buffer->line_gap_start;
+     if(line < buffer->line_gap_start){
+          int64_t move_count = buffer->line_gap_start - line;
+          memmove(buffer->lines + line + gap_len, buffer->lines + line, move_count * sizeof(*buffer->lines));
+     }else if(line > buffer->line_gap_start){
+          int64_t move_count = line - buffer->line_gap_start;
+          memmove(buffer->lines + buffer->line_gap_start, buffer->lines + buffer->line_gap_end,
+                  move_count * sizeof(*buffer->lines));
+     }
+     buffer->line_gap_start = line;
+     buffer->line_gap_end = line + gap_len;
+}
+
+// opens up count lines before line and returns them, they are left for the caller to fill in
+static char** buffer_lines_insert(CeBuffer_t* buffer, int64_t line, int64_t count){
+     // grow geometrically so splitting/joining lines doesn't realloc the line array on every edit, we never shrink
+     // here, ce_buffer_empty() is where the array gets trimmed back down
+     if(buffer->line_gap_end - buffer->line_gap_start < count){
+          int64_t new_capacity = buffer->line_capacity ? buffer->line_capacity : CE_BUFFER_MIN_LINE_CAPACITY;
+          while(new_capacity - buffer->line_count < count) new_capacity *= 2;
+
+          char** new_lines = realloc(buffer->lines, new_capacity * sizeof(*new_lines));
+          if(new_lines == NULL) return NULL;
+          int64_t after_gap_count = buffer->line_capacity - buffer->line_gap_end;
+          int64_t new_gap_end = new_capacity - after_gap_count;
+          memmove(new_lines + new_gap_end, new_lines + buffer->line_gap_end, after_gap_count * sizeof(*new_lines));
+          buffer->lines = new_lines;
+          buffer->line_capacity = new_capacity;
+          buffer->line_gap_end = new_gap_end;
+     }
+
+     if(buffer->storage == CE_BUFFER_STORAGE_LINE_GAP){
+          buffer_lines_move_gap(buffer, line);
+     }else{
+          memmove(buffer->lines + line + count, buffer->lines + line, (buffer->line_count - line) * sizeof(*buffer->lines));
+     }
+     buffer->line_gap_start += count;
+     buffer->line_count += count;
+     return buffer->lines + line;
+}
+
+// NOTE: we expect the lines to be freed prior to calling this func
+static void buffer_lines_remove(CeBuffer_t* buffer, int64_t line, int64_t count){
+     if(buffer->storage == CE_BUFFER_STORAGE_LINE_GAP){
+          buffer_lines_move_gap(buffer, line);
+          buffer->line_gap_end += count;
+     }else{
+          int64_t after_count = buffer->line_count - (line + count);
+          memmove(buffer->lines + line, buffer->lines + line + count, after_count * sizeof(*buffer->lines));
+          buffer->line_gap_start -= count;
+     }
+     buffer->line_count -= count;
+}
+
+void ce_buffer_set_storage(CeBuffer_t* buffer, CeBufferStorage_t storage){
+     if(storage == CE_BUFFER_STORAGE_LINE_ARRAY) buffer_lines_move_gap(buffer, buffer->line_count);
+     buffer->storage = storage;
+}
+
 bool ce_buffer_alloc(CeBuffer_t* buffer, int64_t line_count, const char* name){
      if(buffer->lines) ce_buffer_free(buffer);
 
@@ -118,17 +530,24 @@ bool ce_buffer_alloc(CeBuffer_t* buffer, int64_t line_count, const char* name){
           return false;
      }
 
-     buffer->lines = (char**)malloc(line_count * sizeof(*buffer->lines));
-     if(!buffer->lines){
+     char** lines = (char**)malloc(line_count * sizeof(*lines));
+     if(!lines){
           ce_log("%s() failed to malloc() %ld lines.\n", __FUNCTION__, line_count);
           return false;
      }
 
-     buffer->line_count = line_count;
+     if(!line_infos_init(&buffer->line_infos, line_count)){
+          ce_log("%s() failed to malloc() %ld line infos.\n", __FUNCTION__, line_count);
+          free(lines);
+          return false;
+     }
+
+     buffer_set_lines(buffer, lines, line_count, line_count);
      buffer->name = strdup(name);
+     buffer->version++;
 
      for(int64_t i = 0; i < line_count; i++){
-          buffer->lines[i] = (char*)calloc(1, sizeof(buffer->lines[i]));
+          lines[i] = (char*)calloc(1, sizeof(lines[i]));
      }
 
      buffer->status = CE_BUFFER_STATUS_MODIFIED;
@@ -137,36 +556,185 @@ bool ce_buffer_alloc(CeBuffer_t* buffer, int64_t line_count, const char* name){
 
 void ce_buffer_free(CeBuffer_t* buffer){
      for(int64_t i = 0; i < buffer->line_count; i++){
-          free(buffer->lines[i]);
+          buffer_line_free(buffer, *buffer_line_slot(buffer, i));
      }
 
      free(buffer->lines);
+     line_infos_free(&buffer->line_infos);
+     buffer_unmap(buffer);
      free(buffer->name);
 
-     if(buffer->change_node){
-          CeBufferChangeNode_t* head = buffer->change_node;
-          while(head->prev) head = head->prev;
-          ce_buffer_change_node_free(&head);
-     }
+     change_arena_free(&buffer->change_arena);
 
+     // keep counting, anything built from the old lines needs to know they are gone
+     int64_t version = buffer->version;
+     int64_t change_memory_limit = buffer->change_memory_limit;
+     CeBufferStorage_t storage = buffer->storage;
+     void* syntax_cache = buffer->syntax_cache;
      memset(buffer, 0, sizeof(*buffer));
+     buffer->version = version + 1;
+     buffer->change_memory_limit = change_memory_limit;
+     buffer->storage = storage;
+     buffer->syntax_cache = syntax_cache;
 }
 
-bool ce_buffer_load_file(CeBuffer_t* buffer, const char* filename){
-     struct stat statbuf;
-     if(stat(filename, &statbuf) != 0) return false;
+// the line table is built straight from the scan: every newline we find adds a pointer to the start of the next line
+static bool line_split_add(CeLineSplit_t* split, char* line_start){
+     if(split->line_count == split->line_capacity){
+          int64_t new_capacity = split->line_capacity ? split->line_capacity * 2 : CE_BUFFER_MIN_LINE_CAPACITY;
+          char** new_lines = realloc(split->lines, new_capacity * sizeof(*new_lines));
+          if(!new_lines) return false;
+          split->lines = new_lines;
+          split->line_capacity = new_capacity;
+     }
+
+     split->lines[split->line_count] = line_start;
+     split->line_count++;
+     return true;
+}
+
+static bool line_split_newline(CeLineSplit_t* split, char* newline){
+     return line_split_add(split, newline + 1);
+}
+
+static bool line_split_scalar(CeLineSplit_t* split, char* itr, const char* end){
+     for(; itr < end; itr++){
+          unsigned char byte = *itr;
+          if(split->continuation_bytes){
+               if((byte & 0xC0) != 0x80) return false;
+               split->continuation_bytes--;
+          }else if(byte == CE_NEWLINE){
+               if(!line_split_newline(split, itr)) return false;
+          }else if(byte == 0){
+               return false;
+          }else if(byte < 0x80){
+               // ascii
+          }else if(byte >= 0xC2 && byte <= 0xDF){
+               split->continuation_bytes = 1;
+          }else if((byte & 0xF0) == 0xE0){
+               split->continuation_bytes = 2;
+          }else if(byte >= 0xF0 && byte <= 0xF4){
+               split->continuation_bytes = 3;
+          }else{
+               return false;
+          }
+     }
+
+     return true;
+}
+
+#if defined(CE_SPLIT_LINES_X86)
+// chunks that are pure ascii only need their newlines picked out, anything else falls back to the scalar path so
+// multi-byte runes can be validated (which also carries a rune that straddles chunks into the next one)
+static bool line_split_ascii_mask(CeLineSplit_t* split, char* chunk, uint32_t newline_mask){
+     while(newline_mask){
+          if(!line_split_newline(split, chunk + __builtin_ctz(newline_mask))) return false;
+          newline_mask &= newline_mask - 1;
+     }
+     return true;
+}
+
+__attribute__((target("avx2")))
+static bool line_split_avx2(CeLineSplit_t* split, char** itr, const char* end){
+     const __m256i newlines = _mm256_set1_epi8(CE_NEWLINE);
+     const __m256i nulls = _mm256_setzero_si256();
+     char* chunk = *itr;
+     for(; end - chunk >= 32; chunk += 32){
+          __m256i bytes = _mm256_loadu_si256((const __m256i*)chunk);
+          uint32_t non_ascii_mask = _mm256_movemask_epi8(bytes);
+          uint32_t null_mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, nulls));
+          if(non_ascii_mask || null_mask || split->continuation_bytes){
+               if(!line_split_scalar(split, chunk, chunk + 32)) return false;
+               continue;
+          }
+
+          uint32_t newline_mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, newlines));
+          if(!line_split_ascii_mask(split, chunk, newline_mask)) return false;
+     }
+
+     *itr = chunk;
+     return true;
+}
+
+static bool line_split_sse2(CeLineSplit_t* split, char** itr, const char* end){
+     const __m128i newlines = _mm_set1_epi8(CE_NEWLINE);
+     const __m128i nulls = _mm_setzero_si128();
+     char* chunk = *itr;
+     for(; end - chunk >= 16; chunk += 16){
+          __m128i bytes = _mm_loadu_si128((const __m128i*)chunk);
+          uint32_t non_ascii_mask = _mm_movemask_epi8(bytes);
+          uint32_t null_mask = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, nulls));
+          if(non_ascii_mask || null_mask || split->continuation_bytes){
+               if(!line_split_scalar(split, chunk, chunk + 16)) return false;
+               continue;
+          }
+
+          uint32_t newline_mask = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newlines));
+          if(!line_split_ascii_mask(split, chunk, newline_mask)) return false;
+     }
+
+     *itr = chunk;
+     return true;
+}
+#endif
+
+static bool line_split_begin(CeLineSplit_t* split, char* data){
+     memset(split, 0, sizeof(*split));
+     return line_split_add(split, data);
+}
+
+// validates the chunk is utf-8 without any nulls while splitting it into lines, in a single pass. Chunks have to be
+// passed in order, and a rune may straddle two of them. On failure, split->line_count is the line the bad byte was
+// found on.
+static bool line_split_chunk(CeLineSplit_t* split, char* itr, const char* end){
+#if defined(CE_SPLIT_LINES_X86)
+     if(__builtin_cpu_supports("avx2")){
+          if(!line_split_avx2(split, &itr, end)) return false;
+     }
+     if(!line_split_sse2(split, &itr, end)) return false;
+#endif
+     return line_split_scalar(split, itr, end);
+}
+
+// the line count is always one more than the number of newlines
+static bool line_split(CeLineSplit_t* split, char* data, int64_t len){
+     if(!line_split_begin(split, data)) return false;
+     if(!line_split_chunk(split, data, data + len)) return false;
+
+     // the data can't end in the middle of a rune
+     return split->continuation_bytes == 0;
+}
+
+// hands the split lines over to the buffer, along with fresh line infos
+static bool buffer_take_lines(CeBuffer_t* buffer, CeLineSplit_t* split, const char* name){
+     if(!line_infos_init(&buffer->line_infos, split->line_count)){
+          ce_log("%s() failed to allocate %ld line infos\n", __FUNCTION__, split->line_count);
+          return false;
+     }
+
+     buffer_set_lines(buffer, split->lines, split->line_count, split->line_capacity);
+     buffer->name = strdup(name);
+     buffer->version++;
+     return true;
+}
+
+// stat the file, make sure it's something we can load and set up the buffer's status from it
+static bool buffer_prepare_file_load(CeBuffer_t* buffer, const char* filename, struct stat* statbuf){
+     if(stat(filename, statbuf) != 0) return false;
      bool is_dir = false;
 
 #if defined(PLATFORM_WINDOWS)
-     is_dir = (statbuf.st_mode & _S_IFDIR);
+     is_dir = (statbuf->st_mode & _S_IFDIR);
 #else
-     is_dir = S_ISDIR(statbuf.st_mode);
+     is_dir = S_ISDIR(statbuf->st_mode);
 #endif
      if(is_dir){
           errno = EPERM;
           return false;
      }
 
+     if(buffer->lines) ce_buffer_free(buffer);
+
 #if defined(PLATFORM_WINDOWS)
      bool writeable = (_access(filename, 2) == 0);
      bool readable = (_access(filename, 4) == 0);
@@ -187,7 +755,187 @@ bool ce_buffer_load_file(CeBuffer_t* buffer, const char* filename){
      }
 #endif
 
-     buffer->file_modified_time = statbuf.st_mtime;
+     buffer->file_modified_time = statbuf->st_mtime;
+     return true;
+}
+
+#if defined(PLATFORM_WINDOWS)
+bool ce_buffer_file_load_begin(CeBuffer_t* buffer, CeBufferFileLoad_t* load, const char* filename){
+     // no mapping to load from in pieces, so do it all up front
+     memset(load, 0, sizeof(*load));
+     if(!ce_buffer_load_file(buffer, filename)) return false;
+     load->final_status = buffer->status;
+     load->placeholder_replaced = true;
+     return true;
+}
+
+bool ce_buffer_file_load_step(CeBufferFileLoad_t* load, int64_t max_bytes){
+     return true;
+}
+#else
+// the file is mapped read only and lines point straight into the mapping, their lengths kept in their line infos, until
+// they are first read or modified
+bool ce_buffer_file_load_begin(CeBuffer_t* buffer, CeBufferFileLoad_t* load, const char* filename){
+     memset(load, 0, sizeof(*load));
+
+     struct stat statbuf;
+     if(!buffer_prepare_file_load(buffer, filename, &statbuf)) return false;
+
+     if(statbuf.st_size > 0){
+          int fd = open(filename, O_RDONLY);
+          if(fd < 0){
+               ce_log("%s() open('%s', O_RDONLY) failed: '%s'\n", __FUNCTION__, filename, strerror(errno));
+               return false;
+          }
+
+          load->mapping = mmap(NULL, statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+          close(fd);
+          if(load->mapping == MAP_FAILED){
+               ce_log("%s() mmap('%s') failed: '%s'\n", __FUNCTION__, filename, strerror(errno));
+               load->mapping = NULL;
+               return false;
+          }
+          load->mapping_size = statbuf.st_size;
+          madvise(load->mapping, load->mapping_size, MADV_SEQUENTIAL);
+          mapping_fault_handler_install();
+
+          if(!line_split_begin(&load->split, load->mapping)){
+               munmap(load->mapping, load->mapping_size);
+               return false;
+          }
+     }
+
+     // start with a single empty line, so there is something to display until the first lines come in
+     load->final_status = buffer->status;
+     time_t file_modified_time = buffer->file_modified_time;
+     if(!ce_buffer_alloc(buffer, 1, filename)){
+          free(load->split.lines);
+          if(load->mapping) munmap(load->mapping, load->mapping_size);
+          return false;
+     }
+     buffer->status = CE_BUFFER_STATUS_READONLY;
+     buffer->file_modified_time = file_modified_time;
+     buffer->mapping = load->mapping;
+     buffer->mapping_size = load->mapping_size;
+     return true;
+}
+
+bool ce_buffer_file_load_step(CeBufferFileLoad_t* load, int64_t max_bytes){
+     int64_t bytes_left = load->mapping_size - load->bytes_split;
+     int64_t len = (max_bytes < bytes_left) ? max_bytes : bytes_left;
+     char* chunk = load->mapping + load->bytes_split;
+
+     // the file may be truncated while we scan it
+     sigjmp_buf jump;
+     if(sigsetjmp(jump, 0)){
+          g_mapping_fault_jump = NULL;
+          load->truncated = true;
+          load->failed = true;
+          return false;
+     }
+     g_mapping_fault_jump = &jump;
+     bool valid = line_split_chunk(&load->split, chunk, chunk + len);
+     g_mapping_fault_jump = NULL;
+     if(!valid){
+          load->failed = true;
+          return false;
+     }
+
+     load->bytes_split += len;
+
+     // the file can't end in the middle of a rune
+     if(load->bytes_split == load->mapping_size && load->split.continuation_bytes){
+          load->failed = true;
+          return false;
+     }
+
+     return true;
+}
+#endif
+
+bool ce_buffer_file_load_take(CeBuffer_t* buffer, CeBufferFileLoad_t* load){
+     CeLineSplit_t* split = &load->split;
+     bool finished = load->failed || load->bytes_split == load->mapping_size;
+
+     // the last line split is still being scanned, unless the whole file has been
+     char* end = load->mapping + load->mapping_size;
+     int64_t take_count = split->line_count ? split->line_count - 1 : 0;
+     if(finished && !load->failed && split->line_count){
+          // a file ending in a newline doesn't start another line
+          if(split->lines[split->line_count - 1] < end) take_count++;
+     }
+
+     if(take_count > 0){
+          buffer->version++;
+          if(!load->placeholder_replaced){
+               free(ce_buffer_line(buffer, 0));
+               buffer_lines_remove(buffer, 0, 1);
+               line_infos_remove(&buffer->line_infos, 0, 1);
+               load->placeholder_replaced = true;
+          }
+
+          int64_t first_new_line = buffer->line_count;
+          char** new_lines = buffer_lines_insert(buffer, first_new_line, take_count);
+          if(!new_lines || !line_infos_insert(&buffer->line_infos, first_new_line, take_count)){
+               ce_log("%s() failed to allocate %ld more lines\n", __FUNCTION__, take_count);
+               if(new_lines) buffer_lines_remove(buffer, first_new_line, take_count);
+               load->failed = true;
+               finished = true;
+          }else{
+               memcpy(new_lines, split->lines, take_count * sizeof(*split->lines));
+
+               // each line runs up to the newline before the next one starts, or the end of the file
+               for(int64_t i = 0; i < take_count; i++){
+                    char* line_end = (i + 1 < split->line_count) ? split->lines[i + 1] - 1 : end;
+                    line_infos_get(&buffer->line_infos, first_new_line + i)->mapped_length = line_end - split->lines[i];
+               }
+               memmove(split->lines, split->lines + take_count, (split->line_count - take_count) * sizeof(*split->lines));
+               split->line_count -= take_count;
+          }
+     }
+
+     if(finished){
+          // anything left unscanned isn't in the buffer, so don't let it get saved over the file
+          buffer->status = load->failed ? CE_BUFFER_STATUS_READONLY : load->final_status;
+          free(split->lines);
+          memset(split, 0, sizeof(*split));
+     }
+
+     return finished;
+}
+
+void ce_buffer_file_load_cancel(CeBuffer_t* buffer, CeBufferFileLoad_t* load){
+     load->failed = true;
+     ce_buffer_file_load_take(buffer, load);
+}
+
+int64_t ce_buffer_file_load_percent(CeBufferFileLoad_t* load){
+     if(load->mapping_size == 0) return 100;
+     return (load->bytes_split * 100) / load->mapping_size;
+}
+
+bool ce_buffer_load_file(CeBuffer_t* buffer, const char* filename){
+#if !defined(PLATFORM_WINDOWS)
+     CeBufferFileLoad_t load;
+     if(!ce_buffer_file_load_begin(buffer, &load, filename)) return false;
+
+     if(!ce_buffer_file_load_step(&load, load.mapping_size)){
+          if(load.truncated){
+               ce_log("%s() file '%s' was truncated while loading it\n", __FUNCTION__, filename);
+          }else{
+               ce_log("%s() file '%s' has a null terminator or invalid utf-8 on line %ld\n", __FUNCTION__, filename,
+                      load.split.line_count);
+          }
+          ce_buffer_file_load_cancel(buffer, &load);
+          ce_buffer_free(buffer);
+          errno = ENOPROTOOPT;
+          return false;
+     }
+
+     ce_buffer_file_load_take(buffer, &load);
+#else
+     struct stat statbuf;
+     if(!buffer_prepare_file_load(buffer, filename, &statbuf)) return false;
 
      // read the entire file
      size_t content_size;
@@ -214,7 +962,7 @@ bool ce_buffer_load_file(CeBuffer_t* buffer, const char* filename){
      }
 
      // strip the ending '\n'
-     if(contents[content_size - 1] == CE_NEWLINE) contents[content_size - 1] = 0;
+     if(content_size > 0 && contents[content_size - 1] == CE_NEWLINE) contents[content_size - 1] = 0;
 
      if(!ce_buffer_load_string(buffer, contents, filename)){
           return false;
@@ -223,89 +971,211 @@ bool ce_buffer_load_file(CeBuffer_t* buffer, const char* filename){
      fclose(file);
 
      free(contents);
+#endif
      ce_log("%s() loaded '%s'\n", __FUNCTION__, filename);
      return true;
 }
 
-typedef enum{
-     FNS_OK,
-     FNS_EOF,
-     FNS_INVALID,
-}FindNewlineStatus_t;
+bool ce_buffer_load_string(CeBuffer_t* buffer, const char* string, const char* name){
+     if(buffer->lines) ce_buffer_free(buffer);
+
+     // the split only reads from the string
+     CeLineSplit_t split;
+     int64_t string_len = strlen(string);
+     if(!line_split(&split, (char*)(string), string_len)){
+          ce_log("%s() saw invalid utf-8 bytes on line %ld\n", __FUNCTION__, split.line_count);
+          free(split.lines);
+          return false;
+     }
 
-typedef struct{
-     const char* str;
-     FindNewlineStatus_t status;
-}FindNewlineResult_t;
+     // replace each line start with a copy of the line, the next line's start tells us where this one ends
+     const char* string_end = string + string_len;
+     for(int64_t i = 0; i < split.line_count; i++){
+          const char* line_start = split.lines[i];
+          const char* line_end = (i + 1 < split.line_count) ? split.lines[i + 1] - 1 : string_end;
+          size_t line_len = line_end - line_start;
+          split.lines[i] = (char*)malloc(line_len + 1);
+          memcpy(split.lines[i], line_start, line_len);
+          split.lines[i][line_len] = 0;
+     }
 
-static FindNewlineResult_t find_next_newline(const char* str){
-     int64_t rune_len = 0;
-     FindNewlineResult_t status = {};
-     while(*str){
-          CeRune_t rune = ce_utf8_decode(str, &rune_len);
-          if(rune == CE_NEWLINE){
-               status.str = str;
-               status.status = FNS_OK;
-               return status;
-          }else if(rune == CE_UTF8_INVALID){
-               status.status = FNS_INVALID;
-               return status;
+     if(!buffer_take_lines(buffer, &split, name)){
+          for(int64_t i = 0; i < split.line_count; i++) free(split.lines[i]);
+          free(split.lines);
+          return false;
+     }
+
+     return true;
+}
+
+#if !defined(PLATFORM_WINDOWS)
+// write every line followed by a newline, gathering as many lines as we can into each writev()
+static bool buffer_write_lines(CeBuffer_t* buffer, int fd){
+     static char newline = CE_NEWLINE;
+     struct iovec iovecs[CE_SAVE_IOVEC_COUNT];
+
+     int64_t line = 0;
+     while(line < buffer->line_count){
+          int iovec_count = 0;
+          ssize_t batch_len = 0;
+          for(; line < buffer->line_count && iovec_count + 2 <= CE_SAVE_IOVEC_COUNT; line++){
+               // mapped lines are written straight out of the mapping, if the file was truncated under us writev() fails
+               // with EFAULT rather than faulting
+               char* string = *buffer_line_slot(buffer, line);
+               iovecs[iovec_count].iov_base = string;
+               if(buffer_line_is_mapped(buffer, string)){
+                    iovecs[iovec_count].iov_len = line_infos_get(&buffer->line_infos, line)->mapped_length;
+               }else{
+                    iovecs[iovec_count].iov_len = strlen(string);
+               }
+               batch_len += iovecs[iovec_count].iov_len;
+               iovec_count++;
+               iovecs[iovec_count].iov_base = &newline;
+               iovecs[iovec_count].iov_len = 1;
+               batch_len++;
+               iovec_count++;
+          }
+
+          // short writes leave us part way through the batch, so skip over whatever made it out and keep going
+          struct iovec* itr = iovecs;
+          while(batch_len > 0){
+               ssize_t written = writev(fd, itr, iovec_count);
+               if(written < 0){
+                    if(errno == EINTR) continue;
+                    return false;
+               }
+
+               batch_len -= written;
+               while(iovec_count > 0 && (size_t)(written) >= itr->iov_len){
+                    written -= itr->iov_len;
+                    itr++;
+                    iovec_count--;
+               }
+               if(iovec_count > 0){
+                    itr->iov_base = (char*)(itr->iov_base) + written;
+                    itr->iov_len -= written;
+               }
           }
-          str += rune_len;
      }
 
-     status.status = FNS_EOF;
-     return status;
+     return true;
 }
 
-bool ce_buffer_load_string(CeBuffer_t* buffer, const char* string, const char* name){
-     if(buffer->lines) ce_buffer_free(buffer);
+// write to a temporary file next to the original, then rename it over the original, so the original is never left
+// half written if we crash (or the disk fills up) part way through
+static bool buffer_save_atomic(CeBuffer_t* buffer, bool* try_in_place){
+     // follow symlinks so we replace the file they point at, rather than the link
+     char* path = realpath(buffer->name, NULL);
+     if(!path) path = strdup(buffer->name);
 
-     int64_t line_count = ce_util_count_string_lines(string);
+     struct stat statbuf;
+     bool exists = (stat(path, &statbuf) == 0);
 
-     // allocate for the number of lines contained in the string
-     buffer->lines = (char**)calloc(line_count, sizeof(*buffer->lines));
-     if(!buffer->lines){
-          ce_log("%s() failed to allocate %ld lines\n", __FUNCTION__, line_count);
+     // the rename makes a new inode owned by us, so only replace files we own and could have written anyway
+     if(exists && (statbuf.st_uid != geteuid() || access(path, W_OK) != 0)){
+          *try_in_place = true;
+          free(path);
           return false;
      }
 
-     buffer->line_count = line_count;
-     buffer->name = strdup(name);
+     char temp_path[PATH_MAX];
+     char* last_slash = strrchr(path, '/');
+     if(last_slash){
+          snprintf(temp_path, PATH_MAX, "%.*s/.%s.XXXXXX", (int)(last_slash - path), path, last_slash + 1);
+     }else{
+          snprintf(temp_path, PATH_MAX, ".%s.XXXXXX", path);
+     }
 
-     // loop over each line
-     const char* newline = NULL;
-     size_t line_len = 0;
-     for(int64_t i = 0; i < line_count; i++){
-          FindNewlineResult_t res = find_next_newline(string);
-          if(res.status == FNS_INVALID){
-               ce_log("%s() saw invalid utf-8 bytes\n");
-               ce_buffer_free(buffer);
-               return false;
-          }
+     // if we can't create files in the directory, the file itself may still be writable
+     int fd = mkstemp(temp_path);
+     if(fd < 0){
+          ce_log("%s() mkstemp('%s') failed: '%s'\n", __FUNCTION__, temp_path, strerror(errno));
+          *try_in_place = true;
+          free(path);
+          return false;
+     }
 
-          // look for the newline
-          newline = strchr(string, CE_NEWLINE);
+     // the temp file starts out only readable by us, so give it the original's group and permissions, or the ones
+     // open() would have given a new file
+     mode_t mode = 0;
+     if(exists){
+          mode = statbuf.st_mode & 07777;
+     }else{
+          mode_t mask = umask(0);
+          umask(mask);
+          mode = 0666 & ~mask;
+     }
 
-          if(newline){
-               // allocate space for the line, excluding the newline character
-               line_len = newline - string;
-               buffer->lines[i] = (char*)malloc(line_len + 1);
-               buffer->lines[i] = strncpy(buffer->lines[i], string, line_len);
-               buffer->lines[i][line_len] = 0;
+     if((exists && fchown(fd, statbuf.st_uid, statbuf.st_gid) != 0) || fchmod(fd, mode) != 0){
+          ce_log("%s() failed to set the owner and mode of '%s': '%s'\n", __FUNCTION__, temp_path, strerror(errno));
+          close(fd);
+          unlink(temp_path);
+          *try_in_place = true;
+          free(path);
+          return false;
+     }
 
-               string = newline + 1;
-          }else{
-               // if this is the end, just dupe it
-               buffer->lines[i] = strdup(string);
-               break;
-          }
+     if(!buffer_write_lines(buffer, fd) || fsync(fd) != 0){
+          ce_log("%s() failed to write '%s': '%s'\n", __FUNCTION__, temp_path, strerror(errno));
+          close(fd);
+          unlink(temp_path);
+          free(path);
+          return false;
+     }
+
+     close(fd);
+
+     if(rename(temp_path, path) != 0){
+          ce_log("%s() rename('%s', '%s') failed: '%s'\n", __FUNCTION__, temp_path, path, strerror(errno));
+          unlink(temp_path);
+          free(path);
+          return false;
+     }
+
+     // make sure the rename itself makes it to disk
+     int dir_fd = -1;
+     if(last_slash){
+          *last_slash = 0;
+          dir_fd = open(*path ? path : "/", O_RDONLY | O_DIRECTORY);
+     }else{
+          dir_fd = open(".", O_RDONLY | O_DIRECTORY);
+     }
+     if(dir_fd >= 0){
+          fsync(dir_fd);
+          close(dir_fd);
      }
 
+     free(path);
      return true;
 }
 
+// hard links would be broken off by the rename, so those files (and ones in directories we can't write to) get
+// written in place
+static bool buffer_save_in_place(CeBuffer_t* buffer){
+     // truncating the file would pull the pages out from under lines that still point into its mapping
+     for(int64_t i = 0; i < buffer->line_count; i++){
+          if(!buffer_line_make_writable(buffer, i)){
+               ce_log("%s() failed to copy line %ld out of the mapping of '%s'\n", __FUNCTION__, i, buffer->name);
+               return false;
+          }
+     }
+     buffer_unmap(buffer);
+
+     int fd = open(buffer->name, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+     if(fd < 0){
+          ce_log("%s() open('%s') failed: '%s'\n", __FUNCTION__, buffer->name, strerror(errno));
+          return false;
+     }
+
+     bool success = buffer_write_lines(buffer, fd);
+     if(!success) ce_log("%s() failed to write '%s': '%s'\n", __FUNCTION__, buffer->name, strerror(errno));
+     close(fd);
+     return success;
+}
+#endif
+
 bool ce_buffer_save(CeBuffer_t* buffer){
+#if defined(PLATFORM_WINDOWS)
      FILE* file = fopen(buffer->name, "wb");
      if(!file){
           ce_log("%s() fopen('%s', 'wb') failed: '%s'\n", __FUNCTION__, buffer->name, strerror(errno));
@@ -314,12 +1184,20 @@ bool ce_buffer_save(CeBuffer_t* buffer){
 
      char newline = CE_NEWLINE;
      for(int64_t i = 0; i < buffer->line_count; ++i){
-          int64_t line_len = strlen(buffer->lines[i]);
-          fwrite(buffer->lines[i], 1, line_len, file);
+          int64_t line_len = strlen(ce_buffer_line(buffer, i));
+          fwrite(ce_buffer_line(buffer, i), 1, line_len, file);
           fwrite(&newline, 1, 1, file);
      }
 
      fclose(file);
+#else
+     struct stat link_statbuf;
+     bool hard_linked = (stat(buffer->name, &link_statbuf) == 0 && link_statbuf.st_nlink > 1);
+     bool try_in_place = hard_linked;
+     if(!hard_linked && !buffer_save_atomic(buffer, &try_in_place) && !try_in_place) return false;
+     if(try_in_place && !buffer_save_in_place(buffer)) return false;
+#endif
+
      if(buffer->status == CE_BUFFER_STATUS_MODIFIED) buffer->status = CE_BUFFER_STATUS_NONE;
      buffer->save_at_change_node = buffer->change_node;
 
@@ -334,24 +1212,34 @@ bool ce_buffer_save(CeBuffer_t* buffer){
 bool ce_buffer_empty(CeBuffer_t* buffer){
      if(buffer->lines == NULL) return false;
 
+     // allocate the new line info up front, so failing leaves the buffer as it was
+     CeLineInfos_t line_infos = {};
+     if(!line_infos_init(&line_infos, 1)){
+          ce_log("%s() failed to malloc() line infos.\n", __FUNCTION__);
+          return false;
+     }
+
      // free all lines after the first
      for(int64_t i = 0; i < buffer->line_count; ++i){
-          free(buffer->lines[i]);
+          buffer_line_free(buffer, *buffer_line_slot(buffer, i));
      }
+     buffer_unmap(buffer);
 
      // re allocate it down to a single blank line
-     buffer->lines = realloc(buffer->lines, sizeof(*buffer->lines));
+     buffer_set_lines(buffer, realloc(buffer->lines, sizeof(*buffer->lines)), 1, 1);
      buffer->lines[0] = malloc(sizeof(buffer->lines[0]));
      buffer->lines[0][0] = 0;
-     buffer->line_count = 1;
+     line_infos_free(&buffer->line_infos);
+     buffer->line_infos = line_infos;
      buffer->status = CE_BUFFER_STATUS_NONE;
+     buffer->version++;
 
      return true;
 }
 
 bool ce_buffer_contains_point(CeBuffer_t* buffer, CePoint_t point){
      if(point.y < 0 || point.y >= buffer->line_count || point.x < 0) return false;
-     int64_t line_len = ce_utf8_strlen(buffer->lines[point.y]);
+     int64_t line_len = buffer_line_info(buffer, point.y)->rune_count;
      if(point.x >= line_len){
           if(line_len == 0 && point.x == 0){
                return true;
@@ -364,7 +1252,7 @@ bool ce_buffer_contains_point(CeBuffer_t* buffer, CePoint_t point){
 
 int64_t ce_buffer_point_is_valid(CeBuffer_t* buffer, CePoint_t point){
      if(point.y < 0 || point.y >= buffer->line_count || point.x < 0) return false;
-     int64_t line_len = ce_utf8_strlen(buffer->lines[point.y]);
+     int64_t line_len = buffer_line_info(buffer, point.y)->rune_count;
      if(point.x > line_len) return false;
 
      return true;
@@ -373,90 +1261,139 @@ int64_t ce_buffer_point_is_valid(CeBuffer_t* buffer, CePoint_t point){
 CeRune_t ce_buffer_get_rune(CeBuffer_t* buffer, CePoint_t point){
      if(!ce_buffer_point_is_valid(buffer, point)) return CE_UTF8_INVALID;
 
-     char* str = ce_utf8_iterate_to(buffer->lines[point.y], point.x);
+     char* str = ce_buffer_line_iterate_to(buffer, point.y, point.x);
      int64_t rune_len = 0;
      return ce_utf8_decode(str, &rune_len);
 }
 
+void ce_search_init(CeSearch_t* search, const char* pattern){
+     search->pattern = pattern;
+     search->length = strlen(pattern);
+     search->rune_length = ce_utf8_strlen(pattern);
+
+     int32_t length = search->length;
+     for(int64_t i = 0; i < 256; i++){
+          search->reverse_skip[i] = length;
+     }
+
+     // line the window up with the first occurrence of the byte we mismatched on, the first pattern byte itself is
+     // left out so we always make progress
+     for(int32_t i = length - 1; i > 0; i--){
+          search->reverse_skip[(unsigned char)(pattern[i])] = i;
+     }
+}
+
+// finds the last match that fits entirely between string and end
+const char* ce_search_find_reverse(const CeSearch_t* search, const char* string, const char* end){
+     int64_t length = search->length;
+     int64_t string_len = end - string;
+     if(length == 0) return end;
+     if(string_len < length) return NULL;
+
+     const unsigned char* pattern = (const unsigned char*)(search->pattern);
+     unsigned char first = pattern[0];
+     for(int64_t offset = string_len - length; offset >= 0;){
+          unsigned char byte = string[offset];
+          if(byte == first && memcmp(string + offset + 1, pattern + 1, length - 1) == 0) return string + offset;
+          offset -= search->reverse_skip[byte];
+     }
+
+     return NULL;
+}
+
+static int64_t utf8_rune_count(const char* start, const char* end){
+     int64_t count = 0;
+     for(const char* itr = start; itr < end; itr++){
+          if((*itr & 0xC0) != 0x80) count++;
+     }
+     return count;
+}
+
+// lines are null terminated, so searching forward to the end of one is exactly what strstr() does, and libc already
+// vectorizes it
+static const char* search_find_to_end(const CeSearch_t* search, const char* string){
+     if(search->length == 0) return string;
+     return strstr(string, search->pattern);
+}
+
+void ce_search_line_begin(CeSearchLineItr_t* line_itr, const char* line){
+     line_itr->itr = line;
+     line_itr->rune_index = 0;
+}
+
+int64_t ce_search_line_next(const CeSearch_t* search, CeSearchLineItr_t* line_itr){
+     // an empty pattern would match at the same spot forever
+     if(search->length == 0) return -1;
+
+     const char* match = search_find_to_end(search, line_itr->itr);
+     if(!match) return -1;
+
+     int64_t match_index = line_itr->rune_index + utf8_rune_count(line_itr->itr, match);
+     line_itr->itr = match + search->length;
+     line_itr->rune_index = match_index + search->rune_length;
+     return match_index;
+}
+
 CePoint_t ce_buffer_search_forward(CeBuffer_t* buffer, CePoint_t start, const char* pattern){
+     CeSearch_t search;
+     ce_search_init(&search, pattern);
+     return ce_buffer_literal_search_forward(buffer, start, &search);
+}
+
+CePoint_t ce_buffer_search_backward(CeBuffer_t* buffer, CePoint_t start, const char* pattern){
+     CeSearch_t search;
+     ce_search_init(&search, pattern);
+     return ce_buffer_literal_search_backward(buffer, start, &search);
+}
+
+CePoint_t ce_buffer_literal_search_forward(CeBuffer_t* buffer, CePoint_t start, const CeSearch_t* search){
      CePoint_t result = (CePoint_t){-1, -1};
 
      if(!ce_buffer_point_is_valid(buffer, start)) return result;
 
-     int64_t save_y = start.y;
-     char* itr = ce_utf8_iterate_to(buffer->lines[start.y], start.x);
-     char* match = NULL;
+     const char* itr = ce_buffer_line_iterate_to(buffer, start.y, start.x);
+     int64_t itr_rune_index = start.x;
 
      // try to match the pattern on each line to the end
      while(true){
-          match = strstr(itr, pattern);
-          if(match) break;
+          const char* match = search_find_to_end(search, itr);
+          if(match){
+               result.x = itr_rune_index + utf8_rune_count(itr, match);
+               result.y = start.y;
+               break;
+          }
           start.y++;
           if(start.y >= buffer->line_count) break;
-          itr = buffer->lines[start.y];
-     }
-
-     if(match){
-          // figure out index in the line
-          int64_t index = 0;
-          int64_t rune_len = 0;
-          while(match > itr){
-               ce_utf8_decode(itr, &rune_len);
-               itr += rune_len;
-               index++;
-          }
-
-          if(start.y == save_y){
-               // if we are on the same line, use the starting x plus the index
-               result.x = start.x + index;
-          }else{
-               result.x = index;
-          }
-          result.y = start.y;
+          itr = ce_buffer_line(buffer, start.y);
+          itr_rune_index = 0;
      }
 
      return result;
 }
 
-CePoint_t ce_buffer_search_backward(CeBuffer_t* buffer, CePoint_t start, const char* pattern){
+CePoint_t ce_buffer_literal_search_backward(CeBuffer_t* buffer, CePoint_t start, const CeSearch_t* search){
      CePoint_t result = (CePoint_t){-1, -1};
 
      if(!ce_buffer_point_is_valid(buffer, start)) return result;
 
-     char* beginning_of_line = buffer->lines[start.y];
-     char* itr = ce_utf8_iterate_to(beginning_of_line, start.x);
-     bool match = false;
-     size_t pattern_len = strlen(pattern);
+     // on the first line, a match may start at the start point and run passed it
+     const char* line = ce_buffer_line(buffer, start.y);
+     const char* line_end = line + strlen(line);
+     const char* end = ce_buffer_line_iterate_to(buffer, start.y, start.x) + search->length;
+     if(end > line_end) end = line_end;
 
-     // try to match the pattern on each line to the end
+     // try to match the pattern on each line to the beginning
      while(true){
-          while(itr > beginning_of_line){
-               if(strncmp(itr, pattern, pattern_len) == 0){
-                    match = true;
-                    break;
-               }
-
-               itr--;
+          const char* match = ce_search_find_reverse(search, line, end);
+          if(match){
+               result.x = ce_buffer_line_rune_index(buffer, start.y, match);
+               result.y = start.y;
+               break;
           }
-          if(match) break;
           start.y--;
           if(start.y < 0) break;
-          beginning_of_line = buffer->lines[start.y];
-          itr = beginning_of_line + ce_utf8_last_index(beginning_of_line);
-     }
-
-     if(match){
-          // figure out index in the line
-          int64_t index = 0;
-          int64_t rune_len = 0;
-          while(itr > beginning_of_line){
-               ce_utf8_decode(beginning_of_line, &rune_len);
-               beginning_of_line += rune_len;
-               index++;
-          }
-
-          result.x = index;
-          result.y = start.y;
+          line = ce_buffer_line(buffer, start.y);
+          end = line + strlen(line);
      }
 
      return result;
@@ -467,22 +1404,29 @@ CeRegexSearchResult_t ce_buffer_regex_search_forward(CeBuffer_t* buffer, CePoint
 
      if(!ce_buffer_point_is_valid(buffer, start)) return result;
 
+     // regex offsets are in bytes, points are in runes
+     const char* start_itr = ce_buffer_line_iterate_to(buffer, start.y, start.x);
+     if(start_itr == NULL) return result;
+     int64_t offset = start_itr - ce_buffer_line(buffer, start.y);
+
      while(start.y < buffer->line_count){
-          CeRegexResult_t regex_result = ce_regex_match(regex,
-                                                        buffer->lines[start.y] + start.x);
+          const char* line = ce_buffer_line(buffer, start.y);
+          CeRegexMatch_t match;
+          int64_t match_count = 0;
+          CeRegexResult_t regex_result = ce_regex_match_all(regex, line, offset, &match, 1, &match_count);
           if(regex_result.error_message != NULL){
-               ce_log("ce_regex_match() failed: %s", regex_result.error_message);
+               ce_log("ce_regex_match_all() failed: %s", regex_result.error_message);
                free(regex_result.error_message);
                break;
           }
-          if(regex_result.match_start != CE_REGEX_NO_MATCH){
-               result.point = start;
-               result.point.x += regex_result.match_start;
-               result.length = regex_result.match_length;
+          if(match_count > 0){
+               result.point.x = ce_buffer_line_rune_index(buffer, start.y, line + match.start);
+               result.point.y = start.y;
+               result.length = utf8_rune_count(line + match.start, line + match.start + match.length);
                break;
           }
           start.y++;
-          start.x = 0;
+          offset = 0;
      }
 
      return result;
@@ -493,60 +1437,54 @@ CeRegexSearchResult_t ce_buffer_regex_search_backward(CeBuffer_t* buffer, CePoin
 
      if(!ce_buffer_point_is_valid(buffer, start)) return result;
 
-     CePoint_t location = start;
-
-     // loop over each line, backwards
-     while(true){
-          CePoint_t last_valid_match = {-1, location.y};
-          int64_t last_valid_match_len = 0;
-
-          location.x = 0;
-
-          if(buffer->lines[location.y][0]){
-               // dupe the line up to the current index
-               char* search_str = strdup(buffer->lines[location.y]);
-               int64_t search_str_len = strlen(search_str);
-
-               // start at the beginning of the line, find all matches up to the cursor and take that one
-               while(location.x < search_str_len){
-                    CeRegexResult_t regex_result = ce_regex_match(regex,
-                                                                  search_str + location.x);
-                    if(regex_result.error_message != NULL){
-                         ce_log("ce_regex_match() failed: %s", regex_result.error_message);
-                         free(regex_result.error_message);
-                         return result;
-                    }
-
-                    if(regex_result.match_start != CE_REGEX_NO_MATCH){
-                         int64_t match_x = location.x + regex_result.match_start;
-
-                         // if the match is after the start, then stop looking in this line
-                         if(match_x >= start.x && location.y == start.y) break;
+     // matches have to start before the start point on its line
+     const char* start_itr = ce_buffer_line_iterate_to(buffer, start.y, start.x);
+     if(start_itr == NULL) return result;
+     int64_t line_limit = start_itr - ce_buffer_line(buffer, start.y);
+
+     // walk the lines backwards, matching each line once and keeping the last match before the limit
+     CeRegexMatch_t matches[CE_REGEX_SEARCH_MATCH_BATCH];
+     for(int64_t y = start.y; y >= 0; y--){
+          const char* line = ce_buffer_line(buffer, y);
+          if(y != start.y) line_limit = strlen(line) + 1;
+
+          CeRegexMatch_t last_match = {-1, 0};
+          int64_t offset = 0;
+          while(true){
+               int64_t match_count = 0;
+               CeRegexResult_t regex_result = ce_regex_match_all(regex, line, offset, matches,
+                                                                 CE_REGEX_SEARCH_MATCH_BATCH, &match_count);
+               if(regex_result.error_message != NULL){
+                    ce_log("ce_regex_match_all() failed: %s", regex_result.error_message);
+                    free(regex_result.error_message);
+                    return result;
+               }
 
-                         // save the match if we find one
-                         last_valid_match.x = match_x;
-                         last_valid_match_len = regex_result.match_length;
-                         if(last_valid_match_len == 0) break;
-                    }else{
+               bool past_limit = false;
+               for(int64_t i = 0; i < match_count; i++){
+                    if(matches[i].start >= line_limit){
+                         past_limit = true;
                          break;
                     }
-
-                    // update the next location to start after the match
-                    location.x = last_valid_match.x + last_valid_match_len;
+                    last_match = matches[i];
                }
 
-               free(search_str);
+               // a full batch means there may be more matches in the rest of the line
+               if(past_limit || match_count < CE_REGEX_SEARCH_MATCH_BATCH) break;
+               CeRegexMatch_t* final_match = matches + (match_count - 1);
+               offset = final_match->start + final_match->length;
+               if(final_match->length == 0){
+                    offset++;
+                    while((line[offset] & 0xC0) == 0x80) offset++;
+               }
           }
 
-          if(last_valid_match.x >= 0){
-               result.point = last_valid_match;
-               result.length = last_valid_match_len;
+          if(last_match.start >= 0){
+               result.point.x = ce_buffer_line_rune_index(buffer, y, line + last_match.start);
+               result.point.y = y;
+               result.length = utf8_rune_count(line + last_match.start, line + last_match.start + last_match.length);
                break;
           }
-
-          location.y--;
-
-          if(location.y < 0) break;
      }
 
      return result;
@@ -564,12 +1502,12 @@ int64_t ce_buffer_range_len(CeBuffer_t* buffer, CePoint_t start, CePoint_t end){
      for(int64_t y = start.y; y <= end.y; ++y){
           if(y == start.y){
                // count from the star to the end of the line
-               length = ce_utf8_strlen(ce_utf8_iterate_to(buffer->lines[y], start.x)) + 1;
+               length = (buffer_line_info(buffer, y)->rune_count - start.x) + 1;
           }else if(y == end.y){
                length += end.x + 1;
           }else{
                // count entire line
-               int64_t line_length = ce_utf8_strlen(buffer->lines[y]) + 1;
+               int64_t line_length = buffer_line_info(buffer, y)->rune_count + 1;
                if(line_length == 0) length++;
                length += line_length;
           }
@@ -581,7 +1519,69 @@ int64_t ce_buffer_range_len(CeBuffer_t* buffer, CePoint_t start, CePoint_t end){
 int64_t ce_buffer_line_len(CeBuffer_t* buffer, int64_t line){
      if(line < 0 || line >= buffer->line_count) return -1;
 
-     return ce_utf8_strlen(buffer->lines[line]);
+     return buffer_line_info(buffer, line)->rune_count;
+}
+
+CeBufferMemory_t ce_buffer_memory(CeBuffer_t* buffer){
+     CeBufferMemory_t memory = {};
+     memory.text_bytes = buffer->mapping_size + (buffer->line_capacity * sizeof(*buffer->lines)) +
+                         (buffer->line_infos.capacity * sizeof(*buffer->line_infos.infos));
+     for(int64_t i = 0; i < buffer->line_count; i++){
+          const char* line = *buffer_line_slot(buffer, i);
+          if(!buffer_line_is_mapped(buffer, line)) memory.text_bytes += strlen(line) + 1;
+     }
+     memory.history_bytes = buffer->change_arena.allocated_bytes;
+     return memory;
+}
+
+char* ce_buffer_line_iterate_to(CeBuffer_t* buffer, int64_t line, int64_t index){
+     char* string = ce_buffer_line(buffer, line);
+     CeLineInfo_t* line_info = buffer_line_info(buffer, line);
+     if(index > line_info->rune_count) return NULL;
+
+     // jump to the closest checkpoint before the index, then walk the rest of the way
+     int64_t checkpoint = index / CE_LINE_CHECKPOINT_RUNES;
+     if(checkpoint > 0 && line_info->checkpoints){
+          string += line_info->checkpoints[checkpoint - 1];
+          index -= checkpoint * CE_LINE_CHECKPOINT_RUNES;
+     }
+
+     return ce_utf8_iterate_to(string, index);
+}
+
+int64_t ce_buffer_line_rune_index(CeBuffer_t* buffer, int64_t line, const char* line_itr){
+     const char* string = ce_buffer_line(buffer, line);
+     CeLineInfo_t* line_info = buffer_line_info(buffer, line);
+     int64_t byte_offset = line_itr - string;
+     int64_t index = 0;
+
+     // binary search for the last checkpoint at or before the byte offset
+     if(line_info->checkpoints){
+          int64_t low = 0;
+          int64_t high = line_info->rune_count / CE_LINE_CHECKPOINT_RUNES;
+          while(low < high){
+               int64_t mid = low + (high - low) / 2;
+               if(line_info->checkpoints[mid] <= byte_offset){
+                    low = mid + 1;
+               }else{
+                    high = mid;
+               }
+          }
+
+          if(low > 0){
+               string += line_info->checkpoints[low - 1];
+               index = low * CE_LINE_CHECKPOINT_RUNES;
+          }
+     }
+
+     int64_t rune_len = 0;
+     while(string < line_itr){
+          ce_utf8_decode(string, &rune_len);
+          string += rune_len;
+          index++;
+     }
+
+     return index;
 }
 
 CePoint_t ce_buffer_move_point(CeBuffer_t* buffer, CePoint_t point, CePoint_t delta, int64_t tab_width, CeClampX_t clamp_x){
@@ -589,7 +1589,7 @@ CePoint_t ce_buffer_move_point(CeBuffer_t* buffer, CePoint_t point, CePoint_t de
           CE_CLAMP(point.y, 0, (buffer->line_count - 1));
 
           // figure out where we are visibly (due to tabs being variable length)
-          int64_t cur_visible_index = ce_util_string_index_to_visible_index(buffer->lines[point.y], point.x, tab_width);
+          int64_t cur_visible_index = ce_util_string_index_to_visible_index(ce_buffer_line(buffer, point.y), point.x, tab_width);
 
           // move to the new line
           point.y += delta.y;
@@ -598,7 +1598,7 @@ CePoint_t ce_buffer_move_point(CeBuffer_t* buffer, CePoint_t point, CePoint_t de
           CE_CLAMP(point.y, 0, (buffer->line_count - 1));
 
           // convert the x from visible index to a string index
-          point.x = ce_util_visible_index_to_string_index(buffer->lines[point.y], cur_visible_index, tab_width);
+          point.x = ce_util_visible_index_to_string_index(ce_buffer_line(buffer, point.y), cur_visible_index, tab_width);
      }
 
      point.x += delta.x;
@@ -643,7 +1643,7 @@ CePoint_t ce_buffer_advance_point(CeBuffer_t* buffer, CePoint_t point, int64_t d
                          delta += point.x;
                     }
                     point.y = new_line;
-                    point.x = ce_utf8_strlen(buffer->lines[point.y]);
+                    point.x = buffer_line_info(buffer, point.y)->rune_count;
                }else{
                     point.x = destination;
                     break;
@@ -651,7 +1651,7 @@ CePoint_t ce_buffer_advance_point(CeBuffer_t* buffer, CePoint_t point, int64_t d
           }
      }else if(delta > 0){
           while(delta > 0){
-               int64_t line_len = ce_utf8_strlen(buffer->lines[point.y]);
+               int64_t line_len = buffer_line_info(buffer, point.y)->rune_count;
                int64_t destination = point.x + delta;
                if(destination > line_len){
                     // if we are already at the end of the buffer, get out
@@ -679,7 +1679,7 @@ CePoint_t ce_buffer_clamp_point(CeBuffer_t* buffer, CePoint_t point, CeClampX_t
      case CE_CLAMP_X_ON:
           if(buffer->line_count){
                CE_CLAMP(point.y, 0, (buffer->line_count - 1));
-               int64_t line_len = ce_utf8_strlen(buffer->lines[point.y]);
+               int64_t line_len = buffer_line_info(buffer, point.y)->rune_count;
                CE_CLAMP(point.x, 0, line_len);
           }else{
                point.x = 0;
@@ -689,7 +1689,7 @@ CePoint_t ce_buffer_clamp_point(CeBuffer_t* buffer, CePoint_t point, CeClampX_t
      case CE_CLAMP_X_INSIDE:
           if(buffer->line_count){
                CE_CLAMP(point.y, 0, (buffer->line_count - 1));
-               int64_t line_len = ce_utf8_strlen(buffer->lines[point.y]);
+               int64_t line_len = buffer_line_info(buffer, point.y)->rune_count;
                if(line_len){
                     CE_CLAMP(point.x, 0, (line_len - 1));
                }else{
@@ -709,7 +1709,8 @@ CePoint_t ce_buffer_end_point(CeBuffer_t* buffer){
      CePoint_t point = {0, buffer->line_count};
      if(point.y > 0){
           point.y--;
-          point.x = ce_utf8_last_index(buffer->lines[point.y]);
+          point.x = buffer_line_info(buffer, point.y)->rune_count;
+          if(point.x > 0) point.x--;
      }
      return point;
 }
@@ -719,22 +1720,36 @@ bool ce_buffer_insert_string(CeBuffer_t* buffer, const char* string, CePoint_t p
 
      if(!ce_buffer_point_is_valid(buffer, point)){
           if(buffer->line_count == 0 && ce_points_equal(point, (CePoint_t){0, 0})){
-               int64_t line_count = ce_util_count_string_lines(string);
-               buffer_realloc_lines(buffer, line_count);
+               // start with a single empty line and insert into it like normal
+               char** new_line = buffer_lines_insert(buffer, 0, 1);
+               if(!new_line) return false;
+               *new_line = calloc(1, 1);
+               if(!line_infos_insert(&buffer->line_infos, 0, 1)) return false;
           }else if(point.y == buffer->line_count && point.x == 0){
                // allow inserting a string after a buffer by resizing
-               if(!buffer_realloc_lines(buffer, buffer->line_count + 1)) return false;
-               buffer->lines[point.y] = calloc(1, 1); // allocate an empty string
+               char** new_line = buffer_lines_insert(buffer, point.y, 1);
+               if(!new_line) return false;
+               *new_line = calloc(1, 1); // allocate an empty string
+               if(!line_infos_insert(&buffer->line_infos, point.y, 1)) return false;
           }else{
                return false;
           }
      }
 
-     int64_t string_lines = ce_util_count_string_lines(string);
-     if(string_lines == 0){
-          return true; // sure, yeah, we inserted that empty string
-     }else if(string_lines == 1){
-          char* line = buffer->lines[point.y];
+     int64_t string_lines = ce_util_count_string_lines(string);
+     if(string_lines == 0){
+          return true; // sure, yeah, we inserted that empty string
+     }
+
+     buffer->version++;
+
+     if(!buffer_line_make_writable(buffer, point.y)) return false;
+
+     // figure out where in the line we are inserting, before any reallocs
+     size_t insert_offset = ce_buffer_line_iterate_to(buffer, point.y, point.x) - ce_buffer_line(buffer, point.y);
+
+     if(string_lines == 1){
+          char* line = ce_buffer_line(buffer, point.y);
           size_t insert_len = strlen(string);
           size_t existing_len = strlen(line);
           size_t total_len = insert_len + existing_len;
@@ -744,7 +1759,7 @@ bool ce_buffer_insert_string(CeBuffer_t* buffer, const char* string, CePoint_t p
           if(!line) return false;
 
           // figure out where to move from and to
-          char* src = ce_utf8_iterate_to(line, point.x);
+          char* src = line + insert_offset;
           char* dst = src + insert_len;
           size_t src_len = strlen(src);
           memmove(dst, src, src_len);
@@ -754,51 +1769,50 @@ bool ce_buffer_insert_string(CeBuffer_t* buffer, const char* string, CePoint_t p
 
           // tidy up
           line[total_len] = 0;
-          buffer->lines[point.y] = line;
+          *buffer_line_slot(buffer, point.y) = line;
+          buffer_line_changed(buffer, point.y);
           buffer->status = CE_BUFFER_STATUS_MODIFIED;
           return true;
      }
 
      int64_t shift_lines = string_lines - 1;
-     int64_t old_line_count = buffer->line_count;
 
-     // allocate space to fit the buffer plus the new multiline string
-     if(!buffer_realloc_lines(buffer, buffer->line_count + shift_lines)){
+     // open up space for the new lines after the one we are inserting into
+     int64_t first_new_line = point.y + 1;
+     char** new_lines = buffer_lines_insert(buffer, first_new_line, shift_lines);
+     if(!new_lines) return false;
+     if(!line_infos_insert(&buffer->line_infos, first_new_line, shift_lines)){
+          buffer_lines_remove(buffer, first_new_line, shift_lines);
           return false;
      }
 
-     // shift down all the line pointers
-     int64_t first_new_line = point.y + 1;
-     char** src_line = buffer->lines + first_new_line;
-     char** dst_line = src_line + shift_lines;
-     size_t move_count = old_line_count - first_new_line;
-     memmove(dst_line, src_line, move_count * sizeof(src_line));
-
      // save the last part of the first line to stick on the end of the multiline string
+     char** first_line = buffer_line_slot(buffer, point.y);
      char* end_string = NULL;
-     int64_t end_string_len = strlen(buffer->lines[point.y] + point.x);
-     if(end_string_len) end_string = strdup(buffer->lines[point.y] + point.x);
+     int64_t end_string_len = strlen(*first_line + insert_offset);
+     if(end_string_len) end_string = strdup(*first_line + insert_offset);
 
      // insert the first line of the string at the point specified
      const char* next_newline = strchr(string, CE_NEWLINE);
      assert(next_newline);
      size_t first_line_len = next_newline - string;
-     size_t new_line_len = point.x + first_line_len;
-     buffer->lines[point.y] = realloc(buffer->lines[point.y], new_line_len + 1);
+     size_t new_line_len = insert_offset + first_line_len;
+     *first_line = realloc(*first_line, new_line_len + 1);
      if(*string != CE_NEWLINE){ // if the first character is a newline, there is no first line of the string
-          memcpy(buffer->lines[point.y] + point.x, string, first_line_len);
+          memcpy(*first_line + insert_offset, string, first_line_len);
      }
-     buffer->lines[point.y][new_line_len] = 0;
+     (*first_line)[new_line_len] = 0;
+     buffer_line_changed(buffer, point.y);
 
      // copy in each of the new lines
      string = next_newline + 1;
      next_newline = strchr(string, CE_NEWLINE);
-     int64_t next_line = point.y + 1;
+     int64_t next_line = 0;
      while(next_newline){
           new_line_len = next_newline - string;
-          buffer->lines[next_line] = calloc(1, new_line_len + 1);
-          memcpy(buffer->lines[next_line], string, new_line_len);
-          buffer->lines[next_line][new_line_len] = 0;
+          new_lines[next_line] = calloc(1, new_line_len + 1);
+          memcpy(new_lines[next_line], string, new_line_len);
+          new_lines[next_line][new_line_len] = 0;
           string = next_newline + 1;
           next_newline = strchr(string, CE_NEWLINE);
           next_line++;
@@ -807,16 +1821,16 @@ bool ce_buffer_insert_string(CeBuffer_t* buffer, const char* string, CePoint_t p
      // copy in the last line
      new_line_len = strlen(string);
      int64_t last_line_len = new_line_len + end_string_len;
-     buffer->lines[next_line] = calloc(1, last_line_len + 1);
-     memcpy(buffer->lines[next_line], string, new_line_len);
+     new_lines[next_line] = calloc(1, last_line_len + 1);
+     memcpy(new_lines[next_line], string, new_line_len);
 
      // attach the end part of the line we inserted into at the end of the last line
      if(end_string){
-          memcpy(buffer->lines[next_line] + new_line_len, end_string, end_string_len);
+          memcpy(new_lines[next_line] + new_line_len, end_string, end_string_len);
           free(end_string);
      }
 
-     buffer->lines[next_line][last_line_len] = 0;
+     new_lines[next_line][last_line_len] = 0;
 
      buffer->status = CE_BUFFER_STATUS_MODIFIED;
      return true;
@@ -830,63 +1844,91 @@ bool ce_buffer_insert_rune(CeBuffer_t* buffer, CeRune_t rune, CePoint_t point){
      return ce_buffer_insert_string(buffer, str, point);
 }
 
+static bool buffer_remove_lines(CeBuffer_t* buffer, int64_t line_start, int64_t lines_to_remove){
+     // check invalid input
+     if(line_start < 0) return false;
+     if(line_start >= buffer->line_count) return false;
+     if(lines_to_remove <= 0) return false;
+     if(line_start + lines_to_remove > buffer->line_count) return false;
+
+     // free lines we are going to remove and overwrite
+     for(int64_t i = line_start; i < line_start + lines_to_remove; i++){
+          buffer_line_free(buffer, *buffer_line_slot(buffer, i));
+     }
+
+     // we hold onto the capacity so the next split doesn't have to realloc
+     buffer_lines_remove(buffer, line_start, lines_to_remove);
+     line_infos_remove(&buffer->line_infos, line_start, lines_to_remove);
+     if(buffer->line_count == 0) ce_buffer_empty(buffer);
+
+     buffer->status = CE_BUFFER_STATUS_MODIFIED;
+     return buffer->lines != NULL;
+}
+
 bool ce_buffer_remove_string(CeBuffer_t* buffer, CePoint_t point, int64_t length){
      if(buffer->status == CE_BUFFER_STATUS_READONLY) return false;
      if(!ce_buffer_point_is_valid(buffer, point)) return false;
+     buffer->version++;
+     if(!buffer_line_make_writable(buffer, point.y)) return false;
 
-     char* first_line_start = ce_utf8_iterate_to(buffer->lines[point.y], point.x);
-     int64_t length_left_on_line = ce_utf8_strlen(first_line_start) + 1;
+     char* first_line_start = ce_buffer_line_iterate_to(buffer, point.y, point.x);
+     int64_t length_left_on_line = (buffer_line_info(buffer, point.y)->rune_count - point.x) + 1;
 
      if(length_left_on_line > length){
           // case: glue together left and right sides and cut out the middle
-          char* end_of_start = ce_utf8_iterate_to(buffer->lines[point.y], point.x);
+          char* end_of_start = first_line_start;
           assert(end_of_start);
-          char* beginning_of_end = ce_utf8_iterate_to(buffer->lines[point.y], point.x + length);
+          char* beginning_of_end = ce_utf8_iterate_to(end_of_start, length);
           assert(beginning_of_end);
 
           // figure out how big of a line to allocate
-          size_t start_line_len = end_of_start - buffer->lines[point.y];
+          char** line = buffer_line_slot(buffer, point.y);
+          size_t start_line_len = end_of_start - *line;
           size_t end_line_len = strlen(beginning_of_end);
           size_t full_line_len = start_line_len + end_line_len;
           char* new_line = calloc(full_line_len + 1, sizeof(*new_line));
           if(!new_line) return false;
 
           // copy over the data to our new line
-          memcpy(new_line, buffer->lines[point.y], start_line_len);
+          memcpy(new_line, *line, start_line_len);
           memcpy(new_line + start_line_len, beginning_of_end, end_line_len);
           new_line[full_line_len] = 0;
 
           // free and overwrite our new line
-          free(buffer->lines[point.y]);
-          buffer->lines[point.y] = new_line;
+          free(*line);
+          *line = new_line;
+          buffer_line_changed(buffer, point.y);
 
           buffer->status = CE_BUFFER_STATUS_MODIFIED;
           return true;
      }else if(length_left_on_line == length){
           if(point.x == 0){
                buffer->status = CE_BUFFER_STATUS_MODIFIED;
-               return ce_buffer_remove_lines(buffer, point.y, 1);
+               return buffer_remove_lines(buffer, point.y, 1);
           }
 
           // remove characters left on current line
-          int64_t keep_length = (first_line_start - buffer->lines[point.y]);
-          buffer->lines[point.y] = realloc(buffer->lines[point.y], keep_length + 1);
-          buffer->lines[point.y][keep_length] = 0;
+          char** line = buffer_line_slot(buffer, point.y);
+          int64_t keep_length = (first_line_start - *line);
+          *line = realloc(*line, keep_length + 1);
+          (*line)[keep_length] = 0;
 
           // perform a join with the next line
           int64_t next_line_index = point.y + 1;
           if(next_line_index > buffer->line_count) return false;
           if(next_line_index < buffer->line_count){
-               int64_t cur_line_len = strlen(buffer->lines[point.y]);
-               int64_t next_line_len = strlen(buffer->lines[next_line_index]);
+               const char* next_line = ce_buffer_line(buffer, next_line_index);
+               int64_t cur_line_len = strlen(*line);
+               int64_t next_line_len = strlen(next_line);
                int64_t new_line_len = next_line_len + cur_line_len;
-               buffer->lines[point.y] = realloc(buffer->lines[point.y], new_line_len + 1);
-               strncpy(buffer->lines[point.y] + cur_line_len, buffer->lines[next_line_index], next_line_len);
-               buffer->lines[point.y][new_line_len] = 0;
+               *line = realloc(*line, new_line_len + 1);
+               strncpy(*line + cur_line_len, next_line, next_line_len);
+               (*line)[new_line_len] = 0;
           }
+          buffer_line_changed(buffer, point.y);
 
           buffer->status = CE_BUFFER_STATUS_MODIFIED;
-          return ce_buffer_remove_lines(buffer, next_line_index, 1);
+          return buffer_remove_lines(buffer, next_line_index, 1);
      }
 
      // case: cut the end of the initial line, N lines in the middle and N leftover characters in the final
@@ -900,7 +1942,7 @@ bool ce_buffer_remove_string(CeBuffer_t* buffer, CePoint_t point, int64_t length
 
      // how many lines do we have to delete?
      for(; current_line < buffer->line_count; current_line++){
-          line_len = ce_utf8_strlen(buffer->lines[current_line]) + 1;
+          line_len = buffer_line_info(buffer, current_line)->rune_count + 1;
 
           if(length_left >= line_len){
                length_left -= line_len;
@@ -926,58 +1968,34 @@ bool ce_buffer_remove_string(CeBuffer_t* buffer, CePoint_t point, int64_t length
 
      // join the rest of the last line in the deletion, to the first line
      if(last_line_offset || do_join){
-          char* end_to_join = ce_utf8_iterate_to(buffer->lines[current_line], last_line_offset);
+          char* end_to_join = ce_buffer_line_iterate_to(buffer, current_line, last_line_offset);
           int64_t join_len = strlen(end_to_join);
-          int64_t new_len = point.x + join_len;
-          buffer->lines[point.y] = realloc(buffer->lines[point.y], new_len + 1);
-          memcpy(buffer->lines[point.y] + point.x, end_to_join, join_len);
-          buffer->lines[point.y][new_len] = 0;
+          char** line = buffer_line_slot(buffer, point.y);
+          int64_t keep_len = first_line_start - *line;
+          int64_t new_len = keep_len + join_len;
+          *line = realloc(*line, new_len + 1);
+          memcpy(*line + keep_len, end_to_join, join_len);
+          (*line)[new_len] = 0;
+          buffer_line_changed(buffer, point.y);
      }else{
           // if we aren't doing a join, then start with deleting the first line
           save_current_line--;
      }
 
      // remove the intermediate lines
-     return ce_buffer_remove_lines(buffer, save_current_line, lines_to_delete);
+     return buffer_remove_lines(buffer, save_current_line, lines_to_delete);
 }
 
 bool ce_buffer_remove_lines(CeBuffer_t* buffer, int64_t line_start, int64_t lines_to_remove){
-     // check invalid input
-     if(line_start < 0) return false;
-     if(line_start >= buffer->line_count) return false;
-     if(lines_to_remove <= 0) return false;
-     if(line_start + lines_to_remove > buffer->line_count) return false;
-
-     // free lines we are going to remove and overwrite
-     for(int64_t i = line_start; i < line_start + lines_to_remove; i++){
-          free(buffer->lines[i]);
-     }
-
-     // shift lines down, overwriting lines we want to remove
-     int64_t last_line_to_shift = buffer->line_count - lines_to_remove;
-     for(int64_t dst = line_start; dst < last_line_to_shift; dst++){
-          int64_t src = dst + lines_to_remove;
-          buffer->lines[dst] = buffer->lines[src];
-     }
-
-     // update line count, and shrink our allocation
-     buffer->line_count -= lines_to_remove;
-     if(buffer->line_count > 0){
-          buffer->lines = realloc(buffer->lines, buffer->line_count * sizeof(*buffer->lines));
-     }else{
-          ce_buffer_empty(buffer);
-     }
-
-     buffer->status = CE_BUFFER_STATUS_MODIFIED;
-     return buffer->lines != NULL;
+     buffer->version++;
+     return buffer_remove_lines(buffer, line_start, lines_to_remove);
 }
 
 char* ce_buffer_dupe_string(CeBuffer_t* buffer, CePoint_t point, int64_t length){
      if(!ce_buffer_point_is_valid(buffer, point)) return NULL;
 
-     char* start = ce_utf8_iterate_to(buffer->lines[point.y], point.x);
-     // NOTE: would a function that returns both utf8 len and byte len be helpful here?
-     int64_t buffer_utf8_length = ce_utf8_strlen(start) + 1;
+     char* start = ce_buffer_line_iterate_to(buffer, point.y, point.x);
+     int64_t buffer_utf8_length = (buffer_line_info(buffer, point.y)->rune_count - point.x) + 1;
      int64_t real_length = strlen(start) + 1;
 
      // exit early if the whole string is just on this line
@@ -999,16 +2017,16 @@ char* ce_buffer_dupe_string(CeBuffer_t* buffer, CePoint_t point, int64_t length)
      if(current_line >= buffer->line_count) return strdup("");
 
      while(true){
-          int64_t line_utf8_length = ce_utf8_strlen(buffer->lines[current_line]) + 1;
+          int64_t line_utf8_length = buffer_line_info(buffer, current_line)->rune_count + 1;
           buffer_utf8_length += line_utf8_length;
           if(buffer_utf8_length > length){
                int64_t diff = buffer_utf8_length - length;
-               char* end_of_dupe = ce_utf8_iterate_to(buffer->lines[current_line], line_utf8_length - diff);
-               real_length += end_of_dupe - buffer->lines[current_line];
+               char* end_of_dupe = ce_buffer_line_iterate_to(buffer, current_line, line_utf8_length - diff);
+               real_length += end_of_dupe - ce_buffer_line(buffer, current_line);
                break;
           }
 
-          real_length += strlen(buffer->lines[current_line]) + 1;
+          real_length += strlen(ce_buffer_line(buffer, current_line)) + 1;
           if(buffer_utf8_length == length) break;
           current_line++;
           if(current_line >= buffer->line_count) return NULL; // not enough length in the buffer
@@ -1032,18 +2050,18 @@ char* ce_buffer_dupe_string(CeBuffer_t* buffer, CePoint_t point, int64_t length)
           // loop over each line again from the beginning
           current_line = point.y + 1;
           while(copy_length < real_length){
-               int64_t line_length = strlen(buffer->lines[current_line]);
+               int64_t line_length = strlen(ce_buffer_line(buffer, current_line));
                copy_length += line_length;
 
                // just copy in the rest of the characters
                if(copy_length > real_length){
                     int64_t diff = copy_length - real_length;
-                    memcpy(itr, buffer->lines[current_line], line_length - diff);
+                    memcpy(itr, ce_buffer_line(buffer, current_line), line_length - diff);
                     break;
                }
 
                // copy in the whole line
-               memcpy(itr, buffer->lines[current_line], line_length);
+               memcpy(itr, ce_buffer_line(buffer, current_line), line_length);
                itr += line_length;
 
                // append a newline
@@ -1062,7 +2080,8 @@ char* ce_buffer_dupe(CeBuffer_t* buffer){
      CePoint_t start = {0, 0};
      CePoint_t end = {0, buffer->line_count};
      if(end.y) end.y--;
-     end.x = ce_utf8_last_index(buffer->lines[end.y]);
+     end.x = buffer_line_info(buffer, end.y)->rune_count;
+     if(end.x > 0) end.x--;
      int64_t len = ce_buffer_range_len(buffer, start, end);
      if(len > 0) return ce_buffer_dupe_string(buffer, start, len);
      return NULL;
@@ -1123,27 +2142,96 @@ bool ce_buffer_remove_string_change(CeBuffer_t* buffer, CePoint_t point, int64_t
      return true;
 }
 
+// typing or deleting a rune at a time in insert mode makes a chain of single rune changes. Fold each one into the
+// current change when they are chained (so they are undone together anyway), stay on one line and touch each other
+static bool buffer_change_coalesce(CeBuffer_t* buffer, CeBufferChange_t* change){
+     CeBufferChangeNode_t* node = buffer->change_node;
+     CeBufferChange_t* current = &node->change;
+     if(!change->chain || !change->string || !node->prev || node->next) return false;
+     if(node == buffer->save_at_change_node) return false;
+     if(!current->string || current->insertion != change->insertion) return false;
+     if(current->location.y != change->location.y) return false;
+     if(ce_utf8_strlen(change->string) != 1 || strchr(change->string, CE_NEWLINE)) return false;
+     if(node->coalesced_count == 0 && strchr(current->string, CE_NEWLINE)) return false;
+
+     bool prepend = false;
+     if(change->insertion){
+          if(change->location.x != current->location.x + ce_utf8_strlen(current->string)) return false;
+     }else if(change->location.x + 1 == current->location.x){
+          prepend = true; // backspace
+     }else if(change->location.x != current->location.x){
+          return false;
+     }
+
+     int64_t current_length = strlen(current->string);
+     int64_t change_length = strlen(change->string);
+     if(!change_string_reserve(&buffer->change_arena, node, current_length + change_length)) return false;
+     if(prepend){
+          memmove(current->string + change_length, current->string, current_length + 1);
+          memcpy(current->string, change->string, change_length);
+          current->location = change->location;
+     }else{
+          memcpy(current->string + current_length, change->string, change_length + 1);
+     }
+
+     current->cursor_after = change->cursor_after;
+     node->coalesced_count++;
+     free(change->string);
+     return true;
+}
+
+// drop the oldest history until the arena fits under the limit, it never trims passed the current change
+static void buffer_change_trim(CeBuffer_t* buffer){
+     int64_t limit = buffer->change_memory_limit ? buffer->change_memory_limit : CE_CHANGE_HISTORY_DEFAULT_MEMORY_LIMIT;
+     while(buffer->change_arena.allocated_bytes > limit){
+          CeBufferChangeNode_t* root = buffer->change_root;
+          if(root == buffer->change_node || !root->next) break;
+
+          CeBufferChangeNode_t* new_root = root->next;
+          new_root->prev = NULL;
+          if(buffer->save_at_change_node == root) buffer->save_at_change_node = NULL;
+          change_node_release(buffer, root);
+
+          // the root is only ever undone back to, never applied, so it doesn't need its string
+          if(new_root->change.string){
+               change_arena_release(&buffer->change_arena, new_root->string_block);
+               new_root->change.string = NULL;
+          }
+          buffer->change_root = new_root;
+     }
+}
+
 bool ce_buffer_change(CeBuffer_t* buffer, CeBufferChange_t* change){
-     CeBufferChangeNode_t* node = calloc(1, sizeof(*node));
-     node->change = *change;
-     node->next = NULL;
+     buffer->recorded_version++;
 
      if(buffer->change_node){
           if(buffer->change_node->next){
-               ce_buffer_change_node_free(&buffer->change_node->next);
+               change_nodes_free(buffer, buffer->change_node->next);
+               buffer->change_node->next = NULL;
           }
 
-          node->prev = buffer->change_node;
-          node->index = buffer->change_node->index + 1;
-          buffer->change_node->next = node;
+          if(buffer_change_coalesce(buffer, change)) return true;
      }else{
-          CeBufferChangeNode_t* first_empty_node = calloc(1, sizeof(*node));
-          first_empty_node->next = node;
-          node->prev = first_empty_node;
+          CeBufferChangeNode_t* first_empty_node = change_node_alloc(buffer, NULL);
+          if(!first_empty_node){
+               free(change->string);
+               return false;
+          }
+          buffer->change_root = first_empty_node;
+          buffer->change_node = first_empty_node;
           if(buffer->save_at_change_node == NULL) buffer->save_at_change_node = first_empty_node;
      }
 
+     CeBufferChangeNode_t* node = change_node_alloc(buffer, change);
+     if(!node){
+          free(change->string);
+          return false;
+     }
+
+     node->prev = buffer->change_node;
+     buffer->change_node->next = node;
      buffer->change_node = node;
+     buffer_change_trim(buffer);
      return true;
 }
 
@@ -1152,24 +2240,27 @@ bool ce_buffer_undo(CeBuffer_t* buffer, CePoint_t* cursor){
      if(!buffer->change_node) return true;
      if(!buffer->change_node->prev) return true;
 
-     CeBufferChange_t* change = &buffer->change_node->change;
-     if(change->insertion){
-          ce_buffer_remove_string(buffer, change->location, ce_utf8_strlen(change->string));
-     }else{
-          ce_buffer_insert_string(buffer, change->string, change->location);
-     }
+     // undo the whole chain, looping rather than recursing so a long chain (like a big replace_all) can't run out of stack
+     while(buffer->change_node->prev){
+          CeBufferChange_t* change = &buffer->change_node->change;
+          if(change->insertion){
+               ce_buffer_remove_string(buffer, change->location, ce_utf8_strlen(change->string));
+          }else{
+               ce_buffer_insert_string(buffer, change->string, change->location);
+          }
 
-     *cursor = change->cursor_before;
-     buffer->change_node = buffer->change_node->prev;
+          *cursor = change->cursor_before;
+          buffer->change_node = buffer->change_node->prev;
+          buffer->recorded_version++;
 
-     bool success = true;
-     if(change->chain) success = ce_buffer_undo(buffer, cursor);
+          if(!change->chain) break;
+     }
 
      if(buffer->status == CE_BUFFER_STATUS_MODIFIED && buffer->change_node == buffer->save_at_change_node){
           buffer->status = CE_BUFFER_STATUS_NONE;
      }
 
-     return success;
+     return true;
 }
 
 bool ce_buffer_redo(CeBuffer_t* buffer, CePoint_t* cursor){
@@ -1177,18 +2268,19 @@ bool ce_buffer_redo(CeBuffer_t* buffer, CePoint_t* cursor){
      if(!buffer->change_node) return false;
      if(!buffer->change_node->next) return false;
 
-     buffer->change_node = buffer->change_node->next;
-
-     CeBufferChange_t* change = &buffer->change_node->change;
-     if(change->insertion){
-          ce_buffer_insert_string(buffer, change->string, change->location);
-     }else{
-          ce_buffer_remove_string(buffer, change->location, ce_utf8_strlen(change->string));
-     }
+     do{
+          buffer->change_node = buffer->change_node->next;
 
-     *cursor = change->cursor_after;
+          CeBufferChange_t* change = &buffer->change_node->change;
+          if(change->insertion){
+               ce_buffer_insert_string(buffer, change->string, change->location);
+          }else{
+               ce_buffer_remove_string(buffer, change->location, ce_utf8_strlen(change->string));
+          }
 
-     if(buffer->change_node->next && buffer->change_node->next->change.chain) return ce_buffer_redo(buffer, cursor);
+          *cursor = change->cursor_after;
+          buffer->recorded_version++;
+     }while(buffer->change_node->next && buffer->change_node->next->change.chain);
 
      if(buffer->status == CE_BUFFER_STATUS_MODIFIED && buffer->change_node == buffer->save_at_change_node){
           buffer->status = CE_BUFFER_STATUS_NONE;
@@ -1227,6 +2319,213 @@ static CePoint_t move_point_based_on_buffer_change(CeBuffer_t* buffer, CeBufferC
      return point;
 }
 
+void ce_buffer_change_mark(CeBufferChangeMark_t* mark, const CeBuffer_t* buffer){
+     mark->buffer_version = buffer->version;
+     mark->unrecorded_edits = buffer->version - buffer->recorded_version;
+     mark->change_node = buffer->change_node;
+     mark->change_index = buffer->change_node ? buffer->change_node->index : 0;
+     mark->change_coalesced_count = buffer->change_node ? buffer->change_node->coalesced_count : 0;
+     mark->change_string_length = 0;
+     mark->change_location = (CePoint_t){0, 0};
+     if(buffer->change_node && buffer->change_node->change.string){
+          mark->change_string_length = strlen(buffer->change_node->change.string);
+          mark->change_location = buffer->change_node->change.location;
+     }
+}
+
+static bool change_mark_at(const CeBufferChangeMark_t* mark, const CeBufferChangeNode_t* node){
+     return node == mark->change_node && node->index == mark->change_index;
+}
+
+bool ce_buffer_changes_since(CeBuffer_t* buffer, const CeBufferChangeMark_t* mark, CeBufferChangesSince_t* changes){
+     memset(changes, 0, sizeof(*changes));
+     changes->grown_line = -1;
+     if(mark->buffer_version == buffer->version) return true;
+
+     // if something edited the buffer without recording a change, we can't know what it did
+     if(buffer->version - buffer->recorded_version != mark->unrecorded_edits) return false;
+
+     // otherwise the changes between the marked one and the current one are everything that happened. The marked change
+     // may have been freed, so it is only ever compared against, never followed
+     int64_t change_count = 0;
+     bool undo = false;
+     CeBufferChangeNode_t* itr = buffer->change_node;
+     while(itr && itr->index >= mark->change_index && !change_mark_at(mark, itr)){
+          if(itr->change.string) change_count++;
+          itr = itr->prev;
+     }
+
+     bool found = itr ? change_mark_at(mark, itr) : (mark->change_node == NULL);
+     if(!found && buffer->change_node){
+          // the marked changes have since been undone
+          undo = true;
+          change_count = 0;
+          itr = buffer->change_node->next;
+          while(itr){
+               if(itr->change.string) change_count++;
+               if(change_mark_at(mark, itr)) break;
+               itr = itr->next;
+          }
+          found = (itr != NULL);
+     }
+
+     if(!found) return false;
+
+     // edits folded into the marked change since then all happened on its line. When undoing, the whole change is
+     // reverted anyway
+     if(!undo && itr && itr->coalesced_count != mark->change_coalesced_count){
+          changes->grown_line = itr->change.location.y;
+     }
+
+     // changes were undone and redone back to where we were
+     if(change_count == 0) return true;
+
+     changes->nodes = malloc(change_count * sizeof(*changes->nodes));
+     if(!changes->nodes) return false;
+     changes->count = change_count;
+     changes->undo = undo;
+
+     int64_t node_count = change_count;
+     itr = undo ? buffer->change_node->next : buffer->change_node;
+     while(node_count > 0){
+          if(itr->change.string) changes->nodes[--node_count] = itr;
+          itr = undo ? itr->next : itr->prev;
+     }
+
+     return true;
+}
+
+void ce_buffer_changes_since_free(CeBufferChangesSince_t* changes){
+     free(changes->nodes);
+     changes->nodes = NULL;
+     changes->count = 0;
+}
+
+static int64_t utf8_strnlen(const char* string, int64_t byte_count){
+     int64_t length = 0;
+     for(int64_t i = 0; i < byte_count; i++){
+          if((string[i] & 0xC0) != 0x80) length++;
+     }
+     return length;
+}
+
+// where a string inserted at start ends
+static CePoint_t string_end_point(CePoint_t start, const char* string, int64_t byte_count){
+     CePoint_t end = start;
+     for(int64_t i = 0; i < byte_count; i++){
+          if(string[i] == CE_NEWLINE){
+               end.y++;
+               end.x = 0;
+          }else if((string[i] & 0xC0) != 0x80){
+               end.x++;
+          }
+     }
+     return end;
+}
+
+static bool buffer_edits_add(CeBufferEdits_t* edits, CePoint_t start, CePoint_t end, const char* text, int64_t text_length){
+     CeBufferEdit_t* elements = realloc(edits->elements, (edits->count + 1) * sizeof(*elements));
+     if(!elements) return false;
+     edits->elements = elements;
+     CeBufferEdit_t* edit = edits->elements + edits->count;
+     edit->start = start;
+     edit->end = end;
+     edit->text = strndup(text, text_length);
+     if(!edit->text) return false;
+     edits->count++;
+     return true;
+}
+
+// a change is an insertion or removal of its whole string, undoing it does the opposite
+static bool buffer_edits_add_change(CeBufferEdits_t* edits, const CeBufferChange_t* change, bool undo){
+     int64_t length = strlen(change->string);
+     if(change->insertion != undo){
+          return buffer_edits_add(edits, change->location, change->location, change->string, length);
+     }
+     return buffer_edits_add(edits, change->location, string_end_point(change->location, change->string, length), "", 0);
+}
+
+// the part of the marked change's string that was already applied when the mark was made. Inserts only ever append to
+// it, but backspacing prepends to a removal
+static bool mark_change_portion(const CeBufferChangeMark_t* mark, const CeBufferChange_t* change, int64_t* offset){
+     *offset = 0;
+     if(!change->insertion){
+          int64_t prepended = mark->change_location.x - change->location.x;
+          if(prepended < 0 || prepended > ce_utf8_strlen(change->string) || change->location.y != mark->change_location.y){
+               return false;
+          }
+          char* portion = ce_utf8_iterate_to(change->string, prepended);
+          if(!portion) return false;
+          *offset = portion - change->string;
+     }else if(change->location.x != mark->change_location.x || change->location.y != mark->change_location.y){
+          return false;
+     }
+     return *offset + mark->change_string_length <= (int64_t)(strlen(change->string));
+}
+
+bool ce_buffer_edits_since(CeBuffer_t* buffer, const CeBufferChangeMark_t* mark, CeBufferEdits_t* edits){
+     memset(edits, 0, sizeof(*edits));
+
+     CeBufferChangesSince_t changes = {};
+     if(!ce_buffer_changes_since(buffer, mark, &changes)) return false;
+
+     bool result = true;
+     int64_t first = 0;
+     if(changes.undo){
+          // the marked change is undone first, but only the part of it that was applied when it was marked
+          const CeBufferChange_t* change = &changes.nodes[0]->change;
+          int64_t offset = 0;
+          result = (changes.nodes[0] == mark->change_node) && mark_change_portion(mark, change, &offset);
+          if(result){
+               const char* portion = change->string + offset;
+               if(change->insertion){
+                    CePoint_t end = string_end_point(change->location, portion, mark->change_string_length);
+                    result = buffer_edits_add(edits, change->location, end, "", 0);
+               }else{
+                    result = buffer_edits_add(edits, mark->change_location, mark->change_location, portion,
+                                              mark->change_string_length);
+               }
+          }
+          first = 1;
+     }else if(changes.grown_line >= 0){
+          // single rune edits on one line were folded into the marked change after it was marked, they come before the
+          // rest of the changes
+          const CeBufferChange_t* change = &mark->change_node->change;
+          int64_t offset = 0;
+          result = mark_change_portion(mark, change, &offset);
+          if(result){
+               int64_t portion_length = utf8_strnlen(change->string + offset, mark->change_string_length);
+               if(change->insertion){
+                    CePoint_t point = {change->location.x + portion_length, change->location.y};
+                    const char* text = change->string + mark->change_string_length;
+                    result = buffer_edits_add(edits, point, point, text, strlen(text));
+               }else{
+                    // whatever was backspaced or deleted around the marked removal is one contiguous range now
+                    CePoint_t end = {change->location.x + ce_utf8_strlen(change->string) - portion_length,
+                                     change->location.y};
+                    result = buffer_edits_add(edits, change->location, end, "", 0);
+               }
+          }
+     }
+
+     for(int64_t i = first; result && i < changes.count; i++){
+          result = buffer_edits_add_change(edits, &changes.nodes[i]->change, changes.undo);
+     }
+
+     ce_buffer_changes_since_free(&changes);
+     if(!result) ce_buffer_edits_free(edits);
+     return result;
+}
+
+void ce_buffer_edits_free(CeBufferEdits_t* edits){
+     for(int64_t i = 0; i < edits->count; i++){
+          free(edits->elements[i].text);
+     }
+     free(edits->elements);
+     edits->elements = NULL;
+     edits->count = 0;
+}
+
 CePoint_t ce_move_point_based_on_buffer_changes(CeBuffer_t* buffer, CeBufferChangeNode_t* before, CePoint_t point){
      CeBufferChangeNode_t* itr = buffer->change_node;
      while(itr && itr != before){
@@ -1236,6 +2535,364 @@ CePoint_t ce_move_point_based_on_buffer_changes(CeBuffer_t* buffer, CeBufferChan
      return point;
 }
 
+// lines edited while catching up on changes, they are re-scanned once all the changes have been applied
+typedef struct{
+     int64_t first;
+     int64_t last;
+}CeMatchIndexDirty_t;
+
+int64_t ce_match_index_count(const CeMatchIndex_t* index){
+     return index->capacity - (index->gap_end - index->gap_start);
+}
+
+CeMatch_t ce_match_index_get(const CeMatchIndex_t* index, int64_t i){
+     if(i < index->gap_start) return index->matches[i];
+     CeMatch_t match = index->matches[i + (index->gap_end - index->gap_start)];
+     match.point.y += index->gap_line_shift;
+     return match;
+}
+
+int64_t ce_match_index_lower_bound(const CeMatchIndex_t* index, CePoint_t point){
+     int64_t low = 0;
+     int64_t high = ce_match_index_count(index);
+     while(low < high){
+          int64_t mid = low + (high - low) / 2;
+          CePoint_t mid_point = ce_match_index_get(index, mid).point;
+          if(mid_point.y < point.y || (mid_point.y == point.y && mid_point.x < point.x)){
+               low = mid + 1;
+          }else{
+               high = mid;
+          }
+     }
+     return low;
+}
+
+CePoint_t ce_match_index_next(const CeMatchIndex_t* index, CePoint_t start){
+     int64_t i = ce_match_index_lower_bound(index, start);
+     if(i >= ce_match_index_count(index)) return (CePoint_t){-1, -1};
+     return ce_match_index_get(index, i).point;
+}
+
+CePoint_t ce_match_index_prev(const CeMatchIndex_t* index, CePoint_t start){
+     int64_t i = ce_match_index_lower_bound(index, (CePoint_t){start.x + 1, start.y}) - 1;
+     if(i < 0) return (CePoint_t){-1, -1};
+     return ce_match_index_get(index, i).point;
+}
+
+static void match_index_move_gap(CeMatchIndex_t* index, int64_t position){
+     if(position < index->gap_start){
+          int64_t move_count = index->gap_start - position;
+          index->gap_start -= move_count;
+          index->gap_end -= move_count;
+          memmove(index->matches + index->gap_end, index->matches + index->gap_start, move_count * sizeof(*index->matches));
+          for(int64_t i = index->gap_end; i < index->gap_end + move_count; i++){
+               index->matches[i].point.y -= index->gap_line_shift;
+          }
+     }else if(position > index->gap_start){
+          int64_t move_count = position - index->gap_start;
+          for(int64_t i = index->gap_end; i < index->gap_end + move_count; i++){
+               index->matches[i].point.y += index->gap_line_shift;
+          }
+          memmove(index->matches + index->gap_start, index->matches + index->gap_end, move_count * sizeof(*index->matches));
+          index->gap_start += move_count;
+          index->gap_end += move_count;
+     }
+
+     if(index->gap_end == index->capacity) index->gap_line_shift = 0;
+}
+
+// drop the matches right after the gap, up to and including last_line
+static void match_index_remove_through_line(CeMatchIndex_t* index, int64_t last_line){
+     while(index->gap_end < index->capacity &&
+           index->matches[index->gap_end].point.y + index->gap_line_shift <= last_line){
+          index->gap_end++;
+     }
+}
+
+static bool match_index_add(CeMatchIndex_t* index, CePoint_t point, int64_t length){
+     if(index->gap_start == index->gap_end){
+          int64_t new_capacity = index->capacity ? index->capacity * 2 : CE_MATCH_INDEX_MIN_CAPACITY;
+          CeMatch_t* new_matches = realloc(index->matches, new_capacity * sizeof(*new_matches));
+          if(!new_matches){
+               ce_log("%s() failed to allocate %ld matches\n", __FUNCTION__, new_capacity);
+               return false;
+          }
+
+          int64_t after_gap_count = index->capacity - index->gap_end;
+          memmove(new_matches + new_capacity - after_gap_count, new_matches + index->gap_end,
+                  after_gap_count * sizeof(*new_matches));
+          index->matches = new_matches;
+          index->gap_end = new_capacity - after_gap_count;
+          index->capacity = new_capacity;
+     }
+
+     CeMatch_t* match = index->matches + index->gap_start;
+     match->point = point;
+     match->length = length;
+     index->gap_start++;
+     return true;
+}
+
+// adds the line's matches at the gap, so the gap needs to be where the line's matches belong
+static void match_index_scan_line(CeMatchIndex_t* index, CeBuffer_t* buffer, int64_t y){
+     const char* line = ce_buffer_line(buffer, y);
+     const char* counted = line;
+     int64_t rune_index = 0;
+
+     if(index->regex){
+          CeRegexMatch_t matches[CE_REGEX_SEARCH_MATCH_BATCH];
+          int64_t offset = 0;
+          while(true){
+               int64_t match_count = 0;
+               CeRegexResult_t regex_result = ce_regex_match_all(index->compiled_regex, line, offset, matches,
+                                                                 CE_REGEX_SEARCH_MATCH_BATCH, &match_count);
+               if(regex_result.error_message != NULL){
+                    ce_log("ce_regex_match_all() failed: %s", regex_result.error_message);
+                    free(regex_result.error_message);
+                    return;
+               }
+
+               for(int64_t i = 0; i < match_count; i++){
+                    // an empty match (like "x*" between x's) has nothing to index, keep going to the real ones
+                    if(matches[i].length <= 0) continue;
+
+                    // regex results are byte offsets
+                    const char* match_start = line + matches[i].start;
+                    const char* match_end = match_start + matches[i].length;
+                    rune_index += utf8_rune_count(counted, match_start);
+                    counted = match_start;
+                    if(!match_index_add(index, (CePoint_t){rune_index, y}, utf8_rune_count(match_start, match_end))) return;
+               }
+
+               if(match_count < CE_REGEX_SEARCH_MATCH_BATCH) return;
+               offset = matches[match_count - 1].start + matches[match_count - 1].length;
+          }
+     }else{
+          const char* itr = line;
+          const char* match;
+          while((match = strstr(itr, index->search.pattern))){
+               rune_index += utf8_rune_count(counted, match);
+               counted = match;
+               if(!match_index_add(index, (CePoint_t){rune_index, y}, index->search.rune_length)) return;
+
+               // keep overlapping matches, they are all places a forward search would stop
+               itr = match + 1;
+          }
+     }
+}
+
+static void match_index_reset(CeMatchIndex_t* index, CeBuffer_t* buffer){
+     index->gap_start = 0;
+     index->gap_end = index->capacity;
+     index->gap_line_shift = 0;
+     index->scanned_line_count = 0;
+     ce_buffer_change_mark(&index->synced, buffer);
+}
+
+// where a line ends up after lines are inserted after, or joined into, first_line. When a range ends on the edited
+// line, the range should grow to cover any lines inserted there
+static int64_t match_index_map_line(int64_t line, int64_t first_line, int64_t line_count, bool insertion,
+                                    bool end_of_range){
+     if(insertion){
+          if(line < first_line) return line;
+          if(line == first_line) return end_of_range ? line + line_count : line;
+          return line + line_count;
+     }
+
+     if(line <= first_line) return line;
+     if(line <= first_line + line_count) return first_line;
+     return line - line_count;
+}
+
+static void match_index_apply_change(CeMatchIndex_t* index, const CeBufferChange_t* change, bool undo,
+                                     CeMatchIndexDirty_t* dirty, int64_t* dirty_count){
+     bool insertion = (change->insertion != undo);
+     int64_t first_line = change->location.y;
+     int64_t line_count = ce_util_count_string_lines(change->string) - 1;
+
+     match_index_move_gap(index, ce_match_index_lower_bound(index, (CePoint_t){0, first_line + 1}));
+     if(insertion){
+          index->gap_line_shift += line_count;
+     }else{
+          // the lines joined into the first line take their matches with them
+          match_index_remove_through_line(index, first_line + line_count);
+          index->gap_line_shift -= line_count;
+     }
+
+     // a change inside one line doesn't move any others, skipping it keeps a big replace_all from going quadratic
+     if(line_count > 0){
+          for(int64_t i = 0; i < *dirty_count; i++){
+               dirty[i].first = match_index_map_line(dirty[i].first, first_line, line_count, insertion, false);
+               dirty[i].last = match_index_map_line(dirty[i].last, first_line, line_count, insertion, true);
+          }
+     }
+
+     dirty[*dirty_count].first = first_line;
+     dirty[*dirty_count].last = insertion ? first_line + line_count : first_line;
+     (*dirty_count)++;
+
+     if(index->scanned_line_count > first_line){
+          index->scanned_line_count = match_index_map_line(index->scanned_line_count - 1, first_line, line_count,
+                                                           insertion, true) + 1;
+     }
+}
+
+static int match_index_dirty_compare(const void* a, const void* b){
+     const CeMatchIndexDirty_t* dirty_a = a;
+     const CeMatchIndexDirty_t* dirty_b = b;
+     if(dirty_a->first < dirty_b->first) return -1;
+     if(dirty_a->first > dirty_b->first) return 1;
+     return 0;
+}
+
+void ce_match_index_sync(CeMatchIndex_t* index, CeBuffer_t* buffer){
+     if(!index->pattern) return;
+     if(index->synced.buffer_version == buffer->version) return;
+
+     CeBufferChangesSince_t changes;
+     if(!ce_buffer_changes_since(buffer, &index->synced, &changes)){
+          match_index_reset(index, buffer);
+          return;
+     }
+
+     if(changes.count == 0 && changes.grown_line < 0){
+          ce_buffer_change_mark(&index->synced, buffer);
+          return;
+     }
+
+     CeMatchIndexDirty_t* dirty = malloc((changes.count + 1) * sizeof(*dirty));
+     if(!dirty){
+          ce_buffer_changes_since_free(&changes);
+          match_index_reset(index, buffer);
+          return;
+     }
+
+     int64_t dirty_count = 0;
+     if(changes.grown_line >= 0){
+          dirty[0].first = changes.grown_line;
+          dirty[0].last = changes.grown_line;
+          dirty_count++;
+     }
+
+     for(int64_t i = 0; i < changes.count; i++){
+          match_index_apply_change(index, &changes.nodes[i]->change, changes.undo, dirty, &dirty_count);
+     }
+
+     if(index->scanned_line_count > buffer->line_count) index->scanned_line_count = buffer->line_count;
+
+     // re-scan the edited lines against what the buffer looks like now, lines we haven't scanned yet can wait
+     qsort(dirty, dirty_count, sizeof(*dirty), match_index_dirty_compare);
+     int64_t rescanned_through = -1;
+     for(int64_t i = 0; i < dirty_count; i++){
+          int64_t first_line = dirty[i].first;
+          int64_t last_line = dirty[i].last;
+          if(first_line <= rescanned_through) first_line = rescanned_through + 1;
+          if(last_line >= index->scanned_line_count) last_line = index->scanned_line_count - 1;
+          if(first_line > last_line) continue;
+
+          match_index_move_gap(index, ce_match_index_lower_bound(index, (CePoint_t){0, first_line}));
+          match_index_remove_through_line(index, last_line);
+          for(int64_t y = first_line; y <= last_line; y++){
+               match_index_scan_line(index, buffer, y);
+          }
+          rescanned_through = last_line;
+     }
+
+     ce_buffer_changes_since_free(&changes);
+     free(dirty);
+     ce_buffer_change_mark(&index->synced, buffer);
+}
+
+bool ce_match_index_scan(CeMatchIndex_t* index, CeBuffer_t* buffer, int64_t max_lines){
+     if(!index->pattern) return true;
+
+     ce_match_index_sync(index, buffer);
+     match_index_move_gap(index, ce_match_index_count(index));
+
+     int64_t end_line = index->scanned_line_count + max_lines;
+     if(end_line > buffer->line_count) end_line = buffer->line_count;
+     for(int64_t y = index->scanned_line_count; y < end_line; y++){
+          match_index_scan_line(index, buffer, y);
+     }
+     if(end_line > index->scanned_line_count) index->scanned_line_count = end_line;
+
+     return index->scanned_line_count >= buffer->line_count;
+}
+
+bool ce_match_index_is_complete(const CeMatchIndex_t* index, const CeBuffer_t* buffer){
+     return index->pattern && index->synced.buffer_version == buffer->version &&
+            index->scanned_line_count >= buffer->line_count;
+}
+
+bool ce_match_index_covers(CeMatchIndex_t* index, CeBuffer_t* buffer, const char* pattern, bool regex, int64_t last_line){
+     if(!index->pattern || index->regex != regex || strcmp(index->pattern, pattern) != 0) return false;
+     ce_match_index_sync(index, buffer);
+     return index->scanned_line_count > last_line;
+}
+
+// a longer literal pattern can only match where the shorter one did, so typing a search out doesn't have to re-scan
+static void match_index_narrow(CeMatchIndex_t* index, CeBuffer_t* buffer){
+     match_index_move_gap(index, ce_match_index_count(index));
+
+     int64_t kept = 0;
+     for(int64_t i = 0; i < index->gap_start; i++){
+          CeMatch_t match = index->matches[i];
+          const char* string = ce_buffer_line_iterate_to(buffer, match.point.y, match.point.x);
+          if(string && strncmp(string, index->search.pattern, index->search.length) == 0){
+               match.length = index->search.rune_length;
+               index->matches[kept] = match;
+               kept++;
+          }
+     }
+
+     index->gap_start = kept;
+}
+
+bool ce_match_index_set_pattern(CeMatchIndex_t* index, CeBuffer_t* buffer, const char* pattern, bool regex){
+     if(index->pattern && index->regex == regex && strcmp(index->pattern, pattern) == 0) return true;
+
+     if(pattern[0] == 0){
+          ce_match_index_free(index);
+          return false;
+     }
+
+     CeRegex_t compiled_regex = NULL;
+     if(regex){
+          CeRegexResult_t regex_result = ce_regex_init(pattern, &compiled_regex);
+          if(regex_result.error_message != NULL){
+               ce_log("ce_regex_init() failed: '%s'", regex_result.error_message);
+               free(regex_result.error_message);
+               ce_match_index_free(index);
+               return false;
+          }
+     }
+
+     bool narrow = (index->pattern && !index->regex && !regex &&
+                    strncmp(pattern, index->pattern, index->search.length) == 0);
+     if(narrow) ce_match_index_sync(index, buffer);
+
+     if(index->compiled_regex) ce_regex_free(index->compiled_regex);
+     free(index->pattern);
+     index->pattern = strdup(pattern);
+     index->regex = regex;
+     index->compiled_regex = compiled_regex;
+     ce_search_init(&index->search, index->pattern);
+
+     if(narrow){
+          match_index_narrow(index, buffer);
+     }else{
+          match_index_reset(index, buffer);
+     }
+     return true;
+}
+
+void ce_match_index_free(CeMatchIndex_t* index){
+     if(index->compiled_regex) ce_regex_free(index->compiled_regex);
+     free(index->pattern);
+     free(index->matches);
+     memset(index, 0, sizeof(*index));
+}
+
 const char* ce_buffer_status_get_str(CeBufferStatus_t status){
      if(status == CE_BUFFER_STATUS_READONLY){
           return "[RO]";
@@ -1270,7 +2927,7 @@ void ce_view_follow_cursor(CeView_t* view, int64_t horizontal_scroll_off, int64_
 
      int64_t visible_index = 0;
      if(ce_buffer_point_is_valid(view->buffer, view->cursor)){
-          visible_index = ce_util_string_index_to_visible_index(view->buffer->lines[view->cursor.y],
+          visible_index = ce_util_string_index_to_visible_index(ce_buffer_line(view->buffer, view->cursor.y),
                                                                 view->cursor.x, tab_width);
      }
 
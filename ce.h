@@ -26,6 +26,13 @@
 #define CE_UTF8_INVALID -1
 #define CE_UTF8_SIZE 4
 #define CE_ASCII_PRINTABLE_CHARACTERS (127 - 32)
+#define CE_BUFFER_MIN_LINE_CAPACITY 16
+#define CE_LINE_CHECKPOINT_RUNES 64
+#define CE_MATCH_INDEX_MIN_CAPACITY 64
+#define CE_REGEX_SEARCH_MATCH_BATCH 64
+#define CE_SAVE_IOVEC_COUNT 1024 // IOV_MAX on linux
+#define CE_CHANGE_ARENA_BLOCK_SIZE (64 * 1024)
+#define CE_CHANGE_HISTORY_DEFAULT_MEMORY_LIMIT (64 * 1024 * 1024)
 
 #if defined(PLATFORM_WINDOWS)
     #define CE_PATH_SEPARATOR '\\'
@@ -122,16 +129,101 @@ typedef struct{
      CePoint_t cursor_after;
 }CeBufferChange_t;
 
+// undo history is carved out of large blocks rather than a malloc per node and per string. Each block counts the
+// nodes and strings in it that are still part of the history, and is freed once they have all been trimmed or thrown
+// away along with redo history
+typedef struct CeChangeArenaBlock_t{
+     struct CeChangeArenaBlock_t* next;
+     struct CeChangeArenaBlock_t* prev;
+     int64_t used;
+     int64_t capacity;
+     int64_t live_count;
+     char* data;
+}CeChangeArenaBlock_t;
+
+typedef struct{
+     CeChangeArenaBlock_t* head; // oldest
+     CeChangeArenaBlock_t* tail; // allocations come from here
+     int64_t allocated_bytes;
+}CeChangeArena_t;
+
 typedef struct CeBufferChangeNode_t{
      CeBufferChange_t change;
      struct CeBufferChangeNode_t* next;
      struct CeBufferChangeNode_t* prev;
-     int64_t index;
+     int64_t index; // unique and increasing within a buffer's history
+     int64_t coalesced_count; // bumped every time another edit is folded into this change
+     int64_t string_capacity;
+     CeChangeArenaBlock_t* block;
+     CeChangeArenaBlock_t* string_block;
 }CeBufferChangeNode_t;
 
+// where something built from a buffer's lines left off in its change history, so it can catch up on just the edits made
+// since rather than starting over
+typedef struct{
+     int64_t buffer_version;
+     int64_t unrecorded_edits;
+     CeBufferChangeNode_t* change_node; // only ever compared against, it may have been freed since
+     int64_t change_index;
+     int64_t change_coalesced_count;
+     int64_t change_string_length; // bytes of the marked change's string, edits folded in later grow it
+     CePoint_t change_location;
+}CeBufferChangeMark_t;
+
+// the changes made since a mark, in the order they were applied to the buffer
+typedef struct{
+     CeBufferChangeNode_t** nodes;
+     int64_t count;
+     bool undo; // the changes were undone, so each one applies in reverse
+     int64_t grown_line; // the marked change had more edits folded into it on this line, -1 if it didn't
+}CeBufferChangesSince_t;
+
+// replace the runes from start up to (not including) end with text. Points are in the buffer as it was before the edit
 typedef struct{
+     CePoint_t start;
+     CePoint_t end;
+     char* text;
+}CeBufferEdit_t;
+
+typedef struct{
+     CeBufferEdit_t* elements;
+     int64_t count;
+}CeBufferEdits_t;
+
+// cached per line so we don't have to decode the whole line every time we convert between rune and byte indices
+typedef struct{
+     int64_t rune_count; // -1 when the line has changed and needs to be re-counted
+     int32_t* checkpoints; // byte offset of every CE_LINE_CHECKPOINT_RUNES'th rune, NULL for short lines
+     int64_t mapped_length; // bytes of the line while it still points into the buffer's mapping, where it isn't terminated
+}CeLineInfo_t;
+
+typedef struct{
+     CeLineInfo_t* infos;
+     int64_t capacity;
+     int64_t gap_start;
+     int64_t gap_end;
+}CeLineInfos_t;
+
+// how a buffer's line pointers are laid out, pick one with ce_buffer_set_storage()
+typedef enum{
+     CE_BUFFER_STORAGE_LINE_GAP, // the gap stays where lines were last inserted or removed, edits near each other only
+                                 // move the lines between them
+     CE_BUFFER_STORAGE_LINE_ARRAY, // the gap is kept at the end, every edit shifts all the lines after it
+}CeBufferStorage_t;
+
+typedef struct{
+     // read lines through ce_buffer_line(), the pointers sit either side of a gap, only ce.c should touch these
      char** lines;
+     int64_t line_gap_start;
+     int64_t line_gap_end;
+     CeBufferStorage_t storage;
+     CeLineInfos_t line_infos; // one per line, only ce.c should touch these
      int64_t line_count;
+     int64_t line_capacity; // lines allocated, so we aren't reallocing the line array on every split/join
+
+     // when loaded from a file, lines point into this read only mapping until they are first read or modified
+     char* mapping;
+     int64_t mapping_size;
 
      char* name;
 
@@ -142,18 +234,51 @@ typedef struct{
 
      CeBufferChangeNode_t* change_node;
      CeBufferChangeNode_t* save_at_change_node;
+     CeBufferChangeNode_t* change_root; // oldest change we can undo back to
+     CeChangeArena_t change_arena;
+     int64_t change_memory_limit; // oldest history is trimmed past this, 0 uses CE_CHANGE_HISTORY_DEFAULT_MEMORY_LIMIT
+     int64_t version; // bumped on every edit, so caches built from the lines can tell they are out of date
+     int64_t recorded_version; // bumped for every edit made through the change list, including undo and redo
 
      bool no_line_numbers;
      bool no_highlight_current_line;
 
      void* app_data; // TODO: this doesn't need to be a void*
      void* syntax_data;
+     void* syntax_cache; // per line lexer state owned by ce_syntax.c, kept when the buffer is freed so it can be reused
 
      time_t file_modified_time;
 
      // NOTE: if we decide to do a buffer init hook, add config_data for user configs
 }CeBuffer_t;
 
+typedef struct{
+     int64_t text_bytes; // lines, whether mapped or on the heap, and the tables to track them
+     int64_t history_bytes; // undo history
+}CeBufferMemory_t;
+
+// lines found so far while scanning text, every newline adds a pointer to the start of the next line
+typedef struct{
+     char** lines;
+     int64_t line_count;
+     int64_t line_capacity;
+     int64_t continuation_bytes; // left to see before the current multi-byte rune is complete
+}CeLineSplit_t;
+
+// fills a buffer from a file a piece at a time, so a file can be displayed while the rest of it is still loading.
+// ce_buffer_file_load_step() doesn't touch the buffer, so it may be called from another thread, as long as it is
+// synchronized with ce_buffer_file_load_take()
+typedef struct{
+     char* mapping;
+     int64_t mapping_size;
+     int64_t bytes_split;
+     CeLineSplit_t split;
+     CeBufferStatus_t final_status; // the buffer is readonly until the load finishes
+     bool placeholder_replaced;
+     bool failed;
+     bool truncated; // the file shrank while we were scanning it
+}CeBufferFileLoad_t;
+
 typedef struct{
      CeRect_t rect;
      CePoint_t scroll;
@@ -205,6 +330,7 @@ typedef struct{
      char clang_format_path[MAX_PATH_LEN];
      int mouse_wheel_line_scroll;
      int popup_view_height;
+     int64_t undo_memory_limit; // bytes of undo history kept per buffer
 }CeConfigOptions_t;
 
 typedef struct CeRuneNode_t{
@@ -217,6 +343,47 @@ typedef struct{
      int64_t length;
 }CeRegexSearchResult_t;
 
+// a literal pattern compiled once, so it can be searched for over and over (every line of a view, every match in a
+// replace_all, etc.) without redoing the setup. The pattern is borrowed, it needs to outlive the search.
+typedef struct{
+     const char* pattern;
+     int64_t length; // in bytes
+     int64_t rune_length;
+     int32_t reverse_skip[256]; // horspool shift for searching backwards, keyed off the byte under the first pattern byte
+}CeSearch_t;
+
+// walks the matches on a line, keeping track of the rune index as it goes, so callers get rune offsets without walking
+// the line a second time
+typedef struct{
+     const char* itr;
+     int64_t rune_index; // of itr
+}CeSearchLineItr_t;
+
+typedef struct{
+     CePoint_t point;
+     int64_t length; // in runes
+}CeMatch_t;
+
+// every match of a pattern in a buffer, built up a chunk of lines at a time and then kept in sync with the buffer's
+// changes. The matches are sorted in a gap buffer that follows edits around, so an edit only moves the matches near it
+// rather than renumbering every match after it
+typedef struct{
+     char* pattern;
+     bool regex;
+     CeSearch_t search;
+     CeRegex_t compiled_regex;
+
+     CeMatch_t* matches;
+     int64_t capacity;
+     int64_t gap_start;
+     int64_t gap_end;
+     int64_t gap_line_shift; // added to the line of every match after the gap to get its real line
+
+     int64_t scanned_line_count; // matches are only known for lines before this
+
+     CeBufferChangeMark_t synced; // the buffer state the matches reflect
+}CeMatchIndex_t;
+
 typedef struct{
      CePoint_t point;
      char filepath[MAX_PATH_LEN];
@@ -241,12 +408,24 @@ bool ce_buffer_alloc(CeBuffer_t* buffer, int64_t line_count, const char* name);
 void ce_buffer_free(CeBuffer_t* buffer);
 bool ce_buffer_load_file(CeBuffer_t* buffer, const char* filename);
 bool ce_buffer_load_string(CeBuffer_t* buffer, const char* string, const char* name);
+bool ce_buffer_file_load_begin(CeBuffer_t* buffer, CeBufferFileLoad_t* load, const char* filename);
+bool ce_buffer_file_load_step(CeBufferFileLoad_t* load, int64_t max_bytes);
+bool ce_buffer_file_load_take(CeBuffer_t* buffer, CeBufferFileLoad_t* load); // returns true once the load is over
+void ce_buffer_file_load_cancel(CeBuffer_t* buffer, CeBufferFileLoad_t* load);
+int64_t ce_buffer_file_load_percent(CeBufferFileLoad_t* load);
 bool ce_buffer_save(CeBuffer_t* buffer);
 bool ce_buffer_empty(CeBuffer_t* buffer);
+void ce_buffer_set_storage(CeBuffer_t* buffer, CeBufferStorage_t storage);
 
 CeRune_t ce_buffer_get_rune(CeBuffer_t* buffer, CePoint_t point); // TODO: unittest
 int64_t ce_buffer_range_len(CeBuffer_t* buffer, CePoint_t start, CePoint_t end); // inclusive
+// the line's NUL terminated text, only ce.c should modify it. Lines still in the file mapping are copied out the first
+// time they are asked for
+char* ce_buffer_line(CeBuffer_t* buffer, int64_t line);
 int64_t ce_buffer_line_len(CeBuffer_t* buffer, int64_t line);
+CeBufferMemory_t ce_buffer_memory(CeBuffer_t* buffer);
+char* ce_buffer_line_iterate_to(CeBuffer_t* buffer, int64_t line, int64_t index); // like ce_utf8_iterate_to() but uses the line's cached checkpoints
+int64_t ce_buffer_line_rune_index(CeBuffer_t* buffer, int64_t line, const char* line_itr); // rune index of a pointer into the line
 CePoint_t ce_buffer_move_point(CeBuffer_t* buffer, CePoint_t point, CePoint_t delta, int64_t tab_width, CeClampX_t clamp_x); // TODO: unittest
 CePoint_t ce_buffer_advance_point(CeBuffer_t* buffer, CePoint_t point, int64_t delta); // TODO: unittest
 CePoint_t ce_buffer_clamp_point(CeBuffer_t* buffer, CePoint_t point, CeClampX_t clamp_x); // TODO: unittest
@@ -255,6 +434,8 @@ bool ce_buffer_contains_point(CeBuffer_t* buffer, CePoint_t point);
 int64_t ce_buffer_point_is_valid(CeBuffer_t* buffer, CePoint_t point); // like ce_buffer_contains_point(), but includes end of line as valid // TODO: unittest
 CePoint_t ce_buffer_search_forward(CeBuffer_t* buffer, CePoint_t start, const char* pattern);
 CePoint_t ce_buffer_search_backward(CeBuffer_t* buffer, CePoint_t start, const char* pattern);
+CePoint_t ce_buffer_literal_search_forward(CeBuffer_t* buffer, CePoint_t start, const CeSearch_t* search);
+CePoint_t ce_buffer_literal_search_backward(CeBuffer_t* buffer, CePoint_t start, const CeSearch_t* search);
 CeRegexSearchResult_t ce_buffer_regex_search_forward(CeBuffer_t* buffer, CePoint_t start, CeRegex_t regex);
 CeRegexSearchResult_t ce_buffer_regex_search_backward(CeBuffer_t* buffer, CePoint_t start, CeRegex_t regex);
 
@@ -273,12 +454,34 @@ bool ce_buffer_insert_string_change_at_cursor(CeBuffer_t* buffer, char* alloced_
 bool ce_buffer_remove_string_change(CeBuffer_t* buffer, CePoint_t point, int64_t remove_len, CePoint_t* cursor_before,
                                     CePoint_t cursor_after, bool chain_undo);
 
-bool ce_buffer_change(CeBuffer_t* buffer, CeBufferChange_t* change); // TODO: unittest
+// takes ownership of change->string. A chained single rune insert or delete next to the current change on the same line
+// is folded into it rather than adding a node, so don't count on the change node changing
+bool ce_buffer_change(CeBuffer_t* buffer, CeBufferChange_t* change);
 bool ce_buffer_undo(CeBuffer_t* buffer, CePoint_t* cursor); // TODO: unittest
 bool ce_buffer_redo(CeBuffer_t* buffer, CePoint_t* cursor); // TODO: unittest
 
+void ce_buffer_change_mark(CeBufferChangeMark_t* mark, const CeBuffer_t* buffer);
+// returns false when the changes can't be known, like after edits that weren't recorded, and the caller should start over
+bool ce_buffer_changes_since(CeBuffer_t* buffer, const CeBufferChangeMark_t* mark, CeBufferChangesSince_t* changes);
+void ce_buffer_changes_since_free(CeBufferChangesSince_t* changes);
+bool ce_buffer_edits_since(CeBuffer_t* buffer, const CeBufferChangeMark_t* mark, CeBufferEdits_t* edits); // false if the edits can't be known
+void ce_buffer_edits_free(CeBufferEdits_t* edits);
+
 CePoint_t ce_move_point_based_on_buffer_changes(CeBuffer_t* buffer, CeBufferChangeNode_t* before, CePoint_t before_point);
 
+// an empty or invalid pattern leaves the index without a pattern
+bool ce_match_index_set_pattern(CeMatchIndex_t* index, CeBuffer_t* buffer, const char* pattern, bool regex);
+void ce_match_index_free(CeMatchIndex_t* index);
+void ce_match_index_sync(CeMatchIndex_t* index, CeBuffer_t* buffer); // catch up on edits made since the last sync
+bool ce_match_index_scan(CeMatchIndex_t* index, CeBuffer_t* buffer, int64_t max_lines); // returns true once complete
+bool ce_match_index_is_complete(const CeMatchIndex_t* index, const CeBuffer_t* buffer);
+bool ce_match_index_covers(CeMatchIndex_t* index, CeBuffer_t* buffer, const char* pattern, bool regex, int64_t last_line);
+int64_t ce_match_index_count(const CeMatchIndex_t* index);
+CeMatch_t ce_match_index_get(const CeMatchIndex_t* index, int64_t i);
+int64_t ce_match_index_lower_bound(const CeMatchIndex_t* index, CePoint_t point); // first match at or after point
+CePoint_t ce_match_index_next(const CeMatchIndex_t* index, CePoint_t start); // like searching forward from start
+CePoint_t ce_match_index_prev(const CeMatchIndex_t* index, CePoint_t start); // like searching backward from start
+
 const char* ce_buffer_status_get_str(CeBufferStatus_t status);
 
 void ce_view_follow_cursor(CeView_t* view, int64_t horizontal_scroll_off, int64_t vertical_scroll_off, int64_t tab_width);
@@ -289,6 +492,11 @@ int64_t ce_view_height(CeView_t* view);
 
 int64_t ce_utf8_strlen(const char* string);
 int64_t ce_utf8_strlen_between(const char* start, const char* end); // inclusive
+
+void ce_search_init(CeSearch_t* search, const char* pattern);
+const char* ce_search_find_reverse(const CeSearch_t* search, const char* string, const char* end);
+void ce_search_line_begin(CeSearchLineItr_t* line_itr, const char* line);
+int64_t ce_search_line_next(const CeSearch_t* search, CeSearchLineItr_t* line_itr); // returns -1 when out of matches
 int64_t ce_utf8_last_index(const char* string);
 char* ce_utf8_iterate_to(char* string, int64_t index);
 char* ce_utf8_iterate_to_include_end(char* string, int64_t index);
@@ -1,5 +1,6 @@
 #include "ce_app.h"
 #include "ce_commands.h"
+#include "ce_key_defines.h"
 #include "ce_subprocess.h"
 #include "ce_syntax.h"
 
@@ -44,8 +45,12 @@ bool ce_buffer_node_insert(CeBufferNode_t** head, CeBuffer_t* buffer){
 
 static void free_buffer_node(CeBufferNode_t* node){
      CeAppBufferData_t* buffer_data = node->buffer->app_data;
-     if(buffer_data) free(buffer_data->base_directory);
+     if(buffer_data){
+          free(buffer_data->base_directory);
+          ce_match_index_free(&buffer_data->vim.search_matches);
+     }
      free(node->buffer->app_data);
+     ce_syntax_cache_free(node->buffer);
      ce_buffer_free(node->buffer);
      free(node->buffer);
      free(node);
@@ -251,7 +256,7 @@ void ce_syntax_highlight_completions(CeView_t* view, CeRangeList_t* highlight_ra
      }
 
      for(int64_t y = min; y <= max; ++y){
-          char* line = view->buffer->lines[y];
+          char* line = ce_buffer_line(view->buffer, y);
           char* end_of_match = strchr(line, ':');
           CePoint_t match_point = {0, y};
 
@@ -440,7 +445,7 @@ CePoint_t view_cursor_on_screen(CeView_t* view, int64_t tab_width, CeLineNumber_
      // move the visual cursor to the right location
      int64_t visible_cursor_x = 0;
      if(ce_buffer_point_is_valid(view->buffer, view->cursor)){
-          visible_cursor_x = ce_util_string_index_to_visible_index(view->buffer->lines[view->cursor.y],
+          visible_cursor_x = ce_util_string_index_to_visible_index(ce_buffer_line(view->buffer, view->cursor.y),
                                                                    view->cursor.x, tab_width);
      }
 
@@ -523,6 +528,7 @@ CeBuffer_t* load_file_into_view(CeBufferNode_t** buffer_node_head, CeView_t* vie
      // load file
      CeBuffer_t* buffer = new_buffer();
      if(ce_buffer_load_file(buffer, load_path)){
+          buffer->change_memory_limit = config_options->undo_memory_limit;
           ce_buffer_node_insert(buffer_node_head, buffer);
           ce_view_switch_buffer(view, buffer, vim, config_options, insert_into_jump_list);
           determine_buffer_syntax(buffer);
@@ -691,14 +697,10 @@ void build_complete_list(CeBuffer_t* buffer, CeComplete_t* complete){
 
 bool buffer_append_on_new_line(CeBuffer_t* buffer, const char* string){
      int64_t old_line_count = buffer->line_count;
-     if(old_line_count == 1 && strlen(buffer->lines[0]) == 0){
+     if(old_line_count == 1 && strlen(ce_buffer_line(buffer, 0)) == 0){
           return ce_buffer_insert_string(buffer, string, (CePoint_t){0, 0});
      }
-     int64_t new_line_count = buffer->line_count + 1;
-     buffer->lines = realloc(buffer->lines, new_line_count * sizeof(buffer->lines[0]));
-     if(buffer->lines == NULL) return false;
-     buffer->line_count = new_line_count;
-     buffer->lines[old_line_count] = calloc(1, sizeof(buffer->lines[old_line_count]));
+     // inserting just passed the last line appends a new line for us
      return ce_buffer_insert_string(buffer, string, (CePoint_t){0, old_line_count});
 }
 
@@ -915,6 +917,7 @@ void ce_app_init_default_commands(CeApp_t* app){
      CeCommandEntry_t command_entries[] = {
           {command_balance_layout, "balance_layout", "rebalance layout based on the node tree"},
           {command_blank, "blank", "empty command"},
+          {command_cancel_file_load, "cancel_file_load", "stop loading a large file in the background, keeping what has loaded so far"},
           {command_clang_goto_def, "clang_goto_def", "If clangd is enabled, request to go the definition of the symbol under the cursor."},
           {command_clang_goto_decl, "clang_goto_decl", "If clangd is enabled, request to go the declaration of the symbol under the cursor."},
           {command_clang_goto_type_def, "clang_goto_type_def", "If clangd is enabled, request to go the type definition of the symbol under the cursor."},
@@ -960,8 +963,10 @@ void ce_app_init_default_commands(CeApp_t* app){
           {command_setpaste, "setpaste", "about to paste, so turn off auto indentation"},
           {command_show_buffers, "show_buffers", "show the list of buffers"},
           {command_show_jumps, "show_jumps", "show the state of your jumps"},
+          {command_show_loop_stats, "show_loop_stats", "show how often the main loop has woken up and drawn"},
           {command_show_macros, "show_macros", "show the state of your macros"},
           {command_show_marks, "show_marks", "show the state of your vim marks"},
+          {command_show_profile, "show_profile", "show p50/p99 timings of each stage of recent frames, if built with ENABLE_PROFILE"},
           {command_show_yanks, "show_yanks", "show the state of your vim yanks"},
           {command_split_layout, "split_layout", "split the current layout 'horizontal' or 'vertical' into 2 layouts"},
           {command_switch_buffer, "switch_buffer", "open dialogue to switch buffer by name"},
@@ -969,6 +974,7 @@ void ce_app_init_default_commands(CeApp_t* app){
           {command_toggle_log_keys_pressed, "toggle_log_keys_pressed", "debug command to log key presses"},
           {command_shell_command, "shell_command", "run a shell command"},
           {command_shell_command_relative, "shell_command_relative", "run a shell command relative to the current buffer"},
+          {command_write_profile_trace, "write_profile_trace", "write recent profile timings as a chrome trace json file (optionally specified)"},
           {command_vim_cn, "cn", "vim's cn command to select the goto the next build error"},
           {command_vim_cp, "cp", "vim's cn command to select the goto the previous build error"},
           {command_vim_e, "e", "vim's e command to load a file specified"},
@@ -1103,10 +1109,10 @@ bool apply_completion_to_buffer(CeComplete_t* complete,
 
      // Do we even need completion ?
      int64_t completion_len = strlen(complete->elements[complete->current].string);
-     int64_t input_len = strlen(buffer->lines[cursor->y] + start_x);
+     int64_t input_len = strlen(ce_buffer_line(buffer, cursor->y) + start_x);
      int64_t input_offset = 0;
      if(input_len > completion_len) input_offset = input_len - completion_len;
-     if(strcmp(complete->elements[complete->current].string, buffer->lines[cursor->y] + start_x + input_offset) == 0){
+     if(strcmp(complete->elements[complete->current].string, ce_buffer_line(buffer, cursor->y) + start_x + input_offset) == 0){
           return false;
      }
 
@@ -1134,8 +1140,8 @@ bool apply_completion_to_buffer(CeComplete_t* complete,
      }
 
      // Delete any previous match from after the cursor
-     int64_t extra_len = strlen(buffer->lines[cursor->y] + cursor->x);
-     char* extra = strdup(buffer->lines[cursor->y] + cursor->x);
+     int64_t extra_len = strlen(ce_buffer_line(buffer, cursor->y) + cursor->x);
+     char* extra = strdup(ce_buffer_line(buffer, cursor->y) + cursor->x);
      bool removed = false;
      for(int64_t i = extra_len; i > 0; i--){
           extra[i] = 0;
@@ -1682,7 +1688,7 @@ void _extract_reference_locations_to_buffer(CeJsonObj_t* obj, CeBuffer_t* buffer
               free(buffer_full_path);
               if(matches){
                   if(start_y < buffer_itr->buffer->line_count){
-                      char* buffer_line = buffer_itr->buffer->lines[start_y];
+                      char* buffer_line = ce_buffer_line(buffer_itr->buffer, start_y);
                       end = ce_buffer_end_point(buffer);
                       ce_buffer_insert_string(buffer, buffer_line, end);
                   }
@@ -1701,12 +1707,14 @@ void _extract_reference_locations_to_buffer(CeJsonObj_t* obj, CeBuffer_t* buffer
      buffer->status = CE_BUFFER_STATUS_READONLY;
 }
 
-void ce_app_handle_clangd_response(CeApp_t* app){
+bool ce_app_handle_clangd_response(CeApp_t* app){
      if(app->clangd.buffer == NULL){
-          return;
+          return false;
      }
+     bool handled = false;
      while(ce_clangd_outstanding_responses(&app->clangd)){
           CeClangDResponse_t response = ce_clangd_pop_response(&app->clangd);
+          handled = true;
           if(response.method != NULL){
                if(strcmp(response.method, "textDocument/typeDefinition") == 0 ||
                   strcmp(response.method, "textDocument/definition") == 0 ||
@@ -1790,6 +1798,7 @@ void ce_app_handle_clangd_response(CeApp_t* app){
           }
           ce_clangd_response_free(&response);
      }
+     return handled;
 }
 
 void build_clangd_diagnostics_buffer(CeBuffer_t* buffer, CeBuffer_t* source){
@@ -1807,8 +1816,8 @@ void build_clangd_diagnostics_buffer(CeBuffer_t* buffer, CeBuffer_t* source){
 }
 
 bool unsaved_buffers_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffer){
-     if(strcmp(app->input_view.buffer->lines[0], "y") == 0 ||
-        strcmp(app->input_view.buffer->lines[0], "Y") == 0){
+     if(strcmp(ce_buffer_line(app->input_view.buffer, 0), "y") == 0 ||
+        strcmp(ce_buffer_line(app->input_view.buffer, 0), "Y") == 0){
           app->quit = true;
      }
 
@@ -1816,8 +1825,8 @@ bool unsaved_buffers_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffer)
 }
 
 bool buffer_modified_outside_editor_complete_func(CeApp_t* app, CeBuffer_t* input_buffer){
-     if(strcmp(app->input_view.buffer->lines[0], "y") == 0 ||
-        strcmp(app->input_view.buffer->lines[0], "Y") == 0){
+     if(strcmp(ce_buffer_line(app->input_view.buffer, 0), "y") == 0 ||
+        strcmp(ce_buffer_line(app->input_view.buffer, 0), "Y") == 0){
           CeLayout_t* tab_layout = app->tab_list_layout->tab_list.current;
           CeView_t* view = NULL;
 
@@ -1838,9 +1847,9 @@ bool command_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffer){
      if(tab_layout->tab.current->type != CE_LAYOUT_TYPE_VIEW) return false;
      CeView_t* view = &tab_layout->tab.current->view;
 
-     char* end_of_number = app->input_view.buffer->lines[0];
-     int64_t line_number = strtol(app->input_view.buffer->lines[0], &end_of_number, 10);
-     if(end_of_number > app->input_view.buffer->lines[0]){
+     char* end_of_number = ce_buffer_line(app->input_view.buffer, 0);
+     int64_t line_number = strtol(ce_buffer_line(app->input_view.buffer, 0), &end_of_number, 10);
+     if(end_of_number > ce_buffer_line(app->input_view.buffer, 0)){
           // if the command entered was a number, go to that line
           if(line_number >= 0 && line_number < view->buffer->line_count){
                view->cursor.y = line_number - 1;
@@ -1852,8 +1861,8 @@ bool command_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffer){
      }else{
           // convert and run the command
           CeCommand_t command = {};
-          if(!ce_command_parse(&command, app->input_view.buffer->lines[0])){
-               ce_log("failed to parse command: '%s'\n", app->input_view.buffer->lines[0]);
+          if(!ce_command_parse(&command, ce_buffer_line(app->input_view.buffer, 0))){
+               ce_log("failed to parse command: '%s'\n", ce_buffer_line(app->input_view.buffer, 0));
           }else{
                CeCommandFunc_t* command_func = NULL;
                CeCommandEntry_t* entry = NULL;
@@ -1874,7 +1883,7 @@ bool command_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffer){
                          ce_app_message(app, "%s: %s", entry->name, entry->description);
                          break;
                     }
-                    ce_history_insert(&app->command_history, app->input_view.buffer->lines[0]);
+                    ce_history_insert(&app->command_history, ce_buffer_line(app->input_view.buffer, 0));
                }else{
                     ce_app_message(app, "unknown command: '%s'", command.name);
                }
@@ -1895,10 +1904,10 @@ bool load_file_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffer){
      char* base_directory = buffer_base_directory(view->buffer);
      char filepath[MAX_PATH_LEN];
      for(int64_t i = 0; i < app->input_view.buffer->line_count; i++){
-          if(base_directory && app->input_view.buffer->lines[i][0] != CE_PATH_SEPARATOR){
-               snprintf(filepath, MAX_PATH_LEN, "%s%c%s", base_directory, CE_PATH_SEPARATOR, app->input_view.buffer->lines[i]);
+          if(base_directory && ce_buffer_line(app->input_view.buffer, i)[0] != CE_PATH_SEPARATOR){
+               snprintf(filepath, MAX_PATH_LEN, "%s%c%s", base_directory, CE_PATH_SEPARATOR, ce_buffer_line(app->input_view.buffer, i));
           }else{
-               strncpy(filepath, app->input_view.buffer->lines[i], MAX_PATH_LEN);
+               strncpy(filepath, ce_buffer_line(app->input_view.buffer, i), MAX_PATH_LEN);
           }
           if(!load_file_into_view(&app->buffer_node_head, view, &app->config_options, &app->vim,
                                   true, filepath)){
@@ -1923,8 +1932,8 @@ bool load_project_file_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffe
 
      for(int64_t i = 0; i < input_buffer->line_count; i++){
           if(!load_file_into_view(&app->buffer_node_head, view, &app->config_options, &app->vim,
-                                  true, input_buffer->lines[i])){
-               ce_app_message(app, "failed to load file '%s': '%s'", input_buffer->lines[i], strerror(errno));
+                                  true, ce_buffer_line(input_buffer, i))){
+               ce_app_message(app, "failed to load file '%s': '%s'", ce_buffer_line(input_buffer, i), strerror(errno));
                errno = 0;
                return false;
           }else{
@@ -1943,16 +1952,16 @@ bool search_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffer){
      if(tab_layout->tab.current->type != CE_LAYOUT_TYPE_VIEW) return false;
      CeView_t* view = &tab_layout->tab.current->view;
 
-     ce_history_insert(&app->search_history, app->input_view.buffer->lines[0]);
+     ce_history_insert(&app->search_history, ce_buffer_line(app->input_view.buffer, 0));
 
      // update yanks
      CeVimYank_t* yank = app->vim.yanks + ce_vim_register_index('/');
      free(yank->text);
-     yank->text = strdup(app->input_view.buffer->lines[0]);
+     yank->text = strdup(ce_buffer_line(app->input_view.buffer, 0));
      yank->type = CE_VIM_YANK_TYPE_STRING;
 
      // clear input buffer
-     app->input_view.buffer->lines[0][0] = 0;
+     ce_buffer_empty(app->input_view.buffer);
 
      // insert jump
      CeAppViewData_t* view_data = view->user_data;
@@ -1974,7 +1983,7 @@ bool switch_buffer_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffer){
      CeJumpList_t* jump_list = &view_data->jump_list;
      CeBufferNode_t* itr = app->buffer_node_head;
      while(itr){
-          if(strcmp(itr->buffer->name, app->input_view.buffer->lines[0]) == 0){
+          if(strcmp(itr->buffer->name, ce_buffer_line(app->input_view.buffer, 0)) == 0){
                ce_view_switch_buffer(view, itr->buffer, &app->vim, &app->config_options,
                                      jump_list);
                break;
@@ -1994,13 +2003,13 @@ bool replace_all_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffer){
      int64_t index = ce_vim_register_index('/');
      CeVimYank_t* yank = app->vim.yanks + index;
      if(yank->text){
-          replace_all(view, &app->vim_visual_save, yank->text, app->input_view.buffer->lines[0]);
+          replace_all(view, &app->vim_visual_save, yank->text, ce_buffer_line(app->input_view.buffer, 0));
      }
      return true;
 }
 
 bool edit_macro_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffer){
-     CeRune_t* rune_string = ce_char_string_to_rune_string(app->input_view.buffer->lines[0]);
+     CeRune_t* rune_string = ce_char_string_to_rune_string(ce_buffer_line(app->input_view.buffer, 0));
      if(rune_string){
           ce_rune_node_free(app->macros.rune_head + app->edit_register);
           CeRune_t* itr = rune_string;
@@ -2022,8 +2031,8 @@ bool edit_yank_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffer){
           yank->block_line_count = app->input_view.buffer->line_count;
           yank->block = malloc(yank->block_line_count * sizeof(*yank->block));
           for(int64_t i = 0; i < app->input_view.buffer->line_count; i++){
-               if(strlen(app->input_view.buffer->lines[i])){
-                    yank->block[i] = strdup(app->input_view.buffer->lines[i]);
+               if(strlen(ce_buffer_line(app->input_view.buffer, i))){
+                    yank->block[i] = strdup(ce_buffer_line(app->input_view.buffer, i));
                }else{
                     yank->block[i] = NULL;
                }
@@ -2296,6 +2305,224 @@ bool ce_app_run_shell_command(CeApp_t* app, const char* command, CeLayout_t* tab
      return true;
 }
 
+#if !defined(PLATFORM_WINDOWS)
+static void* file_load_thread(void* data){
+     CeAppFileLoad_t* file_load = (CeAppFileLoad_t*)(data);
+     bool finished = false;
+     while(!finished && !file_load->should_die){
+          pthread_mutex_lock(&file_load->lock);
+          ce_buffer_file_load_step(&file_load->load, APP_FILE_LOAD_CHUNK_SIZE);
+          finished = file_load->load.failed || file_load->load.bytes_split == file_load->load.mapping_size;
+          pthread_mutex_unlock(&file_load->lock);
+
+#if defined(DISPLAY_TERMINAL)
+          // wake up the main loop so it pulls in the new lines
+          int rc = 0;
+          do{
+               rc = write(g_shell_command_ready_fds[1], "1", 2);
+          }while(rc == -1 && errno == EINTR);
+
+          if(rc < 0){
+               ce_log("%s() write() to terminal ready fd failed: %s", __FUNCTION__, strerror(errno));
+          }
+#endif
+     }
+
+     return NULL;
+}
+#endif
+
+// small files are loaded right away, large ones are filled in by a background thread while the buffer is displayed
+bool ce_app_load_file(CeApp_t* app, CeBuffer_t* buffer, const char* filename){
+#if defined(PLATFORM_WINDOWS)
+     return ce_buffer_load_file(buffer, filename);
+#else
+     // we only keep track of one background load at a time, so any others while it runs are done up front
+     struct stat statbuf;
+     if(app->file_load || stat(filename, &statbuf) != 0 || statbuf.st_size < APP_FILE_LOAD_ASYNC_MIN_SIZE){
+          return ce_buffer_load_file(buffer, filename);
+     }
+
+     CeAppFileLoad_t* file_load = calloc(1, sizeof(*file_load));
+     if(!file_load) return false;
+
+     if(!ce_buffer_file_load_begin(buffer, &file_load->load, filename)){
+          free(file_load);
+          return false;
+     }
+
+     file_load->buffer = buffer;
+     pthread_mutex_init(&file_load->lock, NULL);
+     int rc = pthread_create(&file_load->thread, NULL, file_load_thread, file_load);
+     if(rc != 0){
+          ce_log("pthread_create() failed: '%s'\n", strerror(rc));
+          pthread_mutex_destroy(&file_load->lock);
+          ce_buffer_file_load_cancel(buffer, &file_load->load);
+          ce_buffer_free(buffer);
+          free(file_load);
+          return false;
+     }
+
+     CeAppBufferData_t* buffer_data = buffer->app_data;
+     buffer_data->loading = true;
+     buffer_data->load_incomplete = false;
+     buffer_data->load_percent = 0;
+     app->file_load = file_load;
+     return true;
+#endif
+}
+
+static void file_load_finish(CeApp_t* app){
+     CeAppFileLoad_t* file_load = app->file_load;
+     CeAppBufferData_t* buffer_data = file_load->buffer->app_data;
+     buffer_data->loading = false;
+     buffer_data->load_incomplete = file_load->load.failed;
+#if !defined(PLATFORM_WINDOWS)
+     pthread_mutex_destroy(&file_load->lock);
+#endif
+     free(file_load);
+     app->file_load = NULL;
+}
+
+// pull in whatever lines the background load has found since the last call, returns true if the buffer changed
+bool ce_app_update_file_load(CeApp_t* app){
+#if defined(PLATFORM_WINDOWS)
+     return false;
+#else
+     CeAppFileLoad_t* file_load = app->file_load;
+     if(!file_load) return false;
+
+     pthread_mutex_lock(&file_load->lock);
+     int64_t old_line_count = file_load->buffer->line_count;
+     bool finished = ce_buffer_file_load_take(file_load->buffer, &file_load->load);
+     CeAppBufferData_t* buffer_data = file_load->buffer->app_data;
+     int64_t load_percent = ce_buffer_file_load_percent(&file_load->load);
+     pthread_mutex_unlock(&file_load->lock);
+
+     if(!finished){
+          bool changed = (old_line_count != file_load->buffer->line_count || load_percent != buffer_data->load_percent);
+          buffer_data->load_percent = load_percent;
+          return changed;
+     }
+
+     pthread_join(file_load->thread, NULL);
+     CeBuffer_t* buffer = file_load->buffer;
+     if(file_load->load.failed){
+          ce_app_message(app, "failed to load all of '%s', it has a null or invalid utf-8, the buffer is readonly",
+                         buffer->name);
+     }
+     file_load_finish(app);
+     if(!buffer_data->load_incomplete) ce_clangd_file_open(&app->clangd, buffer);
+     return true;
+#endif
+}
+
+// stop the background load, keeping the lines loaded so far in a readonly buffer
+bool ce_app_cancel_file_load(CeApp_t* app){
+     CeAppFileLoad_t* file_load = app->file_load;
+     if(!file_load) return false;
+
+#if !defined(PLATFORM_WINDOWS)
+     file_load->should_die = true;
+     pthread_join(file_load->thread, NULL);
+#endif
+
+     // if the thread already got to the end, this just finishes up like normal
+     ce_buffer_file_load_cancel(file_load->buffer, &file_load->load);
+     CeAppBufferData_t* buffer_data = file_load->buffer->app_data;
+     ce_app_message(app, "stopped loading '%s' at %ld%%, the buffer is readonly", file_load->buffer->name,
+                    buffer_data->load_percent);
+     file_load_finish(app);
+     return true;
+}
+
+// index the matches of whatever is being searched for in the current view, a chunk of lines at a time
+bool ce_app_update_search_matches(CeApp_t* app){
+     CeLayout_t* tab_layout = app->tab_list_layout->tab_list.current;
+     if(tab_layout->tab.current->type != CE_LAYOUT_TYPE_VIEW) return false;
+     CeBuffer_t* buffer = tab_layout->tab.current->view.buffer;
+     CeAppBufferData_t* buffer_data = buffer->app_data;
+     if(!buffer_data) return false;
+     CeMatchIndex_t* search_matches = &buffer_data->vim.search_matches;
+
+     const char* pattern = NULL;
+     if(app->input_complete_func == search_input_complete_func){
+          if(app->input_view.buffer->line_count) pattern = ce_buffer_line(app->input_view.buffer, 0);
+     }else if(app->highlight_search){
+          pattern = app->vim.yanks[ce_vim_register_index('/')].text;
+     }
+
+     if(!pattern){
+          if(search_matches->pattern) ce_match_index_free(search_matches);
+          return false;
+     }
+
+     bool regex = (app->vim.search_mode == CE_VIM_SEARCH_MODE_REGEX_FORWARD ||
+                   app->vim.search_mode == CE_VIM_SEARCH_MODE_REGEX_BACKWARD);
+     if(!ce_match_index_set_pattern(search_matches, buffer, pattern, regex)) return false;
+     return !ce_match_index_scan(search_matches, buffer, APP_SEARCH_MATCH_SCAN_LINES);
+}
+
+// "match 37 of 1204" when the cursor is on a match, otherwise how many matches there are
+bool ce_app_search_match_status(CeView_t* view, char* string, int64_t string_len){
+     CeAppBufferData_t* buffer_data = view->buffer->app_data;
+     if(!buffer_data) return false;
+     CeMatchIndex_t* search_matches = &buffer_data->vim.search_matches;
+     if(!search_matches->pattern) return false;
+
+     ce_match_index_sync(search_matches, view->buffer);
+     int64_t count = ce_match_index_count(search_matches);
+     if(!ce_match_index_is_complete(search_matches, view->buffer)){
+          snprintf(string, string_len, "%" PRId64 "+ matches", count);
+          return true;
+     }
+
+     int64_t i = ce_match_index_lower_bound(search_matches, view->cursor);
+     if(i < count && ce_points_equal(ce_match_index_get(search_matches, i).point, view->cursor)){
+          snprintf(string, string_len, "match %" PRId64 " of %" PRId64, i + 1, count);
+     }else{
+          snprintf(string, string_len, "%" PRId64 " match%s", count, (count == 1) ? "" : "es");
+     }
+     return true;
+}
+
+static void loop_stats_sample(CeAppLoopStats_t* stats){
+     struct timespec now = {};
+#if defined(PLATFORM_WINDOWS)
+     timespec_get(&now, TIME_UTC);
+#else
+     clock_gettime(CLOCK_MONOTONIC, &now);
+#endif
+     if(stats->sample_start.tv_sec == 0 && stats->sample_start.tv_nsec == 0){
+          stats->sample_start = now;
+          return;
+     }
+
+     double elapsed = (double)(now.tv_sec - stats->sample_start.tv_sec) +
+                      (double)(now.tv_nsec - stats->sample_start.tv_nsec) / 1000000000.0;
+     if(elapsed < 1.0) return;
+
+     stats->wakeups_per_second = (double)(stats->sample_wakeups) / elapsed;
+     stats->frames_per_second = (double)(stats->sample_frames) / elapsed;
+     if(stats->sample_frames > 0) stats->draw_msec_average = (double)(stats->sample_draw_usec) / (double)(stats->sample_frames) / 1000.0;
+     stats->sample_start = now;
+     stats->sample_wakeups = 0;
+     stats->sample_frames = 0;
+     stats->sample_draw_usec = 0;
+}
+
+void ce_app_loop_stats_wakeup(CeAppLoopStats_t* stats){
+     loop_stats_sample(stats);
+     stats->wakeups++;
+     stats->sample_wakeups++;
+}
+
+void ce_app_loop_stats_frame(CeAppLoopStats_t* stats, uint64_t draw_usec){
+     stats->frames++;
+     stats->sample_frames++;
+     stats->sample_draw_usec += draw_usec;
+}
+
 typedef struct {
     bool success;
     char* bytes;
@@ -2543,7 +2770,7 @@ CeBuffer_t* load_destination_into_view(CeBufferNode_t** buffer_node_head, CeView
 
      if(destination->point.y < load_buffer->line_count){
           view->cursor.y = destination->point.y;
-          int64_t line_len = ce_utf8_strlen(load_buffer->lines[view->cursor.y]);
+          int64_t line_len = ce_utf8_strlen(ce_buffer_line(load_buffer, view->cursor.y));
           if(destination->point.x < line_len) view->cursor.x = destination->point.x;
      }
 
@@ -2551,9 +2778,9 @@ CeBuffer_t* load_destination_into_view(CeBufferNode_t** buffer_node_head, CeView
 }
 
 CePoint_t ce_paste_clipboard_into_buffer(CeBuffer_t* buffer, CePoint_t point){
-#if defined(DISPLAY_TERMINAL)
+#if !defined(DISPLAY_GUI)
      return (CePoint_t){-1, -1};
-#elif defined(DISPLAY_GUI)
+#else
      if(!SDL_HasClipboardText()){
           return (CePoint_t){-1, -1};
      }
@@ -2586,9 +2813,9 @@ CePoint_t ce_paste_clipboard_into_buffer(CeBuffer_t* buffer, CePoint_t point){
 }
 
 bool ce_set_clipboard_from_buffer(CeBuffer_t* buffer, CePoint_t start, CePoint_t end){
-#if defined(DISPLAY_TERMINAL)
+#if !defined(DISPLAY_GUI)
      return false;
-#elif defined(DISPLAY_GUI)
+#else
      int64_t text_len = ce_buffer_range_len(buffer, start, end);
      char* clipboard_text = ce_buffer_dupe_string(buffer, start, text_len);
      if(clipboard_text == NULL){
@@ -2613,3 +2840,891 @@ bool ce_get_cwd(char* buffer, size_t size){
 #endif
      return result == buffer;
 }
+
+void ce_app_init_default_config(CeApp_t* app){
+     // config options
+     CeConfigOptions_t* config_options = &app->config_options;
+     config_options->tab_width = 5;
+     config_options->horizontal_scroll_off = 10;
+     config_options->vertical_scroll_off = 0;
+     config_options->insert_spaces_on_tab = true;
+     config_options->line_number = CE_LINE_NUMBER_NONE;
+     config_options->completion_line_limit = 15;
+     config_options->message_display_time_usec = 5000000; // 5 seconds
+     config_options->apply_completion_key = CE_TAB;
+     config_options->popup_view_height = 12;
+     config_options->undo_memory_limit = CE_CHANGE_HISTORY_DEFAULT_MEMORY_LIMIT;
+     config_options->cycle_next_completion_key = ce_ctrl_key('n');
+     config_options->cycle_prev_completion_key = ce_ctrl_key('p');
+     config_options->show_line_extends_passed_view_as = '>';
+
+     config_options->color_defs[CE_COLOR_BLACK].red = 32;
+     config_options->color_defs[CE_COLOR_BLACK].green = 32;
+     config_options->color_defs[CE_COLOR_BLACK].blue = 32;
+
+     config_options->color_defs[CE_COLOR_RED].red = 137;
+     config_options->color_defs[CE_COLOR_RED].green = 56;
+     config_options->color_defs[CE_COLOR_RED].blue = 56;
+
+     config_options->color_defs[CE_COLOR_GREEN].red = 69;
+     config_options->color_defs[CE_COLOR_GREEN].green = 123;
+     config_options->color_defs[CE_COLOR_GREEN].blue = 77;
+
+     config_options->color_defs[CE_COLOR_YELLOW].red = 150;
+     config_options->color_defs[CE_COLOR_YELLOW].green = 111;
+     config_options->color_defs[CE_COLOR_YELLOW].blue = 78;
+
+     config_options->color_defs[CE_COLOR_BLUE].red = 70;
+     config_options->color_defs[CE_COLOR_BLUE].green = 107;
+     config_options->color_defs[CE_COLOR_BLUE].blue = 138;
+
+     config_options->color_defs[CE_COLOR_MAGENTA].red = 116;
+     config_options->color_defs[CE_COLOR_MAGENTA].green = 90;
+     config_options->color_defs[CE_COLOR_MAGENTA].blue = 160;
+
+     config_options->color_defs[CE_COLOR_CYAN].red = 55;
+     config_options->color_defs[CE_COLOR_CYAN].green = 125;
+     config_options->color_defs[CE_COLOR_CYAN].blue = 108;
+
+     config_options->color_defs[CE_COLOR_WHITE].red = 42;
+     config_options->color_defs[CE_COLOR_WHITE].green = 42;
+     config_options->color_defs[CE_COLOR_WHITE].blue = 42;
+
+     config_options->color_defs[CE_COLOR_BRIGHT_BLACK].red = 36;
+     config_options->color_defs[CE_COLOR_BRIGHT_BLACK].green = 36;
+     config_options->color_defs[CE_COLOR_BRIGHT_BLACK].blue = 36;
+
+     config_options->color_defs[CE_COLOR_BRIGHT_RED].red = 157;
+     config_options->color_defs[CE_COLOR_BRIGHT_RED].green = 110;
+     config_options->color_defs[CE_COLOR_BRIGHT_RED].blue = 127;
+
+     config_options->color_defs[CE_COLOR_BRIGHT_GREEN].red = 110;
+     config_options->color_defs[CE_COLOR_BRIGHT_GREEN].green = 137;
+     config_options->color_defs[CE_COLOR_BRIGHT_GREEN].blue = 106;
+
+     config_options->color_defs[CE_COLOR_BRIGHT_YELLOW].red = 156;
+     config_options->color_defs[CE_COLOR_BRIGHT_YELLOW].green = 148;
+     config_options->color_defs[CE_COLOR_BRIGHT_YELLOW].blue = 95;
+
+     config_options->color_defs[CE_COLOR_BRIGHT_BLUE].red = 114;
+     config_options->color_defs[CE_COLOR_BRIGHT_BLUE].green = 151;
+     config_options->color_defs[CE_COLOR_BRIGHT_BLUE].blue = 179;
+
+     config_options->color_defs[CE_COLOR_BRIGHT_MAGENTA].red = 147;
+     config_options->color_defs[CE_COLOR_BRIGHT_MAGENTA].green = 108;
+     config_options->color_defs[CE_COLOR_BRIGHT_MAGENTA].blue = 151;
+
+     config_options->color_defs[CE_COLOR_BRIGHT_CYAN].red = 124;
+     config_options->color_defs[CE_COLOR_BRIGHT_CYAN].green = 166;
+     config_options->color_defs[CE_COLOR_BRIGHT_CYAN].blue = 145;
+
+     config_options->color_defs[CE_COLOR_BRIGHT_WHITE].red = 255;
+     config_options->color_defs[CE_COLOR_BRIGHT_WHITE].green = 255;
+     config_options->color_defs[CE_COLOR_BRIGHT_WHITE].blue = 255;
+
+     config_options->color_defs[CE_COLOR_FOREGROUND].red = 218;
+     config_options->color_defs[CE_COLOR_FOREGROUND].green = 218;
+     config_options->color_defs[CE_COLOR_FOREGROUND].blue = 218;
+
+     config_options->color_defs[CE_COLOR_BACKGROUND].red = 25;
+     config_options->color_defs[CE_COLOR_BACKGROUND].green = 25;
+     config_options->color_defs[CE_COLOR_BACKGROUND].blue = 25;
+
+     // GUI options
+     config_options->gui_window_width = 1024;
+     config_options->gui_window_height = 768;
+     config_options->gui_font_size = 16;
+     config_options->gui_font_line_separation = 1;
+     strncpy(config_options->gui_font_path, "Inconsolata-SemiBold.ttf", MAX_PATH_LEN);
+     config_options->mouse_wheel_line_scroll = 5;
+
+     // keybinds
+     CeKeyBindDef_t normal_mode_bind_defs[] = {
+          {{'\\', 'q'},             "quit"},
+          {{ce_ctrl_key('w'), 'h'}, "select_adjacent_layout left"},
+          {{ce_ctrl_key('w'), 'l'}, "select_adjacent_layout right"},
+          {{ce_ctrl_key('w'), 'k'}, "select_adjacent_layout up"},
+          {{ce_ctrl_key('w'), 'j'}, "select_adjacent_layout down"},
+          {{ce_ctrl_key('s')},      "save_buffer"},
+          {{'\\', 'b'},             "show_buffers"},
+          {{ce_ctrl_key('f')},      "load_file"},
+          {{'/'},                   "search forward"},
+          {{'?'},                   "search backward"},
+          {{':'},                   "command"},
+          {{'g', 't'},              "select_adjacent_tab right"},
+          {{'g', 'T'},              "select_adjacent_tab left"},
+          {{'\\', '/'},             "regex_search forward"},
+          {{'\\', '?'},             "regex_search backward"},
+          {{'g', 'r'},              "redraw"},
+          {{'\\', 'f'},             "reload_file"},
+          {{ce_ctrl_key('b')},      "switch_buffer"},
+          {{ce_ctrl_key('o')},      "jump_list previous"},
+          {{ce_ctrl_key('i')},      "jump_list next"},
+          {{'K'},                   "man_page_on_word_under_cursor"},
+          {{'Z', 'Z'},              "wq"},
+     };
+
+     ce_convert_bind_defs(&app->key_binds, normal_mode_bind_defs, sizeof(normal_mode_bind_defs) / sizeof(normal_mode_bind_defs[0]));
+
+     // syntax
+     {
+          CeSyntaxDef_t* syntax_defs = malloc(CE_SYNTAX_COLOR_COUNT * sizeof(*syntax_defs));
+          syntax_defs[CE_SYNTAX_COLOR_NORMAL].fg = CE_COLOR_DEFAULT;
+          syntax_defs[CE_SYNTAX_COLOR_NORMAL].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_TYPE].fg = CE_COLOR_BRIGHT_BLUE;
+          syntax_defs[CE_SYNTAX_COLOR_TYPE].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_KEYWORD].fg = CE_COLOR_BLUE;
+          syntax_defs[CE_SYNTAX_COLOR_KEYWORD].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_CONTROL].fg = CE_COLOR_YELLOW;
+          syntax_defs[CE_SYNTAX_COLOR_CONTROL].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_CAPS_VAR].fg = CE_COLOR_MAGENTA;
+          syntax_defs[CE_SYNTAX_COLOR_CAPS_VAR].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_COMMENT].fg = CE_COLOR_GREEN;
+          syntax_defs[CE_SYNTAX_COLOR_COMMENT].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_STRING].fg = CE_COLOR_RED;
+          syntax_defs[CE_SYNTAX_COLOR_STRING].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_CHAR_LITERAL].fg = CE_COLOR_RED;
+          syntax_defs[CE_SYNTAX_COLOR_CHAR_LITERAL].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_NUMBER_LITERAL].fg = CE_COLOR_MAGENTA;
+          syntax_defs[CE_SYNTAX_COLOR_NUMBER_LITERAL].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_PREPROCESSOR].fg = CE_COLOR_BRIGHT_MAGENTA;
+          syntax_defs[CE_SYNTAX_COLOR_PREPROCESSOR].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_TRAILING_WHITESPACE].fg = CE_COLOR_RED;
+          syntax_defs[CE_SYNTAX_COLOR_TRAILING_WHITESPACE].bg = CE_COLOR_RED;
+          syntax_defs[CE_SYNTAX_COLOR_VISUAL].fg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_VISUAL].bg = CE_COLOR_WHITE;
+          syntax_defs[CE_SYNTAX_COLOR_CURRENT_LINE].fg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_CURRENT_LINE].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_DIFF_ADD].fg = CE_COLOR_GREEN;
+          syntax_defs[CE_SYNTAX_COLOR_DIFF_ADD].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_DIFF_REMOVE].fg = CE_COLOR_RED;
+          syntax_defs[CE_SYNTAX_COLOR_DIFF_REMOVE].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_DIFF_HEADER].fg = CE_COLOR_MAGENTA;
+          syntax_defs[CE_SYNTAX_COLOR_DIFF_HEADER].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_DIFF_COMMENT].fg = CE_COLOR_BLUE;
+          syntax_defs[CE_SYNTAX_COLOR_DIFF_COMMENT].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_COMPLETE_SELECTED].fg = CE_COLOR_BLACK;
+          syntax_defs[CE_SYNTAX_COLOR_COMPLETE_SELECTED].bg = CE_COLOR_YELLOW;
+          syntax_defs[CE_SYNTAX_COLOR_COMPLETE_MATCH].fg = CE_COLOR_BRIGHT_BLUE;
+          syntax_defs[CE_SYNTAX_COLOR_COMPLETE_MATCH].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+          syntax_defs[CE_SYNTAX_COLOR_LINE_NUMBER].fg = CE_COLOR_DEFAULT;
+          syntax_defs[CE_SYNTAX_COLOR_LINE_NUMBER].bg = CE_COLOR_DEFAULT;
+          syntax_defs[CE_SYNTAX_COLOR_MULTIPLE_CURSOR_INACTIVE].fg = CE_COLOR_DEFAULT;
+          syntax_defs[CE_SYNTAX_COLOR_MULTIPLE_CURSOR_INACTIVE].bg = CE_COLOR_RED;
+          syntax_defs[CE_SYNTAX_COLOR_MULTIPLE_CURSOR_ACTIVE].fg = CE_COLOR_DEFAULT;
+          syntax_defs[CE_SYNTAX_COLOR_MULTIPLE_CURSOR_ACTIVE].bg = CE_COLOR_GREEN;
+          syntax_defs[CE_SYNTAX_COLOR_LINE_EXTENDS_PASSED_VIEW].fg = CE_COLOR_YELLOW;
+          syntax_defs[CE_SYNTAX_COLOR_LINE_EXTENDS_PASSED_VIEW].bg = CE_SYNTAX_USE_CURRENT_COLOR;
+
+          app->config_options.ui_fg_color = CE_COLOR_BRIGHT_WHITE;
+          app->config_options.ui_bg_color = CE_COLOR_WHITE;
+          app->config_options.message_fg_color = CE_COLOR_BLUE;
+          app->config_options.message_bg_color = CE_COLOR_WHITE;
+
+          app->syntax_defs = syntax_defs;
+     }
+}
+
+void ce_app_init_buffers(CeApp_t* app, bool ls_clangd){
+     app->buffer_list_buffer = new_buffer();
+     app->bind_list_buffer = new_buffer();
+     app->yank_list_buffer = new_buffer();
+     app->complete_list_buffer = new_buffer();
+     app->macro_list_buffer = new_buffer();
+     app->mark_list_buffer = new_buffer();
+     app->jump_list_buffer = new_buffer();
+     app->profile_buffer = new_buffer();
+     app->shell_command_buffer = new_buffer();
+     CeBuffer_t* scratch_buffer = new_buffer();
+
+     ce_buffer_alloc(app->buffer_list_buffer, 1, "[buffers]");
+     ce_buffer_node_insert(&app->buffer_node_head, app->buffer_list_buffer);
+     ce_buffer_alloc(app->bind_list_buffer, 1, "[binds]");
+     ce_buffer_node_insert(&app->buffer_node_head, app->bind_list_buffer);
+     ce_buffer_alloc(app->yank_list_buffer, 1, "[yanks]");
+     ce_buffer_node_insert(&app->buffer_node_head, app->yank_list_buffer);
+     ce_buffer_alloc(app->complete_list_buffer, 1, "[completions]");
+     ce_buffer_node_insert(&app->buffer_node_head, app->complete_list_buffer);
+     ce_buffer_alloc(app->macro_list_buffer, 1, "[macros]");
+     ce_buffer_node_insert(&app->buffer_node_head, app->macro_list_buffer);
+     ce_buffer_alloc(app->mark_list_buffer, 1, "[marks]");
+     ce_buffer_node_insert(&app->buffer_node_head, app->mark_list_buffer);
+     ce_buffer_alloc(app->jump_list_buffer, 1, "[jumps]");
+     ce_buffer_node_insert(&app->buffer_node_head, app->jump_list_buffer);
+     ce_buffer_alloc(app->profile_buffer, 1, "[profile]");
+     ce_buffer_node_insert(&app->buffer_node_head, app->profile_buffer);
+     ce_buffer_alloc(app->shell_command_buffer, 1, "[shell command]");
+     ce_buffer_node_insert(&app->buffer_node_head, app->shell_command_buffer);
+     ce_buffer_alloc(scratch_buffer, 1, "scratch");
+     ce_buffer_node_insert(&app->buffer_node_head, scratch_buffer);
+
+     app->buffer_list_buffer->status = CE_BUFFER_STATUS_NONE;
+     app->bind_list_buffer->status = CE_BUFFER_STATUS_NONE;
+     app->yank_list_buffer->status = CE_BUFFER_STATUS_NONE;
+     app->complete_list_buffer->status = CE_BUFFER_STATUS_NONE;
+     app->macro_list_buffer->status = CE_BUFFER_STATUS_NONE;
+     app->mark_list_buffer->status = CE_BUFFER_STATUS_NONE;
+     app->jump_list_buffer->status = CE_BUFFER_STATUS_NONE;
+     app->profile_buffer->status = CE_BUFFER_STATUS_NONE;
+     app->shell_command_buffer->status = CE_BUFFER_STATUS_NONE;
+     scratch_buffer->status = CE_BUFFER_STATUS_NONE;
+
+     app->buffer_list_buffer->no_line_numbers = true;
+     app->bind_list_buffer->no_line_numbers = true;
+     app->yank_list_buffer->no_line_numbers = true;
+     app->complete_list_buffer->no_line_numbers = true;
+     app->macro_list_buffer->no_line_numbers = true;
+     app->mark_list_buffer->no_line_numbers = true;
+     app->jump_list_buffer->no_line_numbers = true;
+     app->profile_buffer->no_line_numbers = true;
+     app->shell_command_buffer->no_line_numbers = true;
+
+     app->complete_list_buffer->no_highlight_current_line = true;
+
+     CeAppBufferData_t* buffer_data = app->complete_list_buffer->app_data;
+     buffer_data->syntax_function = ce_syntax_highlight_completions;
+
+     buffer_data = app->buffer_list_buffer->app_data;
+     buffer_data->syntax_function = ce_syntax_highlight_c;
+     buffer_data = app->bind_list_buffer->app_data;
+     buffer_data->syntax_function = ce_syntax_highlight_c;
+     buffer_data = app->yank_list_buffer->app_data;
+     buffer_data->syntax_function = ce_syntax_highlight_c;
+     buffer_data = app->macro_list_buffer->app_data;
+     buffer_data->syntax_function = ce_syntax_highlight_c;
+     buffer_data = app->mark_list_buffer->app_data;
+     buffer_data->syntax_function = ce_syntax_highlight_c;
+     buffer_data = app->jump_list_buffer->app_data;
+     buffer_data->syntax_function = ce_syntax_highlight_c;
+     buffer_data = app->profile_buffer->app_data;
+     buffer_data->syntax_function = ce_syntax_highlight_c;
+     buffer_data = app->shell_command_buffer->app_data;
+     buffer_data->syntax_function = ce_syntax_highlight_plain;
+     buffer_data = scratch_buffer->app_data;
+     buffer_data->syntax_function = ce_syntax_highlight_c;
+
+     if(ls_clangd){
+          app->clangd.buffer = new_buffer();
+          app->clangd_diagnostics_buffer = new_buffer();
+          app->clangd_references_buffer = new_buffer();
+          app->clangd_completion.buffer = new_buffer();
+
+          ce_buffer_alloc(app->clangd.buffer, 1, "[clangd]");
+          ce_buffer_node_insert(&app->buffer_node_head, app->clangd.buffer);
+          ce_buffer_alloc(app->clangd_completion.buffer, 1, "[clangd completions]");
+          ce_buffer_node_insert(&app->buffer_node_head, app->clangd_completion.buffer);
+          ce_buffer_alloc(app->clangd_diagnostics_buffer, 1, "[clangd diagnostics]");
+          ce_buffer_node_insert(&app->buffer_node_head, app->clangd_diagnostics_buffer);
+          ce_buffer_alloc(app->clangd_references_buffer, 1, "[clangd references]");
+          ce_buffer_node_insert(&app->buffer_node_head, app->clangd_references_buffer);
+
+          app->clangd.buffer->status = CE_BUFFER_STATUS_NONE;
+          app->clangd_completion.buffer->status = CE_BUFFER_STATUS_NONE;
+          app->clangd_diagnostics_buffer->status = CE_BUFFER_STATUS_NONE;
+          app->clangd_references_buffer->status = CE_BUFFER_STATUS_NONE;
+          app->clangd.buffer->no_line_numbers = true;
+          app->clangd_completion.buffer->no_line_numbers = true;
+          app->clangd_diagnostics_buffer->no_line_numbers = true;
+          app->clangd_references_buffer->no_line_numbers = true;
+
+          buffer_data = app->clangd.buffer->app_data;
+          buffer_data->syntax_function = ce_syntax_highlight_plain;
+          buffer_data = app->clangd_completion.buffer->app_data;
+          buffer_data->syntax_function = ce_syntax_highlight_completions;
+          buffer_data = app->clangd_diagnostics_buffer->app_data;
+          buffer_data->syntax_function = ce_syntax_highlight_c;
+          buffer_data = app->clangd_references_buffer->app_data;
+          buffer_data->syntax_function = ce_syntax_highlight_plain;
+
+          app->clangd_completion.view.buffer = app->clangd_completion.buffer;
+     }
+
+     app->discovered_filepath_count = 0;
+     app->shell_command_buffer_should_scroll = false;
+     app->shell_command_thread_should_die = false;
+#if defined(PLATFORM_WINDOWS)
+     app->shell_command_thread = INVALID_HANDLE_VALUE;
+     app->shell_command_thread_id = -1;
+#endif
+}
+
+static int int_strneq(int* a, int* b, size_t len){
+     for(size_t i = 0; i < len; ++i){
+          if(!*a) return false;
+          if(!*b) return false;
+          if(*a != *b) return false;
+          a++;
+          b++;
+     }
+
+     return true;
+}
+
+void scroll_to_and_center_if_offscreen(CeView_t* view, CePoint_t point, CeConfigOptions_t* config_options){
+     view->cursor = point;
+     CePoint_t before_follow = view->scroll;
+     ce_view_follow_cursor(view, config_options->horizontal_scroll_off,
+                           config_options->vertical_scroll_off, config_options->tab_width);
+     if(!ce_points_equal(before_follow, view->scroll)){
+          ce_view_center(view);
+     }
+}
+
+bool handle_input_history_key(int key, CeHistory_t* history, CeBuffer_t* input_buffer, CePoint_t* cursor){
+     if(key == KEY_UP_ARROW){
+          char* prev = ce_history_previous(history);
+          if(prev){
+               ce_buffer_remove_string(input_buffer, (CePoint_t){0, 0}, ce_utf8_strlen(ce_buffer_line(input_buffer, 0)));
+               ce_buffer_insert_string(input_buffer, prev, (CePoint_t){0, 0});
+          }
+          cursor->x = ce_utf8_strlen(ce_buffer_line(input_buffer, 0));
+          return true;
+     }
+
+     if(key == KEY_DOWN_ARROW){
+          char* next = ce_history_next(history);
+          ce_buffer_remove_string(input_buffer, (CePoint_t){0, 0}, ce_utf8_strlen(ce_buffer_line(input_buffer, 0)));
+          if(next){
+               ce_buffer_insert_string(input_buffer, next, (CePoint_t){0, 0});
+          }
+          cursor->x = ce_utf8_strlen(ce_buffer_line(input_buffer, 0));
+          return true;
+     }
+
+     return false;
+}
+
+void app_handle_key(CeApp_t* app, CeView_t* view, int key){
+     if(key == KEY_INVALID) return;
+
+     if(key == KEY_RESIZE_EVENT){
+#if defined(DISPLAY_TERMINAL)
+          int terminal_width = 0;
+          int terminal_height = 0;
+          getmaxyx(stdscr, terminal_height, terminal_width);
+          ce_app_update_terminal_view(app, terminal_width, terminal_height);
+#endif
+          return;
+     }
+
+     if(app->last_vim_handle_result == CE_VIM_PARSE_IN_PROGRESS){
+          const CeRune_t* end = NULL;
+          int64_t parsed_multiplier = istrtol(app->vim.current_command, &end);
+          if(end) app->macro_multiplier = parsed_multiplier;
+     }
+
+     if(key == '.' && app->last_macro_register){
+          app->macro_multiplier = app->last_macro_multiplier;
+          app->replay_macro = true;
+          key = app->last_macro_register;
+     }
+
+     if(app->key_count == 0 &&
+        (app->last_vim_handle_result != CE_VIM_PARSE_IN_PROGRESS || app->macro_multiplier > 1) &&
+        app->last_vim_handle_result != CE_VIM_PARSE_CONSUME_ADDITIONAL_KEY &&
+        app->last_vim_handle_result != CE_VIM_PARSE_CONTINUE &&
+        app->vim.mode != CE_VIM_MODE_INSERT &&
+        app->vim.mode != CE_VIM_MODE_REPLACE){
+          if(key == 'q' && !app->replay_macro){ // TODO: make configurable
+               if(app->record_macro && ce_macros_is_recording(&app->macros)){
+                    ce_macros_end_recording(&app->macros);
+                    app->record_macro = false;
+                    return;
+               }else if(!app->record_macro){
+                    app->record_macro = true;
+                    return;
+               }
+          }
+
+          if(key == '@' && !app->record_macro && !app->replay_macro){
+               app->replay_macro = true;
+               app->vim.current_command[0] = 0;
+               return;
+          }
+
+          if(app->record_macro && !ce_macros_is_recording(&app->macros)){
+               ce_macros_begin_recording(&app->macros, key);
+               app->macro_multiplier = 1;
+               return;
+          }
+
+          if(app->replay_macro){
+               app->replay_macro = false;
+               CeRune_t* rune_string = ce_macros_get_register_string(&app->macros, key);
+               if(rune_string){
+                    for(int64_t i = 0; i < app->macro_multiplier; i++){
+                         CeRune_t* itr = rune_string;
+                         while(*itr){
+                              app_handle_key(app, view, *itr);
+
+                              // update the view if it has changed
+                              CeLayout_t* tab_layout = app->tab_list_layout->tab_list.current;
+                              if(tab_layout->tab.current->type == CE_LAYOUT_TYPE_VIEW){
+                                   view = &tab_layout->tab.current->view;
+                              }
+                              itr++;
+                         }
+                    }
+                    app->last_macro_register = key;
+                    app->last_macro_multiplier = app->macro_multiplier;
+                    app->macro_multiplier = 1;
+               }
+
+               free(rune_string);
+               return;
+          }
+     }
+
+     if(ce_macros_is_recording(&app->macros)){
+          ce_macros_record_key(&app->macros, key);
+     }
+
+     // as long as vim isn't in the middle of handling keys, in insert mode vim returns VKH_HANDLED_KEY
+     if(app->last_vim_handle_result != CE_VIM_PARSE_IN_PROGRESS &&
+        app->last_vim_handle_result != CE_VIM_PARSE_CONSUME_ADDITIONAL_KEY &&
+        app->last_vim_handle_result != CE_VIM_PARSE_CONTINUE &&
+        app->vim.mode != CE_VIM_MODE_INSERT &&
+        app->vim.mode != CE_VIM_MODE_REPLACE){
+          // append to keys
+          if(app->key_count < APP_MAX_KEY_COUNT){
+               app->keys[app->key_count] = key;
+               app->key_count++;
+
+               bool no_matches = true;
+               for(int64_t i = 0; i < app->key_binds.count; ++i){
+                    if(int_strneq(app->key_binds.binds[i].keys, app->keys, app->key_count)){
+                         no_matches = false;
+                         // if we have matches, but don't completely match, then wait for more keypresses,
+                         // otherwise, execute the action
+                         if(app->key_binds.binds[i].key_count == app->key_count){
+                              CeCommand_t* command = &app->key_binds.binds[i].command;
+                              CeCommandFunc_t* command_func = NULL;
+                              CeCommandEntry_t* entry = NULL;
+                              for(int64_t c = 0; c < app->command_entry_count; ++c){
+                                   entry = app->command_entries + c;
+                                   if(strcmp(entry->name, command->name) == 0){
+                                        command_func = entry->func;
+                                        break;
+                                   }
+                              }
+
+                              if(command_func){
+                                   CeCommandStatus_t cs = command_func(command, app);
+
+                                   app->key_count = 0;
+                                   app->vim.current_command[0] = 0;
+
+                                   switch(cs){
+                                   default:
+                                        return;
+                                   case CE_COMMAND_NO_ACTION:
+                                        break;
+                                   case CE_COMMAND_FAILURE:
+                                        ce_log("'%s' failed\n", entry->name);
+                                        return;
+                                   case CE_COMMAND_PRINT_HELP:
+                                        ce_app_message(app, "%s: %s\n", entry->name, entry->description);
+                                        return;
+                                   }
+                              }else{
+                                   ce_app_message(app, "unknown command: '%s'", command->name);
+                              }
+
+                              app->key_count = 0;
+                              break;
+                         }else{
+                              return;
+                         }
+                    }
+               }
+
+               if(no_matches){
+                    app->vim.current_command[0] = 0;
+                    for(int64_t i = 0; i < app->key_count - 1; ++i){
+                         ce_vim_append_key(&app->vim, app->keys[i]);
+                    }
+
+                    app->key_count = 0;
+               }
+          }
+     }
+
+     CeComplete_t* app_complete = ce_app_is_completing(app);
+     bool clangd_is_completing = (app->clangd_completion.start.x >= 0 &&
+                                  app->clangd_completion.start.y >= 0);
+
+     if(view){
+          if(key == KEY_CARRIAGE_RETURN) key = CE_NEWLINE;
+          if(key == CE_NEWLINE && !app->input_complete_func && view->buffer == app->buffer_list_buffer){
+               CeBufferNode_t* itr = app->buffer_node_head;
+               int64_t index = 0;
+               while(itr){
+                    if(index == view->cursor.y){
+                         ce_view_switch_buffer(view, itr->buffer, &app->vim, &app->config_options, true);
+                         break;
+                    }
+                    itr = itr->next;
+                    index++;
+               }
+          }else if(key == CE_NEWLINE && !app->input_complete_func && view->buffer == app->yank_list_buffer){
+               // TODO: move to command
+               app->edit_register = -1;
+               int64_t line = view->cursor.y;
+               CeVimYank_t* selected_yank = NULL;
+               for(int64_t i = 0; i < CE_ASCII_PRINTABLE_CHARACTERS; i++){
+                    CeVimYank_t* yank = app->vim.yanks + i;
+                    if(yank->text != NULL){
+                         int64_t line_count = 2;
+                         line_count += ce_util_count_string_lines(yank->text);
+                         line -= line_count;
+                         if(line <= 0){
+                              app->edit_register = i;
+                              selected_yank = yank;
+                              break;
+                         }
+                    }
+               }
+
+               if(app->edit_register >= 0){
+                    ce_app_input(app, "Edit Yank", edit_yank_input_complete_func);
+                    ce_buffer_insert_string(app->input_view.buffer, selected_yank->text, (CePoint_t){0, 0});
+                    app->input_view.cursor.y = app->input_view.buffer->line_count;
+                    if(app->input_view.cursor.y) app->input_view.cursor.y--;
+                    app->input_view.cursor.x = ce_buffer_line_len(app->input_view.buffer, app->input_view.cursor.y);
+               }
+          }else if(key == CE_NEWLINE && !app->input_complete_func && view->buffer == app->macro_list_buffer){
+               // TODO: move to command
+               app->edit_register = -1;
+               int64_t line = view->cursor.y;
+               char* macro_string = NULL;
+               for(int64_t i = 0; i < CE_ASCII_PRINTABLE_CHARACTERS; i++){
+                    CeRuneNode_t* rune_node = app->macros.rune_head[i];
+                    if(rune_node){
+                         line -= 2;
+                         if(line <= 2){
+                              app->edit_register = i;
+                              CeRune_t* rune_string = ce_rune_node_string(rune_node);
+                              macro_string = ce_rune_string_to_char_string(rune_string);
+                              free(rune_string);
+                              break;
+                         }
+                    }
+               }
+
+               if(app->edit_register >= 0){
+                    ce_app_input(app, "Edit Macro", edit_macro_input_complete_func);
+                    ce_buffer_insert_string(app->input_view.buffer, macro_string, (CePoint_t){0, 0});
+                    app->input_view.cursor.y = app->input_view.buffer->line_count;
+                    if(app->input_view.cursor.y) app->input_view.cursor.y--;
+                    app->input_view.cursor.x = ce_buffer_line_len(app->input_view.buffer, app->input_view.cursor.y);
+                    free(macro_string);
+               }
+          }else if(key == CE_NEWLINE && app->input_complete_func){
+               if(app->vim.mode == CE_VIM_MODE_INSERT && app_complete){
+                    apply_completion_to_buffer(app_complete, app->input_view.buffer, 0, &app->input_view.cursor);
+               }
+               app->vim.mode = CE_VIM_MODE_NORMAL;
+               CeInputCompleteFunc* input_complete_func = app->input_complete_func;
+               app->input_complete_func = NULL;
+               if(app->input_view.buffer->line_count && strlen(ce_buffer_line(app->input_view.buffer, 0))){
+                    input_complete_func(app, app->input_view.buffer);
+               }
+          }else if((app_complete || clangd_is_completing) &&
+                   key == app->config_options.apply_completion_key &&
+                   app->vim.mode == CE_VIM_MODE_INSERT){
+               if(app_complete &&
+                  apply_completion_to_buffer(app_complete, app->input_view.buffer, 0,
+                                             &app->input_view.cursor)){
+                    // TODO: compress with other similar code elsewhere
+                    if(app->input_complete_func == load_file_input_complete_func){
+                         char* base_directory = buffer_base_directory(view->buffer);
+                         complete_files(&app->input_complete, ce_buffer_line(app->input_view.buffer, 0), base_directory);
+                         free(base_directory);
+                         build_complete_list(app->complete_list_buffer, &app->input_complete);
+                    }else{
+                         ce_complete_match(&app->input_complete, ce_buffer_line(app->input_view.buffer, 0));
+                         build_complete_list(app->complete_list_buffer, &app->input_complete);
+                    }
+
+                    return;
+               }else if(clangd_is_completing){
+                  apply_completion_to_buffer(app->clangd_completion.complete, view->buffer,
+                                             app->clangd_completion.start.x,
+                                             &view->cursor);
+                   app->clangd_completion.start = (CePoint_t){-1, -1};
+               }
+          }else if(key == app->config_options.cycle_next_completion_key){
+               if(app->vim.mode == CE_VIM_MODE_INSERT){
+                    if(app_complete){
+                         ce_complete_next_match(app_complete);
+                         build_complete_list(app->complete_list_buffer, app_complete);
+                         return;
+                    }
+
+                    if(app->clangd_completion.start.x >= 0 &&
+                       app->clangd_completion.start.y >= 0){
+                         ce_complete_next_match(app->clangd_completion.complete);
+                         build_complete_list(app->clangd_completion.buffer,
+                                             app->clangd_completion.complete);
+                         return;
+                    }
+               }
+          }else if(key == app->config_options.cycle_prev_completion_key){
+               if(app->vim.mode == CE_VIM_MODE_INSERT){
+                    if(app_complete){
+                         ce_complete_previous_match(app_complete);
+                         build_complete_list(app->complete_list_buffer, app_complete);
+                         return;
+                    }
+                    if(app->clangd_completion.start.x >= 0 &&
+                       app->clangd_completion.start.y >= 0){
+                         ce_complete_previous_match(app->clangd_completion.complete);
+                         build_complete_list(app->clangd_completion.buffer,
+                                             app->clangd_completion.complete);
+                         return;
+                    }
+               }
+          }else if(key == KEY_ESCAPE && app->input_complete_func && app->vim.mode == CE_VIM_MODE_NORMAL){ // Escape
+               ce_history_reset_current(&app->command_history);
+               ce_history_reset_current(&app->search_history);
+               app->input_complete_func = NULL;
+
+               if(app_complete) ce_complete_reset(app_complete);
+               return;
+          }else if(key == 'd' && view->buffer == app->buffer_list_buffer){ // Escape
+               CeBufferNode_t* itr = app->buffer_node_head;
+               int64_t buffer_index = 0;
+               while(itr){
+                    if(buffer_index == view->cursor.y) break;
+                    buffer_index++;
+                    itr = itr->next;
+               }
+
+               if(buffer_index == view->cursor.y){
+                    if(itr->buffer == app->buffer_list_buffer ||
+                       itr->buffer == app->yank_list_buffer ||
+                       itr->buffer == app->complete_list_buffer ||
+                       itr->buffer == app->macro_list_buffer ||
+                       itr->buffer == app->mark_list_buffer ||
+                       itr->buffer == app->jump_list_buffer ||
+                       itr->buffer == app->profile_buffer ||
+                       itr->buffer == app->shell_command_buffer ||
+                       itr->buffer == g_ce_log_buffer ||
+                       itr->buffer == app->message_view.buffer ||
+                       itr->buffer == app->clangd_diagnostics_buffer ||
+                       itr->buffer == app->clangd_references_buffer ||
+                       itr->buffer == app->clangd_completion.buffer ||
+                       itr->buffer == app->clangd.buffer ||
+                       itr->buffer == app->input_view.buffer){
+                         ce_app_message(app, "cannot delete buffer '%s'", itr->buffer->name);
+                    }else{
+                         // find all the views showing this buffer and switch to a different view
+                         for(int64_t t = 0; t < app->tab_list_layout->tab_list.tab_count; t++){
+                              CeLayoutBufferInViewsResult_t result = ce_layout_buffer_in_views(app->tab_list_layout->tab_list.tabs[t], itr->buffer);
+                              for(int64_t i = 0; i < result.layout_count; i++){
+                                   result.layouts[i]->view.buffer = app->buffer_list_buffer;
+                              }
+                         }
+
+                         if(app->file_load && app->file_load->buffer == itr->buffer) ce_app_cancel_file_load(app);
+                         ce_clangd_file_close(&app->clangd, itr->buffer);
+                         ce_buffer_node_delete(&app->buffer_node_head, itr->buffer);
+                    }
+               }
+          }else if(app->input_complete_func){
+
+               // TODO: how are we going to let this be supported through customization
+               if(app->input_complete_func == command_input_complete_func && app->input_view.buffer->line_count){
+                    handle_input_history_key(key, &app->command_history, app->input_view.buffer, &app->input_view.cursor);
+               }else if(app->input_complete_func == search_input_complete_func && app->input_view.buffer->line_count){
+                    handle_input_history_key(key, &app->search_history, app->input_view.buffer, &app->input_view.cursor);
+               }
+
+               CeAppBufferData_t* buffer_data = app->input_view.buffer->app_data;
+               CE_PROFILE_BEGIN(vim_timer, CE_PROFILE_STAGE_VIM_HANDLE_KEY);
+               app->last_vim_handle_result = ce_vim_handle_key(&app->vim, &app->input_view, &app->input_view.cursor,
+                                                               &app->visual, key, &buffer_data->vim, &app->config_options);
+               CE_PROFILE_END(vim_timer);
+
+               if(app->vim.mode == CE_VIM_MODE_INSERT && app->input_view.buffer->line_count){
+                    if(app->input_complete_func == load_file_input_complete_func){
+                         char* base_directory = buffer_base_directory(view->buffer);
+                         complete_files(&app->input_complete, ce_buffer_line(app->input_view.buffer, 0), base_directory);
+                         free(base_directory);
+                         build_complete_list(app->complete_list_buffer, &app->input_complete);
+                    }else{
+                         ce_complete_match(&app->input_complete, ce_buffer_line(app->input_view.buffer, 0));
+                         build_complete_list(app->complete_list_buffer, &app->input_complete);
+                    }
+               }
+          // TODO: Make completion key configurable
+          }else if((app->vim.mode == CE_VIM_MODE_NORMAL || app->vim.mode == CE_VIM_MODE_INSERT) &&
+                   key == app->config_options.clangd_trigger_completion_key &&
+                   app->clangd.buffer != NULL){
+               ce_vim_insert_mode(&app->vim);
+               ce_clangd_request_auto_complete(&app->clangd, view->buffer, view->cursor);
+               app->clangd_completion.initiate = view->cursor;
+          }else{
+               // TODO: how are we going to let this be supported through customization
+               CeAppBufferData_t* buffer_data = view->buffer->app_data;
+
+               CE_PROFILE_BEGIN(vim_timer, CE_PROFILE_STAGE_VIM_HANDLE_KEY);
+               app->last_vim_handle_result = ce_vim_handle_key(&app->vim, view, &view->cursor, &app->visual,
+                                                               key, &buffer_data->vim, &app->config_options);
+               CE_PROFILE_END(vim_timer);
+
+               // A "jump" is one of the following commands: "'", "`", "G", "/", "?", "n",
+               // "N", "%", "(", ")", "[[", "]]", "{", "}", ":s", ":tag", "L", "M", "H" and
+               if(app->vim.current_action.verb.function == ce_vim_verb_motion){
+                    if(app->vim.current_action.motion.function == ce_vim_motion_mark ||
+                       app->vim.current_action.motion.function == ce_vim_motion_end_of_file ||
+                       app->vim.current_action.motion.function == ce_vim_motion_search_next ||
+                       app->vim.current_action.motion.function == ce_vim_motion_search_prev ||
+                       app->vim.current_action.motion.function == ce_vim_motion_match_pair){
+                         CeAppViewData_t* view_data = view->user_data;
+                         CeJumpList_t* jump_list = &view_data->jump_list;
+                         CeDestination_t destination = {};
+                         destination.point = view->cursor;
+                         strncpy(destination.filepath, view->buffer->name, MAX_PATH_LEN);
+                         ce_jump_list_insert(jump_list, destination);
+                    }
+
+                    if(app->vim.current_action.motion.function == ce_vim_motion_search_word_forward ||
+                       app->vim.current_action.motion.function == ce_vim_motion_search_word_backward ||
+                       app->vim.current_action.motion.function == ce_vim_motion_search_next ||
+                       app->vim.current_action.motion.function == ce_vim_motion_search_prev){
+                         app->highlight_search = true;
+                    }
+               }
+
+               if(app->last_vim_handle_result == CE_VIM_PARSE_COMPLETE &&
+                  app->vim.current_action.repeatable){
+                    app->last_macro_register = 0;
+               }
+
+               if(app->clangd_completion.start.x >= 0 &&
+                  app->clangd_completion.start.y >= 0){
+                    if(app->vim.mode == CE_VIM_MODE_INSERT){
+                         if((!ce_point_after(view->cursor, app->clangd_completion.start) &&
+                            !ce_points_equal(view->cursor, app->clangd_completion.start)) ||
+                            view->cursor.y != app->clangd_completion.start.y){
+                              app->clangd_completion.start = (CePoint_t){-1, -1};
+                         }else{
+                              int64_t match_len = view->cursor.x - app->clangd_completion.start.x;
+                              char* match = ce_buffer_dupe_string(view->buffer, app->clangd_completion.start, match_len);
+                              ce_complete_match(app->clangd_completion.complete, match);
+                              free(match);
+                              build_complete_list(app->clangd_completion.buffer,
+                                                  app->clangd_completion.complete);
+                              build_clangd_completion_view(&app->clangd_completion.view,
+                                                           app->clangd_completion.start,
+                                                           view,
+                                                           app->clangd_completion.buffer,
+                                                           &app->config_options,
+                                                           &app->terminal_rect);
+                         }
+
+                    }else{
+                         app->clangd_completion.start = (CePoint_t){-1, -1};
+                    }
+               }
+          }
+     }else{
+          if(key == KEY_ESCAPE){
+               CeLayout_t* tab_layout = app->tab_list_layout->tab_list.current;
+               CeLayout_t* current_layout = tab_layout->tab.current;
+               CeRect_t layout_rect = {};
+
+               switch(current_layout->type){
+               default:
+                    assert(!"unexpected current layout type");
+                    return;
+               case CE_LAYOUT_TYPE_LIST:
+                    layout_rect = current_layout->list.rect;
+                    break;
+               case CE_LAYOUT_TYPE_TAB:
+                    layout_rect = current_layout->tab.rect;
+                    break;
+               case CE_LAYOUT_TYPE_TAB_LIST:
+                    layout_rect = current_layout->tab_list.rect;
+                    break;
+               }
+
+               tab_layout->tab.current = ce_layout_find_at(tab_layout, (CePoint_t){layout_rect.left, layout_rect.top});
+               return;
+          }
+     }
+
+     // incremental search
+     if(view && app->input_complete_func == search_input_complete_func){
+          // once the whole buffer has been indexed for this pattern, jump using the index rather than searching again
+          ce_app_update_search_matches(app);
+          CeAppBufferData_t* view_buffer_data = view->buffer->app_data;
+          CeMatchIndex_t* search_matches = &view_buffer_data->vim.search_matches;
+          bool indexed = (app->input_view.buffer->line_count &&
+                          ce_match_index_covers(search_matches, view->buffer, ce_buffer_line(app->input_view.buffer, 0), false,
+                                                view->buffer->line_count - 1));
+
+          if(strcmp(app->input_view.buffer->name, "Search") == 0){
+               if(app->input_view.buffer->line_count && view->buffer->line_count && strlen(ce_buffer_line(app->input_view.buffer, 0))){
+                    CePoint_t match_point = indexed ? ce_match_index_next(search_matches, view->cursor) :
+                                            ce_buffer_search_forward(view->buffer, view->cursor, ce_buffer_line(app->input_view.buffer, 0));
+                    if(match_point.x >= 0){
+                         scroll_to_and_center_if_offscreen(view, match_point, &app->config_options);
+                    }else{
+                         view->cursor = app->search_start;
+                    }
+               }else{
+                    view->cursor = app->search_start;
+               }
+          }else if(strcmp(app->input_view.buffer->name, "Reverse Search") == 0){
+               if(app->input_view.buffer->line_count && view->buffer->line_count && strlen(ce_buffer_line(app->input_view.buffer, 0))){
+                    CePoint_t match_point = indexed ? ce_match_index_prev(search_matches, view->cursor) :
+                                            ce_buffer_search_backward(view->buffer, view->cursor, ce_buffer_line(app->input_view.buffer, 0));
+                    if(match_point.x >= 0){
+                         scroll_to_and_center_if_offscreen(view, match_point, &app->config_options);
+                    }else{
+                         view->cursor = app->search_start;
+                    }
+               }else{
+                    view->cursor = app->search_start;
+               }
+          }else if(strcmp(app->input_view.buffer->name, "Regex Search") == 0){
+               if(app->input_view.buffer->line_count && view->buffer->line_count && strlen(ce_buffer_line(app->input_view.buffer, 0))){
+                    CeRegex_t regex = NULL;
+                    CeRegexResult_t regex_result = ce_regex_cache_get(ce_buffer_line(app->input_view.buffer, 0), &regex);
+                    if(regex_result.error_message != NULL){
+                         ce_log("ce_regex_cache_get() failed: '%s'", regex_result.error_message);
+                         free(regex_result.error_message);
+                    }else{
+                         CeRegexSearchResult_t result = ce_buffer_regex_search_forward(view->buffer, view->cursor, regex);
+                         if(result.point.x >= 0){
+                              scroll_to_and_center_if_offscreen(view, result.point, &app->config_options);
+                         }else{
+                              view->cursor = app->search_start;
+                         }
+                    }
+               }else{
+                    view->cursor = app->search_start;
+               }
+          }else if(strcmp(app->input_view.buffer->name, "Regex Reverse Search") == 0){
+               if(app->input_view.buffer->line_count && view->buffer->line_count && strlen(ce_buffer_line(app->input_view.buffer, 0))){
+                    CeRegex_t regex = NULL;
+                    CeRegexResult_t regex_result = ce_regex_cache_get(ce_buffer_line(app->input_view.buffer, 0), &regex);
+                    if(regex_result.error_message != NULL){
+                         ce_log("ce_regex_cache_get() failed: '%s'", regex_result.error_message);
+                         free(regex_result.error_message);
+                    }else{
+                         CeRegexSearchResult_t result = ce_buffer_regex_search_backward(view->buffer, view->cursor, regex);
+                         if(result.point.x >= 0){
+                              scroll_to_and_center_if_offscreen(view, result.point, &app->config_options);
+                         }else{
+                              view->cursor = app->search_start;
+                         }
+                    }
+               }else{
+                    view->cursor = app->search_start;
+               }
+          }
+     }
+}
@@ -6,6 +6,7 @@
 #include "ce_complete.h"
 #include "ce_layout.h"
 #include "ce_macros.h"
+#include "ce_profile.h"
 #include "ce_syntax.h"
 #include "ce_vim.h"
 
@@ -21,6 +22,9 @@
 
 #define APP_MAX_KEY_COUNT 16
 #define JUMP_LIST_DESTINATION_COUNT 16
+#define APP_FILE_LOAD_ASYNC_MIN_SIZE (32 * 1024 * 1024)
+#define APP_FILE_LOAD_CHUNK_SIZE (4 * 1024 * 1024)
+#define APP_SEARCH_MATCH_SCAN_LINES 65536 // per trip through the main loop, so big buffers don't stall typing
 
 typedef struct CeBufferNode_t{
      CeBuffer_t* buffer;
@@ -68,13 +72,57 @@ typedef struct{
      CeSyntaxHighlightFunc_t* syntax_function;
      char* base_directory;
      CeClangDDiagnostics_t clangd_diagnostics;
+     bool loading; // still being filled in by a background file load
+     bool load_incomplete; // the load was cancelled or failed, so the buffer doesn't hold the whole file
+     int64_t load_percent;
 }CeAppBufferData_t;
 
+// large files are loaded on a background thread so they can be viewed while the rest of the file comes in
+typedef struct{
+     CeBuffer_t* buffer;
+     CeBufferFileLoad_t load;
+#if !defined(PLATFORM_WINDOWS)
+     pthread_t thread;
+     pthread_mutex_t lock;
+#endif
+     volatile bool should_die;
+}CeAppFileLoad_t;
+
+// what a view was last highlighted from, so drawing it again can skip the syntax pass when none of it changed
+typedef struct{
+     CeSyntaxHighlightFunc_t* syntax_function;
+     CeSyntaxDef_t* syntax_defs;
+     CeBuffer_t* buffer;
+     int64_t buffer_version;
+     int64_t syntax_generation;
+     CeRect_t rect;
+     CePoint_t scroll;
+     CePoint_t cursor;
+     CeRangeList_t ranges;
+     CeDrawColorList_t colors;
+}CeAppViewHighlight_t;
+
 typedef struct{
      CeJumpList_t jump_list;
      CeBuffer_t* prev_buffer;
+     CeAppViewHighlight_t last_highlight;
 }CeAppViewData_t;
 
+// how often the main loop woke up and drew, so we can tell an idle editor is actually asleep
+typedef struct{
+     int64_t wakeups;
+     int64_t frames;
+
+     // rates are measured over samples at least a second long, closed by the first wakeup after that
+     struct timespec sample_start;
+     int64_t sample_wakeups;
+     int64_t sample_frames;
+     uint64_t sample_draw_usec;
+     double wakeups_per_second;
+     double frames_per_second;
+     double draw_msec_average;
+}CeAppLoopStats_t;
+
 struct CeApp_t;
 
 #if defined(PLATFORM_WINDOWS)
@@ -139,6 +187,7 @@ typedef struct CeApp_t{
      CeBuffer_t* macro_list_buffer;
      CeBuffer_t* mark_list_buffer;
      CeBuffer_t* jump_list_buffer;
+     CeBuffer_t* profile_buffer;
      CeBuffer_t* shell_command_buffer;
      CeBuffer_t* last_goto_buffer;
      CeBuffer_t* clangd_diagnostics_buffer;
@@ -175,6 +224,8 @@ typedef struct CeApp_t{
      bool shell_command_buffer_should_scroll;
      bool shell_command_thread_should_die;
 
+     CeAppFileLoad_t* file_load;
+
      void* gui;
 
      CeClangD_t clangd;
@@ -182,6 +233,12 @@ typedef struct CeApp_t{
 
      CeBuffer_t* last_popup_buffer;
 
+     // the drawers clear and refill these for every view they draw, rather than allocating new ones each frame
+     CeDrawColorList_t draw_color_list;
+     CeRangeList_t draw_range_list;
+
+     CeAppLoopStats_t loop_stats;
+
      // debug
      bool log_key_presses;
 }CeApp_t;
@@ -247,6 +304,8 @@ void ce_app_clear_filepath_cache(CeApp_t* app);
 void ce_app_update_terminal_view(CeApp_t* app, int width, int height);
 
 void ce_app_init_default_commands(CeApp_t* app);
+void ce_app_init_default_config(CeApp_t* app); // used when there is no user config
+void ce_app_init_buffers(CeApp_t* app, bool ls_clangd); // the list, shell command and scratch buffers
 void ce_app_init_command_completion(CeApp_t* app, CeComplete_t* complete);
 void ce_app_message(CeApp_t* app, const char* fmt, ...);
 void ce_app_input(CeApp_t* app, const char* dialogue, CeInputCompleteFunc* input_complete_func);
@@ -256,7 +315,7 @@ bool apply_completion_to_buffer(CeComplete_t* complete,
                                 int64_t start_x,
                                 CePoint_t* cursor);
 
-void ce_app_handle_clangd_response(CeApp_t* app);
+bool ce_app_handle_clangd_response(CeApp_t* app); // returns true if any responses were handled
 void build_clangd_completion_view(CeView_t* view,
                                   CePoint_t start,
                                   CeView_t* completed_view,
@@ -277,8 +336,19 @@ bool edit_macro_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffer);
 bool unsaved_buffers_input_complete_func(CeApp_t* app, CeBuffer_t* input_buffer);
 bool buffer_modified_outside_editor_complete_func(CeApp_t* app, CeBuffer_t* input_buffer);
 
+void scroll_to_and_center_if_offscreen(CeView_t* view, CePoint_t point, CeConfigOptions_t* config_options);
+bool handle_input_history_key(int key, CeHistory_t* history, CeBuffer_t* input_buffer, CePoint_t* cursor);
+void app_handle_key(CeApp_t* app, CeView_t* view, int key);
+
 bool ce_app_switch_to_prev_buffer_in_view(CeApp_t* app, CeView_t* view, bool switch_if_deleted);
 bool ce_app_run_shell_command(CeApp_t* app, const char* command, CeLayout_t* tab_layout, CeView_t* view, bool relative);
+bool ce_app_load_file(CeApp_t* app, CeBuffer_t* buffer, const char* filename);
+bool ce_app_update_file_load(CeApp_t* app);
+bool ce_app_cancel_file_load(CeApp_t* app);
+bool ce_app_update_search_matches(CeApp_t* app); // returns true while there are lines left to scan
+bool ce_app_search_match_status(CeView_t* view, char* string, int64_t string_len);
+void ce_app_loop_stats_wakeup(CeAppLoopStats_t* stats);
+void ce_app_loop_stats_frame(CeAppLoopStats_t* stats, uint64_t draw_usec);
 
 bool ce_clang_format_buffer(char* clang_format_exe, CeBuffer_t* buffer, CePoint_t cursor);
 bool ce_clang_format_selection(char* clang_format_exe, CeView_t* view, CeVimMode_t vim_mode, CeVimVisualData_t* visual);
@@ -7,34 +7,29 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #if defined(PLATFORM_WINDOWS)
     #include <windows.h>
 #else
      #include <errno.h>
+     #include <fcntl.h>
+     #include <poll.h>
      #include <pthread.h>
      #include <unistd.h>
 #endif
 
-#define DEFAULT_MESSAGE_SIZE (16 * 1024 * 1024)
 #define DEFAULT_HEADER_SIZE (1024)
-#define READ_BLOCK_SIZE (4 * 1024)
-#define MAX_HEADER_SIZE 128
+#define READ_BLOCK_SIZE (64 * 1024)
 #define MAX_PRINT_SIZE (1024 * 1024)
 
 typedef struct{
      CeBuffer_t* buffer;
      CeSubprocess_t* proc;
      CeClangDResponseQueue_t* response_queue;
+     CeClangDStats_t* stats;
 }HandleOutputData_t;
 
-typedef struct{
-     char expected_header_prefix[MAX_HEADER_SIZE];
-     char header[MAX_HEADER_SIZE];
-     int64_t message_body_size;
-     char* message_body;
-}ParseResponse_t;
-
 #if defined(PLATFORM_WINDOWS)
 static bool _convert_windows_path_to_uri(char* path, int64_t max_len){
      const char prefix[] = "file:///";
@@ -75,226 +70,115 @@ static bool _calculate_filename_uri(const char* name, char* uri, size_t size){
      return true;
 }
 
-static char* _convert_string_to_json_string(const char* string){
-     char* result = NULL;
-     int64_t string_len = strlen(string);
-     int64_t result_len = 0;
-
-     // Count how big we need to allocate the string.
-     for(int64_t i = 0; i < string_len; i++){
-          if(string[i] == '"' ||
-             string[i] == '\\' ||
-             string[i] == '/' ||
-             string[i] == '\b' ||
-             string[i] == '\f' ||
-             string[i] == '\n' ||
-             string[i] == '\r' ||
-             string[i] == '\t'){
-             // TODO: support \u
-               result_len += 2;
-          }else{
-               result_len++;
-          }
-     }
-
-     // Allocate and populate the new string with valid
-     result = malloc(result_len + 1);
-     int64_t r = 0;
-     for(int64_t i = 0; i < string_len; i++){
-          switch(string[i]){
-          case '"':
-          case '\\':
-          case '/':
-               result[r] = '\\';
-               r++;
-               result[r] = string[i];
-               r++;
-               break;
-          case '\b':
-               result[r] = '\\';
-               r++;
-               result[r] = 'b';
-               r++;
-               break;
-          case '\f':
-               result[r] = '\\';
-               r++;
-               result[r] = 'f';
-               r++;
-               break;
-          case '\n':
-               result[r] = '\\';
-               r++;
-               result[r] = 'n';
-               r++;
-               break;
-          case '\r':
-               result[r] = '\\';
-               r++;
-               result[r] = 'r';
-               r++;
-               break;
-          case '\t':
-               result[r] = '\\';
-               r++;
-               result[r] = 't';
-               r++;
-               break;
-          default:
-               result[r] = string[i];
-               r++;
-               break;
-          }
-     }
-     // End with null terminator
-     result[r] = 0;
-     return result;
+// every message is an object naming the json rpc version and its method, requests also have an id
+static CeJsonWriter_t* _begin_message(CeClangD_t* clangd, const char* method, int64_t request_id){
+     CeJsonWriter_t* writer = &clangd->message_writer;
+     ce_json_writer_clear(writer);
+     ce_json_writer_begin_obj(writer, NULL);
+     ce_json_writer_string(writer, "jsonrpc", "2.0");
+     if(request_id >= 0){
+          ce_json_writer_int(writer, "id", request_id);
+     }
+     ce_json_writer_string(writer, "method", method);
+     return writer;
 }
 
-static bool _send_json_obj(CeJsonObj_t* obj, CeSubprocess_t* subprocess){
-     // Build the message boyd
-     char* message_body = malloc(DEFAULT_MESSAGE_SIZE);
-     ce_json_obj_to_string(obj, message_body, DEFAULT_MESSAGE_SIZE - 1, 1);
-     uint64_t message_len = strlen(message_body);
+static bool _send_message(CeClangD_t* clangd){
+     CeJsonWriter_t* writer = &clangd->message_writer;
+     ce_json_writer_end_obj(writer);
+     if(writer->failed){
+          ce_log("failed to build %" PRIu64 " byte clangd message\n", writer->length);
+          return false;
+     }
 
-     // Prepend the header.
-     char* header = malloc(DEFAULT_HEADER_SIZE);
-     int64_t header_len = snprintf(header, DEFAULT_HEADER_SIZE, "Content-Length: %" PRId64 "\r\n\r\n",
-                                             message_len);
+     char header[DEFAULT_HEADER_SIZE];
+     int64_t header_len = snprintf(header, DEFAULT_HEADER_SIZE, "Content-Length: %" PRIu64 "\r\n\r\n",
+                                   writer->length);
 
-     int64_t bytes_written = ce_subprocess_write_stdin(subprocess, header, header_len);
-     free(header);
+     int64_t bytes_written = ce_subprocess_write_stdin(&clangd->proc, header, header_len);
      if(bytes_written < 0){
-          free(message_body);
           return false;
      }
-     bytes_written = ce_subprocess_write_stdin(subprocess, message_body, message_len);
-     free(message_body);
+     bytes_written = ce_subprocess_write_stdin(&clangd->proc, writer->string, writer->length);
      if(bytes_written < 0){
           return false;
      }
+     clangd->stats.bytes_written += header_len + writer->length;
+     clangd->stats.messages_written++;
      return true;
 }
 
+static void _write_position(CeJsonWriter_t* writer, const char* name, CePoint_t point){
+     ce_json_writer_begin_obj(writer, name);
+     ce_json_writer_int(writer, "line", point.y);
+     ce_json_writer_int(writer, "character", point.x);
+     ce_json_writer_end_obj(writer);
+}
+
 static bool _clangd_request_goto(CeClangD_t* clangd, CeBuffer_t* buffer, CePoint_t point,
                                  const char* method){
+     // the answer is only useful if clangd has seen the edits that led up to it
+     ce_clangd_flush_changes(clangd, true);
+
      char file_uri[MAX_PATH_LEN + 1];
      if(!_calculate_filename_uri(buffer->name, file_uri, MAX_PATH_LEN)){
           return false;
      }
 
-     CeJsonObj_t obj = {};
-     ce_json_obj_set_string(&obj, "jsonrpc", "2.0");
-     ce_json_obj_set_number(&obj, "id", clangd->current_request_id);
-     ce_json_obj_set_string(&obj, "method", method);
-
-     CeJsonObj_t param_obj = {};
-
-     CeJsonObj_t pos_obj = {};
-     ce_json_obj_set_number(&pos_obj, "line", point.y);
-     ce_json_obj_set_number(&pos_obj, "character", point.x);
-     ce_json_obj_set_obj(&param_obj, "position", &pos_obj);
-
-     CeJsonObj_t text_document_obj = {};
-     ce_json_obj_set_string(&text_document_obj, "uri", file_uri);
-     ce_json_obj_set_obj(&param_obj, "textDocument", &text_document_obj);
-
-     ce_json_obj_set_obj(&obj, "params", &param_obj);
-
-     bool result = _send_json_obj(&obj, &clangd->proc);
-     ce_json_obj_free(&text_document_obj);
-     ce_json_obj_free(&pos_obj);
-     ce_json_obj_free(&param_obj);
-     ce_json_obj_free(&obj);
-     return result;
+     CeJsonWriter_t* writer = _begin_message(clangd, method, clangd->current_request_id);
+     ce_json_writer_begin_obj(writer, "params");
+     _write_position(writer, "position", point);
+     ce_json_writer_begin_obj(writer, "textDocument");
+     ce_json_writer_string(writer, "uri", file_uri);
+     ce_json_writer_end_obj(writer);
+     ce_json_writer_end_obj(writer);
+     return _send_message(clangd);
 }
 
-static bool _parse_response_complete(ParseResponse_t* parse){
-     if(parse->message_body != NULL &&
-        (int64_t)(strlen(parse->message_body)) == parse->message_body_size){
-          return true;
-     }
-     return false;
+static uint64_t _load_acquire(uint64_t* value){
+#if defined(PLATFORM_WINDOWS)
+     return InterlockedCompareExchange64((LONG64 volatile*)(value), 0, 0);
+#else
+     return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
 }
 
-static void _parse_response_block(ParseResponse_t* parse,
-                                  char* block,
-                                  int64_t block_size){
-     int64_t expected_header_prefix_len = 0;
-     int64_t header_len = 0;
-     int64_t message_body_len = 0;
-
-     // If we haven't parsed the header yet.
-     for(int64_t i = 0; i < block_size; i++){
-          if(parse->message_body_size <= 0){
-               // Calculate these values as needed.
-               if(expected_header_prefix_len == 0){
-                    expected_header_prefix_len = strlen(parse->expected_header_prefix);
-               }
-               if (header_len == 0){
-                    header_len = strlen(parse->header);
-               }
-               // If we haven't matched the expected header prefix copy the bytes that match it.
-               if(header_len < expected_header_prefix_len){
-                    if(block[i] == parse->expected_header_prefix[header_len]){
-                         parse->header[header_len] = block[i];
-                         header_len++;
-                    }else{
-                         memset(parse->header, 0, MAX_HEADER_SIZE);
-                         header_len = 0;
-                    }
-               }else{
-                    // If we have copied the header prefix, continue coping until we get the \r\n\r\n pattern.
-                    if(header_len >= MAX_HEADER_SIZE){
-                         // Clear the header and retry. This can mean we might miss a message.
-                         memset(parse->header, 0, MAX_HEADER_SIZE);
-                         return;
-                    }
-
-                    parse->header[header_len] = block[i];
-                    header_len++;
-
-                    // Check for the end of the header.
-                    if(parse->header[header_len - 4] == '\r' &&
-                       parse->header[header_len - 3] == '\n' &&
-                       parse->header[header_len - 2] == '\r' &&
-                       parse->header[header_len - 1] == '\n'){
-                         char* end = NULL;
-                         parse->message_body_size = strtol(parse->header + expected_header_prefix_len, &end, 10);
-                         if(parse->header == end){
-                              memset(parse->header, 0, MAX_HEADER_SIZE);
-                              return;
-                         }
-                         // Account for null terminator.
-                         int64_t full_message_body_size = parse->message_body_size + 1;
-                         parse->message_body = malloc(full_message_body_size);
-                         memset(parse->message_body, 0, full_message_body_size);
-                    }
-               }
-          }else{
-               if(message_body_len == 0){
-                    message_body_len = strnlen(parse->message_body, parse->message_body_size);
-               }
-               if(message_body_len >= parse->message_body_size){
-                    return;
-               }
+static void _store_release(uint64_t* value, uint64_t new_value){
+#if defined(PLATFORM_WINDOWS)
+     InterlockedExchange64((LONG64 volatile*)(value), new_value);
+#else
+     __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+#endif
+}
 
-               parse->message_body[message_body_len] = block[i];
-               message_body_len++;
-          }
-     }
+static bool _exchange_flag(bool* flag, bool new_value){
+#if defined(PLATFORM_WINDOWS)
+     return InterlockedExchange8((CHAR volatile*)(flag), new_value);
+#else
+     return __atomic_exchange_n(flag, new_value, __ATOMIC_SEQ_CST);
+#endif
 }
 
-static void _parse_response_free(ParseResponse_t* parse){
-     memset(parse->header, 0, MAX_HEADER_SIZE);
-     if(parse->message_body){
-          parse->message_body_size = 0;
-          free(parse->message_body);
-          parse->message_body = NULL;
+static bool _wait_for_room(CeClangDResponseQueue_t* queue){
+     while(queue->tail - _load_acquire(&queue->head) >= CE_CLANGD_RESPONSE_QUEUE_SIZE){
+#if defined(PLATFORM_WINDOWS)
+          if(InterlockedCompareExchange8((CHAR volatile*)(&queue->closed), 0, 0)){
+               return false;
+          }
+          Sleep(1);
+#else
+          if(__atomic_load_n(&queue->closed, __ATOMIC_ACQUIRE)){
+               return false;
+          }
+          usleep(1000);
+#endif
      }
+     return true;
 }
 
-static bool _push_response(CeClangDResponseQueue_t* queue, CeJsonObj_t* obj){
+// only called from the reader thread
+static bool _push_response(CeClangDResponseQueue_t* queue, CeClangDStats_t* stats, CeJsonObj_t* obj, char* message,
+                           CeJsonArena_t* arena){
      int64_t request_id = -1;
      CeJsonFindResult_t find = ce_json_obj_find(obj, "id");
      if(find.type == CE_JSON_TYPE_NUMBER){
@@ -304,77 +188,63 @@ static bool _push_response(CeClangDResponseQueue_t* queue, CeJsonObj_t* obj){
           }
      }
 
-#if defined(PLATFORM_WINDOWS)
-     DWORD result = WaitForSingleObject(queue->mutex, INFINITE);
-     if(result != WAIT_OBJECT_0){
-          ce_log("Failed to acquire clangd response queue mutex: %d\n", GetLastError());
-          return false;
-     }
-#else
-     int rc = pthread_mutex_lock(&queue->mutex);
-     if(rc != 0){
-         ce_log("Failed to aquire clangd response queue mutex: %s", strerror(rc));
-         return false;
+     if(queue->tail - _load_acquire(&queue->head) >= CE_CLANGD_RESPONSE_QUEUE_SIZE){
+          // a newer notification will replace the one we drop, but someone is waiting on a response
+          if(request_id < 0){
+               ce_clangd_stats_count(&stats->notifications_dropped, 1);
+               return false;
+          }
+          if(!_wait_for_room(queue)){
+               return false;
+          }
      }
-#endif
 
-     int64_t new_size = queue->size + 1;
-     queue->elements = realloc(queue->elements, new_size * sizeof(queue->elements[0]));
-     memset(queue->elements + queue->size, 0, sizeof(queue->elements[0]));
-     CeClangDResponse_t* new_response = queue->elements + queue->size;
+     CeClangDResponse_t* new_response = queue->elements + (queue->tail & (CE_CLANGD_RESPONSE_QUEUE_SIZE - 1));
+     memset(new_response, 0, sizeof(*new_response));
      new_response->request_id = request_id;
      new_response->obj = obj;
-     queue->size = new_size;
+     new_response->message = message;
+     new_response->arena = *arena;
+     _store_release(&queue->tail, queue->tail + 1);
 
-#if defined(PLATFORM_WINDOWS)
-     ReleaseMutex(queue->mutex);
-#else
-     rc = pthread_mutex_unlock(&queue->mutex);
-     if(rc != 0){
-         ce_log("Failed to release clangd response queue mutex: %s", strerror(rc));
+#if !defined(PLATFORM_WINDOWS)
+     // one byte is enough until the main thread catches up
+     if(queue->wake_fds[1] >= 0 && !_exchange_flag(&queue->wake_pending, true)){
+          int64_t rc = 0;
+          do{
+               rc = write(queue->wake_fds[1], "1", 1);
+          }while(rc == -1 && errno == EINTR);
      }
 #endif
      return true;
 }
 
-static CeClangDResponse_t _pop_response(CeClangDResponseQueue_t* queue){
-     CeClangDResponse_t result = {};
-
-#if defined(PLATFORM_WINDOWS)
-     DWORD wait_result = WaitForSingleObject(queue->mutex, INFINITE);
-     if(wait_result != WAIT_OBJECT_0){
-          ce_log("Failed to acquire clangd response queue mutex: %d\n", GetLastError());
-          return result;
+// only called from the main thread
+static bool _responses_queued(CeClangDResponseQueue_t* queue){
+     if(_load_acquire(&queue->tail) != queue->head){
+          return true;
      }
-#else
-     int rc = pthread_mutex_lock(&queue->mutex);
-     if(rc != 0){
-         ce_log("Failed to aquire clangd response queue mutex: %s", strerror(rc));
-         return result;
+
+#if !defined(PLATFORM_WINDOWS)
+     // we are caught up, so take the wake up and look again. Anything pushed after this writes another
+     if(queue->wake_fds[0] >= 0){
+          char buffer[64];
+          while(read(queue->wake_fds[0], buffer, sizeof(buffer)) > 0){
+          }
+          _exchange_flag(&queue->wake_pending, false);
      }
 #endif
-     if(queue->size == 0){
-          return result;
-     }
-
-     // Copy the element
-     result = *queue->elements;
-
-     // Update the queue.
-     int64_t new_size = (queue->size - 1);
-     // Shift down all of the elements.
-     memmove(queue->elements, queue->elements + 1, new_size * sizeof(queue->elements[0]));
-     queue->elements = realloc(queue->elements, new_size * sizeof(queue->elements[0]));
-     queue->size = new_size;
+     return _load_acquire(&queue->tail) != queue->head;
+}
 
-#if defined(PLATFORM_WINDOWS)
-     ReleaseMutex(queue->mutex);
-#else
-     rc = pthread_mutex_unlock(&queue->mutex);
-     if(rc != 0){
-         ce_log("Failed to release clangd response queue mutex: %s", strerror(rc));
+// only called from the main thread
+static CeClangDResponse_t _pop_response(CeClangDResponseQueue_t* queue){
+     CeClangDResponse_t result = {};
+     if(_load_acquire(&queue->tail) == queue->head){
+          return result;
      }
-#endif
+     result = queue->elements[queue->head & (CE_CLANGD_RESPONSE_QUEUE_SIZE - 1)];
+     _store_release(&queue->head, queue->head + 1);
      return result;
 }
 
@@ -385,46 +255,81 @@ static void* handle_output_fn(void* user_data)
 #endif
 {
      HandleOutputData_t* data = (HandleOutputData_t*)(user_data);
-     // bool sent_definition_request = false;
-     ParseResponse_t parse = {};
-     strcpy(parse.expected_header_prefix, "Content-Length: ");
+     CeClangDReader_t reader;
+     ce_clangd_reader_init(&reader);
 
      char block[READ_BLOCK_SIZE];
      while(true){
-          int64_t bytes_read = ce_subprocess_read_stdout(data->proc, block, (READ_BLOCK_SIZE - 1));
+          if(!ce_clangd_reader_reserve(&reader, READ_BLOCK_SIZE)){
+               ce_log("failed to grow the clangd reader past %" PRId64 " bytes\n", reader.capacity);
+               break;
+          }
+          char* dest = NULL;
+          int64_t read_size = ce_clangd_reader_free_span(&reader, &dest);
+          if(read_size > (READ_BLOCK_SIZE - 1)){
+               read_size = READ_BLOCK_SIZE - 1;
+          }
+
+#if !defined(PLATFORM_WINDOWS)
+          // sleep until clangd writes something or goes away
+          struct pollfd poll_fd = {.fd = data->proc->stdout_fd, .events = POLLIN};
+          if(poll(&poll_fd, 1, -1) < 0){
+               if(errno == EINTR){
+                    continue;
+               }
+               ce_log("poll() on clangd stdout failed: %s\n", strerror(errno));
+               break;
+          }
+#endif
+
+          int64_t bytes_read = ce_subprocess_read_stdout(data->proc, dest, read_size);
           if(bytes_read <= 0){
 #if !defined(PLATFORM_WINDOWS)
-               if(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR){
-                    usleep(1000);
+               if(bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)){
                     continue;
                }
 #endif
                break;
           }
+          ce_clangd_reader_commit(&reader, bytes_read, data->stats);
 
+          // keep a copy to print, framing may move the ring
+          memcpy(block, dest, bytes_read);
           block[bytes_read] = 0;
 
-          // Attempt to parse the messages before we sanitize and print them.
-          _parse_response_block(&parse, block, bytes_read);
-          if(_parse_response_complete(&parse)){
+          char* message = NULL;
+          while((message = ce_clangd_reader_next_message(&reader, data->stats))){
+               // the parsed json points into the message, so the response takes it over
+               CeJsonArena_t arena = {};
                CeJsonObj_t* obj = malloc(sizeof(*obj));
-               memset(obj, 0, sizeof(*obj));
-               if(ce_json_parse(parse.message_body, obj, false)){
+               if(obj == NULL){
+                    ce_log("failed to allocate json for a clangd message\n");
+                    ce_clangd_stats_count(&data->stats->messages_dropped, 1);
+                    free(message);
+                    continue;
+               }
+               if(ce_json_parse_in_place(message, obj, &arena, false)){
                     // DEBUG
                     // char* buffer = malloc(MAX_PRINT_SIZE + 1);
                     // ce_json_obj_to_string(obj, buffer, MAX_PRINT_SIZE, 1);
                     // printf("%s\n", buffer);
                     // free(buffer);
-                    if(!_push_response(data->response_queue, obj)){
-                         ce_json_obj_free(obj);
+                    if(!_push_response(data->response_queue, data->stats, obj, message, &arena)){
+                         ce_json_arena_free(&arena);
+                         free(message);
                          free(obj);
                     }
                }else{
                     printf("Failed to parse json obj\n");
+                    ce_clangd_stats_count(&data->stats->messages_dropped, 1);
+                    ce_json_arena_free(&arena);
+                    free(message);
+                    free(obj);
                }
-               _parse_response_free(&parse);
           }
 
+          ce_clangd_reader_trim(&reader);
+
           // sanitize block for non-printable characters
           for(int i = 0; i < bytes_read; i++){
               if(block[i] < 32 && block[i] != '\n') block[i] = '?';
@@ -444,6 +349,8 @@ static void* handle_output_fn(void* user_data)
 #endif
      }
 
+     ce_clangd_reader_free(&reader);
+
      int status = ce_subprocess_close(data->proc);
 
 #if defined(PLATFORM_WINDOWS)
@@ -494,6 +401,109 @@ static void _clangd_track_request(CeClangD_t* clangd, const char* method){
      new_request->method = strdup(method);
 }
 
+static uint64_t _now_usec(void){
+     struct timespec now = {};
+#if defined(PLATFORM_WINDOWS)
+     timespec_get(&now, TIME_UTC);
+#else
+     clock_gettime(CLOCK_MONOTONIC, &now);
+#endif
+     return (uint64_t)(now.tv_sec) * 1000000ULL + (uint64_t)(now.tv_nsec) / 1000ULL;
+}
+
+static CeClangDDocument_t* _find_document(CeClangD_t* clangd, CeBuffer_t* buffer){
+     for(int64_t i = 0; i < clangd->documents.count; i++){
+          if(clangd->documents.elements[i].buffer == buffer){
+               return clangd->documents.elements + i;
+          }
+     }
+     return NULL;
+}
+
+static CeClangDDocument_t* _track_document(CeClangD_t* clangd, CeBuffer_t* buffer){
+     CeClangDDocument_t* document = _find_document(clangd, buffer);
+     if(document){
+          return document;
+     }
+     int64_t new_count = clangd->documents.count + 1;
+     clangd->documents.elements = realloc(clangd->documents.elements,
+                                          new_count * sizeof(clangd->documents.elements[0]));
+     document = clangd->documents.elements + clangd->documents.count;
+     memset(document, 0, sizeof(*document));
+     document->buffer = buffer;
+     clangd->documents.count = new_count;
+     return document;
+}
+
+static void _untrack_document(CeClangD_t* clangd, CeBuffer_t* buffer){
+     CeClangDDocument_t* document = _find_document(clangd, buffer);
+     if(document == NULL){
+          return;
+     }
+     int64_t index = document - clangd->documents.elements;
+     memmove(document, document + 1, (clangd->documents.count - index - 1) * sizeof(*document));
+     clangd->documents.count--;
+}
+
+static bool _send_document_changes(CeClangD_t* clangd, CeClangDDocument_t* document){
+     CeBufferEdits_t edits = {};
+     bool full_sync = document->full_sync_needed ||
+                      !ce_buffer_edits_since(document->buffer, &document->synced, &edits);
+     document->changed_usec = 0;
+
+     // undone and redone back to where clangd already is
+     if(!full_sync && edits.count == 0){
+          ce_buffer_change_mark(&document->synced, document->buffer);
+          return true;
+     }
+
+     char file_uri[MAX_PATH_LEN + 1];
+     if(!_calculate_filename_uri(document->buffer->name, file_uri, MAX_PATH_LEN)){
+          ce_buffer_edits_free(&edits);
+          document->full_sync_needed = true;
+          return false;
+     }
+
+     document->version++;
+
+     CeJsonWriter_t* writer = _begin_message(clangd, "textDocument/didChange", -1);
+     ce_json_writer_begin_obj(writer, "params");
+     ce_json_writer_begin_obj(writer, "textDocument");
+     ce_json_writer_string(writer, "uri", file_uri);
+     ce_json_writer_int(writer, "version", document->version);
+     ce_json_writer_end_obj(writer);
+     ce_json_writer_begin_array(writer, "contentChanges");
+     if(full_sync){
+          // the undo history can't tell us what changed, so send the whole file
+          char* buffer_str = ce_buffer_dupe(document->buffer);
+          ce_json_writer_begin_obj(writer, NULL);
+          ce_json_writer_string(writer, "text", buffer_str ? buffer_str : "");
+          ce_json_writer_end_obj(writer);
+          free(buffer_str);
+     }else{
+          for(int64_t i = 0; i < edits.count; i++){
+               ce_json_writer_begin_obj(writer, NULL);
+               ce_json_writer_begin_obj(writer, "range");
+               _write_position(writer, "start", edits.elements[i].start);
+               _write_position(writer, "end", edits.elements[i].end);
+               ce_json_writer_end_obj(writer);
+               ce_json_writer_string(writer, "text", edits.elements[i].text);
+               ce_json_writer_end_obj(writer);
+          }
+          ce_buffer_edits_free(&edits);
+     }
+     ce_json_writer_end_array(writer);
+     ce_json_writer_end_obj(writer);
+     if(!_send_message(clangd)){
+          // the synced mark stays put, but clangd may have seen part of it, so start it over with the whole file
+          document->full_sync_needed = true;
+          return false;
+     }
+     ce_buffer_change_mark(&document->synced, document->buffer);
+     document->full_sync_needed = false;
+     return true;
+}
+
 bool ce_clangd_init(const char* executable_path,
                     CeClangD_t* clangd){
      char command[MAX_COMMAND_SIZE];
@@ -509,14 +519,12 @@ bool ce_clangd_init(const char* executable_path,
      thread_data->buffer = clangd->buffer;
      thread_data->proc = &clangd->proc;
      thread_data->response_queue = &clangd->response_queue;
+     thread_data->stats = &clangd->stats;
 
-#if defined(PLATFORM_WINDOWS)
-     clangd->response_queue.mutex = CreateMutex(NULL, false, NULL);
-     if(clangd->response_queue.mutex == NULL){
-          ce_log("Failed to create clangd mutex\n");
-          return false;
-     }
+     clangd->response_queue.wake_fds[0] = -1;
+     clangd->response_queue.wake_fds[1] = -1;
 
+#if defined(PLATFORM_WINDOWS)
      clangd->thread_handle = CreateThread(NULL,
                                           0,
                                           handle_output_fn,
@@ -528,30 +536,32 @@ bool ce_clangd_init(const char* executable_path,
           return false;
      }
 #else
-     int rc = pthread_create(&clangd->thread, NULL, handle_output_fn, thread_data);
-     if(rc != 0){
-          ce_log("pthread_create() failed: '%s'\n", strerror(errno));
-          return false;
+     // without it we still work, the main loop just has to check on the queue itself
+     if(pipe(clangd->response_queue.wake_fds) == 0){
+          for(int i = 0; i < 2; i++){
+               fcntl(clangd->response_queue.wake_fds[i], F_SETFL,
+                     fcntl(clangd->response_queue.wake_fds[i], F_GETFL) | O_NONBLOCK);
+               fcntl(clangd->response_queue.wake_fds[i], F_SETFD, FD_CLOEXEC);
+          }
+     }else{
+          ce_log("failed to create clangd wake pipe: %s\n", strerror(errno));
+          clangd->response_queue.wake_fds[0] = -1;
+          clangd->response_queue.wake_fds[1] = -1;
      }
 
-     rc = pthread_mutex_init(&clangd->response_queue.mutex, NULL);
+     int rc = pthread_create(&clangd->thread, NULL, handle_output_fn, thread_data);
      if(rc != 0){
-          ce_log("pthread_mutex_init() failed: %s\n", strerror(rc));
+          ce_log("pthread_create() failed: '%s'\n", strerror(errno));
           return false;
      }
 #endif
 
      // Build our initialization structure.
-     CeJsonObj_t initialize_obj = {};
-     ce_json_obj_set_string(&initialize_obj, "jsonrpc", "2.0");
-     ce_json_obj_set_number(&initialize_obj, "id", 0);
-     ce_json_obj_set_string(&initialize_obj, "method", "initialize");
+     CeJsonWriter_t* writer = _begin_message(clangd, "initialize", 0);
 
      char cwd[MAX_PATH_LEN + 1];
      char cwd_uri[MAX_PATH_LEN + 16];
 
-     CeJsonObj_t params_obj = {};
-
 #if defined(PLATFORM_WINDOWS)
      DWORD pid = GetCurrentProcessId();
      _getcwd(cwd, MAX_PATH_LEN);
@@ -559,33 +569,38 @@ bool ce_clangd_init(const char* executable_path,
      pid_t pid = getpid();
      getcwd(cwd, MAX_PATH_LEN);
 #endif
-     ce_json_obj_set_number(&params_obj, "processId", (double)(pid));
 
 #if defined(PLATFORM_WINDOWS)
      strncpy(cwd_uri, cwd, MAX_PATH_LEN);
      _convert_windows_path_to_uri(cwd_uri, MAX_PATH_LEN);
-     char* json_cwd = _convert_string_to_json_string(cwd);
 #else
      snprintf(cwd_uri, MAX_PATH_LEN + 15, "file://%s", cwd);
-     char* json_cwd = _convert_string_to_json_string(cwd);
 #endif
 
-     ce_json_obj_set_string(&params_obj, "rootPath", json_cwd);
-     ce_json_obj_set_string(&params_obj, "rootUri", cwd_uri);
-     ce_json_obj_set_obj(&initialize_obj, "params", &params_obj);
-
-     CeJsonObj_t client_info_obj = {};
-     ce_json_obj_set_string(&client_info_obj, "name", "ce");
-     ce_json_obj_set_string(&client_info_obj, "version", "9.8.7");
-     ce_json_obj_set_obj(&initialize_obj, "ClientInfo", &client_info_obj);
-
-     bool result = _send_json_obj(&initialize_obj, &clangd->proc);
-     ce_json_obj_free(&initialize_obj);
-     ce_json_obj_free(&params_obj);
-     ce_json_obj_free(&client_info_obj);
-
-     free(json_cwd);
-     return result;
+     ce_json_writer_begin_obj(writer, "params");
+     ce_json_writer_int(writer, "processId", pid);
+     ce_json_writer_string(writer, "rootPath", cwd);
+     ce_json_writer_string(writer, "rootUri", cwd_uri);
+
+     // our points count runes, so ask for positions in code points rather than utf-16 code units
+     ce_json_writer_begin_obj(writer, "capabilities");
+     ce_json_writer_begin_obj(writer, "general");
+     ce_json_writer_begin_array(writer, "positionEncodings");
+     ce_json_writer_string(writer, NULL, "utf-32");
+     ce_json_writer_end_array(writer);
+     ce_json_writer_end_obj(writer);
+     ce_json_writer_begin_array(writer, "offsetEncoding");
+     ce_json_writer_string(writer, NULL, "utf-32");
+     ce_json_writer_end_array(writer);
+     ce_json_writer_end_obj(writer);
+     ce_json_writer_end_obj(writer);
+
+     ce_json_writer_begin_obj(writer, "ClientInfo");
+     ce_json_writer_string(writer, "name", "ce");
+     ce_json_writer_string(writer, "version", "9.8.7");
+     ce_json_writer_end_obj(writer);
+
+     return _send_message(clangd);
 }
 
 bool ce_clangd_file_open(CeClangD_t* clangd, CeBuffer_t* buffer){
@@ -603,34 +618,33 @@ bool ce_clangd_file_open(CeClangD_t* clangd, CeBuffer_t* buffer){
           return false;
      }
 
+     // opening it again starts clangd over from what the buffer has now
+     CeClangDDocument_t* document = _track_document(clangd, buffer);
+     document->version++;
+     ce_buffer_change_mark(&document->synced, buffer);
+     document->changed_usec = 0;
+     document->full_sync_needed = false;
+
      char* buffer_str = ce_buffer_dupe(buffer);
-     char* sanitized_buffer_str = _convert_string_to_json_string(buffer_str);
-
-     CeJsonObj_t obj = {};
-     ce_json_obj_set_string(&obj, "jsonrpc", "2.0");
-     ce_json_obj_set_string(&obj, "method", "textDocument/didOpen");
-
-     CeJsonObj_t text_document_obj = {};
-     ce_json_obj_set_string(&text_document_obj, "uri", file_uri);
-     ce_json_obj_set_string(&text_document_obj, "languageId", "c");
-     ce_json_obj_set_string(&text_document_obj, "text", sanitized_buffer_str);
-     CeJsonObj_t param_obj = {};
-     ce_json_obj_set_obj(&param_obj, "textDocument", &text_document_obj);
-     ce_json_obj_set_obj(&obj, "params", &param_obj);
-
-     bool result = _send_json_obj(&obj, &clangd->proc);
-     ce_json_obj_free(&param_obj);
-     ce_json_obj_free(&text_document_obj);
-     ce_json_obj_free(&obj);
-     free(sanitized_buffer_str);
+
+     CeJsonWriter_t* writer = _begin_message(clangd, "textDocument/didOpen", -1);
+     ce_json_writer_begin_obj(writer, "params");
+     ce_json_writer_begin_obj(writer, "textDocument");
+     ce_json_writer_string(writer, "uri", file_uri);
+     ce_json_writer_string(writer, "languageId", "c");
+     ce_json_writer_int(writer, "version", document->version);
+     ce_json_writer_string(writer, "text", buffer_str ? buffer_str : "");
+     ce_json_writer_end_obj(writer);
+     ce_json_writer_end_obj(writer);
      free(buffer_str);
-     return result;
+     return _send_message(clangd);
 }
 
 bool ce_clangd_file_close(CeClangD_t* clangd, CeBuffer_t* buffer){
      if(clangd->buffer == NULL){
           return true;
      }
+     _untrack_document(clangd, buffer);
      CeAppBufferData_t* buffer_data = buffer->app_data;
      if(buffer_data->syntax_function != ce_syntax_highlight_c &&
         buffer_data->syntax_function != ce_syntax_highlight_cpp){
@@ -641,65 +655,56 @@ bool ce_clangd_file_close(CeClangD_t* clangd, CeBuffer_t* buffer){
           return false;
      }
 
-     CeJsonObj_t obj = {};
-     ce_json_obj_set_string(&obj, "jsonrpc", "2.0");
-     ce_json_obj_set_string(&obj, "method", "textDocument/didClose");
-
-     CeJsonObj_t text_document_obj = {};
-     ce_json_obj_set_string(&text_document_obj, "uri", file_uri);
-     CeJsonObj_t param_obj = {};
-     ce_json_obj_set_obj(&param_obj, "textDocument", &text_document_obj);
-     ce_json_obj_set_obj(&obj, "params", &param_obj);
-
-     bool result = _send_json_obj(&obj, &clangd->proc);
-     ce_json_obj_free(&param_obj);
-     ce_json_obj_free(&text_document_obj);
-     ce_json_obj_free(&obj);
-     return result;
+     CeJsonWriter_t* writer = _begin_message(clangd, "textDocument/didClose", -1);
+     ce_json_writer_begin_obj(writer, "params");
+     ce_json_writer_begin_obj(writer, "textDocument");
+     ce_json_writer_string(writer, "uri", file_uri);
+     ce_json_writer_end_obj(writer);
+     ce_json_writer_end_obj(writer);
+     return _send_message(clangd);
 }
 
-bool ce_clangd_file_report_changes(CeClangD_t* clangd, CeBuffer_t* buffer, CeBufferChangeNode_t* last_change){
-     if(clangd->buffer == NULL){
-          return true;
-     }
-     if(last_change == buffer->change_node){
-          return true;
+bool ce_clangd_flush_changes(CeClangD_t* clangd, bool force){
+     bool result = true;
+     uint64_t now = _now_usec();
+     for(int64_t i = 0; i < clangd->documents.count; i++){
+          CeClangDDocument_t* document = clangd->documents.elements + i;
+          if(!document->full_sync_needed && document->synced.buffer_version == document->buffer->version){
+               document->changed_usec = 0;
+               continue;
+          }
+          // batch up the edits made over the window starting with the first one
+          if(document->changed_usec == 0){
+               document->changed_usec = now;
+          }
+          if(!force && now - document->changed_usec < CE_CLANGD_CHANGE_DEBOUNCE_USEC){
+               continue;
+          }
+          if(!_send_document_changes(clangd, document)){
+               result = false;
+          }
      }
+     return result;
+}
 
-     // TODO: We could take this as a parameter rather than calculating it each time.
-     char file_uri[MAX_PATH_LEN + 1];
-     if(!_calculate_filename_uri(buffer->name, file_uri, MAX_PATH_LEN)){
-          return false;
+int64_t ce_clangd_next_flush_usec(CeClangD_t* clangd){
+     int64_t result = -1;
+     uint64_t now = _now_usec();
+     for(int64_t i = 0; i < clangd->documents.count; i++){
+          CeClangDDocument_t* document = clangd->documents.elements + i;
+          if(!document->full_sync_needed && document->synced.buffer_version == document->buffer->version){
+               continue;
+          }
+          int64_t left_usec = CE_CLANGD_CHANGE_DEBOUNCE_USEC;
+          if(document->changed_usec != 0){
+               uint64_t elapsed_usec = now - document->changed_usec;
+               left_usec = (elapsed_usec >= CE_CLANGD_CHANGE_DEBOUNCE_USEC) ? 0 :
+                           (int64_t)(CE_CLANGD_CHANGE_DEBOUNCE_USEC - elapsed_usec);
+          }
+          if(result < 0 || left_usec < result){
+               result = left_usec;
+          }
      }
-
-     CeJsonObj_t obj = {};
-     ce_json_obj_set_string(&obj, "jsonrpc", "2.0");
-     ce_json_obj_set_string(&obj, "method", "textDocument/didChange");
-     CeJsonObj_t text_document_obj = {};
-     ce_json_obj_set_string(&text_document_obj, "uri", file_uri);
-     CeJsonObj_t param_obj = {};
-     ce_json_obj_set_obj(&param_obj, "textDocument", &text_document_obj);
-
-     char* buffer_str = ce_buffer_dupe(buffer);
-     char* sanitized_buffer_str = _convert_string_to_json_string(buffer_str);
-
-     CeJsonObj_t content_change_obj = {};
-     ce_json_obj_set_string(&content_change_obj, "text", sanitized_buffer_str);
-
-     CeJsonArray_t content_changes_array = {};
-     ce_json_array_add_obj(&content_changes_array, &content_change_obj);
-
-     ce_json_obj_set_array(&param_obj, "contentChanges", &content_changes_array);
-     ce_json_obj_set_obj(&obj, "params", &param_obj);
-
-     bool result = _send_json_obj(&obj, &clangd->proc);
-     free(buffer_str);
-     free(sanitized_buffer_str);
-     ce_json_array_free(&content_changes_array);
-     ce_json_obj_free(&content_change_obj);
-     ce_json_obj_free(&param_obj);
-     ce_json_obj_free(&text_document_obj);
-     ce_json_obj_free(&obj);
      return result;
 }
 
@@ -754,7 +759,29 @@ bool ce_clangd_request_find_references(CeClangD_t* clangd, CeBuffer_t* buffer, C
 }
 
 bool ce_clangd_outstanding_responses(CeClangD_t* clangd){
-     return (clangd->response_queue.size > 0);
+     if(clangd->buffer == NULL){
+          return false;
+     }
+     return _responses_queued(&clangd->response_queue);
+}
+
+int ce_clangd_wake_fd(CeClangD_t* clangd){
+     if(clangd->buffer == NULL){
+          return -1;
+     }
+     return clangd->response_queue.wake_fds[0];
+}
+
+CeClangDStats_t ce_clangd_stats(CeClangD_t* clangd){
+     CeClangDStats_t stats = clangd->stats;
+#if !defined(PLATFORM_WINDOWS)
+     stats.bytes_read = __atomic_load_n(&clangd->stats.bytes_read, __ATOMIC_RELAXED);
+     stats.bytes_skipped = __atomic_load_n(&clangd->stats.bytes_skipped, __ATOMIC_RELAXED);
+     stats.messages_read = __atomic_load_n(&clangd->stats.messages_read, __ATOMIC_RELAXED);
+     stats.messages_dropped = __atomic_load_n(&clangd->stats.messages_dropped, __ATOMIC_RELAXED);
+     stats.notifications_dropped = __atomic_load_n(&clangd->stats.notifications_dropped, __ATOMIC_RELAXED);
+#endif
+     return stats;
 }
 
 CeClangDResponse_t ce_clangd_pop_response(CeClangD_t* clangd){
@@ -776,21 +803,41 @@ void ce_clangd_free(CeClangD_t* clangd){
      if(clangd->buffer == NULL){
           return;
      }
+     // the reader may be waiting for room we aren't going to make
+#if defined(PLATFORM_WINDOWS)
+     InterlockedExchange8((CHAR volatile*)(&clangd->response_queue.closed), true);
+#else
+     __atomic_store_n(&clangd->response_queue.closed, true, __ATOMIC_RELEASE);
+#endif
+
 #if defined(PLATFORM_WINDOWS)
      ce_subprocess_kill(&clangd->proc, 0);
-     CloseHandle(clangd->thread_handle);
 #else
      ce_subprocess_kill(&clangd->proc, SIGINT);
 #endif
 
+     // the reader has to be done pushing before we drain the queue
 #if defined(PLATFORM_WINDOWS)
+     WaitForSingleObject(clangd->thread_handle, INFINITE);
      CloseHandle(clangd->thread_handle);
-     CloseHandle(clangd->response_queue.mutex);
 #else
      pthread_join(clangd->thread, NULL);
-     pthread_mutex_destroy(&clangd->response_queue.mutex);
+     for(int i = 0; i < 2; i++){
+          if(clangd->response_queue.wake_fds[i] >= 0){
+               close(clangd->response_queue.wake_fds[i]);
+          }
+     }
 #endif
 
+     // responses the main thread never got to
+     CeClangDResponse_t response = _pop_response(&clangd->response_queue);
+     while(response.obj){
+          ce_clangd_response_free(&response);
+          response = _pop_response(&clangd->response_queue);
+     }
+
+     free(clangd->documents.elements);
+     ce_json_writer_free(&clangd->message_writer);
      memset(clangd, 0, sizeof(*clangd));
 }
 
@@ -798,8 +845,9 @@ void ce_clangd_response_free(CeClangDResponse_t* response){
      if(response->obj == NULL){
           return;
      }
-     ce_json_obj_free(response->obj);
+     ce_json_arena_free(&response->arena);
      free(response->obj);
+     free(response->message);
      free(response->method);
 }
 
@@ -1,14 +1,15 @@
 #pragma once
 
 // TODO
-// + Locked Queue
+// + Lock free queue
 // + Convert buffer to valid json string
+// + Stream messages out rather than printing a json tree into a fixed size buffer
 // - Timeout for requests ?
 // + Document management
 //   + DidOpen
 //   + DidClose
 //   + DidChange: Save for after gotos
-//     + Maybe initial implementation is to just send the whole file each time ?
+//     + Send the ranges changed since the last report, batched over a short window
 // - Requests
 //   + Goto definiton
 //   + Goto declaration
@@ -30,7 +31,8 @@
 // + Customizable auto complete key.
 //
 // Important learnings
-// - DidChange deltas are stupid and basically end up sending the whole file if you make multi-line changes.
+// - DidChange deltas are easy to get wrong, so fall back to sending the whole file whenever the undo history can't
+//   say exactly what changed.
 // - uris store spaces as %20
 // - Detecting relative vs absolute paths is different on windows. Duh.
 // - clangd gives you the best textDocument/defintion it knows about, so itll give you the header
@@ -38,6 +40,7 @@
 //   project on startup. I wish it could just find it...
 //
 
+#include "ce_clangd_reader.h"
 #include "ce_subprocess.h"
 #include "ce_json.h"
 #include "ce.h"
@@ -47,21 +50,26 @@
 #endif
 
 #define MAX_COMMAND_SIZE 1024
+#define CE_CLANGD_CHANGE_DEBOUNCE_USEC 200000 // edits are batched for this long before telling clangd about them
+#define CE_CLANGD_RESPONSE_QUEUE_SIZE 256 // a power of 2
 
 typedef struct{
      int64_t request_id;
-     CeJsonObj_t* obj;
+     CeJsonObj_t* obj; // read only, it lives in the arena and points into the message
      char* method;
+     char* message;
+     CeJsonArena_t arena;
 }CeClangDResponse_t;
 
+// the reader thread pushes and the main thread pops, so neither needs a lock. When it fills up, notifications are
+// dropped and responses to our requests wait for room
 typedef struct{
-     int64_t size;
-     CeClangDResponse_t* elements;
-#if defined(PLATFORM_WINDOWS)
-     HANDLE mutex;
-#else
-     pthread_mutex_t mutex;
-#endif
+     CeClangDResponse_t elements[CE_CLANGD_RESPONSE_QUEUE_SIZE];
+     uint64_t head; // only the main thread moves it
+     uint64_t tail; // only the reader thread moves it
+     bool wake_pending; // a byte is in wake_fds since the main thread last caught up
+     bool closed; // set when shutting down, so a full queue doesn't hold up the reader
+     int wake_fds[2]; // the main thread can poll() wake_fds[0] to hear about new responses, -1 without one
 }CeClangDResponseQueue_t;
 
 typedef struct{
@@ -86,6 +94,19 @@ typedef struct{
     char* filepath;
 }CeClangDDiagnostics_t;
 
+typedef struct{
+     CeBuffer_t* buffer;
+     int64_t version; // bumped with every didChange
+     CeBufferChangeMark_t synced; // the buffer as clangd last saw it
+     uint64_t changed_usec; // when we noticed the buffer move on from what clangd has, 0 if it hasn't
+     bool full_sync_needed; // a didChange didn't make it out, so we can't trust clangd has what synced says
+}CeClangDDocument_t;
+
+typedef struct{
+     CeClangDDocument_t* elements;
+     int64_t count;
+}CeClangDDocuments_t;
+
 typedef struct{
 #if defined(PLATFORM_WINDOWS)
      HANDLE thread_handle;
@@ -100,6 +121,9 @@ typedef struct{
      int64_t current_request_id;
      CeClangDResponseQueue_t response_queue;
      CeClangDRequestLookup_t request_lookup;
+     CeClangDDocuments_t documents;
+     CeJsonWriter_t message_writer; // every message we send is written here, so it keeps its memory between them
+     CeClangDStats_t stats; // read with ce_clangd_stats(), the reader thread is still counting
 }CeClangD_t;
 
 bool ce_clangd_init(const char* executable_path,
@@ -107,7 +131,11 @@ bool ce_clangd_init(const char* executable_path,
 
 bool ce_clangd_file_open(CeClangD_t* clangd, CeBuffer_t* buffer);
 bool ce_clangd_file_close(CeClangD_t* clangd, CeBuffer_t* buffer);
-bool ce_clangd_file_report_changes(CeClangD_t* clangd, CeBuffer_t* buffer, CeBufferChangeNode_t* last_change);
+
+// send the changes made to open files once they have settled for CE_CLANGD_CHANGE_DEBOUNCE_USEC, or right away if forced.
+// Requests force them out so clangd answers about what is on screen
+bool ce_clangd_flush_changes(CeClangD_t* clangd, bool force);
+int64_t ce_clangd_next_flush_usec(CeClangD_t* clangd); // -1 if there is nothing waiting to be sent
 
 bool ce_clangd_request_goto_type_def(CeClangD_t* clangd, CeBuffer_t* buffer, CePoint_t point);
 bool ce_clangd_request_goto_def(CeClangD_t* clangd, CeBuffer_t* buffer, CePoint_t point);
@@ -116,6 +144,8 @@ bool ce_clangd_request_auto_complete(CeClangD_t* clangd, CeBuffer_t* buffer, CeP
 bool ce_clangd_request_find_references(CeClangD_t* clangd, CeBuffer_t* buffer, CePoint_t point);
 
 bool ce_clangd_outstanding_responses(CeClangD_t* clangd);
+int ce_clangd_wake_fd(CeClangD_t* clangd); // readable when there are responses to pop, -1 if there is nothing to poll()
+CeClangDStats_t ce_clangd_stats(CeClangD_t* clangd);
 CeClangDResponse_t ce_clangd_pop_response(CeClangD_t* clangd);
 
 void ce_clangd_free(CeClangD_t* clangd);
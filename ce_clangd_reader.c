@@ -0,0 +1,188 @@
+#include "ce_clangd_reader.h"
+#include "ce.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_HEADER_SIZE 256
+#define MIN_READER_CAPACITY (64 * 1024)
+#define MAX_IDLE_READER_CAPACITY (1024 * 1024)
+
+// clangd's stdout is read into a ring and messages are framed out of it once their whole body is in
+void ce_clangd_stats_count(uint64_t* counter, uint64_t amount){
+#if defined(PLATFORM_WINDOWS)
+     *counter += amount;
+#else
+     __atomic_store_n(counter, *counter + amount, __ATOMIC_RELAXED);
+#endif
+}
+
+static void _reader_copy(CeClangDReader_t* reader, int64_t offset, char* dest, int64_t size){
+     if(size <= 0){
+          return;
+     }
+     int64_t first = (reader->start + offset) & (reader->capacity - 1);
+     int64_t first_size = reader->capacity - first;
+     if(first_size > size){
+          first_size = size;
+     }
+     memcpy(dest, reader->bytes + first, first_size);
+     memcpy(dest + first_size, reader->bytes, size - first_size);
+}
+
+static bool _reader_matches(CeClangDReader_t* reader, int64_t offset, const char* string, int64_t length){
+     for(int64_t i = 0; i < length; i++){
+          if(reader->bytes[(reader->start + offset + i) & (reader->capacity - 1)] != string[i]){
+               return false;
+          }
+     }
+     return true;
+}
+
+static void _reader_consume(CeClangDReader_t* reader, int64_t size){
+     reader->count -= size;
+     reader->start = (reader->count == 0) ? 0 : (reader->start + size) & (reader->capacity - 1);
+}
+
+void ce_clangd_reader_init(CeClangDReader_t* reader){
+     memset(reader, 0, sizeof(*reader));
+     reader->body_size = -1;
+}
+
+void ce_clangd_reader_free(CeClangDReader_t* reader){
+     free(reader->bytes);
+     ce_clangd_reader_init(reader);
+}
+
+bool ce_clangd_reader_reserve(CeClangDReader_t* reader, int64_t free_size){
+     if(reader->capacity - reader->count >= free_size){
+          return true;
+     }
+     int64_t new_capacity = (reader->capacity > 0) ? reader->capacity : MIN_READER_CAPACITY;
+     while(new_capacity - reader->count < free_size){
+          new_capacity *= 2;
+     }
+     char* bytes = malloc(new_capacity);
+     if(bytes == NULL){
+          return false;
+     }
+     _reader_copy(reader, 0, bytes, reader->count);
+     free(reader->bytes);
+     reader->bytes = bytes;
+     reader->capacity = new_capacity;
+     reader->start = 0;
+     return true;
+}
+
+int64_t ce_clangd_reader_free_span(CeClangDReader_t* reader, char** dest){
+     int64_t end = reader->start + reader->count;
+     if(end < reader->capacity){
+          *dest = reader->bytes + end;
+          return reader->capacity - end;
+     }
+     *dest = reader->bytes + (end - reader->capacity);
+     return reader->capacity - reader->count;
+}
+
+void ce_clangd_reader_commit(CeClangDReader_t* reader, int64_t size, CeClangDStats_t* stats){
+     reader->count += size;
+     ce_clangd_stats_count(&stats->bytes_read, size);
+}
+
+// skips whatever comes before the next header, clangd's log shares the pipe with its messages
+static bool _reader_parse_header(CeClangDReader_t* reader, CeClangDStats_t* stats){
+     const char prefix[] = "Content-Length:";
+     const int64_t prefix_len = sizeof(prefix) - 1;
+
+     while(reader->count >= prefix_len){
+          int64_t skip = 0;
+          while(skip + prefix_len <= reader->count && !_reader_matches(reader, skip, prefix, prefix_len)){
+               skip++;
+          }
+          if(skip + prefix_len > reader->count){
+               // keep the tail in case it is the start of a header
+               skip = reader->count - (prefix_len - 1);
+               _reader_consume(reader, skip);
+               ce_clangd_stats_count(&stats->bytes_skipped, skip);
+               return false;
+          }
+          _reader_consume(reader, skip);
+          ce_clangd_stats_count(&stats->bytes_skipped, skip);
+
+          int64_t header_len = -1;
+          for(int64_t i = prefix_len; i + 4 <= reader->count && i + 4 <= MAX_HEADER_SIZE; i++){
+               if(_reader_matches(reader, i, "\r\n\r\n", 4)){
+                    header_len = i + 4;
+                    break;
+               }
+          }
+          if(header_len < 0){
+               if(reader->count < MAX_HEADER_SIZE){
+                    return false;
+               }
+               // it never ended, so look for the next one
+               _reader_consume(reader, 1);
+               ce_clangd_stats_count(&stats->messages_dropped, 1);
+               continue;
+          }
+
+          char header[MAX_HEADER_SIZE + 1];
+          _reader_copy(reader, 0, header, header_len);
+          header[header_len] = 0;
+          _reader_consume(reader, header_len);
+
+          char* end = NULL;
+          long long body_size = strtoll(header + prefix_len, &end, 10);
+          if(end == header + prefix_len || body_size < 0 || body_size > CE_CLANGD_MAX_MESSAGE_SIZE){
+               ce_log("clangd sent a message with a bad header: %s\n", header);
+               ce_clangd_stats_count(&stats->messages_dropped, 1);
+               continue;
+          }
+          reader->body_size = body_size;
+          return true;
+     }
+     return false;
+}
+
+char* ce_clangd_reader_next_message(CeClangDReader_t* reader, CeClangDStats_t* stats){
+     while(true){
+          if(reader->body_size < 0 && !_reader_parse_header(reader, stats)){
+               return NULL;
+          }
+          if(reader->count < reader->body_size){
+               // make room for the rest of the body up front, rather than doubling our way there
+               if(ce_clangd_reader_reserve(reader, reader->body_size - reader->count)){
+                    return NULL;
+               }
+               // drop it, whatever of the body comes in is skipped over looking for the next header
+               ce_log("failed to make room for %" PRId64 " byte clangd message\n", reader->body_size);
+               ce_clangd_stats_count(&stats->messages_dropped, 1);
+               reader->body_size = -1;
+               continue;
+          }
+          char* message = malloc(reader->body_size + 1);
+          if(message == NULL){
+               // the body is all here, so skip it and keep going with the messages after it
+               ce_log("failed to allocate %" PRId64 " byte clangd message\n", reader->body_size);
+               ce_clangd_stats_count(&stats->messages_dropped, 1);
+               _reader_consume(reader, reader->body_size);
+               reader->body_size = -1;
+               continue;
+          }
+          _reader_copy(reader, 0, message, reader->body_size);
+          message[reader->body_size] = 0;
+          _reader_consume(reader, reader->body_size);
+          reader->body_size = -1;
+          ce_clangd_stats_count(&stats->messages_read, 1);
+          return message;
+     }
+}
+
+void ce_clangd_reader_trim(CeClangDReader_t* reader){
+     if(reader->count == 0 && reader->capacity > MAX_IDLE_READER_CAPACITY){
+          free(reader->bytes);
+          reader->bytes = NULL;
+          reader->capacity = 0;
+     }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// frames the Content-Length delimited messages clangd writes to its stdout. It keeps no state outside the reader, so
+// it can be fed bytes without a clangd on the other end
+
+#define CE_CLANGD_MAX_MESSAGE_SIZE (256 * 1024 * 1024) // anything claiming to be bigger is a bad header, not a message
+
+typedef struct{
+     // counted by the reader thread
+     uint64_t bytes_read;
+     uint64_t bytes_skipped; // clangd's log, it shares the pipe with the messages
+     uint64_t messages_read;
+     uint64_t messages_dropped; // bad headers or bodies that weren't json
+     uint64_t notifications_dropped; // the response queue was full
+     // counted as we send
+     uint64_t bytes_written;
+     uint64_t messages_written;
+}CeClangDStats_t;
+
+typedef struct{
+     char* bytes;
+     int64_t capacity; // a power of 2, so positions wrap with a mask
+     int64_t start; // the oldest byte we haven't framed yet
+     int64_t count;
+     int64_t body_size; // -1 until we have parsed the header of the next message
+}CeClangDReader_t;
+
+void ce_clangd_reader_init(CeClangDReader_t* reader);
+void ce_clangd_reader_free(CeClangDReader_t* reader);
+
+// read into the span, then commit however many bytes landed there
+bool ce_clangd_reader_reserve(CeClangDReader_t* reader, int64_t free_size);
+int64_t ce_clangd_reader_free_span(CeClangDReader_t* reader, char** dest); // where the next read can land without wrapping
+void ce_clangd_reader_commit(CeClangDReader_t* reader, int64_t size, CeClangDStats_t* stats);
+
+// returns the next whole message body, which the caller frees, or NULL until more is read
+char* ce_clangd_reader_next_message(CeClangDReader_t* reader, CeClangDStats_t* stats);
+
+void ce_clangd_reader_trim(CeClangDReader_t* reader); // give back what a big message grew the ring to once it is empty
+
+// only the reader thread counts, the main thread reads them through ce_clangd_stats()
+void ce_clangd_stats_count(uint64_t* counter, uint64_t amount);
@@ -1,5 +1,6 @@
 #include "ce_commands.h"
 #include "ce_draw_gui.h"
+#include "ce_draw_term.h"
 
 #include <stdlib.h>
 #include <assert.h>
@@ -36,6 +37,12 @@ static bool get_command_context(CeApp_t* app, CommandContext_t* command_context)
 }
 
 static bool try_save_buffer(CeApp_t* app, CeBuffer_t* buffer){
+     CeAppBufferData_t* buffer_data = buffer->app_data;
+     if(buffer_data->loading || buffer_data->load_incomplete){
+          ce_app_message(app, "'%s' was not completely loaded, refusing to save over it", buffer->name);
+          return false;
+     }
+
      struct stat statbuf;
      if(stat(buffer->name, &statbuf) == 0){
           if(statbuf.st_mtime > buffer->file_modified_time){
@@ -231,6 +238,38 @@ CeCommandStatus_t command_show_jumps(CeCommand_t* command, void* user_data){
      return command_show_info_buffer(command, user_data, app->jump_list_buffer);
 }
 
+CeCommandStatus_t command_show_loop_stats(CeCommand_t* command, void* user_data){
+     if(command->arg_count != 0) return CE_COMMAND_PRINT_HELP;
+     CeApp_t* app = user_data;
+     CeAppLoopStats_t* stats = &app->loop_stats;
+     ce_app_message(app, "%" PRId64 " wakeups (%.1f/s), %" PRId64 " frames (%.1f fps, %.2fms to draw)", stats->wakeups,
+                    stats->wakeups_per_second, stats->frames, stats->frames_per_second, stats->draw_msec_average);
+     return CE_COMMAND_SUCCESS;
+}
+
+CeCommandStatus_t command_show_profile(CeCommand_t* command, void* user_data){
+     CeApp_t* app = user_data;
+     return command_show_info_buffer(command, user_data, app->profile_buffer);
+}
+
+CeCommandStatus_t command_write_profile_trace(CeCommand_t* command, void* user_data){
+     if(command->arg_count > 1) return CE_COMMAND_PRINT_HELP;
+     if(command->arg_count == 1 && command->args[0].type != CE_COMMAND_ARG_STRING) return CE_COMMAND_PRINT_HELP;
+     CeApp_t* app = user_data;
+#if defined(ENABLE_PROFILE)
+     const char* filepath = (command->arg_count == 1) ? command->args[0].string : "ce_trace.json";
+     if(!ce_profile_write_trace(filepath)){
+          ce_app_message(app, "failed to write profile trace to '%s'", filepath);
+          return CE_COMMAND_FAILURE;
+     }
+     ce_app_message(app, "wrote profile trace to '%s'", filepath);
+     return CE_COMMAND_SUCCESS;
+#else
+     ce_app_message(app, "profiling isn't built in, build with ENABLE_PROFILE defined");
+     return CE_COMMAND_NO_ACTION;
+#endif
+}
+
 CeLayout_t* split_layout(CeApp_t* app, bool vertical){
      CeLayout_t* tab_layout = app->tab_list_layout->tab_list.current;
      bool always_add_last = false;
@@ -493,7 +532,7 @@ CeCommandStatus_t command_load_file(CeCommand_t* command, void* user_data){
           ce_app_input(app, "Load File", load_file_input_complete_func);
 
           char* base_directory = buffer_base_directory(command_context.view->buffer);
-          complete_files(&app->input_complete, app->input_view.buffer->lines[0], base_directory);
+          complete_files(&app->input_complete, ce_buffer_line(app->input_view.buffer, 0), base_directory);
           free(base_directory);
           build_complete_list(app->complete_list_buffer, &app->input_complete);
      }
@@ -962,6 +1001,7 @@ CeCommandStatus_t command_switch_buffer(CeCommand_t* command, void* user_data){
 CeCommandStatus_t command_redraw(CeCommand_t* command, void* user_data){
 #if defined(DISPLAY_TERMINAL)
      clear();
+     ce_draw_term_redraw();
 #endif
      return CE_COMMAND_SUCCESS;
 }
@@ -976,7 +1016,7 @@ CeCommandStatus_t command_goto_destination_in_line(CeCommand_t* command, void* u
 
      if(command_context.view->buffer->line_count == 0) return CE_COMMAND_NO_ACTION;
 
-     CeDestination_t destination = scan_line_for_destination(command_context.view->buffer->lines[command_context.view->cursor.y]);
+     CeDestination_t destination = scan_line_for_destination(ce_buffer_line(command_context.view->buffer, command_context.view->cursor.y));
      if(destination.point.x < 0 || destination.point.y < 0){
           ce_app_message(app, "failed to determine file destination at %s:%d", command_context.view->buffer->name, command_context.view->cursor.y);
           return CE_COMMAND_NO_ACTION;
@@ -1014,7 +1054,7 @@ CeCommandStatus_t command_goto_next_destination(CeCommand_t* command, void* user
                if(i == buffer_data->last_goto_destination) break;
           }
 
-          CeDestination_t destination = scan_line_for_destination(buffer->lines[i]);
+          CeDestination_t destination = scan_line_for_destination(ce_buffer_line(buffer, i));
           if(destination.point.x < 0 || destination.point.y < 0) continue;
 
           char* base_directory = buffer_base_directory(buffer);
@@ -1032,7 +1072,7 @@ CeCommandStatus_t command_goto_next_destination(CeCommand_t* command, void* user
 
      // we didn't find anything, and since the user asked for a destination, find this one
      if(buffer_data->last_goto_destination == save_destination && save_destination < buffer->line_count){
-          CeDestination_t destination = scan_line_for_destination(buffer->lines[save_destination]);
+          CeDestination_t destination = scan_line_for_destination(ce_buffer_line(buffer, save_destination));
           if(destination.point.x >= 0 && destination.point.y >= 0){
                CeLayout_t* layout = ce_layout_buffer_in_view(command_context.tab_layout, buffer);
                if(layout) layout->view.scroll.y = save_destination;
@@ -1065,7 +1105,7 @@ CeCommandStatus_t command_goto_prev_destination(CeCommand_t* command, void* user
                if(i == buffer_data->last_goto_destination) break;
           }
 
-          CeDestination_t destination = scan_line_for_destination(buffer->lines[i]);
+          CeDestination_t destination = scan_line_for_destination(ce_buffer_line(buffer, i));
           if(destination.point.x < 0 || destination.point.y < 0) continue;
 
           char* base_directory = buffer_base_directory(buffer);
@@ -1084,7 +1124,7 @@ CeCommandStatus_t command_goto_prev_destination(CeCommand_t* command, void* user
 
      // we didn't find anything, and since the user asked for a destination, find this one
      if(buffer_data->last_goto_destination == save_destination && save_destination < buffer->line_count){
-          CeDestination_t destination = scan_line_for_destination(buffer->lines[save_destination]);
+          CeDestination_t destination = scan_line_for_destination(ce_buffer_line(buffer, save_destination));
           if(destination.point.x >= 0 && destination.point.y >= 0){
                char* base_directory = buffer_base_directory(buffer);
                load_destination_into_view(&app->buffer_node_head, command_context.view, &app->config_options, &app->vim,
@@ -1156,16 +1196,26 @@ CeCommandStatus_t command_reload_file(CeCommand_t* command, void* user_data){
           return CE_COMMAND_NO_ACTION;
      }
 
+     if(app->file_load && app->file_load->buffer == command_context.view->buffer) ce_app_cancel_file_load(app);
+
      char* filename = strdup(command_context.view->buffer->name);
      CeAppBufferData_t* buffer_data = command_context.view->buffer->app_data;
      ce_buffer_free(command_context.view->buffer);
      command_context.view->buffer->app_data = buffer_data; // NOTE: not great that I need to save user data and reset it
-     ce_buffer_load_file(command_context.view->buffer, filename);
+     buffer_data->load_incomplete = false;
+     ce_app_load_file(app, command_context.view->buffer, filename);
      free(filename);
 
      return CE_COMMAND_SUCCESS;
 }
 
+CeCommandStatus_t command_cancel_file_load(CeCommand_t* command, void* user_data){
+     if(command->arg_count != 0) return CE_COMMAND_PRINT_HELP;
+     CeApp_t* app = user_data;
+     if(!ce_app_cancel_file_load(app)) return CE_COMMAND_NO_ACTION;
+     return CE_COMMAND_SUCCESS;
+}
+
 CeCommandStatus_t command_reload_config(CeCommand_t* command, void* user_data){
      if(command->arg_count != 0) return CE_COMMAND_PRINT_HELP;
      CeApp_t* app = user_data;
@@ -1436,9 +1486,9 @@ CeCommandStatus_t command_font_adjust_size(CeCommand_t* command, void* user_data
      if(command->arg_count < 1) return CE_COMMAND_PRINT_HELP;
      if(command->args[0].type != CE_COMMAND_ARG_INTEGER) return CE_COMMAND_PRINT_HELP;
 
-#if defined(DISPLAY_TERMINAL)
+#if !defined(DISPLAY_GUI)
      return CE_COMMAND_SUCCESS;
-#elif defined(DISPLAY_GUI)
+#else
      CeApp_t* app = (CeApp_t*)(user_data);
      CeGui_t* gui = app->gui;
      int new_font_size = gui->font_point_size + command->args[0].integer;
@@ -1570,6 +1620,7 @@ void buffer_replace_all(CeBuffer_t* buffer, CePoint_t cursor, const char* match,
                         bool regex_search){
      bool chain_undo = false;
      int64_t match_len = 0;
+     CeSearch_t search;
 #if !defined(PLATFORM_WINDOWS)
      CeRegex_t regex = NULL;
 #endif
@@ -1587,7 +1638,9 @@ void buffer_replace_all(CeBuffer_t* buffer, CePoint_t cursor, const char* match,
           }
 #endif
      }else{
-           match_len = strlen(match);
+           // compile the pattern once for every match we replace, the length we remove is in runes
+           ce_search_init(&search, match);
+           match_len = search.rune_length;
      }
 
      while(true){
@@ -1604,7 +1657,7 @@ void buffer_replace_all(CeBuffer_t* buffer, CePoint_t cursor, const char* match,
                break;
 #endif
           }else{
-               match_point = ce_buffer_search_forward(buffer, start, match);
+               match_point = ce_buffer_literal_search_forward(buffer, start, &search);
           }
 
           if(match_point.x < 0) break;
@@ -1636,10 +1689,10 @@ void replace_all(CeView_t* view, CeVimVisualSave_t* vim_visual_save, const char*
      }else if(vim_visual_save->mode == CE_VIM_MODE_VISUAL_LINE){
           if(ce_point_after(view->cursor, vim_visual_save->visual_point)){
                start = (CePoint_t){0, vim_visual_save->visual_point.y};
-               end = (CePoint_t){ce_utf8_last_index(view->buffer->lines[view->cursor.y]), view->cursor.y};
+               end = (CePoint_t){ce_utf8_last_index(ce_buffer_line(view->buffer, view->cursor.y)), view->cursor.y};
           }else{
                start = (CePoint_t){0, view->cursor.y};
-               end = (CePoint_t){ce_utf8_last_index(view->buffer->lines[vim_visual_save->visual_point.y]), vim_visual_save->visual_point.y};
+               end = (CePoint_t){ce_utf8_last_index(ce_buffer_line(view->buffer, vim_visual_save->visual_point.y)), vim_visual_save->visual_point.y};
           }
      }else{
           start = view->cursor;
@@ -15,6 +15,9 @@ CeCommandStatus_t command_show_yanks(CeCommand_t* command, void* user_data);
 CeCommandStatus_t command_show_macros(CeCommand_t* command, void* user_data);
 CeCommandStatus_t command_show_marks(CeCommand_t* command, void* user_data);
 CeCommandStatus_t command_show_jumps(CeCommand_t* command, void* user_data);
+CeCommandStatus_t command_show_loop_stats(CeCommand_t* command, void* user_data);
+CeCommandStatus_t command_show_profile(CeCommand_t* command, void* user_data);
+CeCommandStatus_t command_write_profile_trace(CeCommand_t* command, void* user_data);
 CeCommandStatus_t command_balance_layout(CeCommand_t* command, void* user_data);
 CeCommandStatus_t command_split_layout(CeCommand_t* command, void* user_data);
 CeCommandStatus_t command_resize_layout(CeCommand_t* command, void* user_data);
@@ -43,6 +46,7 @@ CeCommandStatus_t command_goto_prev_destination(CeCommand_t* command, void* user
 CeCommandStatus_t command_goto_prev_buffer_in_view(CeCommand_t* command, void* user_data);
 CeCommandStatus_t command_replace_all(CeCommand_t* command, void* user_data);
 CeCommandStatus_t command_reload_file(CeCommand_t* command, void* user_data);
+CeCommandStatus_t command_cancel_file_load(CeCommand_t* command, void* user_data);
 CeCommandStatus_t command_reload_config(CeCommand_t* command, void* user_data);
 CeCommandStatus_t command_syntax(CeCommand_t* command, void* user_data);
 CeCommandStatus_t command_new_buffer(CeCommand_t* command, void* user_data);
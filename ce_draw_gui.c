@@ -6,6 +6,10 @@
 #if defined(DISPLAY_GUI)
 
 #define STATUS_LINE_LEN 128
+#define GLYPH_FIRST ' '
+#define GLYPH_LAST '~'
+#define GLYPH_COUNT ((GLYPH_LAST - GLYPH_FIRST) + 1)
+#define INITIAL_QUAD_CAPACITY 4096
 
 static SDL_Color color_from_index(CeConfigOptions_t* config_options, int index, bool foreground){
     SDL_Color result;
@@ -40,106 +44,221 @@ static SDL_Rect rect_from_view(CeView_t* view, CeGui_t* gui) {
      return result;
 }
 
+static bool _grow_quads(CeGui_t* gui) {
+     int new_capacity = gui->quad_capacity ? gui->quad_capacity * 2 : INITIAL_QUAD_CAPACITY;
+     SDL_Vertex* new_vertices = realloc(gui->quad_vertices, new_capacity * 4 * sizeof(*new_vertices));
+     if(new_vertices == NULL) return false;
+     gui->quad_vertices = new_vertices;
+     int* new_indices = realloc(gui->quad_indices, new_capacity * 6 * sizeof(*new_indices));
+     if(new_indices == NULL) return false;
+     gui->quad_indices = new_indices;
+
+     // every quad is two triangles sharing a diagonal over its own 4 vertices, so the indices never change once written
+     for(int i = gui->quad_capacity; i < new_capacity; i++){
+          int* index = gui->quad_indices + (i * 6);
+          int vertex = i * 4;
+          index[0] = vertex;
+          index[1] = vertex + 1;
+          index[2] = vertex + 2;
+          index[3] = vertex;
+          index[4] = vertex + 2;
+          index[5] = vertex + 3;
+     }
+     gui->quad_capacity = new_capacity;
+     return true;
+}
+
+static void _flush_quads(CeGui_t* gui) {
+     if(gui->quad_count == 0) return;
+     if(SDL_RenderGeometry(gui->renderer, gui->glyph_atlas, gui->quad_vertices, gui->quad_count * 4,
+                           gui->quad_indices, gui->quad_count * 6) != 0){
+          ce_log("SDL_RenderGeometry() failed: %s\n", SDL_GetError());
+     }
+     gui->quad_count = 0;
+}
+
+static void _queue_quad(CeGui_t* gui, SDL_Rect* rect, float u0, float v0, float u1, float v1, SDL_Color* color) {
+     if(gui->quad_count >= gui->quad_capacity && !_grow_quads(gui)){
+          // out of memory, draw what we have and reuse the space
+          _flush_quads(gui);
+          if(gui->quad_capacity == 0) return;
+     }
+
+     SDL_Vertex* vertex = gui->quad_vertices + (gui->quad_count * 4);
+     float left = rect->x;
+     float top = rect->y;
+     float right = rect->x + rect->w;
+     float bottom = rect->y + rect->h;
+     vertex[0] = (SDL_Vertex){{left, top}, *color, {u0, v0}};
+     vertex[1] = (SDL_Vertex){{right, top}, *color, {u1, v0}};
+     vertex[2] = (SDL_Vertex){{right, bottom}, *color, {u1, v1}};
+     vertex[3] = (SDL_Vertex){{left, bottom}, *color, {u0, v1}};
+     gui->quad_count++;
+}
+
+static void _fill_rect(CeGui_t* gui, SDL_Rect* rect, SDL_Color* color) {
+     if(gui->renderer == NULL){
+          SDL_FillRect(gui->window_surface, rect, SDL_MapRGB(gui->window_surface->format, color->r, color->g, color->b));
+          return;
+     }
+
+     // stretch the inside of the solid cell at the end of the atlas, so fills batch in order with the text
+     float u0 = 0.0f;
+     float v0 = 0.0f;
+     float u1 = 0.0f;
+     float v1 = 0.0f;
+     if(gui->glyph_atlas != NULL){
+          u0 = ((GLYPH_COUNT * gui->glyph_width) + 1.0f) / gui->glyph_atlas_width;
+          u1 = (((GLYPH_COUNT + 1) * gui->glyph_width) - 1.0f) / gui->glyph_atlas_width;
+          v0 = 1.0f / gui->glyph_atlas_height;
+          v1 = (gui->glyph_height - 1.0f) / gui->glyph_atlas_height;
+     }
+     SDL_Color opaque = *color;
+     opaque.a = 255;
+     _queue_quad(gui, rect, u0, v0, u1, v1, &opaque);
+}
+
+static void _blit_text_line(const char* line, int64_t pixel_x, int64_t pixel_y,
+                            SDL_Color* text_color, CeGui_t* gui) {
+     SDL_SetSurfaceColorMod(gui->glyph_atlas_surface, text_color->r, text_color->g, text_color->b);
+
+     SDL_Rect glyph_rect;
+     glyph_rect.y = 0;
+     glyph_rect.w = gui->glyph_width;
+     glyph_rect.h = gui->glyph_height;
+
+     int64_t advance = _text_pixel_x(1, gui);
+     for(const char* itr = line; *itr; itr++){
+          unsigned char ch = (unsigned char)(*itr);
+          if(ch > GLYPH_FIRST && ch <= GLYPH_LAST){
+               glyph_rect.x = (ch - GLYPH_FIRST) * gui->glyph_width;
+
+               SDL_Rect rect;
+               rect.x = pixel_x;
+               rect.y = pixel_y;
+               rect.w = glyph_rect.w;
+               rect.h = glyph_rect.h;
+               SDL_BlitSurface(gui->glyph_atlas_surface, &glyph_rect, gui->window_surface, &rect);
+          }
+          pixel_x += advance;
+     }
+}
+
 static void _draw_text_line(const char* line, int64_t pixel_x, int64_t pixel_y,
                             SDL_Color* text_color, CeGui_t* gui) {
-     SDL_Surface* surface = TTF_RenderText_Blended(gui->font, line, *text_color);
+     if(gui->renderer == NULL){
+          if(gui->glyph_atlas_surface != NULL) _blit_text_line(line, pixel_x, pixel_y, text_color, gui);
+          return;
+     }
+     if(gui->glyph_atlas == NULL) return;
 
      SDL_Rect rect;
-     rect.x = pixel_x;
      rect.y = pixel_y;
-     rect.w = surface->w;
-     rect.h = surface->h;
-
-     SDL_BlitSurface(surface, NULL, gui->window_surface, &rect);
-     SDL_FreeSurface(surface);
+     rect.w = gui->glyph_width;
+     rect.h = gui->glyph_height;
+     float cell_u = (float)(gui->glyph_width) / gui->glyph_atlas_width;
+     float cell_v = (float)(gui->glyph_height) / gui->glyph_atlas_height;
+
+     int64_t advance = _text_pixel_x(1, gui);
+     for(const char* itr = line; *itr; itr++){
+          // spaces and anything we don't have a glyph for just take up their cell
+          unsigned char ch = (unsigned char)(*itr);
+          if(ch > GLYPH_FIRST && ch <= GLYPH_LAST){
+               float u = (ch - GLYPH_FIRST) * cell_u;
+               rect.x = pixel_x;
+               _queue_quad(gui, &rect, u, 0.0f, u + cell_u, cell_v, text_color);
+          }
+          pixel_x += advance;
+     }
 }
 
 static void _draw_cursor(CePoint_t* cursor, CeConfigOptions_t* config_options, CeGui_t* gui) {
      SDL_Color color = color_from_index(config_options,
                                         CE_COLOR_FOREGROUND,
                                         false);
-     uint32_t color_packed = SDL_MapRGB(gui->window_surface->format,
-                                        color.r,
-                                        color.g,
-                                        color.b);
      SDL_Rect left_wall;
      left_wall.x = _text_pixel_x(cursor->x, gui) - 1;
      left_wall.y = _text_pixel_y(cursor->y, gui) - 1;
      left_wall.w = 1;
      left_wall.h = _text_pixel_y(1, gui) + 2;
-     SDL_FillRect(gui->window_surface, &left_wall, color_packed);
+     _fill_rect(gui, &left_wall, &color);
 
      SDL_Rect right_wall;
      right_wall.x = _text_pixel_x(cursor->x + 1, gui) + 1;
      right_wall.y = _text_pixel_y(cursor->y, gui) - 1;
      right_wall.w = 1;
      right_wall.h = _text_pixel_y(1, gui) + 2;
-     SDL_FillRect(gui->window_surface, &right_wall, color_packed);
+     _fill_rect(gui, &right_wall, &color);
 
      SDL_Rect top_wall;
      top_wall.x = _text_pixel_x(cursor->x, gui);
      top_wall.y = _text_pixel_y(cursor->y, gui) - 1;
      top_wall.w = _text_pixel_x(1, gui) + 1;
      top_wall.h = 1;
-     SDL_FillRect(gui->window_surface, &top_wall, color_packed);
+     _fill_rect(gui, &top_wall, &color);
 
      SDL_Rect bottom_wall;
      bottom_wall.x = _text_pixel_x(cursor->x, gui);
      bottom_wall.y = _text_pixel_y(cursor->y + 1, gui) + 1;
      bottom_wall.w = _text_pixel_x(1, gui) + 1;
      bottom_wall.h = 1;
-     SDL_FillRect(gui->window_surface, &bottom_wall, color_packed);
+     _fill_rect(gui, &bottom_wall, &color);
 }
 
 static void _append_search_highlight_ranges(const char* pattern, CeLayout_t* layout, CeVim_t* vim, CeRangeList_t* range_list) {
-     int64_t pattern_len = ce_utf8_strlen(pattern);
      int64_t min = layout->view.scroll.y;
      int64_t max = min + (layout->view.rect.bottom - layout->view.rect.top);
      int64_t clamp_max = (layout->view.buffer->line_count - 1);
      CE_CLAMP(min, 0, clamp_max);
      CE_CLAMP(max, 0, clamp_max);
 
-     if(vim->search_mode == CE_VIM_SEARCH_MODE_FORWARD ||
+     // use the buffer's match index when it has what we need, rather than re-scanning the visible lines
+     bool regex_mode = (vim->search_mode == CE_VIM_SEARCH_MODE_REGEX_FORWARD ||
+                   vim->search_mode == CE_VIM_SEARCH_MODE_REGEX_BACKWARD);
+     CeAppBufferData_t* buffer_data = layout->view.buffer->app_data;
+     if(buffer_data && ce_match_index_covers(&buffer_data->vim.search_matches, layout->view.buffer, pattern, regex_mode, max)){
+          ce_range_list_insert_matches(range_list, &buffer_data->vim.search_matches, min, max);
+     }else if(vim->search_mode == CE_VIM_SEARCH_MODE_FORWARD ||
         vim->search_mode == CE_VIM_SEARCH_MODE_BACKWARD){
+          CeSearch_t search;
+          ce_search_init(&search, pattern);
           for(int64_t i = min; i <= max; i++){
-               const char* itr = layout->view.buffer->lines[i];
-               const char* match = strstr(itr, pattern);
-               while(match){
-                    CePoint_t start = {ce_utf8_strlen_between(layout->view.buffer->lines[i], match) - 1, i};
-                    CePoint_t end = {start.x + (pattern_len - 1), i};
+               CeSearchLineItr_t line_itr;
+               ce_search_line_begin(&line_itr, ce_buffer_line(layout->view.buffer, i));
+               int64_t match_index;
+               while((match_index = ce_search_line_next(&search, &line_itr)) >= 0){
+                    CePoint_t start = {match_index, i};
+                    CePoint_t end = {start.x + (search.rune_length - 1), i};
                     ce_range_list_insert(range_list, start, end);
-                    itr = match + pattern_len;
-                    match = strstr(itr, pattern);
                }
           }
      }else if(vim->search_mode == CE_VIM_SEARCH_MODE_REGEX_FORWARD ||
               vim->search_mode == CE_VIM_SEARCH_MODE_REGEX_BACKWARD){
           CeRegex_t regex = NULL;
-          CeRegexResult_t regex_result = ce_regex_init(pattern,
-                                                       &regex);
+          CeRegexResult_t regex_result = ce_regex_cache_get(pattern, &regex);
           if(regex_result.error_message == NULL){
+               CeRegexMatch_t matches[CE_REGEX_SEARCH_MATCH_BATCH];
                for(int64_t i = min; i <= max; i++){
-                    char* itr = layout->view.buffer->lines[i];
-                    int64_t prev_end_x = 0;
-                    while(itr){
-                         regex_result = ce_regex_match(regex, itr);
+                    const char* line = ce_buffer_line(layout->view.buffer, i);
+                    int64_t offset = 0;
+                    int64_t match_count = CE_REGEX_SEARCH_MATCH_BATCH;
+                    while(match_count == CE_REGEX_SEARCH_MATCH_BATCH){
+                         regex_result = ce_regex_match_all(regex, line, offset, matches, CE_REGEX_SEARCH_MATCH_BATCH, &match_count);
                          if(regex_result.error_message != NULL){
                               free(regex_result.error_message);
                               break;
-                         }else{
-                              if(regex_result.match_length > 0){
-                                   CePoint_t start = {prev_end_x + regex_result.match_start, i};
-                                   CePoint_t end = {start.x + (regex_result.match_length - 1), i};
-                                   ce_range_list_insert(range_list, start, end);
-                                   itr = ce_utf8_iterate_to(itr, regex_result.match_start + regex_result.match_length);
-                                   prev_end_x = end.x + 1;
-                              }else{
-                                   break;
-                              }
                          }
+                         for(int64_t m = 0; m < match_count; m++){
+                              if(matches[m].length <= 0) continue;
+                              const char* match_start = line + matches[m].start;
+                              const char* match_end = match_start + matches[m].length;
+                              CePoint_t start = {ce_buffer_line_rune_index(layout->view.buffer, i, match_start), i};
+                              CePoint_t end = {ce_buffer_line_rune_index(layout->view.buffer, i, match_end) - 1, i};
+                              ce_range_list_insert(range_list, start, end);
+                         }
+                         if(match_count > 0) offset = matches[match_count - 1].start + matches[match_count - 1].length;
                     }
                }
-               ce_regex_free(regex);
           }else{
                free(regex_result.error_message);
           }
@@ -151,16 +270,12 @@ static void _draw_view_status(CeView_t* view, CeGui_t* gui, CeVim_t* vim, CeMacr
                               CeConfigOptions_t* config_options) {
      // Draw the status bar.
      SDL_Color ui_bg_color = color_from_index(config_options, config_options->ui_bg_color, false);
-     uint32_t background_color_packed = SDL_MapRGB(gui->window_surface->format,
-                                                   ui_bg_color.r,
-                                                   ui_bg_color.g,
-                                                   ui_bg_color.b);
      SDL_Rect status_rect;
      status_rect.x = _text_pixel_x(view->rect.left, gui);
      status_rect.y = _text_pixel_y(view->rect.bottom, gui);
      status_rect.w = _text_pixel_x((view->rect.right - view->rect.left) + 1, gui);
      status_rect.h = _text_pixel_y(1, gui);
-     SDL_FillRect(gui->window_surface, &status_rect, background_color_packed);
+     _fill_rect(gui, &status_rect, &ui_bg_color);
 
      // Draw the vim mode if there is one.
      const char* vim_mode_string = "";
@@ -215,6 +330,17 @@ static void _draw_view_status(CeView_t* view, CeGui_t* gui, CeVim_t* vim, CeMacr
          snprintf(line_buffer, STATUS_LINE_LEN, "%s", view->buffer->name);
      }
 
+     CeAppBufferData_t* buffer_data = view->buffer->app_data;
+     if(buffer_data && buffer_data->loading){
+         size_t line_len = strlen(line_buffer);
+         snprintf(line_buffer + line_len, STATUS_LINE_LEN - line_len, " LOADING %" PRId64 "%%", buffer_data->load_percent);
+     }
+
+     char match_status[64];
+     if(vim && ce_app_search_match_status(view, match_status, sizeof(match_status))){
+         size_t line_len = strlen(line_buffer);
+         snprintf(line_buffer + line_len, STATUS_LINE_LEN - line_len, " %s", match_status);
+     }
 
      SDL_Color text_color = color_from_index(config_options, config_options->ui_fg_color, true);
 
@@ -234,6 +360,12 @@ static void _draw_view_status(CeView_t* view, CeGui_t* gui, CeVim_t* vim, CeMacr
                     gui);
 }
 
+static CeDrawColor_t* _next_draw_color(CeDrawColorList_t* list, CeDrawColor_t* color){
+     color++;
+     if(color >= list->colors + list->count) return NULL;
+     return color;
+}
+
 static void _draw_view(CeView_t* view, CeGui_t* gui, CeVim_t* vim,
                        CeDrawColorList_t* syntax_color_list, CeSyntaxDef_t* syntax_defs,
                        CeConfigOptions_t* config_options, int terminal_right) {
@@ -265,17 +397,17 @@ static void _draw_view(CeView_t* view, CeGui_t* gui, CeVim_t* vim,
           }
      }
 
-     CeDrawColorNode_t* current_syntax_color_node = NULL;
-     CeDrawColorNode_t* next_syntax_color_node = NULL;
+     CeDrawColor_t* current_syntax_color_node = NULL;
+     CeDrawColor_t* next_syntax_color_node = NULL;
 
      SDL_Color text_color = color_from_index(config_options, CE_COLOR_FOREGROUND, true);
 
-     CeDrawColorNode_t default_node;
+     CeDrawColor_t default_node;
 
-     if(syntax_color_list){
-          current_syntax_color_node = syntax_color_list->head;
+     if(syntax_color_list && syntax_color_list->count > 0){
+          current_syntax_color_node = syntax_color_list->colors;
           if (current_syntax_color_node) {
-               next_syntax_color_node = current_syntax_color_node->next;
+               next_syntax_color_node = _next_draw_color(syntax_color_list, current_syntax_color_node);
                if (current_syntax_color_node->point.x != 0 ||
                    current_syntax_color_node->point.y != 0) {
                     // If the first point in the buffer doesn't have a syntax node, then
@@ -285,7 +417,6 @@ static void _draw_view(CeView_t* view, CeGui_t* gui, CeVim_t* vim,
                     default_node.bg = CE_COLOR_BACKGROUND;
                     default_node.point.x = 0;
                     default_node.point.y = 0;
-                    default_node.next = current_syntax_color_node;
                     next_syntax_color_node = current_syntax_color_node;
                     current_syntax_color_node = &default_node;
                }
@@ -307,16 +438,12 @@ static void _draw_view(CeView_t* view, CeGui_t* gui, CeVim_t* vim,
                SDL_Color color = color_from_index(config_options,
                                                   ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_CURRENT_LINE, CE_COLOR_BLACK),
                                                   false);
-               uint32_t color_packed = SDL_MapRGB(gui->window_surface->format,
-                                                  color.r,
-                                                  color.g,
-                                                  color.b);
                SDL_Rect rect;
                rect.x = _text_pixel_x(view->rect.left, gui);
                rect.y = _text_pixel_y(view->rect.top + draw_y, gui);
                rect.w = _text_pixel_x((view->rect.right - view->rect.left) + 1, gui);
                rect.h = _text_pixel_y(1, gui);
-               SDL_FillRect(gui->window_surface, &rect, color_packed);
+               _fill_rect(gui, &rect, &color);
           }
 
           if (line_index >= view->buffer->line_count) {
@@ -340,17 +467,17 @@ static void _draw_view(CeView_t* view, CeGui_t* gui, CeVim_t* vim,
           }
 
           CePoint_t buffer_point = {buffer_x, line_index};
-          CeDrawColorNode_t* original_next_syntax_color_node = next_syntax_color_node;
+          CeDrawColor_t* original_next_syntax_color_node = next_syntax_color_node;
           while (next_syntax_color_node && !ce_point_after(next_syntax_color_node->point, buffer_point)) {
                original_next_syntax_color_node = next_syntax_color_node;
-               next_syntax_color_node = next_syntax_color_node->next;
+               next_syntax_color_node = _next_draw_color(syntax_color_list, next_syntax_color_node);
           }
 
           if (next_syntax_color_node != original_next_syntax_color_node) {
               current_syntax_color_node = original_next_syntax_color_node;
           }
 
-          const char* line = view->buffer->lines[draw_y + row_min];
+          const char* line = ce_buffer_line(view->buffer, draw_y + row_min);
           size_t line_buffer_index = 0;
 
           while(rune > 0 && buffer_x < col_max){
@@ -379,7 +506,7 @@ static void _draw_view(CeView_t* view, CeGui_t* gui, CeVim_t* vim,
                    while(next_syntax_color_node &&
                          !ce_point_after(next_syntax_color_node->point, buffer_point)){
                         original_next_syntax_color_node = next_syntax_color_node;
-                        next_syntax_color_node = next_syntax_color_node->next;
+                        next_syntax_color_node = _next_draw_color(syntax_color_list, next_syntax_color_node);
                    }
                    if(next_syntax_color_node != original_next_syntax_color_node){
                         line_buffer[line_buffer_index] = 0;
@@ -391,16 +518,12 @@ static void _draw_view(CeView_t* view, CeGui_t* gui, CeVim_t* vim,
                                  SDL_Color bg_color = color_from_index(config_options,
                                                                        current_syntax_color_node->bg,
                                                                        false);
-                                 uint32_t bg_color_packed = SDL_MapRGB(gui->window_surface->format,
-                                                                       bg_color.r,
-                                                                       bg_color.g,
-                                                                       bg_color.b);
                                  SDL_Rect bg_rect;
                                  bg_rect.x = text_pixel_x;
                                  bg_rect.y = text_pixel_y;
                                  bg_rect.w = _text_pixel_x(strlen(line_buffer), gui);
                                  bg_rect.h = _text_pixel_y(1, gui);
-                                 SDL_FillRect(gui->window_surface, &bg_rect, bg_color_packed);
+                                 _fill_rect(gui, &bg_rect, &bg_color);
                             }
                             _draw_text_line(line_buffer, text_pixel_x, text_pixel_y, &text_color, gui);
                             text_pixel_x += _text_pixel_x(strlen(line_buffer), gui);
@@ -426,16 +549,12 @@ static void _draw_view(CeView_t* view, CeGui_t* gui, CeVim_t* vim,
                          SDL_Color bg_color = color_from_index(config_options,
                                                                current_syntax_color_node->bg,
                                                                false);
-                         uint32_t bg_color_packed = SDL_MapRGB(gui->window_surface->format,
-                                                               bg_color.r,
-                                                               bg_color.g,
-                                                               bg_color.b);
                          SDL_Rect bg_rect;
                          bg_rect.x = text_pixel_x;
                          bg_rect.y = text_pixel_y;
                          bg_rect.w = _text_pixel_x(strlen(line_buffer), gui);
                          bg_rect.h = _text_pixel_y(1, gui);
-                         SDL_FillRect(gui->window_surface, &bg_rect, bg_color_packed);
+                         _fill_rect(gui, &bg_rect, &bg_color);
                     }
                }
                _draw_text_line(line_buffer, text_pixel_x, text_pixel_y, &text_color, gui);
@@ -447,16 +566,12 @@ static void _draw_view(CeView_t* view, CeGui_t* gui, CeVim_t* vim,
      // If this view doesn't extend to the right side of the window, draw a ui border.
      if(view->rect.right < terminal_right){
          SDL_Color border_color = color_from_index(config_options, config_options->ui_bg_color, false);
-         uint32_t background_color_packed = SDL_MapRGB(gui->window_surface->format,
-                                                       border_color.r,
-                                                       border_color.g,
-                                                       border_color.b);
          SDL_Rect border_rect;
          border_rect.x = _text_pixel_x(view->rect.right, gui);
          border_rect.y = _text_pixel_y(view->rect.top, gui);
          border_rect.w = _text_pixel_x(1, gui);
          border_rect.h = _text_pixel_y(view_height, gui);
-         SDL_FillRect(gui->window_surface, &border_rect, background_color_packed);
+         _fill_rect(gui, &border_rect, &border_color);
      }
 
      free(line_buffer);
@@ -465,16 +580,17 @@ static void _draw_view(CeView_t* view, CeGui_t* gui, CeVim_t* vim,
 static void _draw_layout(CeLayout_t* layout, CeGui_t* gui, CeVim_t* vim, CeVimVisualData_t* vim_visual,
                          CeMacros_t* macros, CeSyntaxDef_t* syntax_defs,
                          CeConfigOptions_t* config_options, int terminal_right,
-                         const char* highlight_pattern, CeLayout_t* current_layout) {
+                         const char* highlight_pattern, CeLayout_t* current_layout,
+                         CeDrawColorList_t* syntax_color_list, CeRangeList_t* highlight_ranges) {
      switch(layout->type){
      default:
           break;
      case CE_LAYOUT_TYPE_VIEW:
           {
                CeAppBufferData_t* buffer_data = layout->view.buffer->app_data;
-               CeDrawColorList_t syntax_color_list = {};
+               ce_draw_color_list_clear(syntax_color_list);
                if(buffer_data->syntax_function){
-                    CeRangeList_t highlight_ranges = {};
+                    ce_range_list_clear(highlight_ranges);
                     if(layout == current_layout){
                          switch(vim->mode){
                          default:
@@ -483,15 +599,15 @@ static void _draw_layout(CeLayout_t* layout, CeGui_t* gui, CeVim_t* vim, CeVimVi
                          {
                               CeRange_t range = {vim_visual->point, layout->view.cursor};
                               ce_range_sort(&range);
-                              ce_range_list_insert(&highlight_ranges, range.start, range.end);
+                              ce_range_list_insert(highlight_ranges, range.start, range.end);
                          } break;
                          case CE_VIM_MODE_VISUAL_LINE:
                          {
                               CeRange_t range = {vim_visual->point, layout->view.cursor};
                               ce_range_sort(&range);
                               range.start.x = 0;
-                              range.end.x = ce_utf8_last_index(layout->view.buffer->lines[range.end.y]) + 1;
-                              ce_range_list_insert(&highlight_ranges, range.start, range.end);
+                              range.end.x = ce_utf8_last_index(ce_buffer_line(layout->view.buffer, range.end.y)) + 1;
+                              ce_range_list_insert(highlight_ranges, range.start, range.end);
                          } break;
                          case CE_VIM_MODE_VISUAL_BLOCK:
                          {
@@ -509,22 +625,24 @@ static void _draw_layout(CeLayout_t* layout, CeGui_t* gui, CeVim_t* vim, CeVimVi
                               for(int64_t i = range.start.y; i <= range.end.y; i++){
                                    CePoint_t start = {range.start.x, i};
                                    CePoint_t end = {range.end.x, i};
-                                   ce_range_list_insert(&highlight_ranges, start, end);
+                                   ce_range_list_insert(highlight_ranges, start, end);
                               }
                          } break;
                          }
                     }
                     if(highlight_pattern){
-                        _append_search_highlight_ranges(highlight_pattern, layout, vim, &highlight_ranges);
+                        _append_search_highlight_ranges(highlight_pattern, layout, vim, highlight_ranges);
                     }
-                    buffer_data->syntax_function(&layout->view, &highlight_ranges, &syntax_color_list, syntax_defs,
+                    CE_PROFILE_BEGIN(syntax_timer, CE_PROFILE_STAGE_SYNTAX);
+                    buffer_data->syntax_function(&layout->view, highlight_ranges, syntax_color_list, syntax_defs,
                                                  layout->view.buffer->syntax_data);
-                    ce_range_list_free(&highlight_ranges);
+                    CE_PROFILE_END(syntax_timer);
                }
 
-               _draw_view(&layout->view, gui, vim, &syntax_color_list, syntax_defs,
+               CE_PROFILE_BEGIN(draw_view_timer, CE_PROFILE_STAGE_DRAW_VIEW);
+               _draw_view(&layout->view, gui, vim, syntax_color_list, syntax_defs,
                           config_options, terminal_right);
-               ce_draw_color_list_free(&syntax_color_list);
+               CE_PROFILE_END(draw_view_timer);
                _draw_view_status(&layout->view,
                                  gui,
                                  (layout == current_layout) ? vim : NULL,
@@ -535,12 +653,13 @@ static void _draw_layout(CeLayout_t* layout, CeGui_t* gui, CeVim_t* vim, CeVimVi
      case CE_LAYOUT_TYPE_LIST:
           for(int64_t i = 0; i < layout->list.layout_count; i++){
                _draw_layout(layout->list.layouts[i], gui, vim, vim_visual, macros, syntax_defs,
-                            config_options, terminal_right, highlight_pattern, current_layout);
+                            config_options, terminal_right, highlight_pattern, current_layout,
+                            syntax_color_list, highlight_ranges);
           }
           break;
      case CE_LAYOUT_TYPE_TAB:
           _draw_layout(layout->tab.root, gui, vim, vim_visual, macros, syntax_defs, config_options,
-                       terminal_right, highlight_pattern, current_layout);
+                       terminal_right, highlight_pattern, current_layout, syntax_color_list, highlight_ranges);
           break;
      }
 }
@@ -552,21 +671,19 @@ void ce_draw_gui(struct CeApp_t* app, CeGui_t* gui) {
      SDL_Color background_color = color_from_index(&app->config_options,
                                                    CE_COLOR_BACKGROUND,
                                                    false);
-     uint32_t background_color_packed = SDL_MapRGB(gui->window_surface->format,
-                                                   background_color.r,
-                                                   background_color.g,
-                                                   background_color.b);
-     SDL_FillRect(gui->window_surface, NULL, background_color_packed);
+     if(gui->renderer == NULL){
+          SDL_FillRect(gui->window_surface, NULL, SDL_MapRGB(gui->window_surface->format, background_color.r,
+                                                             background_color.g, background_color.b));
+     }else{
+          SDL_SetRenderDrawColor(gui->renderer, background_color.r, background_color.g, background_color.b, 255);
+          SDL_RenderClear(gui->renderer);
+     }
 
      if(tab_list_layout->tab_list.tab_count > 1){
           // Draw the tab line ui background.
           SDL_Color border_color = color_from_index(&app->config_options,
                                                     app->config_options.ui_bg_color,
                                                     false);
-          uint32_t border_color_packed = SDL_MapRGB(gui->window_surface->format,
-                                                    border_color.r,
-                                                    border_color.g,
-                                                    border_color.b);
 
           SDL_Rect border_rect;
           border_rect.x = 0;
@@ -574,7 +691,7 @@ void ce_draw_gui(struct CeApp_t* app, CeGui_t* gui) {
           border_rect.w = _text_pixel_x(app->terminal_rect.right, gui);
           border_rect.h = _text_pixel_y(1, gui);
 
-          SDL_FillRect(gui->window_surface, &border_rect, border_color_packed);
+          _fill_rect(gui, &border_rect, &border_color);
 
           SDL_Color text_color = color_from_index(&app->config_options,
                                                   app->config_options.ui_fg_color,
@@ -592,7 +709,7 @@ void ce_draw_gui(struct CeApp_t* app, CeGui_t* gui) {
                   selected_border_rect.w = _text_pixel_x(strlen(buffer_name) + 2, gui);
                   selected_border_rect.h = _text_pixel_y(1, gui);
 
-                  SDL_FillRect(gui->window_surface, &selected_border_rect, background_color_packed);
+                  _fill_rect(gui, &selected_border_rect, &background_color);
                }
 
                _draw_text_line(buffer_name, text_pixel_x, 0, &text_color, gui);
@@ -605,8 +722,8 @@ void ce_draw_gui(struct CeApp_t* app, CeGui_t* gui) {
      if(app->highlight_search) {
           if(app->input_complete_func == search_input_complete_func &&
              app->input_view.buffer->line_count > 0 &&
-             app->input_view.buffer->lines[0][0] > 0){
-               highlight_pattern = app->input_view.buffer->lines[0];
+             ce_buffer_line(app->input_view.buffer, 0)[0] > 0){
+               highlight_pattern = ce_buffer_line(app->input_view.buffer, 0);
           }else{
                const CeVimYank_t* yank = app->vim.yanks + ce_vim_register_index('/');
                if(yank->text){
@@ -616,12 +733,12 @@ void ce_draw_gui(struct CeApp_t* app, CeGui_t* gui) {
      }
 
      _draw_layout(tab_layout, gui, &app->vim, &app->visual, &app->macros, app->syntax_defs, &app->config_options, app->terminal_rect.right,
-                  highlight_pattern, tab_layout->tab.current);
+                  highlight_pattern, tab_layout->tab.current, &app->draw_color_list, &app->draw_range_list);
 
      if(app->input_complete_func){
           ce_view_follow_cursor(&app->input_view, 0, 0, 0); // NOTE: I don't think anyone wants their settings applied here
           SDL_Rect view_rect = rect_from_view(&app->input_view, gui);
-          SDL_FillRect(gui->window_surface, &view_rect, background_color_packed);
+          _fill_rect(gui, &view_rect, &background_color);
 
           _draw_view(&app->input_view, gui, NULL, NULL, app->syntax_defs,
                      &app->config_options, app->terminal_rect.right);
@@ -640,17 +757,13 @@ void ce_draw_gui(struct CeApp_t* app, CeGui_t* gui) {
                SDL_Color border_color = color_from_index(&app->config_options,
                                                          app->config_options.ui_bg_color,
                                                          false);
-               uint32_t border_color_packed = SDL_MapRGB(gui->window_surface->format,
-                                                         border_color.r,
-                                                         border_color.g,
-                                                         border_color.b);
-               SDL_FillRect(gui->window_surface, &view_rect, border_color_packed);
+               _fill_rect(gui, &view_rect, &border_color);
           }
      }
 
      CeComplete_t* complete = ce_app_is_completing(app);
      if(complete && tab_layout->tab.current->type == CE_LAYOUT_TYPE_VIEW && app->complete_list_buffer->line_count &&
-        strlen(app->complete_list_buffer->lines[0])){
+        strlen(ce_buffer_line(app->complete_list_buffer, 0))){
           CeLayout_t* view_layout = tab_layout->tab.current;
           app->complete_view.rect.left = view_layout->view.rect.left;
           app->complete_view.rect.right = view_layout->view.rect.right;
@@ -675,7 +788,7 @@ void ce_draw_gui(struct CeApp_t* app, CeGui_t* gui) {
           ce_view_follow_cursor(&app->complete_view, 0, 0, 0); // NOTE: I don't think anyone wants their settings applied here
 
           SDL_Rect view_rect = rect_from_view(&app->complete_view, gui);
-          SDL_FillRect(gui->window_surface, &view_rect, background_color_packed);
+          _fill_rect(gui, &view_rect, &background_color);
 
           // Draw top border
           view_rect.x = _text_pixel_x(app->complete_view.rect.left, gui);
@@ -686,23 +799,18 @@ void ce_draw_gui(struct CeApp_t* app, CeGui_t* gui) {
                SDL_Color border_color = color_from_index(&app->config_options,
                                                          app->config_options.ui_bg_color,
                                                          false);
-               uint32_t border_color_packed = SDL_MapRGB(gui->window_surface->format,
-                                                         border_color.r,
-                                                         border_color.g,
-                                                         border_color.b);
-               SDL_FillRect(gui->window_surface, &view_rect, border_color_packed);
+               _fill_rect(gui, &view_rect, &border_color);
           }
 
-          CeDrawColorList_t draw_color_list = {};
-          CeRangeList_t highlight_ranges = {};
+          ce_draw_color_list_clear(&app->draw_color_list);
+          ce_range_list_clear(&app->draw_range_list);
           CeAppBufferData_t* buffer_data = app->complete_view.buffer->app_data;
           if (buffer_data->syntax_function) {
-               buffer_data->syntax_function(&app->complete_view, &highlight_ranges, &draw_color_list, app->syntax_defs,
+               buffer_data->syntax_function(&app->complete_view, &app->draw_range_list, &app->draw_color_list, app->syntax_defs,
                                             app->complete_view.buffer->syntax_data);
-               ce_range_list_free(&highlight_ranges);
           }
 
-          _draw_view(&app->complete_view, gui, NULL, &draw_color_list,
+          _draw_view(&app->complete_view, gui, NULL, &app->draw_color_list,
                      app->syntax_defs, &app->config_options, app->terminal_rect.right);
      }
 
@@ -713,18 +821,14 @@ void ce_draw_gui(struct CeApp_t* app, CeGui_t* gui) {
           SDL_Color border_color = color_from_index(&app->config_options,
                                                     app->config_options.ui_bg_color,
                                                     false);
-          uint32_t border_color_packed = SDL_MapRGB(gui->window_surface->format,
-                                                    border_color.r,
-                                                    border_color.g,
-                                                    border_color.b);
           SDL_Rect border_rect = view_rect;
           border_rect.x -= _text_pixel_x(1, gui);
           border_rect.y -= _text_pixel_x(1, gui); // intentionally x !
           border_rect.w += _text_pixel_x(1, gui);
           border_rect.h += _text_pixel_x(1, gui); // intentionally x !
 
-          SDL_FillRect(gui->window_surface, &border_rect, border_color_packed);
-          SDL_FillRect(gui->window_surface, &view_rect, background_color_packed);
+          _fill_rect(gui, &border_rect, &border_color);
+          _fill_rect(gui, &view_rect, &background_color);
 
           app->clangd_completion.view.cursor.x = 0;
           app->clangd_completion.view.cursor.y = ce_complete_current_match(app->clangd_completion.complete);
@@ -732,23 +836,22 @@ void ce_draw_gui(struct CeApp_t* app, CeGui_t* gui) {
           app->clangd_completion.view.scroll.x = 0;
           ce_view_follow_cursor(&app->clangd_completion.view, 0, 0, 0);
 
-          CeDrawColorList_t draw_color_list = {};
-          CeRangeList_t highlight_ranges = {};
+          ce_draw_color_list_clear(&app->draw_color_list);
+          ce_range_list_clear(&app->draw_range_list);
           CeAppBufferData_t* buffer_data = app->clangd_completion.buffer->app_data;
           if (buffer_data->syntax_function) {
-               buffer_data->syntax_function(&app->clangd_completion.view, &highlight_ranges, &draw_color_list, app->syntax_defs,
+               buffer_data->syntax_function(&app->clangd_completion.view, &app->draw_range_list, &app->draw_color_list, app->syntax_defs,
                                             app->clangd_completion.buffer->syntax_data);
-               ce_range_list_free(&highlight_ranges);
           }
 
-          _draw_view(&app->clangd_completion.view, gui, NULL, &draw_color_list,
+          _draw_view(&app->clangd_completion.view, gui, NULL, &app->draw_color_list,
                      app->syntax_defs, &app->config_options, app->terminal_rect.right);
      }
 
      if(app->message_mode){
-          CeDrawColorList_t draw_color_list = {};
-          ce_draw_color_list_insert(&draw_color_list, CE_COLOR_RED, app->config_options.ui_bg_color, (CePoint_t){0, 0});
-          _draw_view(&app->message_view, gui, NULL, &draw_color_list,
+          ce_draw_color_list_clear(&app->draw_color_list);
+          ce_draw_color_list_insert(&app->draw_color_list, CE_COLOR_RED, app->config_options.ui_bg_color, (CePoint_t){0, 0});
+          _draw_view(&app->message_view, gui, NULL, &app->draw_color_list,
                      app->syntax_defs, &app->config_options, app->terminal_rect.right);
      }
 
@@ -767,11 +870,98 @@ void ce_draw_gui(struct CeApp_t* app, CeGui_t* gui) {
           _draw_cursor(&cursor, &app->config_options, gui);
      }
 
-     SDL_UpdateWindowSurface(gui->window);
+     if(gui->renderer == NULL){
+          SDL_UpdateWindowSurface(gui->window);
+          return;
+     }
+
+     _flush_quads(gui);
+
+     // reading a pixel back waits for the frame to finish rasterizing. Without it, a GL driver that doesn't block on
+     // present (llvmpipe with no display to sync to) lets frames queue up and then stalls for hundreds of ms to catch up
+     Uint32 pixel;
+     SDL_Rect pixel_rect = {0, 0, 1, 1};
+     SDL_RenderReadPixels(gui->renderer, &pixel_rect, SDL_PIXELFORMAT_ARGB8888, &pixel, sizeof(pixel));
+     SDL_RenderPresent(gui->renderer);
+}
+
+static void _free_glyph_atlas(CeGui_t* gui) {
+     if (gui->glyph_atlas != NULL) {
+          SDL_DestroyTexture(gui->glyph_atlas);
+          gui->glyph_atlas = NULL;
+     }
+     if (gui->glyph_atlas_surface != NULL) {
+          SDL_FreeSurface(gui->glyph_atlas_surface);
+          gui->glyph_atlas_surface = NULL;
+     }
+}
+
+static void _build_glyph_atlas(CeGui_t* gui) {
+     _free_glyph_atlas(gui);
+
+     SDL_Color white = {255, 255, 255, 255};
+     SDL_Surface* glyphs[GLYPH_COUNT];
+
+     // cells are at least as wide as we space characters, but don't clip glyphs that hang over
+     gui->glyph_width = _text_pixel_x(1, gui);
+     gui->glyph_height = TTF_FontHeight(gui->font);
+     for (int i = 0; i < GLYPH_COUNT; i++) {
+          glyphs[i] = TTF_RenderGlyph_Blended(gui->font, (uint16_t)(GLYPH_FIRST + i), white);
+          if (glyphs[i] == NULL) continue;
+          if (glyphs[i]->w > gui->glyph_width) gui->glyph_width = glyphs[i]->w;
+          if (glyphs[i]->h > gui->glyph_height) gui->glyph_height = glyphs[i]->h;
+     }
+
+     // one extra cell on the end is left solid white for filling rects
+     SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, gui->glyph_width * (GLYPH_COUNT + 1), gui->glyph_height, 32,
+                                                         SDL_PIXELFORMAT_ARGB8888);
+     if (atlas == NULL) {
+          ce_log("SDL_CreateRGBSurfaceWithFormat() failed: %s\n", SDL_GetError());
+     }
+
+     for (int i = 0; i < GLYPH_COUNT; i++) {
+          if (glyphs[i] == NULL) continue;
+          if (atlas != NULL) {
+               // copy the glyph's alpha into the atlas rather than blending it onto nothing
+               SDL_SetSurfaceBlendMode(glyphs[i], SDL_BLENDMODE_NONE);
+               SDL_Rect rect;
+               rect.x = i * gui->glyph_width;
+               rect.y = 0;
+               rect.w = glyphs[i]->w;
+               rect.h = glyphs[i]->h;
+               SDL_BlitSurface(glyphs[i], NULL, atlas, &rect);
+          }
+          SDL_FreeSurface(glyphs[i]);
+     }
+
+     if (atlas == NULL) return;
+
+     SDL_Rect solid_rect;
+     solid_rect.x = GLYPH_COUNT * gui->glyph_width;
+     solid_rect.y = 0;
+     solid_rect.w = gui->glyph_width;
+     solid_rect.h = gui->glyph_height;
+     SDL_FillRect(atlas, &solid_rect, SDL_MapRGBA(atlas->format, 255, 255, 255, 255));
+
+     if (gui->renderer == NULL) {
+          SDL_SetSurfaceBlendMode(atlas, SDL_BLENDMODE_BLEND);
+          gui->glyph_atlas_surface = atlas;
+          return;
+     }
+
+     gui->glyph_atlas = SDL_CreateTextureFromSurface(gui->renderer, atlas);
+     if (gui->glyph_atlas == NULL) {
+          ce_log("SDL_CreateTextureFromSurface() failed: %s\n", SDL_GetError());
+     } else {
+          SDL_SetTextureBlendMode(gui->glyph_atlas, SDL_BLENDMODE_BLEND);
+          gui->glyph_atlas_width = atlas->w;
+          gui->glyph_atlas_height = atlas->h;
+     }
+     SDL_FreeSurface(atlas);
 }
 
 int gui_load_font(CeGui_t* gui, const char* font_filepath, int font_point_size, int font_line_separation) {
-     if (gui->font == NULL) {
+     if (gui->font != NULL) {
           TTF_CloseFont(gui->font);
      }
 
@@ -785,9 +975,25 @@ int gui_load_font(CeGui_t* gui, const char* font_filepath, int font_point_size,
          return 1;
      }
 
+     TTF_SetFontHinting(gui->font, TTF_HINTING_MONO);
+     _build_glyph_atlas(gui);
      return 0;
 }
 
+void gui_free_font(CeGui_t* gui) {
+     _free_glyph_atlas(gui);
+     free(gui->quad_vertices);
+     free(gui->quad_indices);
+     gui->quad_vertices = NULL;
+     gui->quad_indices = NULL;
+     gui->quad_count = 0;
+     gui->quad_capacity = 0;
+     if (gui->font != NULL) {
+          TTF_CloseFont(gui->font);
+          gui->font = NULL;
+     }
+}
+
 #else
 void ce_draw_gui(struct CeApp_t* app, CeGui_t* gui) {
 }
@@ -1,8 +1,6 @@
 #pragma once
 
 // TODO:
-// - Performance: Draw all characters on a surface for each color on init. Then while drawing just
-//                copy from the font color surface to the final surface.
 // - Select parent layout, I don't remember what you do with that though.
 // - Display when line extends passed the view
 
@@ -12,9 +10,25 @@
 
 typedef struct{
     SDL_Window* window;
+    SDL_Renderer* renderer; // NULL when there is no accelerated renderer, then we draw straight onto window_surface
     SDL_Surface* window_surface;
     TTF_Font* font;
 
+    // printable ascii rendered once in white when the font is loaded, followed by one solid white cell. With a
+    // renderer, glyphs and filled rects are both queued as vertex colored quads into the texture and drawn in one
+    // batch per frame. Without one, each glyph is tinted and blitted from the surface
+    SDL_Texture* glyph_atlas;
+    SDL_Surface* glyph_atlas_surface;
+    int glyph_atlas_width;
+    int glyph_atlas_height;
+    int glyph_width;
+    int glyph_height;
+
+    SDL_Vertex* quad_vertices;
+    int* quad_indices;
+    int quad_count;
+    int quad_capacity;
+
     const char* application_name;
     int window_width;
     int window_height;
@@ -23,6 +37,7 @@ typedef struct{
 }CeGui_t;
 
 int gui_load_font(CeGui_t* gui, const char* font_filepath, int font_point_size, int font_line_separation);
+void gui_free_font(CeGui_t* gui);
 
 #else
 typedef struct{
@@ -3,10 +3,172 @@
 
 #if defined(DISPLAY_TERMINAL)
 
+#include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ncurses.h>
 
+typedef struct{
+     CeRune_t rune;
+     int16_t color_pair;
+     bool moved_to; // drawing moved here before writing the cell, so writing the row out moves here too
+}CeTermCell_t;
+
+// the frame is drawn into cells, then only the rows that differ from what the terminal shows are handed to curses
+typedef struct{
+     CeTermCell_t* cells;
+     CeTermCell_t* shown_cells;
+     int64_t width;
+     int64_t height;
+     int64_t x;
+     int64_t y;
+     int16_t color_pair;
+     bool redraw; // the terminal may not show shown_cells, so write out every row
+     CeColorDefs_t color_defs; // kept between frames so the same colors keep the same pairs
+     int64_t rows_written;
+}CeTermFrame_t;
+
+static CeTermFrame_t g_term_frame;
+
+static bool _term_frame_begin(int64_t width, int64_t height){
+     CeTermFrame_t* frame = &g_term_frame;
+     if(width != frame->width || height != frame->height || !frame->cells){
+          free(frame->cells);
+          free(frame->shown_cells);
+          frame->cells = calloc(width * height, sizeof(*frame->cells));
+          frame->shown_cells = calloc(width * height, sizeof(*frame->shown_cells));
+          if(!frame->cells || !frame->shown_cells){
+               free(frame->cells);
+               free(frame->shown_cells);
+               frame->cells = NULL;
+               frame->shown_cells = NULL;
+               frame->width = 0;
+               frame->height = 0;
+               return false;
+          }
+          frame->width = width;
+          frame->height = height;
+          frame->redraw = true;
+     }
+
+     // anything not drawn over this frame keeps showing what it did, like it would if we drew straight to curses
+     for(int64_t i = 0; i < width * height; i++){
+          frame->cells[i] = frame->shown_cells[i];
+          frame->cells[i].moved_to = false;
+     }
+
+     frame->x = 0;
+     frame->y = 0;
+     frame->color_pair = 0;
+     frame->rows_written = 0;
+     return true;
+}
+
+static void _term_move(int64_t y, int64_t x){
+     g_term_frame.y = y;
+     g_term_frame.x = x;
+     if(y >= 0 && y < g_term_frame.height && x >= 0 && x < g_term_frame.width){
+          g_term_frame.cells[y * g_term_frame.width + x].moved_to = true;
+     }
+}
+
+static void _term_color(int color_pair){
+     g_term_frame.color_pair = color_pair;
+}
+
+static void _term_rune(CeRune_t rune){
+     CeTermFrame_t* frame = &g_term_frame;
+     if(frame->y >= 0 && frame->y < frame->height && frame->x >= 0 && frame->x < frame->width){
+          CeTermCell_t* cell = frame->cells + (frame->y * frame->width + frame->x);
+          cell->rune = rune;
+          cell->color_pair = frame->color_pair;
+     }
+     frame->x++;
+}
+
+static void _term_string(const char* string){
+     int64_t rune_len = 0;
+     while(*string){
+          CeRune_t rune = ce_utf8_decode(string, &rune_len);
+          if(rune_len <= 0) break;
+          _term_rune(rune);
+          string += rune_len;
+     }
+}
+
+static void _term_printf(const char* format, ...){
+     char string[BUFSIZ];
+     va_list args;
+     va_start(args, format);
+     vsnprintf(string, sizeof(string), format, args);
+     va_end(args);
+     _term_string(string);
+}
+
+static bool _term_cells_equal(const CeTermCell_t* a, const CeTermCell_t* b, int64_t count){
+     for(int64_t i = 0; i < count; i++){
+          if(a[i].rune != b[i].rune || a[i].color_pair != b[i].color_pair) return false;
+     }
+     return true;
+}
+
+// hand curses the rows that changed, the same way they were drawn
+static void _term_frame_end(void){
+     CeTermFrame_t* frame = &g_term_frame;
+     for(int64_t y = 0; y < frame->height; y++){
+          CeTermCell_t* row = frame->cells + (y * frame->width);
+          CeTermCell_t* shown_row = frame->shown_cells + (y * frame->width);
+          if(!frame->redraw && _term_cells_equal(row, shown_row, frame->width)) continue;
+
+          move(y, 0);
+          int16_t color_pair = -1;
+          for(int64_t x = 0; x < frame->width; x++){
+               CeTermCell_t* cell = row + x;
+               if(cell->moved_to) move(y, x);
+               if(cell->color_pair != color_pair){
+                    color_pair = cell->color_pair;
+                    standend();
+                    if(color_pair) attron(COLOR_PAIR(color_pair));
+               }
+
+               if(cell->rune >= 0x80){
+                    char utf8_string[CE_UTF8_SIZE + 1];
+                    int64_t bytes_written = 0;
+                    ce_utf8_encode(cell->rune, utf8_string, CE_UTF8_SIZE, &bytes_written);
+                    utf8_string[bytes_written] = 0;
+                    addstr(utf8_string);
+               }else if(cell->rune > 0){
+                    addch(cell->rune);
+               }else{
+                    addch(' ');
+               }
+          }
+
+          memcpy(shown_row, row, frame->width * sizeof(*row));
+          frame->rows_written++;
+     }
+
+     frame->redraw = false;
+     standend();
+
+     // once every pair is used they start getting redefined, which changes cells curses already shows
+     if(frame->color_defs.count >= 256){
+          memset(&frame->color_defs, 0, sizeof(frame->color_defs));
+          frame->redraw = true;
+     }
+}
+
+void ce_draw_term_redraw(void){
+     g_term_frame.redraw = true;
+}
+
+void ce_draw_term_free(void){
+     free(g_term_frame.cells);
+     free(g_term_frame.shown_cells);
+     memset(&g_term_frame, 0, sizeof(g_term_frame));
+}
+
 static void _draw_view(CeView_t* view, int64_t tab_width, CeLineNumber_t line_number, CeVisualLineDisplayType_t visual_line_display_type,
                        CeDrawColorList_t* draw_color_list, CeColorDefs_t* color_defs, CeSyntaxDef_t* syntax_defs,
                        int64_t terminal_right, CeRune_t show_line_extends_passed_view_as){
@@ -20,7 +182,9 @@ static void _draw_view(CeView_t* view, int64_t tab_width, CeLineNumber_t line_nu
      memset(tab_str, ' ', tab_width);
      tab_str[tab_width] = 0;
 
-     CeDrawColorNode_t* draw_color_node = draw_color_list->head;
+     CeDrawColor_t* draw_color_node = draw_color_list->colors;
+     CeDrawColor_t* draw_color_end = draw_color_list->colors + draw_color_list->count;
+     if(draw_color_node == draw_color_end) draw_color_node = NULL;
 
      // figure out how wide the line number margin needs to be
      int line_number_size = 0;
@@ -41,7 +205,7 @@ static void _draw_view(CeView_t* view, int64_t tab_width, CeLineNumber_t line_nu
                CeRune_t rune = 1;
                int64_t real_y = y + view->scroll.y;
 
-               move(view->rect.top + y, view->rect.left);
+               _term_move(view->rect.top + y, view->rect.left);
 
                if(!view->buffer->no_line_numbers && line_number){
                     int fg = CE_COLOR_DEFAULT;
@@ -53,26 +217,26 @@ static void _draw_view(CeView_t* view, int64_t tab_width, CeLineNumber_t line_nu
                     fg = ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_LINE_NUMBER, fg);
                     bg = ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_LINE_NUMBER, bg);
                     int change_color_pair = ce_color_def_get(color_defs, fg, bg);
-                    attron(COLOR_PAIR(change_color_pair));
+                    _term_color(change_color_pair);
                     int value = real_y + 1;
                     if(line_number == CE_LINE_NUMBER_RELATIVE || (line_number == CE_LINE_NUMBER_ABSOLUTE_AND_RELATIVE && view->cursor.y != real_y)){
                          value = abs((int)(view->cursor.y - real_y));
                     }
-                    printw("%*d ", line_number_size, value);
+                    _term_printf("%*d ", line_number_size, value);
                }
 
-               standend();
+               _term_color(0);
                if(!view->buffer->no_highlight_current_line && real_y == view->cursor.y){
                     int bg = ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_CURRENT_LINE, CE_COLOR_DEFAULT);
                     int change_color_pair = ce_color_def_get(color_defs, CE_COLOR_DEFAULT, bg);
-                    attron(COLOR_PAIR(change_color_pair));
+                    _term_color(change_color_pair);
                }else if(draw_color_node && ce_point_after((CePoint_t){index, y + view->scroll.y}, draw_color_node->point)){
                     int change_color_pair = ce_color_def_get(color_defs, draw_color_node->fg, draw_color_node->bg);
-                    attron(COLOR_PAIR(change_color_pair));
+                    _term_color(change_color_pair);
                }
 
                if(line_index < view->buffer->line_count){
-                    const char* line = view->buffer->lines[y + row_min];
+                    const char* line = ce_buffer_line(view->buffer, y + row_min);
 
                     while(rune > 0){
                          rune = ce_utf8_decode(line, &rune_len);
@@ -85,8 +249,9 @@ static void _draw_view(CeView_t* view, int64_t tab_width, CeLineNumber_t line_nu
                               }
 
                               int change_color_pair = ce_color_def_get(color_defs, draw_color_node->fg, bg);
-                              attron(COLOR_PAIR(change_color_pair));
-                              draw_color_node = draw_color_node->next;
+                              _term_color(change_color_pair);
+                              draw_color_node++;
+                              if(draw_color_node == draw_color_end) draw_color_node = NULL;
                          }
 
                          const char* look_ahead = line + rune_len;
@@ -104,23 +269,23 @@ static void _draw_view(CeView_t* view, int64_t tab_width, CeLineNumber_t line_nu
                               int new_bg = ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_LINE_EXTENDS_PASSED_VIEW, CE_COLOR_DEFAULT);
                               int new_fg = ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_LINE_EXTENDS_PASSED_VIEW, CE_COLOR_DEFAULT);
                               int change_color_pair = ce_color_def_get(color_defs, new_fg, new_bg);
-                              attron(COLOR_PAIR(change_color_pair));
-                              addch(show_line_extends_passed_view_as);
-                              standend();
+                              _term_color(change_color_pair);
+                              _term_rune(show_line_extends_passed_view_as);
+                              _term_color(0);
                               x++;
                          }else if(x >= col_min && rune > 0){
                               if(rune == CE_TAB){
                                    x += tab_width;
-                                   addstr(tab_str);
+                                   _term_string(tab_str);
                               }else if(rune >= 0x80){
                                    char utf8_string[CE_UTF8_SIZE + 1];
                                    int64_t bytes_written = 0;
                                    ce_utf8_encode(rune, utf8_string, CE_UTF8_SIZE, &bytes_written);
                                    utf8_string[bytes_written] = 0;
-                                   addstr(utf8_string);
+                                   _term_string(utf8_string);
                                    x++;
                               }else{
-                                   addch(rune);
+                                   _term_rune(rune);
                                    x++;
                               }
                          }else if(rune == CE_TAB){
@@ -141,25 +306,25 @@ static void _draw_view(CeView_t* view, int64_t tab_width, CeLineNumber_t line_nu
                default:
                     break;
                case CE_VISUAL_LINE_DISPLAY_TYPE_FULL_LINE:
-                    for(; x <= col_max; x++) addch(' ');
+                    for(; x <= col_max; x++) _term_rune(' ');
                     break;
                case CE_VISUAL_LINE_DISPLAY_TYPE_INCLUDE_NEWLINE:
-                    addch(' ');
+                    _term_rune(' ');
                     x++;
                // intentional fall through
                case CE_VISUAL_LINE_DISPLAY_TYPE_EXCLUDE_NEWLINE:
-                    standend();
+                    _term_color(0);
                     if(!view->buffer->no_highlight_current_line && real_y == view->cursor.y){
                          int bg = ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_CURRENT_LINE, CE_COLOR_DEFAULT);
                          int change_color_pair = ce_color_def_get(color_defs, CE_COLOR_DEFAULT, bg);
-                         attron(COLOR_PAIR(change_color_pair));
+                         _term_color(change_color_pair);
                     }
-                    for(; x <= col_max; x++) addch(' ');
+                    for(; x <= col_max; x++) _term_rune(' ');
                     break;
                }
           }
      }else{
-          standend();
+          _term_color(0);
      }
 }
 
@@ -168,11 +333,11 @@ void _draw_view_status(CeView_t* view, CeVim_t* vim, CeMacros_t* macros,
      // create bottom bar bg
      int64_t bottom = view->rect.bottom + height_offset;
      int color_pair = ce_color_def_get(color_defs, ui_fg_color, ui_bg_color);
-     attron(COLOR_PAIR(color_pair));
+     _term_color(color_pair);
      int64_t width = (view->rect.right - view->rect.left) + 1;
-     move(bottom, view->rect.left);
+     _term_move(bottom, view->rect.left);
      for(int64_t i = 0; i < width; ++i){
-          addch(' ');
+          _term_rune(' ');
      }
 
      // set the mode line
@@ -212,49 +377,109 @@ void _draw_view_status(CeView_t* view, CeVim_t* vim, CeMacros_t* macros,
 
      if(vim_mode_string){
           color_pair = ce_color_def_get(color_defs, vim_mode_fg, ui_bg_color);
-          attron(COLOR_PAIR(color_pair));
-          mvprintw(bottom, view->rect.left + 1, "%s", vim_mode_string);
+          _term_color(color_pair);
+          _term_move(bottom, view->rect.left + 1);
+          _term_printf("%s", vim_mode_string);
 
           color_pair = ce_color_def_get(color_defs, ui_fg_color, ui_bg_color);
-          attron(COLOR_PAIR(color_pair));
-          printw(" %s", view->buffer->name);
+          _term_color(color_pair);
+          _term_printf(" %s", view->buffer->name);
      }else{
           color_pair = ce_color_def_get(color_defs, ui_fg_color, ui_bg_color);
-          attron(COLOR_PAIR(color_pair));
-          mvprintw(bottom, view->rect.left + 1, "%s", view->buffer->name);
+          _term_color(color_pair);
+          _term_move(bottom, view->rect.left + 1);
+          _term_printf("%s", view->buffer->name);
      }
 
      const char* status_str = ce_buffer_status_get_str(view->buffer->status);
-     if(status_str) printw("%s", status_str);
+     if(status_str) _term_printf("%s", status_str);
+
+     CeAppBufferData_t* buffer_data = view->buffer->app_data;
+     if(buffer_data && buffer_data->loading) _term_printf(" LOADING %"PRId64"%%", buffer_data->load_percent);
+
+     char match_status[64];
+     if(vim_mode_string && ce_app_search_match_status(view, match_status, sizeof(match_status))){
+          _term_printf(" %s", match_status);
+     }
 
      if(vim_mode_string && ce_macros_is_recording(macros)){
-          printw(" RECORDING %c", macros->recording);
+          _term_printf(" RECORDING %c", macros->recording);
      }
 
 #ifdef ENABLE_DEBUG_KEY_PRESS_INFO
-     if(vim_mode_string) printw(" %s %d ", keyname(g_last_key), g_last_key);
+     if(vim_mode_string) _term_printf(" %s %d ", keyname(g_last_key), g_last_key);
 #endif
 
      char cursor_pos_string[32];
      int64_t cursor_pos_string_len = snprintf(cursor_pos_string, 32, "%"PRId64", %"PRId64"", view->cursor.x + 1, view->cursor.y + 1);
-     mvprintw(bottom, view->rect.right - (cursor_pos_string_len + 1), "%s", cursor_pos_string);
+     _term_move(bottom, view->rect.right - (cursor_pos_string_len + 1));
+     _term_printf("%s", cursor_pos_string);
+}
+
+static bool _view_highlight_unchanged(const CeAppViewHighlight_t* last_highlight, const CeView_t* view,
+                                      CeSyntaxHighlightFunc_t* syntax_function, CeSyntaxDef_t* syntax_defs,
+                                      const CeRangeList_t* range_list){
+     if(last_highlight->syntax_function != syntax_function ||
+        last_highlight->syntax_defs != syntax_defs ||
+        last_highlight->buffer != view->buffer ||
+        last_highlight->buffer_version != view->buffer->version ||
+        last_highlight->syntax_generation != ce_syntax_generation() ||
+        memcmp(&last_highlight->rect, &view->rect, sizeof(view->rect)) != 0 ||
+        !ce_points_equal(last_highlight->scroll, view->scroll) ||
+        !ce_points_equal(last_highlight->cursor, view->cursor) ||
+        last_highlight->ranges.count != range_list->count){
+          return false;
+     }
+
+     for(int64_t i = 0; i < range_list->count; i++){
+          if(!ce_points_equal(last_highlight->ranges.ranges[i].start, range_list->ranges[i].start) ||
+             !ce_points_equal(last_highlight->ranges.ranges[i].end, range_list->ranges[i].end)){
+               return false;
+          }
+     }
+
+     return true;
+}
+
+static void _view_highlight_save(CeAppViewHighlight_t* last_highlight, const CeView_t* view,
+                                 CeSyntaxHighlightFunc_t* syntax_function, CeSyntaxDef_t* syntax_defs,
+                                 const CeRangeList_t* range_list){
+     last_highlight->syntax_function = syntax_function;
+     last_highlight->syntax_defs = syntax_defs;
+     last_highlight->buffer = view->buffer;
+     last_highlight->buffer_version = view->buffer->version;
+     last_highlight->syntax_generation = ce_syntax_generation();
+     last_highlight->rect = view->rect;
+     last_highlight->scroll = view->scroll;
+     last_highlight->cursor = view->cursor;
+
+     ce_range_list_clear(&last_highlight->ranges);
+     for(int64_t i = 0; i < range_list->count; i++){
+          if(!ce_range_list_insert(&last_highlight->ranges, range_list->ranges[i].start, range_list->ranges[i].end)){
+               // it'll never match, so the view is just highlighted again next time
+               last_highlight->syntax_function = NULL;
+               return;
+          }
+     }
 }
 
 static void _draw_layout(CeLayout_t* layout, CeVim_t* vim, CeVimVisualData_t* visual, CeMacros_t* macros,
                          CeBuffer_t* input_buffer, CeColorDefs_t* color_defs, int64_t tab_width, CeLineNumber_t line_number,
                          CeVisualLineDisplayType_t visual_line_display_type, CeLayout_t* current, CeSyntaxDef_t* syntax_defs,
                          int64_t terminal_width, bool highlight_search, int ui_fg_color, int ui_bg_color,
-                         CeRune_t show_line_extends_passed_view_as){
+                         CeRune_t show_line_extends_passed_view_as, CeDrawColorList_t* draw_color_list,
+                         CeRangeList_t* range_list){
      switch(layout->type){
      default:
           break;
      case CE_LAYOUT_TYPE_VIEW:
      {
-          CeDrawColorList_t draw_color_list = {};
           CeAppBufferData_t* buffer_data = layout->view.buffer->app_data;
+          CeDrawColorList_t* view_color_list = draw_color_list;
+          ce_draw_color_list_clear(draw_color_list);
 
           if(buffer_data->syntax_function){
-               CeRangeList_t range_list = {};
+               ce_range_list_clear(range_list);
                // add to the highlight range list only if this is the current view
                if(layout == current){
                     switch(vim->mode){
@@ -264,15 +489,15 @@ static void _draw_layout(CeLayout_t* layout, CeVim_t* vim, CeVimVisualData_t* vi
                     {
                          CeRange_t range = {visual->point, layout->view.cursor};
                          ce_range_sort(&range);
-                         ce_range_list_insert(&range_list, range.start, range.end);
+                         ce_range_list_insert(range_list, range.start, range.end);
                     } break;
                     case CE_VIM_MODE_VISUAL_LINE:
                     {
                          CeRange_t range = {visual->point, layout->view.cursor};
                          ce_range_sort(&range);
                          range.start.x = 0;
-                         range.end.x = ce_utf8_last_index(layout->view.buffer->lines[range.end.y]) + 1;
-                         ce_range_list_insert(&range_list, range.start, range.end);
+                         range.end.x = ce_utf8_last_index(ce_buffer_line(layout->view.buffer, range.end.y)) + 1;
+                         ce_range_list_insert(range_list, range.start, range.end);
                     } break;
                     case CE_VIM_MODE_VISUAL_BLOCK:
                     {
@@ -290,7 +515,7 @@ static void _draw_layout(CeLayout_t* layout, CeVim_t* vim, CeVimVisualData_t* vi
                          for(int64_t i = range.start.y; i <= range.end.y; i++){
                               CePoint_t start = {range.start.x, i};
                               CePoint_t end = {range.end.x, i};
-                              ce_range_list_insert(&range_list, start, end);
+                              ce_range_list_insert(range_list, start, end);
                          }
                     } break;
                     }
@@ -304,61 +529,68 @@ static void _draw_layout(CeLayout_t* layout, CeVim_t* vim, CeVimVisualData_t* vi
                         strcmp(input_buffer->name, "Reverse Search") == 0 ||
                         strcmp(input_buffer->name, "Regex Search") == 0 ||
                         strcmp(input_buffer->name, "Regex Reverse Search") == 0) &&
-                       input_buffer->line_count && strlen(input_buffer->lines[0])){
-                         pattern = input_buffer->lines[0];
+                       input_buffer->line_count && strlen(ce_buffer_line(input_buffer, 0))){
+                         pattern = ce_buffer_line(input_buffer, 0);
                     }else{
                          const CeVimYank_t* yank = vim->yanks + ce_vim_register_index('/');
                          if(yank->text) pattern = yank->text;
                     }
 
                     if(pattern){
-                         int64_t pattern_len = ce_utf8_strlen(pattern);
                          int64_t min = layout->view.scroll.y;
                          int64_t max = min + (layout->view.rect.bottom - layout->view.rect.top);
                          int64_t clamp_max = (layout->view.buffer->line_count - 1);
                          CE_CLAMP(min, 0, clamp_max);
                          CE_CLAMP(max, 0, clamp_max);
 
-                         if(vim->search_mode == CE_VIM_SEARCH_MODE_FORWARD ||
+                         // use the buffer's match index when it has what we need, rather than re-scanning the
+                         // visible lines
+                         bool regex_mode = (vim->search_mode == CE_VIM_SEARCH_MODE_REGEX_FORWARD ||
+                                       vim->search_mode == CE_VIM_SEARCH_MODE_REGEX_BACKWARD);
+                         CeMatchIndex_t* search_matches = &buffer_data->vim.search_matches;
+                         if(ce_match_index_covers(search_matches, layout->view.buffer, pattern, regex_mode, max)){
+                              ce_range_list_insert_matches(range_list, search_matches, min, max);
+                         }else if(vim->search_mode == CE_VIM_SEARCH_MODE_FORWARD ||
                             vim->search_mode == CE_VIM_SEARCH_MODE_BACKWARD){
+                              CeSearch_t search;
+                              ce_search_init(&search, pattern);
                               for(int64_t i = min; i <= max; i++){
-                                   char* match = NULL;
-                                   char* itr = layout->view.buffer->lines[i];
-                                   while((match = strstr(itr, pattern))){
-                                        CePoint_t start = {ce_utf8_strlen_between(layout->view.buffer->lines[i], match) - 1, i};
-                                        CePoint_t end = {start.x + (pattern_len - 1), i};
-                                        ce_range_list_insert(&range_list, start, end);
-                                        itr = match + pattern_len;
+                                   CeSearchLineItr_t line_itr;
+                                   ce_search_line_begin(&line_itr, ce_buffer_line(layout->view.buffer, i));
+                                   int64_t match_index;
+                                   while((match_index = ce_search_line_next(&search, &line_itr)) >= 0){
+                                        CePoint_t start = {match_index, i};
+                                        CePoint_t end = {start.x + (search.rune_length - 1), i};
+                                        ce_range_list_insert(range_list, start, end);
                                    }
                               }
                          }else if(vim->search_mode == CE_VIM_SEARCH_MODE_REGEX_FORWARD ||
                                   vim->search_mode == CE_VIM_SEARCH_MODE_REGEX_BACKWARD){
                               CeRegex_t regex = NULL;
-                              CeRegexResult_t regex_result = ce_regex_init(pattern,
-                                                                           &regex);
+                              CeRegexResult_t regex_result = ce_regex_cache_get(pattern, &regex);
                               if(regex_result.error_message == NULL){
+                                   CeRegexMatch_t matches[CE_REGEX_SEARCH_MATCH_BATCH];
                                    for(int64_t i = min; i <= max; i++){
-                                        char* itr = layout->view.buffer->lines[i];
-                                        int64_t prev_end_x = 0;
-                                        while(itr){
-                                             regex_result = ce_regex_match(regex, itr);
+                                        const char* line = ce_buffer_line(layout->view.buffer, i);
+                                        int64_t offset = 0;
+                                        int64_t match_count = CE_REGEX_SEARCH_MATCH_BATCH;
+                                        while(match_count == CE_REGEX_SEARCH_MATCH_BATCH){
+                                             regex_result = ce_regex_match_all(regex, line, offset, matches, CE_REGEX_SEARCH_MATCH_BATCH, &match_count);
                                              if(regex_result.error_message != NULL){
                                                   free(regex_result.error_message);
                                                   break;
-                                             }else{
-                                                  if(regex_result.match_length > 0){
-                                                       CePoint_t start = {prev_end_x + regex_result.match_start, i};
-                                                       CePoint_t end = {start.x + (regex_result.match_length - 1), i};
-                                                       ce_range_list_insert(&range_list, start, end);
-                                                       itr = ce_utf8_iterate_to(itr, regex_result.match_start + regex_result.match_length);
-                                                       prev_end_x = end.x + 1;
-                                                  }else{
-                                                       break;
-                                                  }
                                              }
+                                             for(int64_t m = 0; m < match_count; m++){
+                                                  if(matches[m].length <= 0) continue;
+                                                  const char* match_start = line + matches[m].start;
+                                                  const char* match_end = match_start + matches[m].length;
+                                                  CePoint_t start = {ce_buffer_line_rune_index(layout->view.buffer, i, match_start), i};
+                                                  CePoint_t end = {ce_buffer_line_rune_index(layout->view.buffer, i, match_end) - 1, i};
+                                                  ce_range_list_insert(range_list, start, end);
+                                             }
+                                             if(match_count > 0) offset = matches[match_count - 1].start + matches[match_count - 1].length;
                                         }
                                    }
-                                   ce_regex_free(regex);
                               }else{
                                    free(regex_result.error_message);
                               }
@@ -366,22 +598,41 @@ static void _draw_layout(CeLayout_t* layout, CeVim_t* vim, CeVimVisualData_t* vi
                     }
                }
 
-               buffer_data->syntax_function(&layout->view, &range_list, &draw_color_list, syntax_defs,
-                                            layout->view.buffer->syntax_data);
-               ce_range_list_free(&range_list);
+               // highlighters with syntax data depend on more than the buffer, so they always run
+               CeAppViewData_t* view_data = layout->view.user_data;
+               if(view_data && !layout->view.buffer->syntax_data){
+                    CeAppViewHighlight_t* last_highlight = &view_data->last_highlight;
+                    view_color_list = &last_highlight->colors;
+                    if(!_view_highlight_unchanged(last_highlight, &layout->view, buffer_data->syntax_function, syntax_defs,
+                                                  range_list)){
+                         ce_draw_color_list_clear(view_color_list);
+                         CE_PROFILE_BEGIN(syntax_timer, CE_PROFILE_STAGE_SYNTAX);
+                         buffer_data->syntax_function(&layout->view, range_list, view_color_list, syntax_defs, NULL);
+                         CE_PROFILE_END(syntax_timer);
+                         _view_highlight_save(last_highlight, &layout->view, buffer_data->syntax_function, syntax_defs,
+                                              range_list);
+                    }
+               }else{
+                    CE_PROFILE_BEGIN(syntax_timer, CE_PROFILE_STAGE_SYNTAX);
+                    buffer_data->syntax_function(&layout->view, range_list, draw_color_list, syntax_defs,
+                                                 layout->view.buffer->syntax_data);
+                    CE_PROFILE_END(syntax_timer);
+               }
           }
 
-          _draw_view(&layout->view, tab_width, line_number, visual_line_display_type, &draw_color_list, color_defs, syntax_defs,
+          CE_PROFILE_BEGIN(draw_view_timer, CE_PROFILE_STAGE_DRAW_VIEW);
+          _draw_view(&layout->view, tab_width, line_number, visual_line_display_type, view_color_list, color_defs, syntax_defs,
                     terminal_width, show_line_extends_passed_view_as);
-          ce_draw_color_list_free(&draw_color_list);
+          CE_PROFILE_END(draw_view_timer);
           _draw_view_status(&layout->view, layout == current ? vim : NULL, macros, color_defs, 0,
                            ui_fg_color, ui_bg_color);
           int64_t rect_height = layout->view.rect.bottom - layout->view.rect.top;
           int color_pair = ce_color_def_get(color_defs, ui_fg_color, ui_bg_color);
-          attron(COLOR_PAIR(color_pair));
+          _term_color(color_pair);
           if(layout->view.rect.right < (terminal_width - 1)){
                for(int i = 0; i < rect_height; i++){
-                    mvaddch(layout->view.rect.top + i, layout->view.rect.right, ' ');
+                    _term_move(layout->view.rect.top + i, layout->view.rect.right);
+                    _term_rune(' ');
                }
           }
      } break;
@@ -389,19 +640,23 @@ static void _draw_layout(CeLayout_t* layout, CeVim_t* vim, CeVimVisualData_t* vi
           for(int64_t i = 0; i < layout->list.layout_count; i++){
                _draw_layout(layout->list.layouts[i], vim, visual, macros, input_buffer, color_defs, tab_width,
                            line_number, visual_line_display_type, current, syntax_defs, terminal_width, highlight_search,
-                           ui_fg_color, ui_bg_color, show_line_extends_passed_view_as);
+                           ui_fg_color, ui_bg_color, show_line_extends_passed_view_as, draw_color_list, range_list);
           }
           break;
      case CE_LAYOUT_TYPE_TAB:
           _draw_layout(layout->tab.root, vim, visual, macros, input_buffer, color_defs, tab_width, line_number,
                       visual_line_display_type, current, syntax_defs, terminal_width, highlight_search, ui_fg_color, ui_bg_color,
-                      show_line_extends_passed_view_as);
+                      show_line_extends_passed_view_as, draw_color_list, range_list);
           break;
      }
 }
 
 void ce_draw_term(CeApp_t* app){
-     CeColorDefs_t color_defs = {};
+     int terminal_width = 0;
+     int terminal_height = 0;
+     getmaxyx(stdscr, terminal_height, terminal_width);
+     if(!_term_frame_begin(terminal_width, terminal_height)) return;
+     CeColorDefs_t* color_defs = &g_term_frame.color_defs;
 
      CeLayout_t* tab_list_layout = app->tab_list_layout;
      CeLayout_t* tab_layout = tab_list_layout->tab_list.current;
@@ -410,57 +665,56 @@ void ce_draw_term(CeApp_t* app){
 
      // draw a tab bar if there is more than 1 tab
      if(tab_list_layout->tab_list.tab_count > 1){
-          move(0, 0);
-          int color_pair = ce_color_def_get(&color_defs, app->config_options.ui_fg_color, app->config_options.ui_bg_color);
-          attron(COLOR_PAIR(color_pair));
+          _term_move(0, 0);
+          int color_pair = ce_color_def_get(color_defs, app->config_options.ui_fg_color, app->config_options.ui_bg_color);
+          _term_color(color_pair);
           for(int64_t i = tab_list_layout->tab_list.rect.left; i <= tab_list_layout->tab_list.rect.right; i++){
-               addch(' ');
+               _term_rune(' ');
           }
 
-          move(0, 0);
+          _term_move(0, 0);
 
           for(int64_t i = 0; i < tab_list_layout->tab_list.tab_count; i++){
                if(tab_list_layout->tab_list.tabs[i] == tab_list_layout->tab_list.current){
-                    color_pair = ce_color_def_get(&color_defs, CE_COLOR_DEFAULT, CE_COLOR_DEFAULT);
-                    attron(COLOR_PAIR(color_pair));
+                    color_pair = ce_color_def_get(color_defs, CE_COLOR_DEFAULT, CE_COLOR_DEFAULT);
+                    _term_color(color_pair);
                }else{
-                    color_pair = ce_color_def_get(&color_defs, app->config_options.ui_fg_color, app->config_options.ui_bg_color);
-                    attron(COLOR_PAIR(color_pair));
+                    color_pair = ce_color_def_get(color_defs, app->config_options.ui_fg_color, app->config_options.ui_bg_color);
+                    _term_color(color_pair);
                }
 
                if(tab_list_layout->tab_list.tabs[i]->tab.current->type == CE_LAYOUT_TYPE_VIEW){
                     const char* buffer_name = tab_list_layout->tab_list.tabs[i]->tab.current->view.buffer->name;
 
-                    printw(" %s ", buffer_name);
+                    _term_printf(" %s ", buffer_name);
                }else{
-                    printw(" selection ");
+                    _term_printf(" selection ");
                }
           }
      }
 
-     standend();
-     _draw_layout(tab_layout, &app->vim, &app->visual, &app->macros, app->input_view.buffer, &color_defs,
+     _term_color(0);
+     _draw_layout(tab_layout, &app->vim, &app->visual, &app->macros, app->input_view.buffer, color_defs,
                  app->config_options.tab_width, app->config_options.line_number, app->config_options.visual_line_display_type,
                  tab_layout->tab.current, app->syntax_defs, tab_list_layout->tab_list.rect.right,
                  app->highlight_search, app->config_options.ui_fg_color, app->config_options.ui_bg_color,
-                 app->config_options.show_line_extends_passed_view_as);
+                 app->config_options.show_line_extends_passed_view_as, &app->draw_color_list, &app->draw_range_list);
 
      if(app->input_complete_func){
-          CeDrawColorList_t draw_color_list = {};
+          ce_draw_color_list_clear(&app->draw_color_list);
           _draw_view(&app->input_view, app->config_options.tab_width, app->config_options.line_number,
-                    app->config_options.visual_line_display_type, &draw_color_list, &color_defs, app->syntax_defs,
+                    app->config_options.visual_line_display_type, &app->draw_color_list, color_defs, app->syntax_defs,
                     app->terminal_rect.right, app->config_options.show_line_extends_passed_view_as);
-          ce_draw_color_list_free(&draw_color_list);
           int64_t new_status_bar_offset = (app->input_view.rect.bottom - app->input_view.rect.top) + 1;
-          _draw_view_status(&app->input_view, &app->vim, &app->macros, &color_defs, 0,
+          _draw_view_status(&app->input_view, &app->vim, &app->macros, color_defs, 0,
                            app->config_options.ui_fg_color, app->config_options.ui_bg_color);
-          _draw_view_status(&tab_layout->tab.current->view, NULL, &app->macros, &color_defs,
+          _draw_view_status(&tab_layout->tab.current->view, NULL, &app->macros, color_defs,
                            -new_status_bar_offset, app->config_options.ui_fg_color, app->config_options.ui_bg_color);
      }
 
      CeComplete_t* complete = ce_app_is_completing(app);
      if(complete && tab_layout->tab.current->type == CE_LAYOUT_TYPE_VIEW && app->complete_list_buffer->line_count &&
-        strlen(app->complete_list_buffer->lines[0])){
+        strlen(ce_buffer_line(app->complete_list_buffer, 0))){
           CeLayout_t* view_layout = tab_layout->tab.current;
           app->complete_view.rect.left = view_layout->view.rect.left;
           app->complete_view.rect.right = view_layout->view.rect.right - 1;
@@ -483,20 +737,18 @@ void ce_draw_term(CeApp_t* app){
           app->complete_view.scroll.y = 0;
           app->complete_view.scroll.x = 0;
           ce_view_follow_cursor(&app->complete_view, 0, 0, 0); // NOTE: I don't think anyone wants their settings applied here
-          CeDrawColorList_t draw_color_list = {};
-          CeRangeList_t range_list = {};
+          ce_draw_color_list_clear(&app->draw_color_list);
+          ce_range_list_clear(&app->draw_range_list);
           CeAppBufferData_t* buffer_data = app->complete_view.buffer->app_data;
-          buffer_data->syntax_function(&app->complete_view, &range_list, &draw_color_list, app->syntax_defs,
+          buffer_data->syntax_function(&app->complete_view, &app->draw_range_list, &app->draw_color_list, app->syntax_defs,
                                        app->complete_view.buffer->syntax_data);
-          ce_range_list_free(&range_list);
           _draw_view(&app->complete_view, app->config_options.tab_width, app->config_options.line_number,
-                    app->config_options.visual_line_display_type, &draw_color_list, &color_defs, app->syntax_defs,
+                    app->config_options.visual_line_display_type, &app->draw_color_list, color_defs, app->syntax_defs,
                     app->terminal_rect.right, app->config_options.show_line_extends_passed_view_as);
-          ce_draw_color_list_free(&draw_color_list);
           if(app->input_complete_func){
                int64_t new_status_bar_offset = (app->complete_view.rect.bottom - app->complete_view.rect.top) + 1 + app->input_view.buffer->line_count;
                _draw_view_status(&tab_layout->tab.current->view, NULL, &app->macros,
-                                &color_defs, -new_status_bar_offset, app->config_options.ui_fg_color,
+                                color_defs, -new_status_bar_offset, app->config_options.ui_fg_color,
                                 app->config_options.ui_bg_color);
           }
      }
@@ -509,45 +761,43 @@ void ce_draw_term(CeApp_t* app){
           app->clangd_completion.view.scroll.x = 0;
           ce_view_follow_cursor(&app->clangd_completion.view, 0, 0, 0);
 
-          CeDrawColorList_t draw_color_list = {};
-          CeRangeList_t highlight_ranges = {};
+          ce_draw_color_list_clear(&app->draw_color_list);
+          ce_range_list_clear(&app->draw_range_list);
           CeAppBufferData_t* buffer_data = app->clangd_completion.buffer->app_data;
           if (buffer_data->syntax_function) {
-               buffer_data->syntax_function(&app->clangd_completion.view, &highlight_ranges, &draw_color_list, app->syntax_defs,
+               buffer_data->syntax_function(&app->clangd_completion.view, &app->draw_range_list, &app->draw_color_list, app->syntax_defs,
                                             app->clangd_completion.buffer->syntax_data);
-               ce_range_list_free(&highlight_ranges);
           }
 
           _draw_view(&app->clangd_completion.view, app->config_options.tab_width, app->config_options.line_number,
-                    app->config_options.visual_line_display_type, &draw_color_list, &color_defs, app->syntax_defs,
+                    app->config_options.visual_line_display_type, &app->draw_color_list, color_defs, app->syntax_defs,
                     app->terminal_rect.right, app->config_options.show_line_extends_passed_view_as);
      }
 
      if(app->message_mode){
-          CeDrawColorList_t draw_color_list = {};
-          CeRangeList_t range_list = {};
+          ce_draw_color_list_clear(&app->draw_color_list);
+          ce_range_list_clear(&app->draw_range_list);
           CeAppBufferData_t* buffer_data = app->message_view.buffer->app_data;
-          buffer_data->syntax_function(&app->message_view, &range_list, &draw_color_list, app->syntax_defs,
+          buffer_data->syntax_function(&app->message_view, &app->draw_range_list, &app->draw_color_list, app->syntax_defs,
                                        app->message_view.buffer->syntax_data);
-          ce_range_list_free(&range_list);
 
           _draw_view(&app->message_view, app->config_options.tab_width, app->config_options.line_number,
-                    app->config_options.visual_line_display_type, &draw_color_list, &color_defs, app->syntax_defs,
+                    app->config_options.visual_line_display_type, &app->draw_color_list, color_defs, app->syntax_defs,
                     app->terminal_rect.right, app->config_options.show_line_extends_passed_view_as);
-          ce_draw_color_list_free(&draw_color_list);
 
           // set the specified background
-          int message_len = ce_utf8_strlen(app->message_view.buffer->lines[0]);
-          int color_pair = ce_color_def_get(&color_defs, app->config_options.message_fg_color, app->config_options.message_bg_color);
-          attron(COLOR_PAIR(color_pair));
+          int message_len = ce_utf8_strlen(ce_buffer_line(app->message_view.buffer, 0));
+          int color_pair = ce_color_def_get(color_defs, app->config_options.message_fg_color, app->config_options.message_bg_color);
+          _term_color(color_pair);
           int64_t view_width = ce_view_width(&app->message_view);
-          move(app->message_view.rect.top, app->message_view.rect.left + message_len);
+          _term_move(app->message_view.rect.top, app->message_view.rect.left + message_len);
           for(int i = message_len; i < view_width; i++){
-               addch(' ');
+               _term_rune(' ');
           }
      }
 
      // show border when non view is selected
+     CePoint_t screen_cursor = {0, 0};
      if(tab_layout->tab.current->type != CE_LAYOUT_TYPE_VIEW){
           int64_t rect_height = 0;
           int64_t rect_width = 0;
@@ -567,34 +817,39 @@ void ce_draw_term(CeApp_t* app){
                break;
           }
 
-          int color_pair = ce_color_def_get(&color_defs, CE_COLOR_BRIGHT_WHITE, CE_COLOR_BRIGHT_WHITE);
-          attron(COLOR_PAIR(color_pair));
+          int color_pair = ce_color_def_get(color_defs, CE_COLOR_BRIGHT_WHITE, CE_COLOR_BRIGHT_WHITE);
+          _term_color(color_pair);
           for(int i = 0; i < rect_height; i++){
-               mvaddch(rect->top + i, rect->right, ' ');
-               mvaddch(rect->top + i, rect->left, ' ');
+               _term_move(rect->top + i, rect->right);
+               _term_rune(' ');
+               _term_move(rect->top + i, rect->left);
+               _term_rune(' ');
           }
 
           for(int i = 0; i < rect_width; i++){
-               mvaddch(rect->top, rect->left + i, ' ');
-               mvaddch(rect->bottom, rect->left + i, ' ');
+               _term_move(rect->top, rect->left + i);
+               _term_rune(' ');
+               _term_move(rect->bottom, rect->left + i);
+               _term_rune(' ');
           }
 
-          mvaddch(rect->bottom, rect->right, ' ');
-
-          move(0, 0);
+          _term_move(rect->bottom, rect->right);
+          _term_rune(' ');
      }else if(app->input_complete_func){
-          CePoint_t screen_cursor = view_cursor_on_screen(&app->input_view, app->config_options.tab_width,
-                                                          app->config_options.line_number);
-          move(screen_cursor.y, screen_cursor.x);
+          screen_cursor = view_cursor_on_screen(&app->input_view, app->config_options.tab_width,
+                                                app->config_options.line_number);
      }else{
-          CePoint_t screen_cursor = view_cursor_on_screen(view, app->config_options.tab_width,
-                                                          app->config_options.line_number);
-          move(screen_cursor.y, screen_cursor.x);
+          screen_cursor = view_cursor_on_screen(view, app->config_options.tab_width,
+                                                app->config_options.line_number);
      }
 
+     _term_frame_end();
+     move(screen_cursor.y, screen_cursor.x);
      refresh();
 }
 
 #else
 void ce_draw_term(CeApp_t* app){ }
+void ce_draw_term_redraw(void){ }
+void ce_draw_term_free(void){ }
 #endif
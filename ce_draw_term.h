@@ -3,3 +3,5 @@
 struct CeApp_t;
 
 void ce_draw_term(struct CeApp_t* app);
+void ce_draw_term_redraw(void); // the next frame writes every row, for when the terminal may not show what we last drew
+void ce_draw_term_free(void);
@@ -372,6 +372,176 @@ void ce_json_obj_to_string(CeJsonObj_t* json, char* string, uint64_t size, uint6
      _print_state_update(&print_state, snprintf(string + print_state.printed, print_state.remaining, "\n"));
 }
 
+static bool _writer_reserve(CeJsonWriter_t* writer, uint64_t length){
+     if(writer->failed){
+          return false;
+     }
+     // leave room for the null terminator
+     uint64_t needed = writer->length + length + 1;
+     if(needed <= writer->capacity){
+          return true;
+     }
+     uint64_t new_capacity = writer->capacity ? writer->capacity : 1024;
+     while(new_capacity < needed){
+          new_capacity *= 2;
+     }
+     char* new_string = realloc(writer->string, new_capacity);
+     if(!new_string){
+          writer->failed = true;
+          return false;
+     }
+     writer->string = new_string;
+     writer->capacity = new_capacity;
+     return true;
+}
+
+static void _writer_append(CeJsonWriter_t* writer, const char* string, uint64_t length){
+     if(!_writer_reserve(writer, length)){
+          return;
+     }
+     memcpy(writer->string + writer->length, string, length);
+     writer->length += length;
+     writer->string[writer->length] = 0;
+}
+
+static void _writer_append_escaped(CeJsonWriter_t* writer, const char* string){
+     _writer_append(writer, "\"", 1);
+     // copy runs of characters that don't need escaping all at once
+     const char* run = string;
+     for(const char* itr = string; *itr; itr++){
+          unsigned char c = (unsigned char)(*itr);
+          if(c >= 0x20 && c != '"' && c != '\\'){
+               continue;
+          }
+          _writer_append(writer, run, itr - run);
+          run = itr + 1;
+          char escaped[8];
+          switch(c){
+          case '"':
+               _writer_append(writer, "\\\"", 2);
+               break;
+          case '\\':
+               _writer_append(writer, "\\\\", 2);
+               break;
+          case '\b':
+               _writer_append(writer, "\\b", 2);
+               break;
+          case '\f':
+               _writer_append(writer, "\\f", 2);
+               break;
+          case '\n':
+               _writer_append(writer, "\\n", 2);
+               break;
+          case '\r':
+               _writer_append(writer, "\\r", 2);
+               break;
+          case '\t':
+               _writer_append(writer, "\\t", 2);
+               break;
+          default:
+               snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+               _writer_append(writer, escaped, 6);
+               break;
+          }
+     }
+     _writer_append(writer, run, strlen(run));
+     _writer_append(writer, "\"", 1);
+}
+
+// the comma and name that come before every value
+static void _writer_begin_value(CeJsonWriter_t* writer, const char* name){
+     if(writer->has_members[writer->depth]){
+          _writer_append(writer, ",", 1);
+     }
+     writer->has_members[writer->depth] = true;
+     if(name){
+          _writer_append_escaped(writer, name);
+          _writer_append(writer, ":", 1);
+     }
+}
+
+static void _writer_push(CeJsonWriter_t* writer, const char* name, const char* open){
+     _writer_begin_value(writer, name);
+     _writer_append(writer, open, 1);
+     if(writer->depth + 1 >= CE_JSON_WRITER_MAX_DEPTH){
+          writer->failed = true;
+          return;
+     }
+     writer->depth++;
+     writer->has_members[writer->depth] = false;
+}
+
+static void _writer_pop(CeJsonWriter_t* writer, const char* close){
+     _writer_append(writer, close, 1);
+     if(writer->depth > 0){
+          writer->depth--;
+     }
+}
+
+void ce_json_writer_begin_obj(CeJsonWriter_t* writer, const char* name){
+     _writer_push(writer, name, "{");
+}
+
+void ce_json_writer_end_obj(CeJsonWriter_t* writer){
+     _writer_pop(writer, "}");
+}
+
+void ce_json_writer_begin_array(CeJsonWriter_t* writer, const char* name){
+     _writer_push(writer, name, "[");
+}
+
+void ce_json_writer_end_array(CeJsonWriter_t* writer){
+     _writer_pop(writer, "]");
+}
+
+void ce_json_writer_string(CeJsonWriter_t* writer, const char* name, const char* string){
+     _writer_begin_value(writer, name);
+     _writer_append_escaped(writer, string);
+}
+
+void ce_json_writer_int(CeJsonWriter_t* writer, const char* name, int64_t number){
+     char printed[32];
+     int length = snprintf(printed, sizeof(printed), "%" PRId64, number);
+     _writer_begin_value(writer, name);
+     _writer_append(writer, printed, length);
+}
+
+void ce_json_writer_number(CeJsonWriter_t* writer, const char* name, double number){
+     char printed[32];
+     int length = snprintf(printed, sizeof(printed), "%.17g", number);
+     _writer_begin_value(writer, name);
+     _writer_append(writer, printed, length);
+}
+
+void ce_json_writer_boolean(CeJsonWriter_t* writer, const char* name, bool boolean){
+     _writer_begin_value(writer, name);
+     if(boolean){
+          _writer_append(writer, "true", 4);
+     }else{
+          _writer_append(writer, "false", 5);
+     }
+}
+
+void ce_json_writer_null(CeJsonWriter_t* writer, const char* name){
+     _writer_begin_value(writer, name);
+     _writer_append(writer, "null", 4);
+}
+
+void ce_json_writer_clear(CeJsonWriter_t* writer){
+     writer->length = 0;
+     if(writer->string){
+          writer->string[0] = 0;
+     }
+     writer->depth = 0;
+     writer->has_members[0] = false;
+     writer->failed = false;
+}
+
+void ce_json_writer_free(CeJsonWriter_t* writer){
+     free(writer->string);
+     memset(writer, 0, sizeof(*writer));
+}
+
 #define TOKEN_OPEN_BRACE '{'
 #define TOKEN_CLOSE_BRACE '}'
 #define TOKEN_OPEN_BRACKET '['
@@ -770,8 +940,39 @@ static bool _obj_parse(ParsePos_t* pos, CeJsonObj_t* obj, bool verbose){
      return true;
 }
 
+static uint32_t _hash_name(const char* name){
+     // fnv-1a
+     uint32_t hash = 2166136261u;
+     for(const char* itr = name; *itr; itr++){
+          hash ^= (unsigned char)(*itr);
+          hash *= 16777619u;
+     }
+     return hash;
+}
+
+// a power of 2 with at least twice as many slots as fields, so probing stays short
+static uint64_t _lookup_capacity(int64_t field_count){
+     uint64_t capacity = 16;
+     while(capacity < (uint64_t)(field_count) * 2){
+          capacity *= 2;
+     }
+     return capacity;
+}
+
 CeJsonFindResult_t ce_json_obj_find(CeJsonObj_t* obj, const char* name){
      CeJsonFindResult_t result = {};
+     if(obj->lookup){
+          uint64_t mask = _lookup_capacity(obj->count) - 1;
+          for(uint64_t slot = _hash_name(name) & mask; obj->lookup[slot]; slot = (slot + 1) & mask){
+               int64_t index = obj->lookup[slot] - 1;
+               if(strcmp(obj->fields[index].name, name) == 0){
+                    result.type = obj->fields[index].value.type;
+                    result.index = index;
+                    return result;
+               }
+          }
+          return result;
+     }
      for(int64_t i = 0; i < obj->count; i++){
           if(strcmp(obj->fields[i].name, name) == 0){
                result.type = obj->fields[i].value.type;
@@ -828,3 +1029,402 @@ bool ce_json_parse(const char* string, CeJsonObj_t* json, bool verbose){
      }
      return result;
 }
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+static void* _arena_alloc(CeJsonArena_t* arena, uint64_t size){
+     // keep everything 8 byte aligned
+     size = (size + 7) & ~(uint64_t)(7);
+     CeJsonArenaBlock_t* block = arena->head;
+     if(block == NULL || block->used + size > block->capacity){
+          uint64_t capacity = (size > ARENA_BLOCK_SIZE) ? size : ARENA_BLOCK_SIZE;
+          block = malloc(sizeof(*block) + capacity);
+          if(block == NULL){
+               return NULL;
+          }
+          block->used = 0;
+          block->capacity = capacity;
+          // a big allocation goes behind the current block so the rest of that block still gets used
+          if(arena->head && size > ARENA_BLOCK_SIZE){
+               block->next = arena->head->next;
+               arena->head->next = block;
+          }else{
+               block->next = arena->head;
+               arena->head = block;
+          }
+          arena->allocated_bytes += sizeof(*block) + capacity;
+     }
+     void* result = (char*)(block + 1) + block->used;
+     block->used += size;
+     return result;
+}
+
+void ce_json_arena_free(CeJsonArena_t* arena){
+     CeJsonArenaBlock_t* itr = arena->head;
+     while(itr){
+          CeJsonArenaBlock_t* next = itr->next;
+          free(itr);
+          itr = next;
+     }
+     arena->head = NULL;
+     arena->allocated_bytes = 0;
+}
+
+typedef struct{
+     char* str;
+     char* start;
+     CeJsonArena_t* arena;
+     // the members of every object and array still being parsed, they move into the arena once we know how many
+     CeJsonField_t* stack;
+     int64_t stack_count;
+     int64_t stack_capacity;
+     int64_t depth;
+     bool verbose;
+}ArenaParse_t;
+
+static bool _arena_parse_value(ArenaParse_t* parse, CeJsonValue_t* value);
+
+static bool _arena_parse_error(ArenaParse_t* parse, const char* expected){
+     if(parse->verbose) printf("Error: byte %" PRId64 " expected %s.\n", (int64_t)(parse->str - parse->start), expected);
+     return false;
+}
+
+static void _arena_eat_whitespace(ArenaParse_t* parse){
+     while(_is_whitespace(*parse->str) || _is_newline(*parse->str)){
+          parse->str++;
+     }
+}
+
+static bool _arena_push(ArenaParse_t* parse, char* name, CeJsonValue_t* value){
+     if(parse->stack_count >= parse->stack_capacity){
+          int64_t new_capacity = parse->stack_capacity ? parse->stack_capacity * 2 : 256;
+          CeJsonField_t* new_stack = realloc(parse->stack, new_capacity * sizeof(*new_stack));
+          if(new_stack == NULL){
+               return false;
+          }
+          parse->stack = new_stack;
+          parse->stack_capacity = new_capacity;
+     }
+     parse->stack[parse->stack_count].name = name;
+     parse->stack[parse->stack_count].value = *value;
+     parse->stack_count++;
+     return true;
+}
+
+// terminates the string where its closing quote was, so it can be used where it is
+static bool _arena_parse_string(ArenaParse_t* parse, char** result){
+     char* begin = parse->str + 1;
+     char* itr = begin;
+     while(*itr != TOKEN_QUOTE){
+          if(*itr == 0 || _is_newline(*itr)){
+               return _arena_parse_error(parse, "end of string");
+          }
+          if(*itr == TOKEN_BACKSLASH){
+               itr++;
+               if(*itr == 0){
+                    return _arena_parse_error(parse, "escaped character");
+               }
+          }
+          itr++;
+     }
+     *itr = 0;
+     parse->str = itr + 1;
+     *result = begin;
+     return true;
+}
+
+static bool _arena_parse_number(ArenaParse_t* parse, double* result){
+     // most numbers in lsp messages are integers, so only hand off to strtod() when we have to
+     char* itr = parse->str;
+     bool negative = (*itr == TOKEN_MINUS);
+     if(negative){
+          itr++;
+     }
+     if(*itr < '0' || *itr > '9'){
+          return _arena_parse_error(parse, "number");
+     }
+     int64_t digits = 0;
+     int64_t integer = 0;
+     while(*itr >= '0' && *itr <= '9' && digits < 18){
+          integer = integer * 10 + (*itr - '0');
+          digits++;
+          itr++;
+     }
+     if(*itr == '.' || *itr == 'e' || *itr == 'E' || (*itr >= '0' && *itr <= '9')){
+          char* end = NULL;
+          *result = strtod(parse->str, &end);
+          if(end <= parse->str){
+               return _arena_parse_error(parse, "number");
+          }
+          parse->str = end;
+          return true;
+     }
+     *result = (double)(negative ? -integer : integer);
+     parse->str = itr;
+     return true;
+}
+
+static bool _arena_parse_obj(ArenaParse_t* parse, CeJsonObj_t* obj){
+     parse->str++;
+     int64_t first = parse->stack_count;
+     _arena_eat_whitespace(parse);
+     if(*parse->str == TOKEN_CLOSE_BRACE){
+          parse->str++;
+          return true;
+     }
+
+     while(true){
+          _arena_eat_whitespace(parse);
+          char* name = NULL;
+          if(*parse->str != TOKEN_QUOTE){
+               return _arena_parse_error(parse, "field name");
+          }
+          if(!_arena_parse_string(parse, &name)){
+               return false;
+          }
+          _arena_eat_whitespace(parse);
+          if(*parse->str != TOKEN_COLON){
+               return _arena_parse_error(parse, "':' after field name");
+          }
+          parse->str++;
+          CeJsonValue_t value = {};
+          if(!_arena_parse_value(parse, &value) || !_arena_push(parse, name, &value)){
+               return false;
+          }
+          _arena_eat_whitespace(parse);
+          if(*parse->str == TOKEN_CLOSE_BRACE){
+               parse->str++;
+               break;
+          }
+          if(*parse->str != TOKEN_COMMA){
+               return _arena_parse_error(parse, "',' or '}' in object");
+          }
+          parse->str++;
+     }
+
+     obj->count = parse->stack_count - first;
+     obj->fields = _arena_alloc(parse->arena, obj->count * sizeof(obj->fields[0]));
+     if(obj->fields == NULL){
+          return false;
+     }
+     memcpy(obj->fields, parse->stack + first, obj->count * sizeof(obj->fields[0]));
+     parse->stack_count = first;
+
+     if(obj->count >= CE_JSON_LOOKUP_MIN_FIELDS){
+          uint64_t capacity = _lookup_capacity(obj->count);
+          uint64_t mask = capacity - 1;
+          obj->lookup = _arena_alloc(parse->arena, capacity * sizeof(obj->lookup[0]));
+          if(obj->lookup == NULL){
+               return false;
+          }
+          memset(obj->lookup, 0, capacity * sizeof(obj->lookup[0]));
+          for(int64_t i = 0; i < obj->count; i++){
+               uint64_t slot = _hash_name(obj->fields[i].name) & mask;
+               // the first field with a name wins, like a linear search
+               bool duplicate = false;
+               while(obj->lookup[slot] && !duplicate){
+                    duplicate = strcmp(obj->fields[obj->lookup[slot] - 1].name, obj->fields[i].name) == 0;
+                    slot = (slot + 1) & mask;
+               }
+               if(!duplicate){
+                    obj->lookup[slot] = (uint32_t)(i + 1);
+               }
+          }
+     }
+     return true;
+}
+
+static bool _arena_parse_array(ArenaParse_t* parse, CeJsonArray_t* array){
+     parse->str++;
+     int64_t first = parse->stack_count;
+     _arena_eat_whitespace(parse);
+     if(*parse->str == TOKEN_CLOSE_BRACKET){
+          parse->str++;
+          return true;
+     }
+
+     while(true){
+          CeJsonValue_t value = {};
+          if(!_arena_parse_value(parse, &value) || !_arena_push(parse, NULL, &value)){
+               return false;
+          }
+          _arena_eat_whitespace(parse);
+          if(*parse->str == TOKEN_CLOSE_BRACKET){
+               parse->str++;
+               break;
+          }
+          if(*parse->str != TOKEN_COMMA){
+               return _arena_parse_error(parse, "',' or ']' in array");
+          }
+          parse->str++;
+     }
+
+     array->count = parse->stack_count - first;
+     array->values = _arena_alloc(parse->arena, array->count * sizeof(array->values[0]));
+     if(array->values == NULL){
+          return false;
+     }
+     for(int64_t i = 0; i < array->count; i++){
+          array->values[i] = parse->stack[first + i].value;
+     }
+     parse->stack_count = first;
+     return true;
+}
+
+static bool _arena_parse_value(ArenaParse_t* parse, CeJsonValue_t* value){
+     _arena_eat_whitespace(parse);
+     char ch = *parse->str;
+     if(ch == TOKEN_OPEN_BRACE || ch == TOKEN_OPEN_BRACKET){
+          if(parse->depth >= CE_JSON_ARENA_MAX_DEPTH){
+               return _arena_parse_error(parse, "less nesting");
+          }
+          parse->depth++;
+          bool result = false;
+          if(ch == TOKEN_OPEN_BRACE){
+               value->type = CE_JSON_TYPE_OBJECT;
+               result = _arena_parse_obj(parse, &value->obj);
+          }else{
+               value->type = CE_JSON_TYPE_ARRAY;
+               result = _arena_parse_array(parse, &value->array);
+          }
+          parse->depth--;
+          return result;
+     }
+     if(ch == TOKEN_QUOTE){
+          value->type = CE_JSON_TYPE_STRING;
+          return _arena_parse_string(parse, &value->string);
+     }
+     if(_starts_number(ch)){
+          value->type = CE_JSON_TYPE_NUMBER;
+          return _arena_parse_number(parse, &value->number);
+     }
+     if(strncmp(parse->str, "true", 4) == 0){
+          value->type = CE_JSON_TYPE_BOOL;
+          value->boolean = true;
+          parse->str += 4;
+          return true;
+     }
+     if(strncmp(parse->str, "false", 5) == 0){
+          value->type = CE_JSON_TYPE_BOOL;
+          value->boolean = false;
+          parse->str += 5;
+          return true;
+     }
+     if(strncmp(parse->str, "null", 4) == 0){
+          value->type = CE_JSON_TYPE_NULL;
+          parse->str += 4;
+          return true;
+     }
+     return _arena_parse_error(parse, "value");
+}
+
+bool ce_json_parse_in_place(char* string, CeJsonObj_t* json, CeJsonArena_t* arena, bool verbose){
+     memset(json, 0, sizeof(*json));
+     ArenaParse_t parse = {};
+     parse.str = string;
+     parse.start = string;
+     parse.arena = arena;
+     parse.verbose = verbose;
+
+     _arena_eat_whitespace(&parse);
+     bool result = false;
+     if(*parse.str == TOKEN_OPEN_BRACE){
+          result = _arena_parse_obj(&parse, json);
+     }else{
+          _arena_parse_error(&parse, "'{' to start the json");
+     }
+
+     free(parse.stack);
+     if(!result){
+          memset(json, 0, sizeof(*json));
+     }
+     return result;
+}
+
+static int _hex_digit(char ch){
+     if(ch >= '0' && ch <= '9') return ch - '0';
+     if(ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+     if(ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+     return -1;
+}
+
+static int64_t _parse_hex4(const char* string){
+     int64_t result = 0;
+     for(int i = 0; i < 4; i++){
+          int digit = _hex_digit(string[i]);
+          if(digit < 0){
+               return -1;
+          }
+          result = (result << 4) | digit;
+     }
+     return result;
+}
+
+static int64_t _encode_utf8(uint32_t code_point, char* string){
+     if(code_point < 0x80){
+          string[0] = (char)(code_point);
+          return 1;
+     }
+     if(code_point < 0x800){
+          string[0] = (char)(0xC0 | (code_point >> 6));
+          string[1] = (char)(0x80 | (code_point & 0x3F));
+          return 2;
+     }
+     if(code_point < 0x10000){
+          string[0] = (char)(0xE0 | (code_point >> 12));
+          string[1] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+          string[2] = (char)(0x80 | (code_point & 0x3F));
+          return 3;
+     }
+     string[0] = (char)(0xF0 | (code_point >> 18));
+     string[1] = (char)(0x80 | ((code_point >> 12) & 0x3F));
+     string[2] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+     string[3] = (char)(0x80 | (code_point & 0x3F));
+     return 4;
+}
+
+// an escape is never shorter than what it decodes to, so this can write over the string as it reads it
+char* ce_json_unescape(char* string){
+     char* read = string;
+     char* write = string;
+     while(*read){
+          if(*read != TOKEN_BACKSLASH || read[1] == 0){
+               *write++ = *read++;
+               continue;
+          }
+          char escaped = read[1];
+          read += 2;
+          switch(escaped){
+          case 'b': *write++ = '\b'; break;
+          case 'f': *write++ = '\f'; break;
+          case 'n': *write++ = '\n'; break;
+          case 'r': *write++ = '\r'; break;
+          case 't': *write++ = '\t'; break;
+          case 'u':
+          {
+               int64_t code_point = _parse_hex4(read);
+               if(code_point < 0){
+                    // leave broken escapes as they were
+                    *write++ = TOKEN_BACKSLASH;
+                    *write++ = 'u';
+                    break;
+               }
+               read += 4;
+               if(code_point >= 0xD800 && code_point <= 0xDBFF && read[0] == TOKEN_BACKSLASH && read[1] == 'u'){
+                    int64_t low = _parse_hex4(read + 2);
+                    if(low >= 0xDC00 && low <= 0xDFFF){
+                         code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                         read += 6;
+                    }
+               }
+               write += _encode_utf8((uint32_t)(code_point), write);
+          } break;
+          default:
+               // \" \\ \/ and anything we don't know just drop the backslash
+               *write++ = escaped;
+               break;
+          }
+     }
+     *write = 0;
+     return string;
+}
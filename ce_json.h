@@ -9,6 +9,9 @@
 #include <stdbool.h>
 
 #define MAX_INDENTATION 1024
+#define CE_JSON_WRITER_MAX_DEPTH 64
+#define CE_JSON_LOOKUP_MIN_FIELDS 16 // objects parsed into an arena with at least this many fields get a hash lookup
+#define CE_JSON_ARENA_MAX_DEPTH 512
 
 typedef struct CeJsonValue_s CeJsonValue_t;
 typedef struct CeJsonField_s CeJsonField_t;
@@ -28,6 +31,7 @@ typedef enum{
 typedef struct CeJsonObj_s{
      CeJsonField_t* fields;
      int64_t count;
+     uint32_t* lookup; // field index + 1 by name hash, only for big objects parsed into an arena
 }CeJsonObj_t;
 
 typedef struct CeJsonArray_s{
@@ -56,6 +60,37 @@ typedef struct{
      int64_t index;
 }CeJsonFindResult_t;
 
+typedef struct CeJsonArenaBlock_s{
+     struct CeJsonArenaBlock_s* next;
+     uint64_t used;
+     uint64_t capacity;
+}CeJsonArenaBlock_t;
+
+// ce_json_parse_in_place() carves every object, array and field out of these blocks. Strings are left where they are
+// in the parsed text, so the text has to live as long as the arena. Json parsed this way is read only, free it all at
+// once with ce_json_arena_free() rather than ce_json_obj_free()
+typedef struct{
+     CeJsonArenaBlock_t* head; // the block being allocated from, the full ones follow it
+     uint64_t allocated_bytes;
+}CeJsonArena_t;
+
+// appends compact json straight into a growing string rather than building up a CeJsonObj_t to print. Members of an
+// object pass their name, values in an array or at the top pass NULL:
+//   ce_json_writer_begin_obj(&writer, NULL);
+//   ce_json_writer_string(&writer, "jsonrpc", "2.0");
+//   ce_json_writer_begin_array(&writer, "ids");
+//   ce_json_writer_int(&writer, NULL, 4);
+//   ce_json_writer_end_array(&writer);
+//   ce_json_writer_end_obj(&writer);
+typedef struct{
+     char* string;
+     uint64_t length;
+     uint64_t capacity;
+     int64_t depth;
+     bool has_members[CE_JSON_WRITER_MAX_DEPTH];
+     bool failed; // ran out of memory or nested too deep, the string is incomplete
+}CeJsonWriter_t;
+
 void ce_json_array_add_obj(CeJsonArray_t* array, CeJsonObj_t* obj);
 void ce_json_array_add_string(CeJsonArray_t* array, const char* string);
 void ce_json_array_add_number(CeJsonArray_t* array, double number);
@@ -80,3 +115,20 @@ double* ce_json_obj_get_number(CeJsonObj_t* json, const CeJsonFindResult_t* find
 bool* ce_json_obj_get_boolean(CeJsonObj_t* json, const CeJsonFindResult_t* find);
 
 bool ce_json_parse(const char* string, CeJsonObj_t* json, bool verbose);
+
+// strings still have their escapes, run ce_json_unescape() on the ones that need it
+bool ce_json_parse_in_place(char* string, CeJsonObj_t* json, CeJsonArena_t* arena, bool verbose);
+void ce_json_arena_free(CeJsonArena_t* arena);
+char* ce_json_unescape(char* string); // in place, returns string
+
+void ce_json_writer_begin_obj(CeJsonWriter_t* writer, const char* name);
+void ce_json_writer_end_obj(CeJsonWriter_t* writer);
+void ce_json_writer_begin_array(CeJsonWriter_t* writer, const char* name);
+void ce_json_writer_end_array(CeJsonWriter_t* writer);
+void ce_json_writer_string(CeJsonWriter_t* writer, const char* name, const char* string); // escapes the string
+void ce_json_writer_int(CeJsonWriter_t* writer, const char* name, int64_t number);
+void ce_json_writer_number(CeJsonWriter_t* writer, const char* name, double number);
+void ce_json_writer_boolean(CeJsonWriter_t* writer, const char* name, bool boolean);
+void ce_json_writer_null(CeJsonWriter_t* writer, const char* name);
+void ce_json_writer_clear(CeJsonWriter_t* writer); // start a new message, keeping the memory
+void ce_json_writer_free(CeJsonWriter_t* writer);
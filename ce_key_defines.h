@@ -13,7 +13,7 @@
   #define KEY_DELETE KEY_DC
   #define KEY_INVALID ERR
   #define KEY_CTRL_F 6
-#elif defined(DISPLAY_GUI)
+#elif defined(DISPLAY_GUI) || defined(DISPLAY_NULL)
   // TODO: figure out the real values here.
   #define KEY_UP_ARROW -2
   #define KEY_DOWN_ARROW -3
@@ -96,9 +96,15 @@ void ce_layout_free(CeLayout_t** root){
      default:
           break;
      case CE_LAYOUT_TYPE_VIEW:
+     {
+          CeAppViewData_t* view_data = layout->view.user_data;
+          if(view_data){
+               ce_range_list_free(&view_data->last_highlight.ranges);
+               ce_draw_color_list_free(&view_data->last_highlight.colors);
+          }
           free(layout->view.user_data);
           layout->view.user_data = NULL;
-          break;
+     } break;
      case CE_LAYOUT_TYPE_LIST:
           for(int64_t i = 0; i < layout->list.layout_count; i++){
                if(layout->list.layouts[i] != NULL){
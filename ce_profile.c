@@ -0,0 +1,171 @@
+#include "ce_profile.h"
+#include "ce.h"
+#include "ce_json.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct{
+     // the frame being recorded is frames[current_frame], the ones before it in the ring are done
+     CeProfileFrame_t frames[CE_PROFILE_FRAME_COUNT];
+     int64_t current_frame;
+     int64_t finished_frame_count;
+
+     CeProfileEvent_t events[CE_PROFILE_EVENT_COUNT];
+     int64_t next_event;
+     int64_t event_count;
+
+     uint64_t epoch_usec; // trace timestamps are relative to the first timer
+}CeProfile_t;
+
+static CeProfile_t g_profile;
+
+static uint64_t profile_now_usec(void){
+     struct timespec now = {};
+#if defined(PLATFORM_WINDOWS)
+     timespec_get(&now, TIME_UTC);
+#else
+     clock_gettime(CLOCK_MONOTONIC, &now);
+#endif
+     return (uint64_t)(now.tv_sec) * 1000000ULL + (uint64_t)(now.tv_nsec) / 1000ULL;
+}
+
+CeProfileTimer_t ce_profile_begin(CeProfileStage_t stage){
+     CeProfileTimer_t timer = {stage, profile_now_usec()};
+     if(g_profile.epoch_usec == 0) g_profile.epoch_usec = timer.start_usec;
+     return timer;
+}
+
+void ce_profile_end(CeProfileTimer_t* timer){
+     uint64_t duration_usec = profile_now_usec() - timer->start_usec;
+
+     CeProfileFrame_t* frame = g_profile.frames + g_profile.current_frame;
+     frame->stage_usec[timer->stage] += duration_usec;
+     frame->stage_mask |= (1u << timer->stage);
+
+     CeProfileEvent_t* event = g_profile.events + g_profile.next_event;
+     event->stage = timer->stage;
+     event->start_usec = timer->start_usec;
+     event->duration_usec = duration_usec;
+     g_profile.next_event = (g_profile.next_event + 1) % CE_PROFILE_EVENT_COUNT;
+     if(g_profile.event_count < CE_PROFILE_EVENT_COUNT) g_profile.event_count++;
+}
+
+void ce_profile_frame_end(void){
+     g_profile.current_frame = (g_profile.current_frame + 1) % CE_PROFILE_FRAME_COUNT;
+     memset(g_profile.frames + g_profile.current_frame, 0, sizeof(g_profile.frames[0]));
+     if(g_profile.finished_frame_count < CE_PROFILE_FRAME_COUNT - 1) g_profile.finished_frame_count++;
+}
+
+void ce_profile_reset(void){
+     memset(&g_profile, 0, sizeof(g_profile));
+}
+
+const char* ce_profile_stage_name(CeProfileStage_t stage){
+     switch(stage){
+     default:
+          break;
+     case CE_PROFILE_STAGE_HANDLE_KEY:
+          return "handle key";
+     case CE_PROFILE_STAGE_VIM_HANDLE_KEY:
+          return "vim handle key";
+     case CE_PROFILE_STAGE_CLANGD_RESPONSE:
+          return "clangd responses";
+     case CE_PROFILE_STAGE_SYNTAX:
+          return "syntax";
+     case CE_PROFILE_STAGE_DRAW_VIEW:
+          return "draw view";
+     case CE_PROFILE_STAGE_DRAW:
+          return "draw";
+     }
+
+     return "unknown";
+}
+
+int64_t ce_profile_frame_count(void){
+     return g_profile.finished_frame_count;
+}
+
+static int compare_usec(const void* a, const void* b){
+     uint64_t usec_a = *(const uint64_t*)(a);
+     uint64_t usec_b = *(const uint64_t*)(b);
+     if(usec_a < usec_b) return -1;
+     if(usec_a > usec_b) return 1;
+     return 0;
+}
+
+// nearest rank, so the result is always one of the samples
+uint64_t ce_profile_percentile(uint64_t* samples, int64_t count, int64_t percent){
+     if(count <= 0) return 0;
+     qsort(samples, count, sizeof(*samples), compare_usec);
+     int64_t rank = (percent * count + 99) / 100;
+     if(rank < 1) rank = 1;
+     if(rank > count) rank = count;
+     return samples[rank - 1];
+}
+
+CeProfileStageStats_t ce_profile_stage_stats(CeProfileStage_t stage){
+     CeProfileStageStats_t stats = {};
+     uint64_t samples[CE_PROFILE_FRAME_COUNT];
+
+     // only the finished frames, walking back from the one being recorded
+     for(int64_t i = 1; i <= g_profile.finished_frame_count; i++){
+          int64_t index = (g_profile.current_frame - i + CE_PROFILE_FRAME_COUNT) % CE_PROFILE_FRAME_COUNT;
+          const CeProfileFrame_t* frame = g_profile.frames + index;
+          if(!(frame->stage_mask & (1u << stage))) continue;
+          samples[stats.frame_count] = frame->stage_usec[stage];
+          stats.frame_count++;
+     }
+
+     if(stats.frame_count == 0) return stats;
+     stats.p50_usec = ce_profile_percentile(samples, stats.frame_count, 50);
+     stats.p99_usec = ce_profile_percentile(samples, stats.frame_count, 99);
+     stats.max_usec = samples[stats.frame_count - 1];
+     return stats;
+}
+
+bool ce_profile_write_trace(const char* filepath){
+     CeJsonArray_t trace_events = {};
+     int64_t oldest = (g_profile.next_event - g_profile.event_count + CE_PROFILE_EVENT_COUNT) % CE_PROFILE_EVENT_COUNT;
+     for(int64_t i = 0; i < g_profile.event_count; i++){
+          const CeProfileEvent_t* event = g_profile.events + ((oldest + i) % CE_PROFILE_EVENT_COUNT);
+          CeJsonObj_t trace_event = {};
+          ce_json_obj_set_string(&trace_event, "name", ce_profile_stage_name(event->stage));
+          ce_json_obj_set_string(&trace_event, "ph", "X");
+          ce_json_obj_set_number(&trace_event, "ts", (double)(event->start_usec - g_profile.epoch_usec));
+          ce_json_obj_set_number(&trace_event, "dur", (double)(event->duration_usec));
+          ce_json_obj_set_number(&trace_event, "pid", 1);
+          ce_json_obj_set_number(&trace_event, "tid", 1);
+          ce_json_array_add_obj(&trace_events, &trace_event);
+          ce_json_obj_free(&trace_event);
+     }
+
+     CeJsonObj_t trace = {};
+     ce_json_obj_set_array(&trace, "traceEvents", &trace_events);
+     ce_json_array_free(&trace_events);
+
+     // each event prints well under this many bytes
+     uint64_t string_size = (g_profile.event_count + 1) * 256;
+     char* string = malloc(string_size);
+     if(!string){
+          ce_json_obj_free(&trace);
+          return false;
+     }
+     ce_json_obj_to_string(&trace, string, string_size, 0);
+     ce_json_obj_free(&trace);
+
+     FILE* file = fopen(filepath, "w");
+     if(!file){
+          ce_log("failed to open '%s' to write the profile trace: %s\n", filepath, strerror(errno));
+          free(string);
+          return false;
+     }
+
+     fputs(string, file);
+     fclose(file);
+     free(string);
+     return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// build with ENABLE_PROFILE defined (make PROFILE=1) to time the stages of each frame. Without it the timer macros
+// compile away to nothing, so they can stay in hot paths
+
+#define CE_PROFILE_FRAME_COUNT 512 // frames of stage timings kept for percentiles
+#define CE_PROFILE_EVENT_COUNT 8192 // individual timings kept for the trace
+
+typedef enum{
+     CE_PROFILE_STAGE_HANDLE_KEY,
+     CE_PROFILE_STAGE_VIM_HANDLE_KEY,
+     CE_PROFILE_STAGE_CLANGD_RESPONSE,
+     CE_PROFILE_STAGE_SYNTAX,
+     CE_PROFILE_STAGE_DRAW_VIEW,
+     CE_PROFILE_STAGE_DRAW,
+     CE_PROFILE_STAGE_COUNT,
+}CeProfileStage_t;
+
+typedef struct{
+     CeProfileStage_t stage;
+     uint64_t start_usec;
+}CeProfileTimer_t;
+
+typedef struct{
+     uint64_t stage_usec[CE_PROFILE_STAGE_COUNT]; // a stage that runs more than once in a frame adds up
+     uint32_t stage_mask; // which stages ran at all
+}CeProfileFrame_t;
+
+typedef struct{
+     CeProfileStage_t stage;
+     uint64_t start_usec;
+     uint64_t duration_usec;
+}CeProfileEvent_t;
+
+typedef struct{
+     int64_t frame_count; // how many of the kept frames the stage ran in
+     uint64_t p50_usec;
+     uint64_t p99_usec;
+     uint64_t max_usec;
+}CeProfileStageStats_t;
+
+// a timer lives from CE_PROFILE_BEGIN() until the matching CE_PROFILE_END() in the same scope:
+//   CE_PROFILE_BEGIN(timer, CE_PROFILE_STAGE_SYNTAX);
+//   ...
+//   CE_PROFILE_END(timer);
+#if defined(ENABLE_PROFILE)
+  #define CE_PROFILE_BEGIN(timer, stage) CeProfileTimer_t timer = ce_profile_begin(stage)
+  #define CE_PROFILE_END(timer) ce_profile_end(&timer)
+  #define CE_PROFILE_FRAME_END() ce_profile_frame_end()
+#else
+  #define CE_PROFILE_BEGIN(timer, stage)
+  #define CE_PROFILE_END(timer)
+  #define CE_PROFILE_FRAME_END()
+#endif
+
+CeProfileTimer_t ce_profile_begin(CeProfileStage_t stage);
+void ce_profile_end(CeProfileTimer_t* timer);
+void ce_profile_frame_end(void); // moves on to the next frame in the ring
+void ce_profile_reset(void);
+
+const char* ce_profile_stage_name(CeProfileStage_t stage);
+int64_t ce_profile_frame_count(void); // frames currently kept in the ring
+CeProfileStageStats_t ce_profile_stage_stats(CeProfileStage_t stage);
+uint64_t ce_profile_percentile(uint64_t* samples, int64_t count, int64_t percent); // sorts samples in place
+
+bool ce_profile_write_trace(const char* filepath); // chrome://tracing json of the kept events
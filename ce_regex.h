@@ -19,13 +19,40 @@ typedef struct{
      int64_t match_length;
 }CeRegexResult_t;
 
+typedef struct{
+     // byte offsets into the string that was matched against
+     int64_t start;
+     int64_t length;
+}CeRegexMatch_t;
+
+#define CE_REGEX_CACHE_SIZE 16
+
 CeRegexResult_t ce_regex_init(const char* expression,
                               CeRegex_t* regex_handle);
 
 CeRegexResult_t ce_regex_match(CeRegex_t regex_handle,
                                const char* string);
 
+// Finds the non-overlapping matches in string starting at byte offset 'start' in one pass, so a line can be searched
+// without re-running the match from every offset. Anchors and word boundaries still see the whole string. Stops after
+// max_matches, match_count is set to how many were filled in. match_start/match_length of the result describe the first
+// match, or are CE_REGEX_NO_MATCH.
+CeRegexResult_t ce_regex_match_all(CeRegex_t regex_handle,
+                                   const char* string,
+                                   int64_t start,
+                                   CeRegexMatch_t* matches,
+                                   int64_t max_matches,
+                                   int64_t* match_count);
+
 void ce_regex_free(CeRegex_t regex_handle);
+
+// Returns the compiled regex for an expression, only compiling it if it isn't one of the CE_REGEX_CACHE_SIZE most
+// recently used expressions. The cache owns the handle: don't free it, and don't hold onto it across calls that could
+// compile other expressions.
+CeRegexResult_t ce_regex_cache_get(const char* expression,
+                                   CeRegex_t* regex_handle);
+
+void ce_regex_cache_clear(void);
 #if defined(__cplusplus)
 }
 #endif
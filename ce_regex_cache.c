@@ -0,0 +1,64 @@
+#include "ce_regex.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct{
+     char* expression;
+     CeRegex_t regex;
+     uint64_t last_used;
+}CeRegexCacheEntry_t;
+
+// the same handful of expressions get matched against every frame (search highlighting, n/N, incremental search), so
+// keep the compiled ones around and evict the least recently used
+static CeRegexCacheEntry_t g_regex_cache[CE_REGEX_CACHE_SIZE];
+static uint64_t g_regex_cache_tick = 0;
+
+CeRegexResult_t ce_regex_cache_get(const char* expression,
+                                   CeRegex_t* regex_handle) {
+     CeRegexResult_t result = {};
+     CeRegexCacheEntry_t* oldest = g_regex_cache;
+
+     g_regex_cache_tick++;
+     for(int64_t i = 0; i < CE_REGEX_CACHE_SIZE; i++){
+          CeRegexCacheEntry_t* entry = g_regex_cache + i;
+          if(entry->expression && strcmp(entry->expression, expression) == 0){
+               entry->last_used = g_regex_cache_tick;
+               *regex_handle = entry->regex;
+               return result;
+          }
+          if(entry->last_used < oldest->last_used) oldest = entry;
+     }
+
+     // don't cache failures, the caller reports the error
+     CeRegex_t regex = NULL;
+     result = ce_regex_init(expression, &regex);
+     if(result.error_message) return result;
+
+     char* expression_copy = strdup(expression);
+     if(expression_copy == NULL){
+          ce_regex_free(regex);
+          result.error_message = strdup("Failed to allocate regex cache entry");
+          return result;
+     }
+
+     if(oldest->expression){
+          free(oldest->expression);
+          ce_regex_free(oldest->regex);
+     }
+     oldest->expression = expression_copy;
+     oldest->regex = regex;
+     oldest->last_used = g_regex_cache_tick;
+     *regex_handle = regex;
+     return result;
+}
+
+void ce_regex_cache_clear(void) {
+     for(int64_t i = 0; i < CE_REGEX_CACHE_SIZE; i++){
+          CeRegexCacheEntry_t* entry = g_regex_cache + i;
+          if(entry->expression == NULL) continue;
+          free(entry->expression);
+          ce_regex_free(entry->regex);
+     }
+     memset(g_regex_cache, 0, sizeof(g_regex_cache));
+}
@@ -44,8 +44,64 @@ CeRegexResult_t ce_regex_match(CeRegex_t regex_handle,
      return result;
 }
 
+CeRegexResult_t ce_regex_match_all(CeRegex_t regex_handle,
+                                   const char* string,
+                                   int64_t start,
+                                   CeRegexMatch_t* matches,
+                                   int64_t max_matches,
+                                   int64_t* match_count) {
+     regex_t* regex = (regex_t*)(regex_handle);
+     CeRegexResult_t result = {};
+     result.match_start = CE_REGEX_NO_MATCH;
+     result.match_length = CE_REGEX_NO_MATCH;
+     *match_count = 0;
+
+     int64_t length = strlen(string);
+     int64_t offset = start;
+     while(*match_count < max_matches && offset <= length){
+          regmatch_t match;
+#if defined(REG_STARTEND)
+          // match within [rm_so, rm_eo) while still letting ^ and \b see the rest of the line
+          match.rm_so = offset;
+          match.rm_eo = length;
+          int rc = regexec(regex, string, 1, &match, REG_STARTEND);
+#else
+          int rc = regexec(regex, string + offset, 1, &match, (offset > 0) ? REG_NOTBOL : 0);
+          if(rc == 0){
+               match.rm_so += offset;
+               match.rm_eo += offset;
+          }
+#endif
+          if(rc == REG_NOMATCH) break;
+          if(rc != 0){
+               result.error_message = malloc(CE_REGEX_MAX_ERROR_SIZE);
+               regerror(rc, regex, result.error_message, CE_REGEX_MAX_ERROR_SIZE);
+               return result;
+          }
+
+          CeRegexMatch_t* found = matches + *match_count;
+          found->start = match.rm_so;
+          found->length = match.rm_eo - match.rm_so;
+          if(*match_count == 0){
+               result.match_start = found->start;
+               result.match_length = found->length;
+          }
+          (*match_count)++;
+
+          if(match.rm_eo > match.rm_so){
+               offset = match.rm_eo;
+          }else{
+               // step over an empty match, a whole utf8 character at a time
+               offset = match.rm_eo + 1;
+               while(offset < length && (string[offset] & 0xC0) == 0x80) offset++;
+          }
+     }
+     return result;
+}
+
 void ce_regex_free(CeRegex_t regex_handle) {
      if(regex_handle != NULL){
+          regfree((regex_t*)(regex_handle));
           free(regex_handle);
      }
 }
@@ -38,6 +38,39 @@ CeRegexResult_t ce_regex_match(CeRegex_t regex_handle,
      return result;
 }
 
+CeRegexResult_t ce_regex_match_all(CeRegex_t regex_handle,
+                                   const char* string,
+                                   int64_t start,
+                                   CeRegexMatch_t* matches,
+                                   int64_t max_matches,
+                                   int64_t* match_count) {
+     std::regex* obj = reinterpret_cast<std::regex*>(regex_handle);
+     CeRegexResult_t result = {};
+     result.match_start = CE_REGEX_NO_MATCH;
+     result.match_length = CE_REGEX_NO_MATCH;
+     *match_count = 0;
+
+     const char* end = string + strlen(string);
+     if(string + start > end) return result;
+
+     // the iterator steps over empty matches for us, match_prev_avail lets ^ and \b see the text before 'start'
+     std::regex_constants::match_flag_type flags = std::regex_constants::match_default;
+     if(start > 0) flags |= std::regex_constants::match_prev_avail;
+     std::cregex_iterator itr(string + start, end, *obj, flags);
+     std::cregex_iterator itr_end;
+     for(; itr != itr_end && *match_count < max_matches; ++itr){
+          CeRegexMatch_t* found = matches + *match_count;
+          found->start = start + itr->position(0);
+          found->length = itr->length(0);
+          if(*match_count == 0){
+               result.match_start = found->start;
+               result.match_length = found->length;
+          }
+          (*match_count)++;
+     }
+     return result;
+}
+
 void ce_regex_free(CeRegex_t regex_handle) {
      if(regex_handle){
           delete reinterpret_cast<std::regex*>(regex_handle);
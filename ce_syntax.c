@@ -4,12 +4,16 @@
 #include <string.h>
 #include <ctype.h>
 
+#if !defined(PLATFORM_WINDOWS)
+    #include <errno.h>
+    #include <pthread.h>
+    #include <unistd.h>
+#endif
+
 #if defined(DISPLAY_TERMINAL)
     #include <ncurses.h>
 #endif
 
-#define SEARCH_BACK_LINES 1024
-
 int ce_syntax_def_get_fg(CeSyntaxDef_t* syntax_defs, CeSyntaxColor_t syntax_color, int current_fg){
      int new_color = syntax_defs[syntax_color].fg;
      if(new_color == CE_SYNTAX_USE_CURRENT_COLOR) return current_fg;
@@ -23,117 +27,130 @@ int ce_syntax_def_get_bg(CeSyntaxDef_t* syntax_defs, CeSyntaxColor_t syntax_colo
 }
 
 bool ce_draw_color_list_insert(CeDrawColorList_t* list, int fg, int bg, CePoint_t point){
-     if(list->tail && list->tail->fg == fg && list->tail->bg == bg && list->tail->point.y == point.y) return true;
-     CeDrawColorNode_t* node = malloc(sizeof(*node));
-     if(!node) return false;
-     node->fg = fg;
-     node->bg = bg;
-     node->point = point;
-     node->next = NULL;
-     if(list->tail) list->tail->next = node;
-     list->tail = node;
-     if(!list->head) list->head = node;
+     if(list->count > 0){
+          CeDrawColor_t* last = list->colors + (list->count - 1);
+          if(last->fg == fg && last->bg == bg && last->point.y == point.y) return true;
+     }
+
+     if(list->count >= list->capacity){
+          int64_t new_capacity = list->capacity ? list->capacity * 2 : 256;
+          CeDrawColor_t* new_colors = realloc(list->colors, new_capacity * sizeof(*new_colors));
+          if(!new_colors) return false;
+          list->colors = new_colors;
+          list->capacity = new_capacity;
+     }
+
+     CeDrawColor_t* color = list->colors + list->count;
+     color->fg = fg;
+     color->bg = bg;
+     color->point = point;
+     list->count++;
      return true;
 }
 
+void ce_draw_color_list_clear(CeDrawColorList_t* list){
+     list->count = 0;
+}
+
 void ce_draw_color_list_free(CeDrawColorList_t* list){
-     CeDrawColorNode_t* itr = list->head;
-     while(itr){
-          CeDrawColorNode_t* tmp = itr;
-          itr = itr->next;
-          free(tmp);
-     }
+     free(list->colors);
+     list->colors = NULL;
+     list->count = 0;
+     list->capacity = 0;
+}
 
-     list->head = NULL;
-     list->tail = NULL;
+static bool range_list_reserve(CeRangeList_t* list, int64_t count){
+     if(count <= list->capacity) return true;
+     int64_t new_capacity = list->capacity ? list->capacity * 2 : 64;
+     while(new_capacity < count) new_capacity *= 2;
+     CeRange_t* new_ranges = realloc(list->ranges, new_capacity * sizeof(*new_ranges));
+     if(!new_ranges) return false;
+     list->ranges = new_ranges;
+     list->capacity = new_capacity;
+     return true;
 }
 
 bool ce_range_list_insert(CeRangeList_t* list, CePoint_t start, CePoint_t end){
-     CeRangeNode_t* node = malloc(sizeof(*node));
-     if(!node) return false;
-     node->range.start = start;
-     node->range.end = end;
-     node->next = NULL;
-     if(list->tail) list->tail->next = node;
-     list->tail = node;
-     if(!list->head) list->head = node;
+     if(!range_list_reserve(list, list->count + 1)) return false;
+     list->ranges[list->count].start = start;
+     list->ranges[list->count].end = end;
+     list->count++;
      return true;
 }
 
-bool ce_range_list_insert_sorted(CeRangeList_t* list, CePoint_t start, CePoint_t end){
-     CeRangeNode_t* itr = list->head;
-     CeRangeNode_t* prev = NULL;
-     while(itr){
-          if(prev){
-               if(ce_point_after(itr->range.start, end) &&
-                  ce_point_after(end, prev->range.end)){
-                    break;
-               }
-          }else{
-               if(ce_point_after(itr->range.start, end)){
-                    break;
-               }
+// overlapping matches are merged, highlighting walks the ranges expecting each to end before the next starts
+bool ce_range_list_insert_matches(CeRangeList_t* list, const CeMatchIndex_t* index, int64_t first_line, int64_t last_line){
+     CeRange_t range = {(CePoint_t){-1, -1}, (CePoint_t){-1, -1}};
+     int64_t count = ce_match_index_count(index);
+     for(int64_t i = ce_match_index_lower_bound(index, (CePoint_t){0, first_line}); i < count; i++){
+          CeMatch_t match = ce_match_index_get(index, i);
+          if(match.point.y > last_line) break;
+
+          CePoint_t end = {match.point.x + (match.length - 1), match.point.y};
+          if(range.start.y == match.point.y && match.point.x <= range.end.x){
+               if(end.x > range.end.x) range.end = end;
+               continue;
           }
 
-          prev = itr;
-          itr = itr->next;
-     }
-
-     if(itr){
-          if(!ce_point_after(end, itr->range.start)) return false;
+          if(range.start.y >= 0 && !ce_range_list_insert(list, range.start, range.end)) return false;
+          range.start = match.point;
+          range.end = end;
      }
 
-     CeRangeNode_t* node = malloc(sizeof(*node));
-     if(!node) return false;
-     node->range.start = start;
-     node->range.end = end;
+     if(range.start.y >= 0) return ce_range_list_insert(list, range.start, range.end);
+     return true;
+}
 
-     if(!itr){
-          node->next = NULL;
-     }else{
-          node->next = itr;
+bool ce_range_list_insert_sorted(CeRangeList_t* list, CePoint_t start, CePoint_t end){
+     // find the first range that starts after the new one ends
+     int64_t low = 0;
+     int64_t high = list->count;
+     while(low < high){
+          int64_t middle = low + (high - low) / 2;
+          if(ce_point_after(list->ranges[middle].start, end)){
+               high = middle;
+          }else{
+               low = middle + 1;
+          }
      }
 
-     if(prev){
-          prev->next = node;
-     }else{
-          list->head = node;
-     }
+     // the range before it has to end before the new one starts
+     if(low > 0 && !ce_point_after(start, list->ranges[low - 1].end)) return false;
+     if(!range_list_reserve(list, list->count + 1)) return false;
 
+     memmove(list->ranges + low + 1, list->ranges + low, (list->count - low) * sizeof(*list->ranges));
+     list->ranges[low].start = start;
+     list->ranges[low].end = end;
+     list->count++;
      return true;
 }
 
-void ce_range_list_free(CeRangeList_t* list){
-     CeRangeNode_t* itr = list->head;
-     while(itr){
-          CeRangeNode_t* tmp = itr;
-          itr = itr->next;
-          free(tmp);
-     }
+void ce_range_list_clear(CeRangeList_t* list){
+     list->count = 0;
+}
 
-     list->head = NULL;
-     list->tail = NULL;
+void ce_range_list_free(CeRangeList_t* list){
+     free(list->ranges);
+     list->ranges = NULL;
+     list->count = 0;
+     list->capacity = 0;
 }
 
 int ce_draw_color_list_last_fg_color(CeDrawColorList_t* draw_color_list){
      int fg = CE_COLOR_DEFAULT;
-     if(draw_color_list->tail) fg = draw_color_list->tail->fg;
+     if(draw_color_list->count > 0) fg = draw_color_list->colors[draw_color_list->count - 1].fg;
      return fg;
 }
 
 int ce_draw_color_list_last_bg_color(CeDrawColorList_t* draw_color_list){
      int bg = CE_COLOR_DEFAULT;
-     if(draw_color_list->tail) bg = draw_color_list->tail->bg;
+     if(draw_color_list->count > 0) bg = draw_color_list->colors[draw_color_list->count - 1].bg;
      return bg;
 }
 
 int ce_draw_color_list_next_to_last_fg_color(CeDrawColorList_t* draw_color_list){
      int fg = CE_COLOR_DEFAULT;
-     if(draw_color_list->tail && (draw_color_list->head != draw_color_list->tail)){
-          CeDrawColorNode_t* itr = draw_color_list->head;
-          while(itr->next != draw_color_list->tail) itr = itr->next;
-          fg = itr->fg;
-     }
+     if(draw_color_list->count > 1) fg = draw_color_list->colors[draw_color_list->count - 2].fg;
      return fg;
 }
 
@@ -170,27 +187,117 @@ static bool is_c_type_char(int ch){
      return isalnum(ch) || ch == '_';
 }
 
-static int64_t match_words(const char* str, const char* beginning_of_line, const char** words, int64_t word_count){
-     for(int64_t i = 0; i < word_count; ++i){
-          int64_t word_len = strlen(words[i]);
-          if(strncmp(words[i], str, word_len) == 0){
-               // make sure word isn't in the middle of an identifier
-               char post_char = str[word_len];
-               if(is_c_type_char(post_char)) return 0;
-               if(str > beginning_of_line){
-                    char pre_char = *(str - 1);
-                    if(is_c_type_char(pre_char)) return 0;
+#define SYNTAX_KEYWORD_MAX_COUNT 64
+#define SYNTAX_KEYWORD_MAX_SLOTS 512
+
+// a perfect hash of a keyword list, so looking up an identifier is a single probe. It's built the first time the
+// list is used, searching for a seed that gives every keyword its own slot
+typedef struct{
+     const char** words;
+     int64_t word_count;
+     bool built;
+     uint32_t seed;
+     uint32_t mask;
+     uint8_t lengths[SYNTAX_KEYWORD_MAX_COUNT];
+     uint8_t slots[SYNTAX_KEYWORD_MAX_SLOTS]; // index + 1 of the word in the slot, 0 when empty
+}CeSyntaxKeywords_t;
+
+#if !defined(PLATFORM_WINDOWS)
+static pthread_mutex_t g_syntax_keywords_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static uint32_t syntax_keyword_hash(const char* str, int64_t len, uint32_t seed){
+     uint32_t hash = 2166136261u ^ seed;
+     for(int64_t i = 0; i < len; i++){
+          hash ^= (uint8_t)(str[i]);
+          hash *= 16777619u;
+     }
+     return hash;
+}
+
+static void syntax_keywords_build(CeSyntaxKeywords_t* keywords){
+     if(keywords->word_count > SYNTAX_KEYWORD_MAX_COUNT){
+          ce_log("%ld keywords is more than the %d supported\n", keywords->word_count, SYNTAX_KEYWORD_MAX_COUNT);
+          keywords->word_count = SYNTAX_KEYWORD_MAX_COUNT;
+     }
+
+     for(int64_t i = 0; i < keywords->word_count; i++){
+          keywords->lengths[i] = strlen(keywords->words[i]);
+     }
+
+     // a table 4 times the size of the list rarely takes more than a few hundred seeds
+     uint32_t slot_count = 16;
+     while(slot_count < (keywords->word_count * 4)) slot_count *= 2;
+
+     for(; slot_count <= SYNTAX_KEYWORD_MAX_SLOTS; slot_count *= 2){
+          for(uint32_t seed = 0; seed < 100000; seed++){
+               memset(keywords->slots, 0, slot_count);
+               bool perfect = true;
+               for(int64_t i = 0; i < keywords->word_count; i++){
+                    uint32_t slot = syntax_keyword_hash(keywords->words[i], keywords->lengths[i], seed) & (slot_count - 1);
+                    uint8_t existing = keywords->slots[slot];
+                    if(existing == 0){
+                         keywords->slots[slot] = i + 1;
+                    }else if(strcmp(keywords->words[existing - 1], keywords->words[i]) != 0){
+                         perfect = false;
+                         break;
+                    }
                }
 
-               return word_len;
+               if(perfect){
+                    keywords->seed = seed;
+                    keywords->mask = slot_count - 1;
+                    return;
+               }
           }
      }
 
+     ce_log("failed to find a perfect hash for %ld keywords starting with '%s'\n", keywords->word_count, keywords->words[0]);
+     memset(keywords->slots, 0, sizeof(keywords->slots));
+     keywords->mask = 0;
+}
+
+static bool syntax_keywords_contain(CeSyntaxKeywords_t* keywords, const char* str, int64_t len){
+#if defined(PLATFORM_WINDOWS)
+     if(!keywords->built){
+          syntax_keywords_build(keywords);
+          keywords->built = true;
+     }
+#else
+     // the lexer may run on more than one thread
+     if(!__atomic_load_n(&keywords->built, __ATOMIC_ACQUIRE)){
+          pthread_mutex_lock(&g_syntax_keywords_lock);
+          if(!keywords->built){
+               syntax_keywords_build(keywords);
+               __atomic_store_n(&keywords->built, true, __ATOMIC_RELEASE);
+          }
+          pthread_mutex_unlock(&g_syntax_keywords_lock);
+     }
+#endif
+
+     uint8_t slot = keywords->slots[syntax_keyword_hash(str, len, keywords->seed) & keywords->mask];
+     if(slot == 0) return false;
+     slot--;
+     return keywords->lengths[slot] == len && strncmp(keywords->words[slot], str, len) == 0;
+}
+
+static int64_t match_keywords(const char* str, const char* beginning_of_line, CeSyntaxKeywords_t* keywords){
+     // make sure word isn't in the middle of an identifier
+     if(str > beginning_of_line){
+          char pre_char = *(str - 1);
+          if(is_c_type_char(pre_char)) return 0;
+     }
+
+     int64_t len = 0;
+     while(is_c_type_char(str[len])) len++;
+     if(len == 0 || len > UINT8_MAX) return 0;
+
+     if(syntax_keywords_contain(keywords, str, len)) return len;
      return 0;
 }
 
-static int64_t match_c_type(const char* str, const char* beginning_of_line, bool cpp){
-     if(!isalpha((int)(*str))) return false;
+static int64_t match_type(const char* str, const char* beginning_of_line, bool cpp){
+     if(!isalpha((int)(*str)) && *str != '_') return false;
 
      const char* itr = str;
      while(*itr){
@@ -205,7 +312,7 @@ static int64_t match_c_type(const char* str, const char* beginning_of_line, bool
           if(cpp && isupper((int)(*str))) return len;
      }
 
-     static const char* keywords[] = {
+     static const char* words[] = {
           "bool",
           "char",
           "double",
@@ -228,13 +335,17 @@ static int64_t match_c_type(const char* str, const char* beginning_of_line, bool
           "F64",
      };
 
-     static const int64_t keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+     static CeSyntaxKeywords_t keywords = {.words = words, .word_count = sizeof(words) / sizeof(words[0])};
+
+     return match_keywords(str, beginning_of_line, &keywords);
+}
 
-     return match_words(str, beginning_of_line, keywords, keyword_count);
+static int64_t match_c_type(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     return match_type(str, beginning_of_line, false);
 }
 
-static int64_t match_c_keyword(const char* str, const char* beginning_of_line){
-     static const char* keywords[] = {
+static int64_t match_c_keyword(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     static const char* words[] = {
           "__thread",
           "auto",
           "case",
@@ -260,13 +371,13 @@ static int64_t match_c_keyword(const char* str, const char* beginning_of_line){
           "while",
      };
 
-     static const int64_t keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+     static CeSyntaxKeywords_t keywords = {.words = words, .word_count = sizeof(words) / sizeof(words[0])};
 
-     return match_words(str, beginning_of_line, keywords, keyword_count);
+     return match_keywords(str, beginning_of_line, &keywords);
 }
 
-static int64_t match_c_control(const char* str, const char* beginning_of_line){
-     static const char* keywords [] = {
+static int64_t match_c_control(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     static const char* words[] = {
           "break",
           "const",
           "continue",
@@ -274,9 +385,9 @@ static int64_t match_c_control(const char* str, const char* beginning_of_line){
           "return",
      };
 
-     static const int64_t keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+     static CeSyntaxKeywords_t keywords = {.words = words, .word_count = sizeof(words) / sizeof(words[0])};
 
-     return match_words(str, beginning_of_line, keywords, keyword_count);
+     return match_keywords(str, beginning_of_line, &keywords);
 }
 
 static bool is_caps_var_char(int ch){
@@ -287,7 +398,7 @@ static bool is_starting_caps_var_char(int ch){
      return (ch >= 'A' && ch <= 'Z') || ch == '_';
 }
 
-static int64_t match_caps_var(const char* str, const char* beginning_of_line){
+static int64_t match_caps_var(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
      const char* itr = str;
      if(!is_starting_caps_var_char(*itr)) return 0; // make sure the first char is not a number
      itr++;
@@ -307,7 +418,7 @@ static int64_t match_caps_var(const char* str, const char* beginning_of_line){
      return 0;
 }
 
-static int64_t match_c_preproc(const char* str){
+static int64_t match_c_preproc(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
      if(*str == '#'){
           const char* itr = str + 1;
           while(*itr){
@@ -321,36 +432,40 @@ static int64_t match_c_preproc(const char* str){
      return 0;
 }
 
-static int64_t utf8_strlen_until_trailing_whitespace(const char* str){
+static int64_t strlen_until_trailing_whitespace(const char* str){
      const char* itr = str;
      while(*itr) itr++;
      itr--;
      while(itr > str && *itr && isblank((int)(*itr))) itr--;
-     return ce_utf8_strlen_between(str, itr);
+     return (itr - str) + 1;
 }
 
-static int64_t match_c_comment(const char* str){
-     if(strncmp("//", str, 2) == 0) return utf8_strlen_until_trailing_whitespace(str);
+static int64_t match_c_comment(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     if(strncmp("//", str, 2) == 0) return strlen_until_trailing_whitespace(str);
      return 0;
 }
 
-static int64_t match_c_multiline_comment(const char* str){
+static int64_t match_c_multiline_comment(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
      if(strncmp("/*", str, 2) == 0){
+          *state = CE_SYNTAX_STATE_MULTILINE_COMMENT;
           char* matching_comment = strstr(str, "*/");
           if(matching_comment) return (matching_comment - str);
-          return utf8_strlen_until_trailing_whitespace(str);
+          return strlen_until_trailing_whitespace(str);
      }
 
      return 0;
 }
 
-static int64_t match_c_multiline_comment_end(const char* str){
-     if(strncmp("*/", str, 2) == 0) return 2;
+static int64_t match_c_multiline_comment_end(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     if(strncmp("*/", str, 2) == 0){
+          *state = CE_SYNTAX_STATE_NONE;
+          return 2;
+     }
 
      return 0;
 }
 
-static int64_t match_c_string(const char* str){
+static int64_t match_c_string(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
      if(*str == '"'){
           const char* match = str;
           while(match){
@@ -364,7 +479,7 @@ static int64_t match_c_string(const char* str){
      return 0;
 }
 
-static int64_t match_c_character_literal(const char* str){
+static int64_t match_c_character_literal(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
      // c character literals are one character long unless that character is escaped
      // in which case the literal will be 2 characters long before we see an end '
      if(*str == '\''){
@@ -386,7 +501,7 @@ static int64_t match_c_character_literal(const char* str){
      return 0;
 }
 
-static int64_t match_c_literal(const char* str, const char* beginning_of_line){
+static int64_t match_c_literal(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
      const char* itr = str;
      int64_t count = 0;
      char ch = *itr;
@@ -466,7 +581,7 @@ static int64_t match_c_literal(const char* str, const char* beginning_of_line){
      return count;
 }
 
-static int64_t match_trailing_whitespace(const char* str){
+static int64_t match_trailing_whitespace(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
      const char* itr = str;
      while(*itr){
           if(!isspace((int)(*itr))) return 0;
@@ -483,11 +598,12 @@ static void change_draw_color(CeDrawColorList_t* draw_color_list, CeSyntaxDef_t*
 }
 
 
-void check_visual_start(CeRangeNode_t* range_node, int64_t line, CeDrawColorList_t* draw_color_list,
+void check_visual_start(const CeRangeList_t* range_list, int64_t range_index, int64_t line, CeDrawColorList_t* draw_color_list,
                         CeSyntaxDef_t* syntax_defs, bool* in_visual){
-     if(range_node){
+     if(range_index < range_list->count){
+          const CeRange_t* range = range_list->ranges + range_index;
           CePoint_t start = {0, line};
-          if(ce_point_after(start, range_node->range.start) && !ce_point_after(start, range_node->range.end)){
+          if(ce_point_after(start, range->start) && !ce_point_after(start, range->end)){
                int bg = ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_VISUAL, ce_draw_color_list_last_bg_color(draw_color_list));
                int fg = ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_VISUAL, ce_draw_color_list_last_fg_color(draw_color_list));
                ce_draw_color_list_insert(draw_color_list, fg, bg, start);
@@ -496,11 +612,12 @@ void check_visual_start(CeRangeNode_t* range_node, int64_t line, CeDrawColorList
      }
 }
 
-void ce_syntax_highlight_visual(CeRangeNode_t** range_node, bool* in_visual, CePoint_t point, CeDrawColorList_t* draw_color_list,
-                                CeSyntaxDef_t* syntax_defs){
-     if(*range_node){
+void ce_syntax_highlight_visual(const CeRangeList_t* range_list, int64_t* range_index, bool* in_visual, CePoint_t point,
+                                CeDrawColorList_t* draw_color_list, CeSyntaxDef_t* syntax_defs){
+     if(*range_index < range_list->count){
+          const CeRange_t* range = range_list->ranges + *range_index;
           if(*in_visual){
-               if(ce_point_after(point, (*range_node)->range.end)){
+               if(ce_point_after(point, range->end)){
                     if(syntax_defs[CE_SYNTAX_COLOR_VISUAL].fg == CE_SYNTAX_USE_CURRENT_COLOR){
                          // if the syntax def for visual fg is use current color, then keep that one
                          ce_draw_color_list_insert(draw_color_list, ce_draw_color_list_last_fg_color(draw_color_list),
@@ -511,39 +628,611 @@ void ce_syntax_highlight_visual(CeRangeNode_t** range_node, bool* in_visual, CeP
                                                    CE_COLOR_DEFAULT, point);
                     }
 
-                    *range_node = (*range_node)->next;
+                    (*range_index)++;
                     *in_visual = false;
                }
           }else{
-               if(ce_points_equal(point, (*range_node)->range.start)){
+               if(ce_points_equal(point, range->start)){
                     int bg = ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_VISUAL, ce_draw_color_list_last_bg_color(draw_color_list));
                     int fg = ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_VISUAL, ce_draw_color_list_last_fg_color(draw_color_list));
                     ce_draw_color_list_insert(draw_color_list, fg, bg, point);
                     *in_visual = true;
-               }else if(ce_point_after(point, (*range_node)->range.end)){
-                    *range_node = (*range_node)->next;
+               }else if(ce_point_after(point, range->end)){
+                    (*range_index)++;
                }
           }
      }
 }
 
-void check_visual_mode_end(CeRangeNode_t* range_node, bool* in_visual, int64_t line, int64_t line_len,
+void check_visual_mode_end(const CeRangeList_t* range_list, int64_t range_index, bool* in_visual, int64_t line, int64_t line_len,
                            CeDrawColorList_t* draw_color_list){
-     if(!range_node) return;
+     if(range_index >= range_list->count) return;
 
      CePoint_t point = {line_len, line};
      if(in_visual){
-          if(ce_point_after(point, range_node->range.end)){
+          if(ce_point_after(point, range_list->ranges[range_index].end)){
                ce_draw_color_list_insert(draw_color_list, ce_draw_color_list_last_fg_color(draw_color_list),
                                          CE_COLOR_DEFAULT, point);
-               range_node = range_node->next;
                *in_visual = false;
           }
      }
 }
 
-void ce_syntax_highlight_c(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
-                           CeSyntaxDef_t* syntax_defs, void* user_data){
+static bool syntax_token_push(CeSyntaxTokenList_t* tokens, int64_t x, CeSyntaxColor_t color){
+     // unmatched text only needs marking where it starts
+     if(color == CE_SYNTAX_COLOR_NORMAL && tokens->count > 0 &&
+        tokens->tokens[tokens->count - 1].color == CE_SYNTAX_COLOR_NORMAL){
+          return true;
+     }
+
+     if(tokens->count >= tokens->capacity){
+          int64_t new_capacity = tokens->capacity ? tokens->capacity * 2 : 64;
+          CeSyntaxToken_t* new_tokens = realloc(tokens->tokens, new_capacity * sizeof(*new_tokens));
+          if(!new_tokens) return false;
+          tokens->tokens = new_tokens;
+          tokens->capacity = new_capacity;
+     }
+
+     tokens->tokens[tokens->count].x = x;
+     tokens->tokens[tokens->count].color = color;
+     tokens->count++;
+     return true;
+}
+
+static CeSyntaxColor_t syntax_state_color(CeSyntaxState_t state){
+     switch(state){
+     default:
+          break;
+     case CE_SYNTAX_STATE_MULTILINE_COMMENT:
+          return CE_SYNTAX_COLOR_COMMENT;
+     case CE_SYNTAX_STATE_DOCSTRING_SINGLE_QUOTE:
+     case CE_SYNTAX_STATE_DOCSTRING_DOUBLE_QUOTE:
+          return CE_SYNTAX_COLOR_STRING;
+     }
+
+     return CE_SYNTAX_COLOR_NORMAL;
+}
+
+static void syntax_line_forget(CeSyntaxLine_t* line){
+     free(line->tokens);
+     line->tokens = NULL;
+     line->token_count = -1;
+     line->lexed = false;
+}
+
+static bool syntax_cache_reserve(CeSyntaxCache_t* cache, int64_t line_count){
+     if(line_count <= cache->line_capacity) return true;
+
+     int64_t new_capacity = cache->line_capacity ? cache->line_capacity : 1024;
+     while(new_capacity < line_count) new_capacity *= 2;
+     CeSyntaxLine_t* new_lines = realloc(cache->lines, new_capacity * sizeof(*new_lines));
+     if(!new_lines) return false;
+     cache->lines = new_lines;
+     cache->line_capacity = new_capacity;
+     return true;
+}
+
+static bool syntax_cache_reset(CeSyntaxCache_t* cache, CeBuffer_t* buffer){
+     for(int64_t i = 0; i < cache->line_count; i++){
+          free(cache->lines[i].tokens);
+     }
+
+     cache->line_count = 0;
+     cache->valid_line_count = 0;
+     ce_buffer_change_mark(&cache->synced, buffer);
+     if(!syntax_cache_reserve(cache, buffer->line_count)){
+          ce_log("failed to allocate syntax state for %ld lines\n", buffer->line_count);
+          return false;
+     }
+
+     memset(cache->lines, 0, buffer->line_count * sizeof(*cache->lines));
+     for(int64_t i = 0; i < buffer->line_count; i++){
+          cache->lines[i].token_count = -1;
+     }
+     cache->line_count = buffer->line_count;
+     return true;
+}
+
+// follow a change the same way the buffer's lines did, forgetting what we knew about the lines it touched
+static bool syntax_cache_apply_change(CeSyntaxCache_t* cache, const CeBufferChange_t* change, bool undo){
+     bool insertion = (change->insertion != undo);
+     int64_t first_line = change->location.y;
+     int64_t line_count = ce_util_count_string_lines(change->string) - 1;
+     if(first_line < 0 || first_line >= cache->line_count) return false;
+
+     if(insertion){
+          if(!syntax_cache_reserve(cache, cache->line_count + line_count)) return false;
+          CeSyntaxLine_t* after = cache->lines + first_line + 1;
+          memmove(after + line_count, after, (cache->line_count - (first_line + 1)) * sizeof(*after));
+          memset(after, 0, line_count * sizeof(*after));
+          for(int64_t i = 0; i < line_count; i++){
+               after[i].token_count = -1;
+          }
+          cache->line_count += line_count;
+     }else{
+          if(first_line + line_count >= cache->line_count) return false;
+          CeSyntaxLine_t* joined = cache->lines + first_line + 1;
+          for(int64_t i = 0; i < line_count; i++){
+               free(joined[i].tokens);
+          }
+          memmove(joined, joined + line_count, (cache->line_count - (first_line + 1 + line_count)) * sizeof(*joined));
+          cache->line_count -= line_count;
+     }
+
+     syntax_line_forget(cache->lines + first_line);
+     if(cache->valid_line_count > first_line) cache->valid_line_count = first_line;
+     return true;
+}
+
+CeSyntaxCache_t* ce_syntax_cache_get(CeBuffer_t* buffer, const CeSyntaxLanguage_t* language){
+     CeSyntaxCache_t* cache = buffer->syntax_cache;
+     if(!cache){
+          cache = calloc(1, sizeof(*cache));
+          if(!cache) return NULL;
+          buffer->syntax_cache = cache;
+     }
+
+     // the buffer's syntax was changed
+     if(cache->language != language){
+          cache->language = language;
+          return syntax_cache_reset(cache, buffer) ? cache : NULL;
+     }
+
+     if(cache->synced.buffer_version == buffer->version) return cache;
+
+     CeBufferChangesSince_t changes;
+     bool applied = ce_buffer_changes_since(buffer, &cache->synced, &changes);
+     if(applied && changes.grown_line >= 0 && changes.grown_line < cache->line_count){
+          syntax_line_forget(cache->lines + changes.grown_line);
+          if(cache->valid_line_count > changes.grown_line) cache->valid_line_count = changes.grown_line;
+     }
+     for(int64_t i = 0; applied && i < changes.count; i++){
+          applied = syntax_cache_apply_change(cache, &changes.nodes[i]->change, changes.undo);
+     }
+     ce_buffer_changes_since_free(&changes);
+
+     if(!applied || cache->line_count != buffer->line_count){
+          return syntax_cache_reset(cache, buffer) ? cache : NULL;
+     }
+
+     ce_buffer_change_mark(&cache->synced, buffer);
+     return cache;
+}
+
+static void syntax_background_forget(CeBuffer_t* buffer);
+
+// bumped when lines lexed in the background are taken, or a buffer's cache goes away and its address may be reused
+static int64_t g_syntax_generation;
+
+void ce_syntax_cache_free(CeBuffer_t* buffer){
+     syntax_background_forget(buffer);
+     g_syntax_generation++;
+
+     CeSyntaxCache_t* cache = buffer->syntax_cache;
+     if(!cache) return;
+
+     for(int64_t i = 0; i < cache->line_count; i++){
+          free(cache->lines[i].tokens);
+     }
+     free(cache->lines);
+     free(cache->scratch.tokens);
+     free(cache);
+     buffer->syntax_cache = NULL;
+}
+
+// a single forward pass over the line's bytes, x counts the runes we have stepped over so far
+static CeSyntaxState_t syntax_lex_line(const CeSyntaxLanguage_t* language, const char* line, CeSyntaxState_t state,
+                                       int64_t cursor_x, CeSyntaxTokenList_t* tokens){
+     const char* str = line;
+     int64_t x = 0;
+
+     while(*str){
+          int64_t match_len = 0;
+
+          if(state != CE_SYNTAX_STATE_NONE){
+               if(!(match_len = language->match_state_end(str, line, &state)) && language->trailing_whitespace_in_state &&
+                  x > cursor_x && (match_len = match_trailing_whitespace(str, line, &state))){
+                    syntax_token_push(tokens, x, CE_SYNTAX_COLOR_TRAILING_WHITESPACE);
+               }
+          }else{
+               CeSyntaxColor_t color = CE_SYNTAX_COLOR_NORMAL;
+               for(int64_t i = 0; i < language->rule_count; i++){
+                    const CeSyntaxRule_t* rule = language->rules + i;
+                    if(rule->color == CE_SYNTAX_COLOR_TRAILING_WHITESPACE && x <= cursor_x) continue;
+                    if((match_len = rule->match(str, line, &state))){
+                         color = rule->color;
+                         break;
+                    }
+               }
+
+               // none of the rules match starting in the middle of an identifier, so don't try the rest of it
+               if(!match_len){
+                    while(is_c_type_char((unsigned char)(str[match_len]))) match_len++;
+               }
+
+               syntax_token_push(tokens, x, color);
+          }
+
+          if(match_len <= 0) match_len = 1;
+          const char* match_end = str + match_len;
+          while(str < match_end && *str){
+               str++;
+               while(((unsigned char)(*str) & 0xC0) == 0x80) str++;
+               x++;
+          }
+     }
+
+     return state;
+}
+
+// lexes the line if it changed or starts in a different state than it was lexed in. When keep_tokens is false only
+// the end state is needed. If keeping the tokens fails, they are left in the cache's scratch list
+static CeSyntaxLine_t* syntax_cache_lex_line(CeSyntaxCache_t* cache, CeBuffer_t* buffer, int64_t y, bool keep_tokens){
+     CeSyntaxLine_t* line = cache->lines + y;
+     CeSyntaxState_t entry_state = (y > 0) ? cache->lines[y - 1].end_state : CE_SYNTAX_STATE_NONE;
+     if(line->lexed && line->entry_state == entry_state && (!keep_tokens || line->token_count >= 0)) return line;
+
+     syntax_line_forget(line);
+     cache->scratch.count = 0;
+     line->end_state = syntax_lex_line(cache->language, ce_buffer_line(buffer, y), entry_state, -1, &cache->scratch);
+     line->entry_state = entry_state;
+     line->lexed = true;
+
+     if(keep_tokens){
+          if(cache->scratch.count > 0){
+               line->tokens = malloc(cache->scratch.count * sizeof(*line->tokens));
+               if(!line->tokens) return line;
+               memcpy(line->tokens, cache->scratch.tokens, cache->scratch.count * sizeof(*line->tokens));
+          }
+          line->token_count = cache->scratch.count;
+     }
+
+     return line;
+}
+
+// lines at the start of the unchecked region that were already lexed starting in the right state don't need it again
+static void syntax_cache_skip_valid_lines(CeSyntaxCache_t* cache){
+     while(cache->valid_line_count < cache->line_count){
+          CeSyntaxLine_t* line = cache->lines + cache->valid_line_count;
+          CeSyntaxState_t entry_state = (cache->valid_line_count > 0) ? cache->lines[cache->valid_line_count - 1].end_state :
+                                                                      CE_SYNTAX_STATE_NONE;
+          if(!line->lexed || line->entry_state != entry_state) break;
+          cache->valid_line_count++;
+     }
+}
+
+#if !defined(PLATFORM_WINDOWS)
+// lines copied out of a buffer for the background lexer, so it never reads a buffer that's being edited
+typedef struct{
+     CeBuffer_t* buffer; // only touched by the main thread, cleared if the buffer is freed before the job comes back
+     const CeSyntaxLanguage_t* language;
+     int64_t buffer_version; // the results only apply to the buffer if it hasn't changed since the lines were copied
+     int64_t first_line;
+     int64_t line_count;
+     int64_t keep_tokens_first; // tokens are only kept for lines near the view, the rest just need their end state
+     int64_t keep_tokens_last;
+     CeSyntaxState_t entry_state;
+     char** lines;
+     CeSyntaxLine_t* results;
+}CeSyntaxBackgroundJob_t;
+
+typedef struct{
+     pthread_t thread;
+     pthread_mutex_t lock;
+     pthread_cond_t cond;
+     bool running;
+     int wake_fd;
+
+     // shared with the thread under the lock
+     CeSyntaxBackgroundJob_t* job;
+     bool job_done;
+     bool should_die;
+
+     // main thread only
+     CeSyntaxBackgroundJob_t* in_flight;
+     CeBuffer_t* wanted_buffer;
+     int64_t wanted_line_count;
+     int64_t view_first;
+     int64_t view_last;
+}CeSyntaxBackground_t;
+
+static CeSyntaxBackground_t g_syntax_background;
+
+static void syntax_background_job_free(CeSyntaxBackgroundJob_t* job){
+     for(int64_t i = 0; i < job->line_count; i++){
+          free(job->lines[i]);
+          free(job->results[i].tokens);
+     }
+     free(job->lines);
+     free(job->results);
+     free(job);
+}
+
+static void syntax_background_lex(CeSyntaxBackgroundJob_t* job, CeSyntaxTokenList_t* scratch){
+     CeSyntaxState_t state = job->entry_state;
+     for(int64_t i = 0; i < job->line_count; i++){
+          CeSyntaxLine_t* result = job->results + i;
+          int64_t y = job->first_line + i;
+          scratch->count = 0;
+          result->entry_state = state;
+          result->end_state = syntax_lex_line(job->language, job->lines[i], state, -1, scratch);
+          result->lexed = true;
+          result->token_count = -1;
+          state = result->end_state;
+
+          if(y < job->keep_tokens_first || y > job->keep_tokens_last) continue;
+          if(scratch->count > 0){
+               result->tokens = malloc(scratch->count * sizeof(*result->tokens));
+               if(!result->tokens) continue;
+               memcpy(result->tokens, scratch->tokens, scratch->count * sizeof(*result->tokens));
+          }
+          result->token_count = scratch->count;
+     }
+}
+
+static void* syntax_background_thread(void* data){
+     CeSyntaxTokenList_t scratch = {};
+
+     pthread_mutex_lock(&g_syntax_background.lock);
+     while(!g_syntax_background.should_die){
+          if(!g_syntax_background.job || g_syntax_background.job_done){
+               pthread_cond_wait(&g_syntax_background.cond, &g_syntax_background.lock);
+               continue;
+          }
+
+          CeSyntaxBackgroundJob_t* job = g_syntax_background.job;
+          pthread_mutex_unlock(&g_syntax_background.lock);
+
+          syntax_background_lex(job, &scratch);
+
+          pthread_mutex_lock(&g_syntax_background.lock);
+          g_syntax_background.job_done = true;
+
+          // wake up the main loop so it takes the lines
+          if(g_syntax_background.wake_fd >= 0){
+               int rc = 0;
+               do{
+                    rc = write(g_syntax_background.wake_fd, "1", 2);
+               }while(rc == -1 && errno == EINTR);
+          }
+     }
+     pthread_mutex_unlock(&g_syntax_background.lock);
+
+     free(scratch.tokens);
+     return NULL;
+}
+
+// hand the thread the next chunk of lines the wanted buffer hasn't lexed yet, if it isn't busy
+static void syntax_background_queue(void){
+     CeBuffer_t* buffer = g_syntax_background.wanted_buffer;
+     if(!g_syntax_background.running || g_syntax_background.in_flight || !buffer) return;
+
+     CeSyntaxCache_t* cache = buffer->syntax_cache;
+     if(cache) cache = ce_syntax_cache_get(buffer, cache->language);
+     if(!cache){
+          g_syntax_background.wanted_buffer = NULL;
+          return;
+     }
+
+     syntax_cache_skip_valid_lines(cache);
+     int64_t wanted_line_count = g_syntax_background.wanted_line_count;
+     if(wanted_line_count > cache->line_count) wanted_line_count = cache->line_count;
+     if(cache->valid_line_count >= wanted_line_count){
+          g_syntax_background.wanted_buffer = NULL;
+          return;
+     }
+
+     CeSyntaxBackgroundJob_t* job = calloc(1, sizeof(*job));
+     if(!job) return;
+     job->buffer = buffer;
+     job->language = cache->language;
+     job->buffer_version = buffer->version;
+     job->first_line = cache->valid_line_count;
+     job->line_count = wanted_line_count - job->first_line;
+     if(job->line_count > CE_SYNTAX_BACKGROUND_CHUNK_LINES) job->line_count = CE_SYNTAX_BACKGROUND_CHUNK_LINES;
+     job->keep_tokens_first = g_syntax_background.view_first;
+     job->keep_tokens_last = g_syntax_background.view_last;
+     job->entry_state = (job->first_line > 0) ? cache->lines[job->first_line - 1].end_state : CE_SYNTAX_STATE_NONE;
+     job->lines = calloc(job->line_count, sizeof(*job->lines));
+     job->results = calloc(job->line_count, sizeof(*job->results));
+     if(!job->lines || !job->results){
+          free(job->lines);
+          free(job->results);
+          free(job);
+          return;
+     }
+
+     for(int64_t i = 0; i < job->line_count; i++){
+          job->lines[i] = strdup(ce_buffer_line(buffer, job->first_line + i));
+          if(!job->lines[i]){
+               job->line_count = i;
+               syntax_background_job_free(job);
+               return;
+          }
+     }
+
+     pthread_mutex_lock(&g_syntax_background.lock);
+     g_syntax_background.job = job;
+     g_syntax_background.job_done = false;
+     pthread_cond_signal(&g_syntax_background.cond);
+     pthread_mutex_unlock(&g_syntax_background.lock);
+     g_syntax_background.in_flight = job;
+}
+
+// a view is waiting on lines too far above it to lex right now, keep lexing until we are a chunk past its bottom
+static void syntax_background_want(CeBuffer_t* buffer, int64_t view_first, int64_t view_last){
+     int64_t view_line_count = (view_last - view_first) + 1;
+     g_syntax_background.wanted_buffer = buffer;
+     g_syntax_background.wanted_line_count = view_last + 1 + CE_SYNTAX_BACKGROUND_CHUNK_LINES;
+     g_syntax_background.view_first = view_first - view_line_count;
+     g_syntax_background.view_last = view_last + view_line_count;
+     syntax_background_queue();
+}
+
+static void syntax_background_forget(CeBuffer_t* buffer){
+     if(g_syntax_background.wanted_buffer == buffer) g_syntax_background.wanted_buffer = NULL;
+     if(g_syntax_background.in_flight && g_syntax_background.in_flight->buffer == buffer){
+          g_syntax_background.in_flight->buffer = NULL;
+     }
+}
+
+bool ce_syntax_background_start(int wake_fd){
+     if(g_syntax_background.running) return true;
+
+     memset(&g_syntax_background, 0, sizeof(g_syntax_background));
+     g_syntax_background.wake_fd = wake_fd;
+     pthread_mutex_init(&g_syntax_background.lock, NULL);
+     pthread_cond_init(&g_syntax_background.cond, NULL);
+     int rc = pthread_create(&g_syntax_background.thread, NULL, syntax_background_thread, NULL);
+     if(rc != 0){
+          ce_log("pthread_create() failed: '%s'\n", strerror(rc));
+          pthread_cond_destroy(&g_syntax_background.cond);
+          pthread_mutex_destroy(&g_syntax_background.lock);
+          return false;
+     }
+
+     g_syntax_background.running = true;
+     return true;
+}
+
+void ce_syntax_background_stop(void){
+     if(!g_syntax_background.running) return;
+
+     pthread_mutex_lock(&g_syntax_background.lock);
+     g_syntax_background.should_die = true;
+     pthread_cond_signal(&g_syntax_background.cond);
+     pthread_mutex_unlock(&g_syntax_background.lock);
+     pthread_join(g_syntax_background.thread, NULL);
+
+     if(g_syntax_background.in_flight) syntax_background_job_free(g_syntax_background.in_flight);
+     pthread_cond_destroy(&g_syntax_background.cond);
+     pthread_mutex_destroy(&g_syntax_background.lock);
+     memset(&g_syntax_background, 0, sizeof(g_syntax_background));
+}
+
+bool ce_syntax_background_update(void){
+     CeSyntaxBackgroundJob_t* job = g_syntax_background.in_flight;
+     if(!job) return false;
+
+     pthread_mutex_lock(&g_syntax_background.lock);
+     bool done = g_syntax_background.job_done;
+     if(done) g_syntax_background.job = NULL;
+     pthread_mutex_unlock(&g_syntax_background.lock);
+     if(!done) return false;
+
+     g_syntax_background.in_flight = NULL;
+
+     // the lines only fit if the buffer is exactly as it was when they were copied
+     bool taken = false;
+     CeBuffer_t* buffer = job->buffer;
+     CeSyntaxCache_t* cache = buffer ? buffer->syntax_cache : NULL;
+     if(cache && cache->language == job->language && buffer->version == job->buffer_version){
+          cache = ce_syntax_cache_get(buffer, cache->language);
+          if(cache && cache->valid_line_count >= job->first_line && cache->line_count >= job->first_line + job->line_count){
+               for(int64_t i = cache->valid_line_count - job->first_line; i < job->line_count; i++){
+                    CeSyntaxLine_t* line = cache->lines + job->first_line + i;
+                    syntax_line_forget(line);
+                    *line = job->results[i];
+                    job->results[i].tokens = NULL;
+               }
+               if(cache->valid_line_count < job->first_line + job->line_count){
+                    cache->valid_line_count = job->first_line + job->line_count;
+                    g_syntax_generation++;
+                    taken = true;
+               }
+          }
+     }
+
+     syntax_background_job_free(job);
+     syntax_background_queue();
+     return taken;
+}
+#else
+static void syntax_background_want(CeBuffer_t* buffer, int64_t view_first, int64_t view_last){
+}
+
+static void syntax_background_forget(CeBuffer_t* buffer){
+}
+
+bool ce_syntax_background_start(int wake_fd){
+     return false;
+}
+
+void ce_syntax_background_stop(void){
+}
+
+bool ce_syntax_background_update(void){
+     return false;
+}
+#endif
+
+int64_t ce_syntax_generation(void){
+     return g_syntax_generation;
+}
+
+static bool syntax_background_running(void){
+#if defined(PLATFORM_WINDOWS)
+     return false;
+#else
+     return g_syntax_background.running;
+#endif
+}
+
+static void syntax_draw_line_tokens(const CeSyntaxToken_t* tokens, int64_t token_count, CeSyntaxState_t entry_state,
+                                    int64_t y, int64_t line_len, const CeRangeList_t* range_list, int64_t* range_index, bool* in_visual,
+                                    CeDrawColorList_t* draw_color_list, CeSyntaxDef_t* syntax_defs){
+     CePoint_t match_point = {0, y};
+     CeSyntaxColor_t state_color = syntax_state_color(entry_state);
+     if(state_color != CE_SYNTAX_COLOR_NORMAL){
+          change_draw_color(draw_color_list, syntax_defs, state_color, match_point);
+     }
+
+     ce_syntax_highlight_visual(range_list, range_index, in_visual, match_point, draw_color_list, syntax_defs);
+
+     // an empty line has nothing matched on it, don't let the line above's color run into it
+     if(line_len == 0 && state_color == CE_SYNTAX_COLOR_NORMAL && draw_color_list->count > 0 &&
+        (ce_draw_color_list_last_fg_color(draw_color_list) != CE_COLOR_DEFAULT ||
+         ce_draw_color_list_last_bg_color(draw_color_list) != CE_COLOR_DEFAULT)){
+          change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NORMAL, match_point);
+     }
+
+     if(*in_visual && line_len == 0) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
+
+     int64_t token_index = 0;
+     bool unmatched = false;
+     for(int64_t x = 0; x < line_len; ++x){
+          match_point.x = x;
+
+          ce_syntax_highlight_visual(range_list, range_index, in_visual, match_point, draw_color_list, syntax_defs);
+
+          if(token_index < token_count && tokens[token_index].x == x){
+               CeSyntaxColor_t color = tokens[token_index].color;
+               token_index++;
+               unmatched = (color == CE_SYNTAX_COLOR_NORMAL);
+               if(!unmatched){
+                    change_draw_color(draw_color_list, syntax_defs, color, match_point);
+                    if(color == CE_SYNTAX_COLOR_TRAILING_WHITESPACE){
+                         ce_draw_color_list_insert(draw_color_list, ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
+                                                   ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
+                                                   (CePoint_t){0, match_point.y + 1});
+                    }
+               }
+          }
+
+          if(unmatched && (draw_color_list->count == 0 || (ce_draw_color_list_last_fg_color(draw_color_list) != CE_COLOR_DEFAULT ||
+                                                           ce_draw_color_list_last_bg_color(draw_color_list) != CE_COLOR_DEFAULT))){
+               change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NORMAL, match_point);
+          }
+
+          if(*in_visual) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
+     }
+
+     check_visual_mode_end(range_list, *range_index, in_visual, match_point.y, line_len, draw_color_list);
+}
+
+// lines above the view are only lexed to find the state the view starts in, and only if they aren't already known
+static void syntax_highlight_cached(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
+                                    CeSyntaxDef_t* syntax_defs, const CeSyntaxLanguage_t* language){
      if(!view->buffer) return;
      if(view->buffer->line_count <= 0) return;
      int64_t min = view->scroll.y;
@@ -552,113 +1241,80 @@ void ce_syntax_highlight_c(CeView_t* view, CeRangeList_t* highlight_range_list,
      if(clamp_max < 0) clamp_max = 0;
      CE_CLAMP(min, 0, clamp_max);
      CE_CLAMP(max, 0, clamp_max);
-     int64_t match_len = 0;
-     bool multiline_comment = false;
      bool in_visual = false;
-     CeRangeNode_t* range_node = highlight_range_list->head;
-
-     check_visual_start(range_node, min, draw_color_list, syntax_defs, &in_visual);
+     int64_t range_index = 0;
 
-     int prepass_min = min - SEARCH_BACK_LINES;
-     if(prepass_min < 0) prepass_min = 0;
+     CeSyntaxCache_t* cache = ce_syntax_cache_get(view->buffer, language);
+     if(!cache) return;
 
-     // pre-pass to check if we are in a multiline comment
-     for(int64_t y = prepass_min; y < min; y++){
-          char* line = view->buffer->lines[y];
-          int64_t line_len = ce_utf8_strlen(line);
+     check_visual_start(highlight_range_list, range_index, min, draw_color_list, syntax_defs, &in_visual);
 
-          for(int64_t x = 0; x < line_len; ++x){
-               char* str = ce_utf8_iterate_to(line, x);
-
-               if(multiline_comment){
-                    if(match_c_multiline_comment_end(str)){
-                         multiline_comment = false;
-                    }
-               }else{
-                    if((match_len = match_c_multiline_comment(str))){
-                         multiline_comment = true;
-                         x += (match_len - 1);
-                    }
-               }
+     // when too much above the view hasn't been lexed, the background lexer catches up while we draw the view lexed
+     // from the state of the line above it, which may not be right yet
+     syntax_cache_skip_valid_lines(cache);
+     bool lexed_above = true;
+     if(min - cache->valid_line_count > CE_SYNTAX_SYNC_LEX_LINES && syntax_background_running()){
+          syntax_background_want(view->buffer, min, max);
+          lexed_above = false;
+     }else{
+          for(int64_t y = cache->valid_line_count; y < min; y++){
+               syntax_cache_lex_line(cache, view->buffer, y, false);
           }
      }
 
      for(int64_t y = min; y <= max; ++y){
-          char* line = view->buffer->lines[y];
-          int64_t line_len = ce_utf8_strlen(line);
-          int64_t current_match_len = 1;
-          CePoint_t match_point = {0, y};
-
-          if(multiline_comment){
-               change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_COMMENT, match_point);
+          CeSyntaxLine_t* line = syntax_cache_lex_line(cache, view->buffer, y, true);
+          const CeSyntaxToken_t* tokens = line->tokens;
+          int64_t token_count = line->token_count;
+          if(token_count < 0){
+               tokens = cache->scratch.tokens;
+               token_count = cache->scratch.count;
           }
 
-          ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
+          // trailing whitespace isn't highlighted up to the cursor, so that line is lexed again knowing where it is
+          if(y == view->cursor.y && token_count > 0 && tokens[token_count - 1].color == CE_SYNTAX_COLOR_TRAILING_WHITESPACE){
+               cache->scratch.count = 0;
+               syntax_lex_line(language, ce_buffer_line(view->buffer, y), line->entry_state, view->cursor.x, &cache->scratch);
+               tokens = cache->scratch.tokens;
+               token_count = cache->scratch.count;
+          }
 
-          if(in_visual && line_len == 0) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
+          syntax_draw_line_tokens(tokens, token_count, line->entry_state, y, ce_utf8_strlen(ce_buffer_line(view->buffer, y)),
+                                  highlight_range_list, &range_index, &in_visual, draw_color_list, syntax_defs);
+     }
 
-          for(int64_t x = 0; x < line_len; ++x){
-               char* str = ce_utf8_iterate_to(line, x);
-               match_point.x = x;
+     if(lexed_above && cache->valid_line_count <= max) cache->valid_line_count = max + 1;
+}
 
-               ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
-
-               if(current_match_len <= 1){
-                    if(multiline_comment){
-                         if((match_len = match_c_multiline_comment_end(str))){
-                              multiline_comment = false;
-                         }else if(((view->cursor.y != y) || (x > view->cursor.x)) && (match_len = match_trailing_whitespace(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_TRAILING_WHITESPACE, match_point);
-                              ce_draw_color_list_insert(draw_color_list, ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                        ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                        (CePoint_t){0, match_point.y + 1});
-                         }
-                    }else{
-                         if((match_len = match_c_type(str, line, false))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_TYPE, match_point);
-                         }else if((match_len = match_c_keyword(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_KEYWORD, match_point);
-                         }else if((match_len = match_c_control(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_CONTROL, match_point);
-                         }else if((match_len = match_caps_var(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_CAPS_VAR, match_point);
-                         }else if((match_len = match_c_comment(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_COMMENT, match_point);
-                         }else if((match_len = match_c_string(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_STRING, match_point);
-                         }else if((match_len = match_c_character_literal(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_CHAR_LITERAL, match_point);
-                         }else if((match_len = match_c_literal(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NUMBER_LITERAL, match_point);
-                         }else if((match_len = match_c_preproc(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_PREPROCESSOR, match_point);
-                         }else if((match_len = match_c_multiline_comment(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_COMMENT, match_point);
-                              multiline_comment = true;
-                         }else if(((view->cursor.y != y) || (x > view->cursor.x)) && (match_len = match_trailing_whitespace(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_TRAILING_WHITESPACE, match_point);
-                              ce_draw_color_list_insert(draw_color_list, ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                        ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                        (CePoint_t){0, match_point.y + 1});
-                         }else if(!draw_color_list->tail || (draw_color_list->tail->fg != CE_COLOR_DEFAULT || draw_color_list->tail->bg != CE_COLOR_DEFAULT)){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NORMAL, match_point);
-                         }
-                    }
+static const CeSyntaxRule_t g_c_rules[] = {
+     {match_c_type, CE_SYNTAX_COLOR_TYPE},
+     {match_c_keyword, CE_SYNTAX_COLOR_KEYWORD},
+     {match_c_control, CE_SYNTAX_COLOR_CONTROL},
+     {match_caps_var, CE_SYNTAX_COLOR_CAPS_VAR},
+     {match_c_comment, CE_SYNTAX_COLOR_COMMENT},
+     {match_c_string, CE_SYNTAX_COLOR_STRING},
+     {match_c_character_literal, CE_SYNTAX_COLOR_CHAR_LITERAL},
+     {match_c_literal, CE_SYNTAX_COLOR_NUMBER_LITERAL},
+     {match_c_preproc, CE_SYNTAX_COLOR_PREPROCESSOR},
+     {match_c_multiline_comment, CE_SYNTAX_COLOR_COMMENT},
+     {match_trailing_whitespace, CE_SYNTAX_COLOR_TRAILING_WHITESPACE},
+};
+
+static const CeSyntaxLanguage_t g_c_language = {
+     g_c_rules, sizeof(g_c_rules) / sizeof(g_c_rules[0]), match_c_multiline_comment_end, true
+};
 
-                    if(match_len) current_match_len = match_len;
-               }else{
-                    current_match_len--;
-               }
-
-               if(in_visual) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
-          }
+void ce_syntax_highlight_c(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
+                           CeSyntaxDef_t* syntax_defs, void* user_data){
+     syntax_highlight_cached(view, highlight_range_list, draw_color_list, syntax_defs, &g_c_language);
+}
 
-          check_visual_mode_end(range_node, &in_visual, match_point.y, line_len, draw_color_list);
-     }
+static int64_t match_cpp_type(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     return match_type(str, beginning_of_line, true);
 }
 
-static int64_t match_cpp_keyword(const char* str, const char* beginning_of_line){
-     static const char* keywords[] = {
+static int64_t match_cpp_keyword(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     static const char* words[] = {
           "Asm",
           "auto",
           "bool",
@@ -717,13 +1373,13 @@ static int64_t match_cpp_keyword(const char* str, const char* beginning_of_line)
           "while",
      };
 
-     static const int64_t keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+     static CeSyntaxKeywords_t keywords = {.words = words, .word_count = sizeof(words) / sizeof(words[0])};
 
-     return match_words(str, beginning_of_line, keywords, keyword_count);
+     return match_keywords(str, beginning_of_line, &keywords);
 }
 
-static int64_t match_cpp_control(const char* str, const char* beginning_of_line){
-     static const char* keywords [] = {
+static int64_t match_cpp_control(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     static const char* words[] = {
           "break",
           "catch",
           "const",
@@ -735,13 +1391,13 @@ static int64_t match_cpp_control(const char* str, const char* beginning_of_line)
           "try",
      };
 
-     static const int64_t keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+     static CeSyntaxKeywords_t keywords = {.words = words, .word_count = sizeof(words) / sizeof(words[0])};
 
-     return match_words(str, beginning_of_line, keywords, keyword_count);
+     return match_keywords(str, beginning_of_line, &keywords);
 }
 
 
-static int64_t match_cpp_namespace(const char* str, const char* beginning_of_line){
+static int64_t match_cpp_namespace(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
      bool saw_colon = false;
      bool saw_alpha = false;
      const char* itr = str;
@@ -766,125 +1422,32 @@ static int64_t match_cpp_namespace(const char* str, const char* beginning_of_lin
      return 0;
 }
 
+static const CeSyntaxRule_t g_cpp_rules[] = {
+     {match_caps_var, CE_SYNTAX_COLOR_CAPS_VAR},
+     {match_cpp_type, CE_SYNTAX_COLOR_TYPE},
+     {match_cpp_keyword, CE_SYNTAX_COLOR_KEYWORD},
+     {match_cpp_control, CE_SYNTAX_COLOR_CONTROL},
+     {match_c_comment, CE_SYNTAX_COLOR_COMMENT},
+     {match_c_string, CE_SYNTAX_COLOR_STRING},
+     {match_c_character_literal, CE_SYNTAX_COLOR_CHAR_LITERAL},
+     {match_c_literal, CE_SYNTAX_COLOR_NUMBER_LITERAL},
+     {match_c_preproc, CE_SYNTAX_COLOR_PREPROCESSOR},
+     {match_cpp_namespace, CE_SYNTAX_COLOR_TYPE},
+     {match_c_multiline_comment, CE_SYNTAX_COLOR_COMMENT},
+     {match_trailing_whitespace, CE_SYNTAX_COLOR_TRAILING_WHITESPACE},
+};
+
+static const CeSyntaxLanguage_t g_cpp_language = {
+     g_cpp_rules, sizeof(g_cpp_rules) / sizeof(g_cpp_rules[0]), match_c_multiline_comment_end, true
+};
+
 void ce_syntax_highlight_cpp(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
                              CeSyntaxDef_t* syntax_defs, void* user_data){
-     if(!view->buffer) return;
-     if(view->buffer->line_count <= 0) return;
-     int64_t min = view->scroll.y;
-     int64_t max = min + (view->rect.bottom - view->rect.top);
-     int64_t clamp_max = (view->buffer->line_count - 1);
-     if(clamp_max < 0) clamp_max = 0;
-     CE_CLAMP(min, 0, clamp_max);
-     CE_CLAMP(max, 0, clamp_max);
-     int64_t match_len = 0;
-     bool multiline_comment = false;
-     bool in_visual = false;
-     CeRangeNode_t* range_node = highlight_range_list->head;
-
-     check_visual_start(range_node, min, draw_color_list, syntax_defs, &in_visual);
-
-     int prepass_min = min - SEARCH_BACK_LINES;
-     if(prepass_min < 0) prepass_min = 0;
-
-     // pre-pass to check if we are in a multiline comment
-     for(int64_t y = prepass_min; y < min; y++){
-          char* line = view->buffer->lines[y];
-          int64_t line_len = ce_utf8_strlen(line);
-
-          for(int64_t x = 0; x < line_len; ++x){
-               char* str = ce_utf8_iterate_to(line, x);
-
-               if(multiline_comment){
-                    if(match_c_multiline_comment_end(str)){
-                         multiline_comment = false;
-                    }
-               }else{
-                    if((match_len = match_c_multiline_comment(str))){
-                         multiline_comment = true;
-                         x += (match_len - 1);
-                    }
-               }
-          }
-     }
-
-     for(int64_t y = min; y <= max; ++y){
-          char* line = view->buffer->lines[y];
-          int64_t line_len = ce_utf8_strlen(line);
-          int64_t current_match_len = 1;
-          CePoint_t match_point = {0, y};
-
-          if(multiline_comment){
-               change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_COMMENT, match_point);
-          }
-
-          ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
-
-          if(in_visual && line_len == 0) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
-
-          for(int64_t x = 0; x < line_len; ++x){
-               char* str = ce_utf8_iterate_to(line, x);
-               match_point.x = x;
-
-               ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
-
-               if(current_match_len <= 1){
-                    if(multiline_comment){
-                         if((match_len = match_c_multiline_comment_end(str))){
-                              multiline_comment = false;
-                         }else if(((view->cursor.y != y) || (x > view->cursor.x)) && (match_len = match_trailing_whitespace(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_TRAILING_WHITESPACE, match_point);
-                              ce_draw_color_list_insert(draw_color_list, ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                        ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                        (CePoint_t){0, match_point.y + 1});
-                         }
-                    }else{
-                         if((match_len = match_caps_var(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_CAPS_VAR, match_point);
-                         }else if((match_len = match_c_type(str, line, true))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_TYPE, match_point);
-                         }else if((match_len = match_cpp_keyword(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_KEYWORD, match_point);
-                         }else if((match_len = match_cpp_control(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_CONTROL, match_point);
-                         }else if((match_len = match_c_comment(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_COMMENT, match_point);
-                         }else if((match_len = match_c_string(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_STRING, match_point);
-                         }else if((match_len = match_c_character_literal(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_CHAR_LITERAL, match_point);
-                         }else if((match_len = match_c_literal(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NUMBER_LITERAL, match_point);
-                         }else if((match_len = match_c_preproc(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_PREPROCESSOR, match_point);
-                         }else if((match_len = match_cpp_namespace(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_TYPE, match_point);
-                         }else if((match_len = match_c_multiline_comment(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_COMMENT, match_point);
-                              multiline_comment = true;
-                         }else if(((view->cursor.y != y) || (x > view->cursor.x)) && (match_len = match_trailing_whitespace(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_TRAILING_WHITESPACE, match_point);
-                              ce_draw_color_list_insert(draw_color_list, ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                        ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                        (CePoint_t){0, match_point.y + 1});
-                         }else if(!draw_color_list->tail || (draw_color_list->tail->fg != CE_COLOR_DEFAULT || draw_color_list->tail->bg != CE_COLOR_DEFAULT)){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NORMAL, match_point);
-                         }
-                    }
-
-                    if(match_len) current_match_len = match_len;
-               }else{
-                    current_match_len--;
-               }
-
-               if(in_visual) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
-          }
-
-          check_visual_mode_end(range_node, &in_visual, match_point.y, line_len, draw_color_list);
-     }
+     syntax_highlight_cached(view, highlight_range_list, draw_color_list, syntax_defs, &g_cpp_language);
 }
 
-static int64_t match_java_type(const char* str, const char* beginning_of_line){
-     static const char* keywords[] = {
+static int64_t match_java_type(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     static const char* words[] = {
           "boolean",
           "byte",
           "float",
@@ -894,13 +1457,13 @@ static int64_t match_java_type(const char* str, const char* beginning_of_line){
           "void",
      };
 
-     static const int64_t keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+     static CeSyntaxKeywords_t keywords = {.words = words, .word_count = sizeof(words) / sizeof(words[0])};
 
-     return match_words(str, beginning_of_line, keywords, keyword_count);
+     return match_keywords(str, beginning_of_line, &keywords);
 }
 
-static int64_t match_java_keyword(const char* str, const char* beginning_of_line){
-     static const char* keywords[] = {
+static int64_t match_java_keyword(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     static const char* words[] = {
           "abstract",
           "for",
           "new",
@@ -936,13 +1499,13 @@ static int64_t match_java_keyword(const char* str, const char* beginning_of_line
           "while",
      };
 
-     static const int64_t keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+     static CeSyntaxKeywords_t keywords = {.words = words, .word_count = sizeof(words) / sizeof(words[0])};
 
-     return match_words(str, beginning_of_line, keywords, keyword_count);
+     return match_keywords(str, beginning_of_line, &keywords);
 }
 
-static int64_t match_java_control(const char* str, const char* beginning_of_line){
-     static const char* keywords [] = {
+static int64_t match_java_control(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     static const char* words[] = {
           "try",
           "continue",
           "goto",
@@ -965,97 +1528,35 @@ static int64_t match_java_control(const char* str, const char* beginning_of_line
           "try",
      };
 
-     static const int64_t keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+     static CeSyntaxKeywords_t keywords = {.words = words, .word_count = sizeof(words) / sizeof(words[0])};
 
-     return match_words(str, beginning_of_line, keywords, keyword_count);
+     return match_keywords(str, beginning_of_line, &keywords);
 }
 
+static const CeSyntaxRule_t g_java_rules[] = {
+     {match_java_type, CE_SYNTAX_COLOR_TYPE},
+     {match_java_keyword, CE_SYNTAX_COLOR_KEYWORD},
+     {match_java_control, CE_SYNTAX_COLOR_CONTROL},
+     {match_caps_var, CE_SYNTAX_COLOR_CAPS_VAR},
+     {match_c_comment, CE_SYNTAX_COLOR_COMMENT},
+     {match_c_string, CE_SYNTAX_COLOR_STRING},
+     {match_c_character_literal, CE_SYNTAX_COLOR_CHAR_LITERAL},
+     {match_c_literal, CE_SYNTAX_COLOR_NUMBER_LITERAL},
+     {match_c_multiline_comment, CE_SYNTAX_COLOR_COMMENT},
+     {match_trailing_whitespace, CE_SYNTAX_COLOR_TRAILING_WHITESPACE},
+};
+
+static const CeSyntaxLanguage_t g_java_language = {
+     g_java_rules, sizeof(g_java_rules) / sizeof(g_java_rules[0]), match_c_multiline_comment_end, false
+};
+
 void ce_syntax_highlight_java(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
                               CeSyntaxDef_t* syntax_defs, void* user_data){
-     if(!view->buffer) return;
-     if(view->buffer->line_count <= 0) return;
-     int64_t min = view->scroll.y;
-     int64_t max = min + (view->rect.bottom - view->rect.top);
-     int64_t clamp_max = (view->buffer->line_count - 1);
-     if(clamp_max < 0) clamp_max = 0;
-     CE_CLAMP(min, 0, clamp_max);
-     CE_CLAMP(max, 0, clamp_max);
-     int64_t match_len = 0;
-     bool multiline_comment = false;
-     bool in_visual = false;
-     CeRangeNode_t* range_node = highlight_range_list->head;
-
-     check_visual_start(range_node, min, draw_color_list, syntax_defs, &in_visual);
-
-     for(int64_t y = min; y <= max; ++y){
-          char* line = view->buffer->lines[y];
-          int64_t line_len = ce_utf8_strlen(line);
-          int64_t current_match_len = 1;
-          CePoint_t match_point = {0, y};
-
-          if(multiline_comment){
-               change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_COMMENT, match_point);
-          }
-
-          ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
-
-          if(in_visual && line_len == 0) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
-
-          for(int64_t x = 0; x < line_len; ++x){
-               char* str = ce_utf8_iterate_to(line, x);
-               match_point.x = x;
-
-               ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
-
-               if(current_match_len <= 1){
-                    if(multiline_comment){
-                         if((match_len = match_c_multiline_comment_end(str))){
-                              multiline_comment = false;
-                         }
-                    }else{
-                         if((match_len = match_java_type(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_TYPE, match_point);
-                         }else if((match_len = match_java_keyword(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_KEYWORD, match_point);
-                         }else if((match_len = match_java_control(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_CONTROL, match_point);
-                         }else if((match_len = match_caps_var(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_CAPS_VAR, match_point);
-                         }else if((match_len = match_c_comment(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_COMMENT, match_point);
-                         }else if((match_len = match_c_string(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_STRING, match_point);
-                         }else if((match_len = match_c_character_literal(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_CHAR_LITERAL, match_point);
-                         }else if((match_len = match_c_literal(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NUMBER_LITERAL, match_point);
-                         }else if((match_len = match_c_multiline_comment(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_COMMENT, match_point);
-                              multiline_comment = true;
-                         }else if(((view->cursor.y != y) || (x > view->cursor.x)) && (match_len = match_trailing_whitespace(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_TRAILING_WHITESPACE, match_point);
-                              ce_draw_color_list_insert(draw_color_list, ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                        ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                        (CePoint_t){0, match_point.y + 1});
-                         }else if(!draw_color_list->tail || (draw_color_list->tail->fg != CE_COLOR_DEFAULT || draw_color_list->tail->bg != CE_COLOR_DEFAULT)){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NORMAL, match_point);
-                         }
-                    }
-
-                    if(match_len) current_match_len = match_len;
-               }else{
-                    current_match_len--;
-               }
-
-               if(in_visual) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
-          }
-
-          check_visual_mode_end(range_node, &in_visual, match_point.y, line_len, draw_color_list);
-     }
+     syntax_highlight_cached(view, highlight_range_list, draw_color_list, syntax_defs, &g_java_language);
 }
 
-static int64_t match_python_keyword(const char* str, const char* beginning_of_line){
-     static const char* keywords[] = {
+static int64_t match_python_keyword(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     static const char* words[] = {
           "and",
           "del",
           "from",
@@ -1082,13 +1583,13 @@ static int64_t match_python_keyword(const char* str, const char* beginning_of_li
           "self",
      };
 
-     static const int64_t keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+     static CeSyntaxKeywords_t keywords = {.words = words, .word_count = sizeof(words) / sizeof(words[0])};
 
-     return match_words(str, beginning_of_line, keywords, keyword_count);
+     return match_keywords(str, beginning_of_line, &keywords);
 }
 
-static int64_t match_python_control(const char* str, const char* beginning_of_line){
-     static const char* keywords[] = {
+static int64_t match_python_control(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     static const char* words[] = {
           "yield",
           "break",
           "except",
@@ -1099,24 +1600,24 @@ static int64_t match_python_control(const char* str, const char* beginning_of_li
           "try",
      };
 
-     static const int64_t keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+     static CeSyntaxKeywords_t keywords = {.words = words, .word_count = sizeof(words) / sizeof(words[0])};
 
-     return match_words(str, beginning_of_line, keywords, keyword_count);
+     return match_keywords(str, beginning_of_line, &keywords);
 }
 
-static int64_t match_python_comment(const char* str){
-     if(*str == '#') return ce_utf8_strlen(str);
+static int64_t match_python_comment(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     if(*str == '#') return strlen(str);
 
      return 0;
 }
 
-static int64_t match_python_string(const char* str){
+static int64_t match_python_string(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
      if(*str == '\'' || *str == '"'){
           const char* match = str;
           while(match){
                match = strchr(match + 1, *str);
                if(match && *(match - 1) != '\\'){
-                    return ce_utf8_strlen_between(str, match);
+                    return (match - str) + 1;
                }
           }
      }
@@ -1124,154 +1625,54 @@ static int64_t match_python_string(const char* str){
      return 0;
 }
 
-typedef enum{
-     PYTHON_DOCSTRING_NONE,
-     PYTHON_DOCSTRING_SINGLE_QUOTE,
-     PYTHON_DOCSTRING_DOUBLE_QUOTE,
-}PythonDocstring_t;
-
-static int64_t match_python_docstring(const char* str, PythonDocstring_t* python_docstring){
+// the docstring's end is found by match_python_docstring_end(), even when it is on the same line
+static int64_t match_python_docstring(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
      if(strncmp(str, "\"\"\"", 3) == 0){
-          *python_docstring = PYTHON_DOCSTRING_DOUBLE_QUOTE;
-          char* match = strstr(str, "\"\"\"");
-          if(match) return ce_utf8_strlen_between(str, match);
-          return ce_utf8_strlen(str);
+          *state = CE_SYNTAX_STATE_DOCSTRING_DOUBLE_QUOTE;
+          return 3;
      }
 
      if(strncmp(str, "'''", 3) == 0){
-          *python_docstring = PYTHON_DOCSTRING_SINGLE_QUOTE;
-          char* match = strstr(str, "'''");
-          if(match) return ce_utf8_strlen_between(str, match);
-          return ce_utf8_strlen(str);
+          *state = CE_SYNTAX_STATE_DOCSTRING_SINGLE_QUOTE;
+          return 3;
      }
 
      return 0;
 }
 
-void ce_syntax_highlight_python(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
-                                CeSyntaxDef_t* syntax_defs, void* user_data){
-     if(!view->buffer) return;
-     if(view->buffer->line_count <= 0) return;
-     int64_t min = view->scroll.y;
-     int64_t max = min + (view->rect.bottom - view->rect.top);
-     int64_t clamp_max = (view->buffer->line_count - 1);
-     if(clamp_max < 0) clamp_max = 0;
-     CE_CLAMP(min, 0, clamp_max);
-     CE_CLAMP(max, 0, clamp_max);
-     int64_t match_len = 0;
-     bool in_visual = false;
-     PythonDocstring_t docstring = PYTHON_DOCSTRING_NONE;
-     CeRangeNode_t* range_node = highlight_range_list->head;
-
-     check_visual_start(range_node, min, draw_color_list, syntax_defs, &in_visual);
-
-     int prepass_min = min - SEARCH_BACK_LINES;
-     if(prepass_min < 0) prepass_min = 0;
-
-     // pre-pass to check if we are in a multiline comment
-     for(int64_t y = prepass_min; y < min; y++){
-          char* line = view->buffer->lines[y];
-          int64_t line_len = ce_utf8_strlen(line);
-
-          for(int64_t x = 0; x < line_len; ++x){
-               char* str = ce_utf8_iterate_to(line, x);
-
-               switch(docstring){
-               default:
-                    if((match_len = match_python_docstring(str, &docstring))){
-                         x += match_len;
-                    }
-                    break;
-               case PYTHON_DOCSTRING_DOUBLE_QUOTE:
-                    if(strncmp(str, "\"\"\"", 3) == 0){
-                         docstring = PYTHON_DOCSTRING_NONE;
-                         x += 3;
-                    }else if(match_len == 0){
-                         docstring = PYTHON_DOCSTRING_NONE;
-                    }
-                    break;
-               case PYTHON_DOCSTRING_SINGLE_QUOTE:
-                    if(strncmp(str, "'''", 3) == 0){
-                         docstring = PYTHON_DOCSTRING_NONE;
-                         x += 3;
-                    }else if(match_len == 0){
-                         docstring = PYTHON_DOCSTRING_NONE;
-                    }
-                    break;
-               }
-          }
+static int64_t match_python_docstring_end(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     if((*state == CE_SYNTAX_STATE_DOCSTRING_DOUBLE_QUOTE && strncmp(str, "\"\"\"", 3) == 0) ||
+        (*state == CE_SYNTAX_STATE_DOCSTRING_SINGLE_QUOTE && strncmp(str, "'''", 3) == 0)){
+          *state = CE_SYNTAX_STATE_NONE;
+          return 3;
      }
 
-     for(int64_t y = min; y <= max; ++y){
-          char* line = view->buffer->lines[y];
-          int64_t line_len = ce_utf8_strlen(line);
-          int64_t current_match_len = 1;
-          CePoint_t match_point = {0, y};
-
-          if(docstring){
-               change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_STRING, match_point);
-          }
-
-          ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
-
-          if(in_visual && line_len == 0) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
-
-          for(int64_t x = 0; x < line_len; ++x){
-               char* str = ce_utf8_iterate_to(line, x);
-               match_point.x = x;
-
-               ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
-
-               if(current_match_len <= 1){
-                    if(docstring){
-                         if(docstring == PYTHON_DOCSTRING_DOUBLE_QUOTE && strncmp(str, "\"\"\"", 3) == 0){
-                              docstring = PYTHON_DOCSTRING_NONE;
-                              match_len = 3;
-                         }else if(docstring == PYTHON_DOCSTRING_SINGLE_QUOTE && strncmp(str, "'''", 3) == 0){
-                              docstring = PYTHON_DOCSTRING_NONE;
-                              match_len = 3;
-                         }
-                    }else{
-                         if((match_len = match_c_type(str, line, false))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_TYPE, match_point);
-                         }else if((match_len = match_python_keyword(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_KEYWORD, match_point);
-                         }else if((match_len = match_python_control(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_CONTROL, match_point);
-                         }else if((match_len = match_caps_var(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_CAPS_VAR, match_point);
-                         }else if((match_len = match_python_comment(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_COMMENT, match_point);
-                         }else if((match_len = match_python_docstring(str, &docstring))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_STRING, match_point);
-                         }else if((match_len = match_python_string(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_STRING, match_point);
-                         }else if((match_len = match_c_literal(str, line))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NUMBER_LITERAL, match_point);
-                         }else if(((view->cursor.y != y) || (x > view->cursor.x)) && (match_len = match_trailing_whitespace(str))){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_TRAILING_WHITESPACE, match_point);
-                              ce_draw_color_list_insert(draw_color_list, ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                        ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                        (CePoint_t){0, match_point.y + 1});
-                         }else if(!draw_color_list->tail || (draw_color_list->tail->fg != CE_COLOR_DEFAULT || draw_color_list->tail->bg != CE_COLOR_DEFAULT)){
-                              change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NORMAL, match_point);
-                         }
-                    }
-
-                    if(match_len) current_match_len = match_len;
-               }else{
-                    current_match_len--;
-               }
+     return 0;
+}
 
-               if(in_visual) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
-          }
+static const CeSyntaxRule_t g_python_rules[] = {
+     {match_c_type, CE_SYNTAX_COLOR_TYPE},
+     {match_python_keyword, CE_SYNTAX_COLOR_KEYWORD},
+     {match_python_control, CE_SYNTAX_COLOR_CONTROL},
+     {match_caps_var, CE_SYNTAX_COLOR_CAPS_VAR},
+     {match_python_comment, CE_SYNTAX_COLOR_COMMENT},
+     {match_python_docstring, CE_SYNTAX_COLOR_STRING},
+     {match_python_string, CE_SYNTAX_COLOR_STRING},
+     {match_c_literal, CE_SYNTAX_COLOR_NUMBER_LITERAL},
+     {match_trailing_whitespace, CE_SYNTAX_COLOR_TRAILING_WHITESPACE},
+};
+
+static const CeSyntaxLanguage_t g_python_language = {
+     g_python_rules, sizeof(g_python_rules) / sizeof(g_python_rules[0]), match_python_docstring_end, false
+};
 
-          check_visual_mode_end(range_node, &in_visual, match_point.y, line_len, draw_color_list);
-     }
+void ce_syntax_highlight_python(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
+                                CeSyntaxDef_t* syntax_defs, void* user_data){
+     syntax_highlight_cached(view, highlight_range_list, draw_color_list, syntax_defs, &g_python_language);
 }
 
-static int64_t match_bash_keyword(const char* str, const char* beginning_of_line){
-     static const char* keywords [] = {
+static int64_t match_bash_keyword(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     static const char* words[] = {
           "if",
           "then",
           "else",
@@ -1291,210 +1692,97 @@ static int64_t match_bash_keyword(const char* str, const char* beginning_of_line
           "coproc",
      };
 
-     static const int64_t keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+     static CeSyntaxKeywords_t keywords = {.words = words, .word_count = sizeof(words) / sizeof(words[0])};
 
-     return match_words(str, beginning_of_line, keywords, keyword_count);
+     return match_keywords(str, beginning_of_line, &keywords);
 }
 
-void ce_syntax_highlight_bash(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
-                              CeSyntaxDef_t* syntax_defs, void* user_data){
-     if(!view->buffer) return;
-     if(view->buffer->line_count <= 0) return;
-     int64_t min = view->scroll.y;
-     int64_t max = min + (view->rect.bottom - view->rect.top);
-     int64_t clamp_max = (view->buffer->line_count - 1);
-     if(clamp_max < 0) clamp_max = 0;
-     CE_CLAMP(min, 0, clamp_max);
-     CE_CLAMP(max, 0, clamp_max);
-     int64_t match_len = 0;
-     bool in_visual = false;
-     CeRangeNode_t* range_node = highlight_range_list->head;
-
-     check_visual_start(range_node, min, draw_color_list, syntax_defs, &in_visual);
+static const CeSyntaxRule_t g_bash_rules[] = {
+     {match_bash_keyword, CE_SYNTAX_COLOR_KEYWORD},
+     {match_caps_var, CE_SYNTAX_COLOR_CAPS_VAR},
+     {match_python_comment, CE_SYNTAX_COLOR_COMMENT},
+     {match_python_string, CE_SYNTAX_COLOR_STRING},
+     {match_c_literal, CE_SYNTAX_COLOR_NUMBER_LITERAL},
+     {match_trailing_whitespace, CE_SYNTAX_COLOR_TRAILING_WHITESPACE},
+};
 
-     for(int64_t y = min; y <= max; ++y){
-          char* line = view->buffer->lines[y];
-          int64_t line_len = ce_utf8_strlen(line);
-          int64_t current_match_len = 1;
-          CePoint_t match_point = {0, y};
-
-          ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
-
-          if(in_visual && line_len == 0) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
-
-          for(int64_t x = 0; x < line_len; ++x){
-               char* str = ce_utf8_iterate_to(line, x);
-               match_point.x = x;
-
-               ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
-
-               if(current_match_len <= 1){
-                    if((match_len = match_bash_keyword(str, line))){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_KEYWORD, match_point);
-                    }else if((match_len = match_caps_var(str, line))){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_CAPS_VAR, match_point);
-                    }else if((match_len = match_python_comment(str))){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_COMMENT, match_point);
-                    }else if((match_len = match_python_string(str))){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_STRING, match_point);
-                    }else if((match_len = match_c_literal(str, line))){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NUMBER_LITERAL, match_point);
-                    }else if(((view->cursor.y != y) || (x > view->cursor.x)) && (match_len = match_trailing_whitespace(str))){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_TRAILING_WHITESPACE, match_point);
-                         ce_draw_color_list_insert(draw_color_list, ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                   ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                   (CePoint_t){0, match_point.y + 1});
-                    }else if(!draw_color_list->tail || (draw_color_list->tail->fg != CE_COLOR_DEFAULT || draw_color_list->tail->bg != CE_COLOR_DEFAULT)){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NORMAL, match_point);
-                    }
+static const CeSyntaxLanguage_t g_bash_language = {
+     g_bash_rules, sizeof(g_bash_rules) / sizeof(g_bash_rules[0]), NULL, false
+};
 
-                    if(match_len) current_match_len = match_len;
-               }else{
-                    current_match_len--;
-               }
-
-               if(in_visual) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
-          }
-
-          check_visual_mode_end(range_node, &in_visual, match_point.y, line_len, draw_color_list);
-     }
+void ce_syntax_highlight_bash(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
+                              CeSyntaxDef_t* syntax_defs, void* user_data){
+     syntax_highlight_cached(view, highlight_range_list, draw_color_list, syntax_defs, &g_bash_language);
 }
 
-static int64_t match_config_keyword(const char* str, const char* beginning_of_line){
-     static const char* keywords [] = {
+static int64_t match_config_keyword(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     static const char* words[] = {
           "true",
           "false",
      };
 
-     static const int64_t keyword_count = sizeof(keywords) / sizeof(keywords[0]);
+     static CeSyntaxKeywords_t keywords = {.words = words, .word_count = sizeof(words) / sizeof(words[0])};
 
-     return match_words(str, beginning_of_line, keywords, keyword_count);
+     return match_keywords(str, beginning_of_line, &keywords);
 }
 
-void ce_syntax_highlight_config(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
-                                CeSyntaxDef_t* syntax_defs, void* user_data){
-     if(!view->buffer) return;
-     if(view->buffer->line_count <= 0) return;
-     int64_t min = view->scroll.y;
-     int64_t max = min + (view->rect.bottom - view->rect.top);
-     int64_t clamp_max = (view->buffer->line_count - 1);
-     if(clamp_max < 0) clamp_max = 0;
-     CE_CLAMP(min, 0, clamp_max);
-     CE_CLAMP(max, 0, clamp_max);
-     int64_t match_len = 0;
-     bool in_visual = false;
-     CeRangeNode_t* range_node = highlight_range_list->head;
+static const CeSyntaxRule_t g_config_rules[] = {
+     {match_config_keyword, CE_SYNTAX_COLOR_KEYWORD},
+     {match_caps_var, CE_SYNTAX_COLOR_CAPS_VAR},
+     {match_python_comment, CE_SYNTAX_COLOR_COMMENT},
+     {match_python_string, CE_SYNTAX_COLOR_STRING},
+     {match_c_literal, CE_SYNTAX_COLOR_NUMBER_LITERAL},
+     {match_trailing_whitespace, CE_SYNTAX_COLOR_TRAILING_WHITESPACE},
+};
 
-     check_visual_start(range_node, min, draw_color_list, syntax_defs, &in_visual);
+static const CeSyntaxLanguage_t g_config_language = {
+     g_config_rules, sizeof(g_config_rules) / sizeof(g_config_rules[0]), NULL, false
+};
 
-     for(int64_t y = min; y <= max; ++y){
-          char* line = view->buffer->lines[y];
-          int64_t line_len = ce_utf8_strlen(line);
-          int64_t current_match_len = 1;
-          CePoint_t match_point = {0, y};
+void ce_syntax_highlight_config(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
+                                CeSyntaxDef_t* syntax_defs, void* user_data){
+     syntax_highlight_cached(view, highlight_range_list, draw_color_list, syntax_defs, &g_config_language);
+}
 
-          ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
+// diff lines are colored by how they start
+static int64_t match_diff_line(const char* str, const char* beginning_of_line, char first_char){
+     if(str != beginning_of_line || *str != first_char) return 0;
+     return strlen(str);
+}
 
-          if(in_visual && line_len == 0) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
+static int64_t match_diff_add(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     return match_diff_line(str, beginning_of_line, '+');
+}
 
-          for(int64_t x = 0; x < line_len; ++x){
-               char* str = ce_utf8_iterate_to(line, x); // TODO: decode rather than iterating to each time
-               match_point.x = x;
+static int64_t match_diff_remove(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     return match_diff_line(str, beginning_of_line, '-');
+}
 
-               ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
-
-               if(current_match_len <= 1){
-                    if((match_len = match_config_keyword(str, line))){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_KEYWORD, match_point);
-                    }else if((match_len = match_caps_var(str, line))){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_CAPS_VAR, match_point);
-                    }else if((match_len = match_python_comment(str))){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_COMMENT, match_point);
-                    }else if((match_len = match_python_string(str))){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_STRING, match_point);
-                    }else if((match_len = match_c_literal(str, line))){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NUMBER_LITERAL, match_point);
-                    }else if(((view->cursor.y != y) || (x > view->cursor.x)) && (match_len = match_trailing_whitespace(str))){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_TRAILING_WHITESPACE, match_point);
-                         ce_draw_color_list_insert(draw_color_list, ce_syntax_def_get_fg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                   ce_syntax_def_get_bg(syntax_defs, CE_SYNTAX_COLOR_NORMAL, CE_COLOR_DEFAULT),
-                                                   (CePoint_t){0, match_point.y + 1});
-                    }else if(!draw_color_list->tail || (draw_color_list->tail->fg != CE_COLOR_DEFAULT || draw_color_list->tail->bg != CE_COLOR_DEFAULT)){
-                         change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NORMAL, match_point);
-                    }
+static int64_t match_diff_comment(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     return match_diff_line(str, beginning_of_line, '#');
+}
 
-                    if(match_len) current_match_len = match_len;
-               }else{
-                    current_match_len--;
-               }
+static int64_t match_diff_header(const char* str, const char* beginning_of_line, CeSyntaxState_t* state){
+     if(str != beginning_of_line || strncmp(str, "@@", 2) != 0) return 0;
+     char* end = strstr(str + 2, "@@");
+     if(end) return (end + 2) - str;
+     return 0;
+}
 
-               if(in_visual) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
-          }
+static const CeSyntaxRule_t g_diff_rules[] = {
+     {match_diff_add, CE_SYNTAX_COLOR_DIFF_ADD},
+     {match_diff_remove, CE_SYNTAX_COLOR_DIFF_REMOVE},
+     {match_diff_comment, CE_SYNTAX_COLOR_DIFF_COMMENT},
+     {match_diff_header, CE_SYNTAX_COLOR_DIFF_HEADER},
+};
 
-          check_visual_mode_end(range_node, &in_visual, match_point.y, line_len, draw_color_list);
-     }
-}
+static const CeSyntaxLanguage_t g_diff_language = {
+     g_diff_rules, sizeof(g_diff_rules) / sizeof(g_diff_rules[0]), NULL, false
+};
 
 void ce_syntax_highlight_diff(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
                               CeSyntaxDef_t* syntax_defs, void* user_data){
-     if(!view->buffer) return;
-     if(view->buffer->line_count <= 0) return;
-     int64_t min = view->scroll.y;
-     int64_t max = min + (view->rect.bottom - view->rect.top);
-     int64_t clamp_max = (view->buffer->line_count - 1);
-     if(clamp_max < 0) clamp_max = 0;
-     CE_CLAMP(min, 0, clamp_max);
-     CE_CLAMP(max, 0, clamp_max);
-     bool in_visual = false;
-     CeRangeNode_t* range_node = highlight_range_list->head;
-
-     check_visual_start(range_node, min, draw_color_list, syntax_defs, &in_visual);
-
-     for(int64_t y = min; y <= max; ++y){
-          char* line = view->buffer->lines[y];
-          int64_t line_len = ce_utf8_strlen(line);
-          int64_t current_match_len = 1;
-          CePoint_t match_point = {0, y};
-
-          ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
-
-          if(*line == '+'){
-               change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_DIFF_ADD, match_point);
-               current_match_len = line_len + 1;
-          }else if(*line == '-'){
-               change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_DIFF_REMOVE, match_point);
-               current_match_len = line_len + 1;
-          }else if(*line == '#'){
-               change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_DIFF_COMMENT, match_point);
-               current_match_len = line_len + 1;
-          }else if(strncmp(line, "@@", 2) == 0){
-               char* end = strstr(line + 2, "@@");
-               if(end){
-                    change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_DIFF_HEADER, match_point);
-                    current_match_len = ce_utf8_strlen_between(line, end + 2);
-               }
-          }else{
-               change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NORMAL, match_point);
-          }
-
-          if(in_visual && line_len == 0) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
-
-          for(int64_t x = 0; x < line_len; ++x){
-               match_point.x = x;
-
-               ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
-
-               if(current_match_len <= 1){
-                    change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_NORMAL, match_point);
-               }else{
-                    current_match_len--;
-               }
-
-               if(in_visual) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
-          }
-
-          check_visual_mode_end(range_node, &in_visual, match_point.y, line_len, draw_color_list);
-     }
+     syntax_highlight_cached(view, highlight_range_list, draw_color_list, syntax_defs, &g_diff_language);
 }
 
 void ce_syntax_highlight_plain(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
@@ -1508,12 +1796,12 @@ void ce_syntax_highlight_plain(CeView_t* view, CeRangeList_t* highlight_range_li
      CE_CLAMP(min, 0, clamp_max);
      CE_CLAMP(max, 0, clamp_max);
      bool in_visual = false;
-     CeRangeNode_t* range_node = highlight_range_list->head;
+     int64_t range_index = 0;
 
-     check_visual_start(range_node, min, draw_color_list, syntax_defs, &in_visual);
+     check_visual_start(highlight_range_list, range_index, min, draw_color_list, syntax_defs, &in_visual);
 
      for(int64_t y = min; y <= max; ++y){
-          char* line = view->buffer->lines[y];
+          char* line = ce_buffer_line(view->buffer, y);
           int64_t line_len = ce_utf8_strlen(line);
           CePoint_t match_point = {0, y};
 
@@ -1526,10 +1814,10 @@ void ce_syntax_highlight_plain(CeView_t* view, CeRangeList_t* highlight_range_li
 
           for(int64_t x = 0; x < line_len; ++x){
                match_point.x = x;
-               ce_syntax_highlight_visual(&range_node, &in_visual, match_point, draw_color_list, syntax_defs);
+               ce_syntax_highlight_visual(highlight_range_list, &range_index, &in_visual, match_point, draw_color_list, syntax_defs);
                if(in_visual) change_draw_color(draw_color_list, syntax_defs, CE_SYNTAX_COLOR_VISUAL, match_point);
           }
 
-          check_visual_mode_end(range_node, &in_visual, match_point.y, line_len, draw_color_list);
+          check_visual_mode_end(highlight_range_list, range_index, &in_visual, match_point.y, line_len, draw_color_list);
      }
 }
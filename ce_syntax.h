@@ -3,6 +3,8 @@
 #include "ce.h"
 
 #define CE_SYNTAX_USE_CURRENT_COLOR -2
+#define CE_SYNTAX_SYNC_LEX_LINES 4096 // past this many lines to lex above a view, leave them to the background lexer
+#define CE_SYNTAX_BACKGROUND_CHUNK_LINES 8192 // lines copied out for the background lexer at a time
 
 typedef enum{
      CE_SYNTAX_COLOR_NORMAL,
@@ -37,26 +39,23 @@ typedef struct{
      int bg;
 }CeSyntaxDef_t;
 
-typedef struct CeDrawColorNode_t{
+typedef struct{
      int fg;
      int bg;
      CePoint_t point;
-     struct CeDrawColorNode_t* next;
-}CeDrawColorNode_t;
+}CeDrawColor_t;
 
+// lists are flat arrays that are cleared and refilled every frame, so once they have grown drawing doesn't allocate
 typedef struct{
-     CeDrawColorNode_t* head;
-     CeDrawColorNode_t* tail;
+     CeDrawColor_t* colors;
+     int64_t count;
+     int64_t capacity;
 }CeDrawColorList_t;
 
-typedef struct CeRangeNode_t{
-     CeRange_t range;
-     struct CeRangeNode_t* next;
-}CeRangeNode_t;
-
 typedef struct{
-     CeRangeNode_t* head;
-     CeRangeNode_t* tail;
+     CeRange_t* ranges;
+     int64_t count;
+     int64_t capacity;
 }CeRangeList_t;
 
 typedef struct{
@@ -72,18 +71,88 @@ typedef struct{
 
 typedef void CeSyntaxHighlightFunc_t(CeView_t*, CeRangeList_t*, CeDrawColorList_t*, CeSyntaxDef_t*, void*);
 
+// what a line leaves open for the line after it
+typedef enum{
+     CE_SYNTAX_STATE_NONE,
+     CE_SYNTAX_STATE_MULTILINE_COMMENT,
+     CE_SYNTAX_STATE_DOCSTRING_SINGLE_QUOTE,
+     CE_SYNTAX_STATE_DOCSTRING_DOUBLE_QUOTE,
+}CeSyntaxState_t;
+
+// the color from x until the next token. CE_SYNTAX_COLOR_NORMAL marks where text that nothing matched starts
+typedef struct{
+     int32_t x;
+     int32_t color;
+}CeSyntaxToken_t;
+
+typedef struct{
+     CeSyntaxToken_t* tokens;
+     int64_t count;
+     int64_t capacity;
+}CeSyntaxTokenList_t;
+
+// returns how many bytes match at str, 0 if it doesn't match. Rules that open a state spanning lines set it
+typedef int64_t CeSyntaxMatchFunc_t(const char* str, const char* beginning_of_line, CeSyntaxState_t* state);
+
+typedef struct{
+     CeSyntaxMatchFunc_t* match;
+     CeSyntaxColor_t color;
+}CeSyntaxRule_t;
+
+// every language is lexed by the same loop, rules are tried in order and the first match wins. While in a state,
+// only match_state_end is tried and the text takes the state's color
+typedef struct{
+     const CeSyntaxRule_t* rules;
+     int64_t rule_count;
+     CeSyntaxMatchFunc_t* match_state_end;
+     bool trailing_whitespace_in_state;
+}CeSyntaxLanguage_t;
+
+typedef struct{
+     CeSyntaxToken_t* tokens;
+     int32_t token_count; // -1 until the line is drawn, lines we only lex through to learn their end state don't keep them
+     uint8_t entry_state;
+     uint8_t end_state;
+     bool lexed; // end_state (and tokens if kept) come from the line's current text, lexed starting in entry_state
+}CeSyntaxLine_t;
+
+// the lexer state every line of a buffer ends in, kept in sync with the buffer's changes, so only lines that were edited
+// or now start in a different state are lexed again
+typedef struct{
+     const CeSyntaxLanguage_t* language;
+     CeSyntaxLine_t* lines;
+     int64_t line_count;
+     int64_t line_capacity;
+     int64_t valid_line_count; // lines before this were lexed starting in the state the line above them ended in
+     CeBufferChangeMark_t synced;
+     CeSyntaxTokenList_t scratch;
+}CeSyntaxCache_t;
+
 int ce_syntax_def_get_fg(CeSyntaxDef_t* syntax_defs, CeSyntaxColor_t syntax_color, int current_fg);
 int ce_syntax_def_get_bg(CeSyntaxDef_t* syntax_defs, CeSyntaxColor_t syntax_color, int current_bg);
 
 bool ce_draw_color_list_insert(CeDrawColorList_t* list, int fg, int bg, CePoint_t point);
+void ce_draw_color_list_clear(CeDrawColorList_t* list); // keeps the memory for the next frame
 void ce_draw_color_list_free(CeDrawColorList_t* list);
 bool ce_range_list_insert(CeRangeList_t* list, CePoint_t start, CePoint_t end);
-bool ce_range_list_insert_sorted(CeRangeList_t* list, CePoint_t start, CePoint_t end);
+bool ce_range_list_insert_sorted(CeRangeList_t* list, CePoint_t start, CePoint_t end); // fails if it overlaps a range
+bool ce_range_list_insert_matches(CeRangeList_t* list, const CeMatchIndex_t* index, int64_t first_line, int64_t last_line);
+void ce_range_list_clear(CeRangeList_t* list);
 void ce_range_list_free(CeRangeList_t* list);
 int ce_draw_color_list_last_fg_color(CeDrawColorList_t* draw_color_list);
 int ce_draw_color_list_last_bg_color(CeDrawColorList_t* draw_color_list);
 int ce_color_def_get(CeColorDefs_t* color_defs, int fg, int bg);
 
+CeSyntaxCache_t* ce_syntax_cache_get(CeBuffer_t* buffer, const CeSyntaxLanguage_t* language); // catches up on the buffer's edits
+void ce_syntax_cache_free(CeBuffer_t* buffer);
+
+// lex buffers ahead of where they are viewed on another thread, a byte is written to wake_fd (if it's valid) when lines
+// are ready to be taken with ce_syntax_background_update()
+bool ce_syntax_background_start(int wake_fd);
+void ce_syntax_background_stop(void);
+bool ce_syntax_background_update(void); // returns true if lexed lines were taken into a buffer's cache
+int64_t ce_syntax_generation(void); // changes whenever highlighting may differ even though the buffer didn't change
+
 void ce_syntax_highlight_c(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
                            CeSyntaxDef_t* syntax_defs, void* user_data);
 void ce_syntax_highlight_cpp(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
@@ -101,5 +170,5 @@ void ce_syntax_highlight_diff(CeView_t* view, CeRangeList_t* highlight_range_lis
 void ce_syntax_highlight_plain(CeView_t* view, CeRangeList_t* highlight_range_list, CeDrawColorList_t* draw_color_list,
                                CeSyntaxDef_t* syntax_defs, void* user_data);
 
-void ce_syntax_highlight_visual(CeRangeNode_t** range_node, bool* in_visual, CePoint_t point, CeDrawColorList_t* draw_color_list,
-                                CeSyntaxDef_t* syntax_defs);
+void ce_syntax_highlight_visual(const CeRangeList_t* range_list, int64_t* range_index, bool* in_visual, CePoint_t point,
+                                CeDrawColorList_t* draw_color_list, CeSyntaxDef_t* syntax_defs);
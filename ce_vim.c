@@ -218,8 +218,8 @@ CeVimParseResult_t insert_mode_handle_key(CeVim_t* vim, CeView_t* view, CePoint_
 
                          // check if previous line was all whitespace, if so, remove it
                          CePoint_t remove_loc = {0, save_cursor.y};
-                         if(string_is_whitespace(view->buffer->lines[save_cursor.y])){
-                              int64_t remove_len = strlen(view->buffer->lines[save_cursor.y]);
+                         if(string_is_whitespace(ce_buffer_line(view->buffer, save_cursor.y))){
+                              int64_t remove_len = strlen(ce_buffer_line(view->buffer, save_cursor.y));
                               ce_buffer_remove_string_change(view->buffer, remove_loc, remove_len, cursor,
                                                              *cursor, true);
                          }
@@ -250,8 +250,8 @@ CeVimParseResult_t insert_mode_handle_key(CeVim_t* vim, CeView_t* view, CePoint_
           break;
      case '}':
      {
-          if(!vim->pasting && string_is_whitespace(view->buffer->lines[cursor->y])){
-               int64_t remove_len = strlen(view->buffer->lines[cursor->y]);
+          if(!vim->pasting && string_is_whitespace(ce_buffer_line(view->buffer, cursor->y))){
+               int64_t remove_len = strlen(ce_buffer_line(view->buffer, cursor->y));
                CePoint_t remove_loc = {0, cursor->y};
                ce_buffer_remove_string_change(view->buffer, remove_loc, remove_len, cursor, remove_loc, true);
 
@@ -302,7 +302,7 @@ CeVimParseResult_t insert_mode_handle_key(CeVim_t* vim, CeView_t* view, CePoint_
 
                if(cursor->x == 0){
                     int64_t line = cursor->y - 1;
-                    end_cursor = (CePoint_t){ce_utf8_strlen(view->buffer->lines[line]), line};
+                    end_cursor = (CePoint_t){ce_buffer_line_len(view->buffer, line), line};
                     ce_vim_join_next_line(view->buffer, cursor->y - 1, *cursor, vim->chain_undo);
                }else{
                     remove_point = ce_buffer_advance_point(view->buffer, *cursor, -1);
@@ -358,8 +358,8 @@ CeVimParseResult_t insert_mode_handle_key(CeVim_t* vim, CeView_t* view, CePoint_
 
           // check if previous line was all whitespace, if so, remove it
           CePoint_t remove_loc = {0, cursor->y};
-          if(string_is_whitespace(view->buffer->lines[cursor->y])){
-               int64_t remove_len = strlen(view->buffer->lines[cursor->y]);
+          if(string_is_whitespace(ce_buffer_line(view->buffer, cursor->y))){
+               int64_t remove_len = strlen(ce_buffer_line(view->buffer, cursor->y));
                ce_buffer_remove_string_change(view->buffer, remove_loc, remove_len, cursor, remove_loc, true);
           }
 
@@ -442,7 +442,7 @@ CeVimParseResult_t ce_vim_handle_key(CeVim_t* vim, CeView_t* view, CePoint_t* cu
           return insert_mode_handle_key(vim, view, cursor, visual, key, config_options);
      case CE_VIM_MODE_REPLACE:
           if(key != CE_NEWLINE && key != 27){ // escape
-               int64_t last_index = ce_utf8_last_index(view->buffer->lines[cursor->y]);
+               int64_t last_index = ce_utf8_last_index(ce_buffer_line(view->buffer, cursor->y));
                if(cursor->x < last_index){
                     ce_buffer_remove_string_change(view->buffer, *cursor, 1, cursor,
                                                    *cursor, vim->chain_undo);
@@ -613,7 +613,7 @@ bool ce_vim_apply_action(CeVim_t* vim, CeVimAction_t* action, CeView_t* view, Ce
                     CeRange_t motion_range = {(CePoint_t){visual->block_top_left.x, i},
                                               (CePoint_t){visual->block_bottom_right.x, i}};
                     int64_t yank_string_index = i - visual->block_top_left.y;
-                    int64_t line_last_index = ce_utf8_last_index(view->buffer->lines[i]);
+                    int64_t line_last_index = ce_utf8_last_index(ce_buffer_line(view->buffer, i));
 
                     // clamp the range to the line length
                     if(motion_range.start.x > line_last_index) motion_range.start.x = line_last_index;
@@ -644,7 +644,7 @@ bool ce_vim_apply_action(CeVim_t* vim, CeVimAction_t* action, CeView_t* view, Ce
                for(int64_t i = visual->block_top_left.y; i <= visual->block_bottom_right.y; i++){
                     CeRange_t motion_range = {(CePoint_t){visual->block_top_left.x, i},
                                               (CePoint_t){visual->block_bottom_right.x, i}};
-                    int64_t line_last_index = ce_utf8_last_index(view->buffer->lines[i]);
+                    int64_t line_last_index = ce_utf8_last_index(ce_buffer_line(view->buffer, i));
 
                     // clamp the range to the line length
                     if(motion_range.start.x > line_last_index) motion_range.start.x = line_last_index;
@@ -701,7 +701,7 @@ typedef enum{
 int64_t ce_vim_soft_begin_line(CeBuffer_t* buffer, int64_t line){
      if(line < 0 || line >= buffer->line_count) return -1;
 
-     const char* itr = buffer->lines[line];
+     const char* itr = ce_buffer_line(buffer, line);
      int64_t index = 0;
      int64_t rune_len = 0;
      CeRune_t rune = ce_utf8_decode(itr, &rune_len);
@@ -719,7 +719,7 @@ int64_t ce_vim_soft_begin_line(CeBuffer_t* buffer, int64_t line){
 CePoint_t ce_vim_move_little_word(CeBuffer_t* buffer, CePoint_t start){
      if(!ce_buffer_point_is_valid(buffer, start)) return (CePoint_t){-1, -1};
 
-     char* itr = ce_utf8_iterate_to(buffer->lines[start.y], start.x);
+     char* itr = ce_buffer_line_iterate_to(buffer, start.y, start.x);
 
      int64_t rune_len = 0;
      CeRune_t rune = ce_utf8_decode(itr, &rune_len);
@@ -741,7 +741,7 @@ CePoint_t ce_vim_move_little_word(CeBuffer_t* buffer, CePoint_t start){
           }
           start.x = 0;
           start.y++;
-          itr = buffer->lines[start.y];
+          itr = ce_buffer_line(buffer, start.y);
           state = WORD_NEW_LINE;
      }
 
@@ -773,7 +773,7 @@ CePoint_t ce_vim_move_little_word(CeBuffer_t* buffer, CePoint_t start){
                if(start.y >= buffer->line_count - 1) break;
                start.x = 0;
                start.y++;
-               itr = buffer->lines[start.y];
+               itr = ce_buffer_line(buffer, start.y);
                state = WORD_NEW_LINE;
           }else{
                itr += rune_len;
@@ -789,7 +789,7 @@ END_LOOP:
 CePoint_t ce_vim_move_big_word(CeBuffer_t* buffer, CePoint_t start){
      if(!ce_buffer_point_is_valid(buffer, start)) return (CePoint_t){-1, -1};
 
-     char* itr = ce_utf8_iterate_to(buffer->lines[start.y], start.x);
+     char* itr = ce_buffer_line_iterate_to(buffer, start.y, start.x);
 
      int64_t rune_len = 0;
      CeRune_t rune = ce_utf8_decode(itr, &rune_len);
@@ -823,7 +823,7 @@ CePoint_t ce_vim_move_big_word(CeBuffer_t* buffer, CePoint_t start){
                if(start.y >= buffer->line_count - 1) break;
                start.x = 0;
                start.y++;
-               itr = buffer->lines[start.y];
+               itr = ce_buffer_line(buffer, start.y);
                state = WORD_NEW_LINE;
           }else{
                itr += rune_len;
@@ -847,7 +847,7 @@ CePoint_t ce_vim_move_end_little_word(CeBuffer_t* buffer, CePoint_t start){
           }
      }
 
-     char* itr = ce_utf8_iterate_to(buffer->lines[start.y], start.x);
+     char* itr = ce_buffer_line_iterate_to(buffer, start.y, start.x);
      int64_t rune_len = 0;
      CeRune_t rune = 0;
      WordState_t state = WORD_INSIDE_OTHER;
@@ -856,7 +856,7 @@ CePoint_t ce_vim_move_end_little_word(CeBuffer_t* buffer, CePoint_t start){
           if(start.y >= buffer->line_count - 1) return (CePoint_t){-1, -1};
           start.x = 0;
           start.y++;
-          itr = buffer->lines[start.y];
+          itr = ce_buffer_line(buffer, start.y);
 
           rune = ce_utf8_decode(itr, &rune_len);
           itr += rune_len;
@@ -905,7 +905,7 @@ CePoint_t ce_vim_move_end_little_word(CeBuffer_t* buffer, CePoint_t start){
                if(start.y >= buffer->line_count - 1) break;
                start.x = 0;
                start.y++;
-               itr = buffer->lines[start.y];
+               itr = ce_buffer_line(buffer, start.y);
 
                rune = ce_utf8_decode(itr, &rune_len);
                itr += rune_len;
@@ -931,7 +931,7 @@ CePoint_t ce_vim_move_end_big_word(CeBuffer_t* buffer, CePoint_t start){
           }
      }
 
-     char* itr = ce_utf8_iterate_to(buffer->lines[start.y], start.x);
+     char* itr = ce_buffer_line_iterate_to(buffer, start.y, start.x);
 
      int64_t rune_len = 0;
      CeRune_t rune = 0;
@@ -941,7 +941,7 @@ CePoint_t ce_vim_move_end_big_word(CeBuffer_t* buffer, CePoint_t start){
           if(start.y >= buffer->line_count - 1) return (CePoint_t){-1, -1};
           start.x = 0;
           start.y++;
-          itr = buffer->lines[start.y];
+          itr = ce_buffer_line(buffer, start.y);
 
           rune = ce_utf8_decode(itr, &rune_len);
           itr += rune_len;
@@ -987,7 +987,7 @@ CePoint_t ce_vim_move_begin_little_word(CeBuffer_t* buffer, CePoint_t start){
           if(start.x == -1){
                start.y--;
                if(start.y < 0) return (CePoint_t){0, 0};
-               start.x = ce_utf8_strlen(buffer->lines[start.y]);
+               start.x = ce_buffer_line_len(buffer, start.y);
                if(start.x > 0) start.x--;
                else return start;
                state = WORD_NEW_LINE;
@@ -997,7 +997,7 @@ CePoint_t ce_vim_move_begin_little_word(CeBuffer_t* buffer, CePoint_t start){
      }
 
 
-     char* line_start = buffer->lines[start.y];
+     char* line_start = ce_buffer_line(buffer, start.y);
      char* itr = ce_utf8_iterate_to(line_start, start.x); // start one character back
 
      int64_t rune_len = 0;
@@ -1047,10 +1047,10 @@ CePoint_t ce_vim_move_begin_little_word(CeBuffer_t* buffer, CePoint_t start){
 
                start.y--;
                if(start.y < 0) return (CePoint_t){0, 0};
-               start.x = ce_utf8_strlen(buffer->lines[start.y]);
+               start.x = ce_buffer_line_len(buffer, start.y);
                if(start.x > 0) start.x--;
                else break;
-               line_start = buffer->lines[start.y];
+               line_start = ce_buffer_line(buffer, start.y);
                itr = ce_utf8_iterate_to(line_start, start.x); // start one character back
                state = WORD_NEW_LINE;
           }
@@ -1066,7 +1066,7 @@ CePoint_t ce_vim_move_begin_big_word(CeBuffer_t* buffer, CePoint_t start){
           if(start.x == -1){
                start.y--;
                if(start.y < 0) return (CePoint_t){0, 0};
-               start.x = ce_utf8_strlen(buffer->lines[start.y]);
+               start.x = ce_buffer_line_len(buffer, start.y);
                if(start.x > 0) start.x--;
                else return start;
           }else{
@@ -1074,7 +1074,7 @@ CePoint_t ce_vim_move_begin_big_word(CeBuffer_t* buffer, CePoint_t start){
           }
      }
 
-     char* line_start = buffer->lines[start.y];
+     char* line_start = ce_buffer_line(buffer, start.y);
      char* itr = ce_utf8_iterate_to(line_start, start.x); // start one character back
 
      int64_t rune_len = 0;
@@ -1117,9 +1117,9 @@ CePoint_t ce_vim_move_begin_big_word(CeBuffer_t* buffer, CePoint_t start){
 
                start.y--;
                if(start.y < 0) return (CePoint_t){0, 0};
-               start.x = ce_utf8_strlen(buffer->lines[start.y]);
+               start.x = ce_buffer_line_len(buffer, start.y);
                if(start.x == 0) break;
-               line_start = buffer->lines[start.y];
+               line_start = ce_buffer_line(buffer, start.y);
                itr = ce_utf8_iterate_to(line_start, start.x);
                state = WORD_NEW_LINE;
                start.x++;
@@ -1134,7 +1134,7 @@ END_LOOP:
 CePoint_t ce_vim_move_find_rune_forward(CeBuffer_t* buffer, CePoint_t start, CeRune_t match_rune, bool until){
      if(!ce_buffer_point_is_valid(buffer, start)) return (CePoint_t){-1, -1};
      int64_t match_x = until ? start.x + 2 : start.x + 1;
-     char* str = ce_utf8_iterate_to(buffer->lines[start.y], match_x);
+     char* str = ce_buffer_line_iterate_to(buffer, start.y, match_x);
      if(!str) return (CePoint_t){-1, -1};
 
      while(*str){
@@ -1152,7 +1152,7 @@ CePoint_t ce_vim_move_find_rune_backward(CeBuffer_t* buffer, CePoint_t start, Ce
      if(!ce_buffer_point_is_valid(buffer, start)) return (CePoint_t){-1, -1};
      if(start.x == 0) return (CePoint_t){-1, -1};
 
-     char* start_of_line = buffer->lines[start.y];
+     char* start_of_line = ce_buffer_line(buffer, start.y);
      char* str = ce_utf8_iterate_to(start_of_line, start.x);
      if(!str) return (CePoint_t){-1, -1};
      int64_t match_x = start.x - 1;
@@ -1178,7 +1178,7 @@ CePoint_t ce_vim_move_find_rune_backward(CeBuffer_t* buffer, CePoint_t start, Ce
 
 CeRange_t ce_vim_find_little_word_boundaries(CeBuffer_t* buffer, CePoint_t start){
      CeRange_t range = {(CePoint_t){-1, -1}, (CePoint_t){-1, -1}};
-     char* line_start = buffer->lines[start.y];
+     char* line_start = ce_buffer_line(buffer, start.y);
      char* itr = ce_utf8_iterate_to(line_start, start.x);
      char* save_start = itr;
      if(!is_little_word_character(*itr)) return range;
@@ -1214,7 +1214,7 @@ CeRange_t ce_vim_find_little_word_boundaries(CeBuffer_t* buffer, CePoint_t start
 
 CeRange_t ce_vim_find_big_word_boundaries(CeBuffer_t* buffer, CePoint_t start){
      CeRange_t range = {(CePoint_t){-1, -1}, (CePoint_t){-1, -1}};
-     char* line_start = buffer->lines[start.y];
+     char* line_start = ce_buffer_line(buffer, start.y);
      char* itr = ce_utf8_iterate_to(line_start, start.x);
      char* save_start = itr;
      if(!is_little_word_character(*itr)) return range;
@@ -1250,7 +1250,7 @@ CeRange_t ce_vim_find_big_word_boundaries(CeBuffer_t* buffer, CePoint_t start){
 
 CeRange_t ce_vim_find_string_boundaries(CeBuffer_t* buffer, CePoint_t start, char string_char){
      CeRange_t range = {(CePoint_t){-1, -1}, (CePoint_t){-1, -1}};
-     char* line_start = buffer->lines[start.y];
+     char* line_start = ce_buffer_line(buffer, start.y);
      char* itr = ce_utf8_iterate_to(line_start, start.x);
      char* save_start = itr;
      int64_t rune_len = 0;
@@ -1297,7 +1297,7 @@ static bool point_in_string_or_comment(CeBuffer_t* buffer, CePoint_t point){
      CeRune_t in_comment = 0;
      CeRune_t prev_rune = 0;
      CeRune_t prev_prev_rune = 0;
-     char* str = buffer->lines[point.y];
+     char* str = ce_buffer_line(buffer, point.y);
      int64_t rune_len;
      for(int64_t i = 0; i <= point.x; i++){
           CeRune_t rune = ce_utf8_decode(str, &rune_len);
@@ -1423,7 +1423,7 @@ CeRange_t ce_vim_find_pair(CeBuffer_t* buffer, CePoint_t start, CeRune_t rune, b
      prev = itr;
      match_count = level;
      CePoint_t new_end = range.end;
-     CePoint_t end_of_buffer = {ce_utf8_last_index(buffer->lines[buffer->line_count - 1]), buffer->line_count - 1};
+     CePoint_t end_of_buffer = {ce_utf8_last_index(ce_buffer_line(buffer, buffer->line_count - 1)), buffer->line_count - 1};
      while(true){
           buffer_rune = ce_buffer_get_rune(buffer, itr);
           if(buffer_rune == right_match && !point_in_string_or_comment(buffer, itr)){
@@ -1470,7 +1470,7 @@ int64_t ce_vim_get_indentation(CeBuffer_t* buffer, CePoint_t point, int64_t tab_
           return indent;
      }else if(buffer_data->syntax_function == ce_syntax_highlight_python){
           for(int64_t y = point.y; y >= 0; --y){
-               const char* itr = buffer->lines[y];
+               const char* itr = ce_buffer_line(buffer, y);
 
                // find previous line that isn't blank
                bool blank = true;
@@ -1487,7 +1487,7 @@ int64_t ce_vim_get_indentation(CeBuffer_t* buffer, CePoint_t point, int64_t tab_
                if(blank) continue;
 
                // use it as indentation unless it ends in a ':'
-               int indentation = itr - buffer->lines[y];
+               int indentation = itr - ce_buffer_line(buffer, y);
 
                while(*itr) itr++;
                itr--;
@@ -1501,7 +1501,7 @@ int64_t ce_vim_get_indentation(CeBuffer_t* buffer, CePoint_t point, int64_t tab_
 }
 
 bool ce_vim_join_next_line(CeBuffer_t* buffer, int64_t line, CePoint_t cursor, bool chain_undo){
-     CePoint_t point = {ce_utf8_strlen(buffer->lines[line]), line};
+     CePoint_t point = {ce_buffer_line_len(buffer, line), line};
      CePoint_t after_point = {0, point.y + 1};
      ce_buffer_remove_string_change(buffer, point, 1, &cursor, after_point, chain_undo);
      return true;
@@ -2124,7 +2124,7 @@ CeVimMotionResult_t ce_vim_motion_up(CeVim_t* vim, CeVimAction_t* action, const
                // we use start instead of end so that we can sort them consistently through a motion multiplier
                motion_range->start.y--;
                motion_range->start.x = 0;
-               motion_range->end.x = ce_utf8_last_index(view->buffer->lines[motion_range->end.y]);
+               motion_range->end.x = ce_utf8_last_index(ce_buffer_line(view->buffer, motion_range->end.y));
                ce_range_sort(motion_range);
           }
 
@@ -2140,7 +2140,7 @@ CeVimMotionResult_t ce_vim_motion_down(CeVim_t* vim, CeVimAction_t* action, cons
      if(action->verb.function != ce_vim_verb_motion){
           if(motion_range->end.y < view->buffer->line_count - 1){
                motion_range->end.y++;
-               motion_range->end.x = ce_utf8_last_index(view->buffer->lines[motion_range->end.y]);
+               motion_range->end.x = ce_utf8_last_index(ce_buffer_line(view->buffer, motion_range->end.y));
                motion_range->start.x = 0;
                ce_range_sort(motion_range);
           }
@@ -2227,14 +2227,14 @@ CeVimMotionResult_t ce_vim_motion_hard_begin_line(CeVim_t* vim, CeVimAction_t* a
 CeVimMotionResult_t ce_vim_motion_end_line(CeVim_t* vim, CeVimAction_t* action, const CeView_t* view, const CePoint_t* cursor,
                                            CeVimVisualData_t* visual, const CeConfigOptions_t* config_options,
                                            CeVimBufferData_t* buffer_data, CeRange_t* motion_range){
-     motion_range->end.x = ce_utf8_last_index(view->buffer->lines[motion_range->end.y]);
+     motion_range->end.x = ce_utf8_last_index(ce_buffer_line(view->buffer, motion_range->end.y));
      return CE_VIM_MOTION_RESULT_SUCCESS;
 }
 
 CeVimMotionResult_t ce_vim_motion_entire_line(CeVim_t* vim, CeVimAction_t* action, const CeView_t* view, const CePoint_t* cursor,
                                               CeVimVisualData_t* visual, const CeConfigOptions_t* config_options,
                                               CeVimBufferData_t* buffer_data, CeRange_t* motion_range){
-     int64_t line_length = ce_utf8_strlen(view->buffer->lines[motion_range->end.y]);
+     int64_t line_length = ce_buffer_line_len(view->buffer, motion_range->end.y);
      motion_range->start = (CePoint_t){0, motion_range->end.y};
      motion_range->end = (CePoint_t){line_length, motion_range->end.y};
      return CE_VIM_MOTION_RESULT_SUCCESS;
@@ -2279,7 +2279,7 @@ CeVimMotionResult_t ce_vim_motion_visual(CeVim_t* vim, CeVimAction_t* action, co
 
           if(vim->mode == CE_VIM_MODE_VISUAL_LINE){
                motion_range->start.x = 0;
-               motion_range->end.x = ce_utf8_strlen(view->buffer->lines[motion_range->end.y]);
+               motion_range->end.x = ce_buffer_line_len(view->buffer, motion_range->end.y);
                action->yank_type = CE_VIM_YANK_TYPE_LINE;
                action->motion.integer = motion_range->end.y - motion_range->start.y;
           }
@@ -2296,7 +2296,7 @@ CeVimMotionResult_t ce_vim_motion_visual(CeVim_t* vim, CeVimAction_t* action, co
                if(motion_range->end.y < 0){
                     motion_range->end.y = 0;
                }
-               motion_range->end.x = ce_utf8_strlen(view->buffer->lines[motion_range->end.y]);
+               motion_range->end.x = ce_buffer_line_len(view->buffer, motion_range->end.y);
                break;
           case CE_VIM_YANK_TYPE_STRING:
                motion_range->start = *cursor;
@@ -2438,6 +2438,16 @@ CeVimMotionResult_t ce_vim_motion_end_of_file(CeVim_t* vim, CeVimAction_t* actio
      return CE_VIM_MOTION_RESULT_SUCCESS;
 }
 
+// the buffer's match index can answer a search without scanning, when it has indexed the whole buffer for the pattern
+static bool search_matches_find(CeVimBufferData_t* buffer_data, CeBuffer_t* buffer, const char* pattern, bool regex,
+                                CePoint_t start, bool forward, CePoint_t* result){
+     if(!buffer_data) return false;
+     CeMatchIndex_t* search_matches = &buffer_data->search_matches;
+     if(!ce_match_index_covers(search_matches, buffer, pattern, regex, buffer->line_count - 1)) return false;
+     *result = forward ? ce_match_index_next(search_matches, start) : ce_match_index_prev(search_matches, start);
+     return true;
+}
+
 CeVimMotionResult_t ce_vim_motion_search_next(CeVim_t* vim, CeVimAction_t* action, const CeView_t* view, const CePoint_t* cursor,
                                               CeVimVisualData_t* visual, const CeConfigOptions_t* config_options,
                                               CeVimBufferData_t* buffer_data, CeRange_t* motion_range){
@@ -2450,42 +2460,44 @@ CeVimMotionResult_t ce_vim_motion_search_next(CeVim_t* vim, CeVimAction_t* actio
      case CE_VIM_SEARCH_MODE_FORWARD:
      {
           CePoint_t start = ce_buffer_advance_point(view->buffer, motion_range->end, 1);
-          result = ce_buffer_search_forward(view->buffer, start, yank->text);
+          if(!search_matches_find(buffer_data, view->buffer, yank->text, false, start, true, &result)){
+               result = ce_buffer_search_forward(view->buffer, start, yank->text);
+          }
      } break;
      case CE_VIM_SEARCH_MODE_BACKWARD:
      {
           CePoint_t start = ce_buffer_advance_point(view->buffer, motion_range->end, -1);
-          result = ce_buffer_search_backward(view->buffer, start, yank->text);
+          if(!search_matches_find(buffer_data, view->buffer, yank->text, false, start, false, &result)){
+               result = ce_buffer_search_backward(view->buffer, start, yank->text);
+          }
      } break;
      case CE_VIM_SEARCH_MODE_REGEX_FORWARD:
      {
           CePoint_t start = ce_buffer_advance_point(view->buffer, motion_range->end, 1);
+          if(search_matches_find(buffer_data, view->buffer, yank->text, true, start, true, &result)) break;
           CeRegex_t regex = NULL;
-          CeRegexResult_t regex_result = ce_regex_init(yank->text,
-                                                       &regex);
+          CeRegexResult_t regex_result = ce_regex_cache_get(yank->text, &regex);
           if(regex_result.error_message != NULL){
-               ce_log("ce_regex_init() failed: '%s'", regex_result.error_message);
+               ce_log("ce_regex_cache_get() failed: '%s'", regex_result.error_message);
                free(regex_result.error_message);
           }else{
                CeRegexSearchResult_t search_result = ce_buffer_regex_search_forward(view->buffer, start, regex);
                result = search_result.point;
           }
-          ce_regex_free(regex);
      } break;
      case CE_VIM_SEARCH_MODE_REGEX_BACKWARD:
      {
           CePoint_t start = ce_buffer_advance_point(view->buffer, motion_range->end, -1);
+          if(search_matches_find(buffer_data, view->buffer, yank->text, true, start, false, &result)) break;
           CeRegex_t regex = NULL;
-          CeRegexResult_t regex_result = ce_regex_init(yank->text,
-                                                       &regex);
+          CeRegexResult_t regex_result = ce_regex_cache_get(yank->text, &regex);
           if(regex_result.error_message != NULL){
-               ce_log("ce_regex_init() failed: '%s'", regex_result.error_message);
+               ce_log("ce_regex_cache_get() failed: '%s'", regex_result.error_message);
                free(regex_result.error_message);
           }else{
                CeRegexSearchResult_t search_result = ce_buffer_regex_search_backward(view->buffer, start, regex);
                result = search_result.point;
           }
-          ce_regex_free(regex);
      } break;
      }
      if(result.x < 0) return CE_VIM_MOTION_RESULT_FAIL;
@@ -2505,21 +2517,25 @@ CeVimMotionResult_t ce_vim_motion_search_prev(CeVim_t* vim, CeVimAction_t* actio
      case CE_VIM_SEARCH_MODE_FORWARD:
      {
           CePoint_t start = ce_buffer_advance_point(view->buffer, motion_range->end, -1);
-          result = ce_buffer_search_backward(view->buffer, start, yank->text);
+          if(!search_matches_find(buffer_data, view->buffer, yank->text, false, start, false, &result)){
+               result = ce_buffer_search_backward(view->buffer, start, yank->text);
+          }
      } break;
      case CE_VIM_SEARCH_MODE_BACKWARD:
      {
           CePoint_t start = ce_buffer_advance_point(view->buffer, motion_range->end, 1);
-          result = ce_buffer_search_forward(view->buffer, start, yank->text);
+          if(!search_matches_find(buffer_data, view->buffer, yank->text, false, start, true, &result)){
+               result = ce_buffer_search_forward(view->buffer, start, yank->text);
+          }
      } break;
      case CE_VIM_SEARCH_MODE_REGEX_FORWARD:
      {
           CePoint_t start = ce_buffer_advance_point(view->buffer, motion_range->end, -1);
+          if(search_matches_find(buffer_data, view->buffer, yank->text, true, start, false, &result)) break;
           CeRegex_t regex = NULL;
-          CeRegexResult_t regex_result = ce_regex_init(yank->text,
-                                                       &regex);
+          CeRegexResult_t regex_result = ce_regex_cache_get(yank->text, &regex);
           if(regex_result.error_message != NULL){
-               ce_log("ce_regex_init() failed: '%s'", regex_result.error_message);
+               ce_log("ce_regex_cache_get() failed: '%s'", regex_result.error_message);
                free(regex_result.error_message);
           }else{
                CeRegexSearchResult_t search_result = ce_buffer_regex_search_backward(view->buffer, start, regex);
@@ -2529,11 +2545,11 @@ CeVimMotionResult_t ce_vim_motion_search_prev(CeVim_t* vim, CeVimAction_t* actio
      case CE_VIM_SEARCH_MODE_REGEX_BACKWARD:
      {
           CePoint_t start = ce_buffer_advance_point(view->buffer, motion_range->end, 1);
+          if(search_matches_find(buffer_data, view->buffer, yank->text, true, start, true, &result)) break;
           CeRegex_t regex = NULL;
-          CeRegexResult_t regex_result = ce_regex_init(yank->text,
-                                                       &regex);
+          CeRegexResult_t regex_result = ce_regex_cache_get(yank->text, &regex);
           if(regex_result.error_message != NULL){
-               ce_log("ce_regex_init() failed: '%s'", regex_result.error_message);
+               ce_log("ce_regex_cache_get() failed: '%s'", regex_result.error_message);
                free(regex_result.error_message);
           }else{
                CeRegexSearchResult_t search_result = ce_buffer_regex_search_forward(view->buffer, start, regex);
@@ -2659,9 +2675,9 @@ static bool string_is_blank(const char* string){
 CeVimMotionResult_t ce_vim_motion_next_blank_line(CeVim_t* vim, CeVimAction_t* action, const CeView_t* view, const CePoint_t* cursor,
                                                   CeVimVisualData_t* visual, const CeConfigOptions_t* config_options,
                                                   CeVimBufferData_t* buffer_data, CeRange_t* motion_range){
-     bool start_blank = string_is_blank(view->buffer->lines[motion_range->end.y]);
+     bool start_blank = string_is_blank(ce_buffer_line(view->buffer, motion_range->end.y));
      for(int64_t y = motion_range->end.y + 1; y < view->buffer->line_count; y++){
-          bool current_blank = string_is_blank(view->buffer->lines[y]);
+          bool current_blank = string_is_blank(ce_buffer_line(view->buffer, y));
           if(current_blank){
                if(!start_blank){
                     motion_range->end = (CePoint_t){0, y};
@@ -2677,9 +2693,9 @@ CeVimMotionResult_t ce_vim_motion_next_blank_line(CeVim_t* vim, CeVimAction_t* a
 CeVimMotionResult_t ce_vim_motion_previous_blank_line(CeVim_t* vim, CeVimAction_t* action, const CeView_t* view, const CePoint_t* cursor,
                                                       CeVimVisualData_t* visual, const CeConfigOptions_t* config_options,
                                                       CeVimBufferData_t* buffer_data, CeRange_t* motion_range){
-     bool start_blank = string_is_blank(view->buffer->lines[motion_range->end.y]);
+     bool start_blank = string_is_blank(ce_buffer_line(view->buffer, motion_range->end.y));
      for(int64_t y = motion_range->end.y - 1; y >= 0; y--){
-          bool current_blank = string_is_blank(view->buffer->lines[y]);
+          bool current_blank = string_is_blank(ce_buffer_line(view->buffer, y));
           if(current_blank){
                if(!start_blank){
                     motion_range->end = (CePoint_t){0, y};
@@ -2697,16 +2713,16 @@ CeVimMotionResult_t ce_vim_motion_next_zero_indentation_line(CeVim_t* vim, CeVim
                                                              CeVimBufferData_t* buffer_data, CeRange_t* motion_range){
      CeAppBufferData_t* buffer_app_data = view->buffer->app_data;
      for(int64_t y = motion_range->end.y + 1; y < view->buffer->line_count; y++){
-          if(ce_utf8_strlen(view->buffer->lines[y]) == 0) continue;
+          if(ce_buffer_line_len(view->buffer, y) == 0) continue;
           if(buffer_app_data->syntax_function == ce_syntax_highlight_c ||
              buffer_app_data->syntax_function == ce_syntax_highlight_cpp){
-               if(view->buffer->lines[y][0] == '#' ||
-                  view->buffer->lines[y][0] == '/'){
+               if(ce_buffer_line(view->buffer, y)[0] == '#' ||
+                  ce_buffer_line(view->buffer, y)[0] == '/'){
                     continue;
                }
           }
 
-          if(_is_print((int)(view->buffer->lines[y][0])) && !isspace((int)(view->buffer->lines[y][0])) && strchr(view->buffer->lines[y], '(')){
+          if(_is_print((int)(ce_buffer_line(view->buffer, y)[0])) && !isspace((int)(ce_buffer_line(view->buffer, y)[0])) && strchr(ce_buffer_line(view->buffer, y), '(')){
                motion_range->end = (CePoint_t){0, y};
                return CE_VIM_MOTION_RESULT_SUCCESS;
           }
@@ -2719,16 +2735,16 @@ CeVimMotionResult_t ce_vim_motion_previous_zero_indentation_line(CeVim_t* vim, C
                                                                  CeVimBufferData_t* buffer_data, CeRange_t* motion_range){
      CeAppBufferData_t* buffer_app_data = view->buffer->app_data;
      for(int64_t y = motion_range->end.y - 1; y >= 0; y--){
-          if(ce_utf8_strlen(view->buffer->lines[y]) == 0) continue;
+          if(ce_buffer_line_len(view->buffer, y) == 0) continue;
           if(buffer_app_data->syntax_function == ce_syntax_highlight_c ||
              buffer_app_data->syntax_function == ce_syntax_highlight_cpp){
-               if(view->buffer->lines[y][0] == '#' ||
-                  view->buffer->lines[y][0] == '/'){
+               if(ce_buffer_line(view->buffer, y)[0] == '#' ||
+                  ce_buffer_line(view->buffer, y)[0] == '/'){
                     continue;
                }
           }
 
-          if(_is_print((int)(view->buffer->lines[y][0])) && !isspace((int)(view->buffer->lines[y][0])) && strchr(view->buffer->lines[y], '(')){
+          if(_is_print((int)(ce_buffer_line(view->buffer, y)[0])) && !isspace((int)(ce_buffer_line(view->buffer, y)[0])) && strchr(ce_buffer_line(view->buffer, y), '(')){
                motion_range->end = (CePoint_t){0, y};
                return CE_VIM_MOTION_RESULT_SUCCESS;
           }
@@ -2819,7 +2835,7 @@ bool ce_vim_verb_delete(CeVim_t* vim, const CeVimAction_t* action, CeRange_t mot
      CeVimYankType_t yank_type = action->yank_type;
      if(action->exclude_end){
           motion_range.end = ce_buffer_advance_point(view->buffer, motion_range.end, -1);
-          if(motion_range.end.x == ce_utf8_strlen(view->buffer->lines[motion_range.end.y])){
+          if(motion_range.end.x == ce_buffer_line_len(view->buffer, motion_range.end.y)){
                yank_type = CE_VIM_YANK_TYPE_LINE;
           }
      }
@@ -2909,7 +2925,7 @@ bool ce_vim_verb_set_character(CeVim_t* vim, const CeVimAction_t* action, CeRang
           if(!ce_buffer_contains_point(view->buffer, motion_range.start)){
                motion_range.start = ce_buffer_advance_point(view->buffer, motion_range.start, 1);
                continue;
-          }else if(view->buffer->lines[motion_range.start.y][0] == 0){
+          }else if(ce_buffer_line(view->buffer, motion_range.start.y)[0] == 0){
                motion_range.start = ce_buffer_advance_point(view->buffer, motion_range.start, 1);
                continue;
           }
@@ -2960,7 +2976,7 @@ bool ce_vim_verb_substitute_soft_begin_line(CeVim_t* vim, const CeVimAction_t* a
 
      cursor->x = soft_begin_index;
      motion_range.start = *cursor;
-     motion_range.end.x = ce_utf8_last_index(view->buffer->lines[motion_range.end.y]);
+     motion_range.end.x = ce_utf8_last_index(ce_buffer_line(view->buffer, motion_range.end.y));
 
      // if the line is empty, just enter insert mode
      if(motion_range.end.x == 0){
@@ -3010,7 +3026,7 @@ static bool paste_text(CeVim_t* vim, const CeVimAction_t* action, CeRange_t moti
      case CE_VIM_YANK_TYPE_STRING:
           if(after){
                insertion_point.x++;
-               int64_t line_len = ce_utf8_strlen(view->buffer->lines[insertion_point.y]);
+               int64_t line_len = ce_buffer_line_len(view->buffer, insertion_point.y);
                if(insertion_point.x > line_len) insertion_point.x = line_len - 1;
                if(insertion_point.x < 0) insertion_point.x = 0;
           }
@@ -3047,7 +3063,7 @@ static bool paste_text(CeVim_t* vim, const CeVimAction_t* action, CeRange_t moti
                CePoint_t point = {insertion_point.x, insertion_point.y + i};
 
                // if the line isn't long enough, append space so it is long enough
-               int64_t line_len = ce_utf8_strlen(view->buffer->lines[point.y]);
+               int64_t line_len = ce_buffer_line_len(view->buffer, point.y);
                if(insertion_point.x > line_len){
                     int64_t space_len = (insertion_point.x - line_len);
                     char* space_str = malloc(space_len + 1);
@@ -3102,7 +3118,7 @@ static bool paste_text(CeVim_t* vim, const CeVimAction_t* action, CeRange_t moti
                     }
                     insert_str[0] = CE_NEWLINE;
                     insertion_point.y = view->buffer->line_count - 1;
-                    insertion_point.x = ce_utf8_strlen(view->buffer->lines[insertion_point.y]);
+                    insertion_point.x = ce_buffer_line_len(view->buffer, insertion_point.y);
                }
           }
      }
@@ -3202,7 +3218,7 @@ bool ce_vim_verb_open_below(CeVim_t* vim, const CeVimAction_t* action, CeRange_t
                             const CeConfigOptions_t* config_options){
      // insert newline at the end of the current line
      char* insert_string = strdup("\n");
-     motion_range.start.x = ce_utf8_strlen(view->buffer->lines[motion_range.start.y]);
+     motion_range.start.x = ce_buffer_line_len(view->buffer, motion_range.start.y);
      if(!ce_buffer_insert_string_change(view->buffer, insert_string, motion_range.start, cursor, *cursor, false)){
           return false;
      }
@@ -3286,7 +3302,7 @@ bool ce_vim_verb_normal_mode(CeVim_t* vim, const CeVimAction_t* action, CeRange_
 bool ce_vim_verb_append(CeVim_t* vim, const CeVimAction_t* action, CeRange_t motion_range, CeView_t* view,
                         CePoint_t* cursor, CeVimVisualData_t* visual, CeVimBufferData_t* buffer_data,
                         const CeConfigOptions_t* config_options){
-     int64_t last_valid_index = ce_utf8_strlen(view->buffer->lines[cursor->y]);
+     int64_t last_valid_index = ce_buffer_line_len(view->buffer, cursor->y);
      cursor->x++;
      if(cursor->x > last_valid_index) cursor->x = last_valid_index;
      ce_vim_insert_mode(vim);
@@ -3296,7 +3312,7 @@ bool ce_vim_verb_append(CeVim_t* vim, const CeVimAction_t* action, CeRange_t mot
 bool ce_vim_verb_append_at_end_of_line(CeVim_t* vim, const CeVimAction_t* action, CeRange_t motion_range, CeView_t* view,
                                        CePoint_t* cursor, CeVimVisualData_t* visual, CeVimBufferData_t* buffer_data,
                                        const CeConfigOptions_t* config_options){
-     cursor->x = ce_utf8_strlen(view->buffer->lines[cursor->y]);
+     cursor->x = ce_buffer_line_len(view->buffer, cursor->y);
      ce_vim_insert_mode(vim);
      return true;
 }
@@ -3401,7 +3417,7 @@ bool ce_vim_verb_indent(CeVim_t* vim, const CeVimAction_t* action, CeRange_t mot
      CePoint_t end_cursor = *cursor;
 
      for(int64_t i = motion_range.start.y; i <= motion_range.end.y; i++){
-          if(view->buffer->lines[i][0] == 0) continue;
+          if(ce_buffer_line(view->buffer, i)[0] == 0) continue;
 
           // calc indentation
           CePoint_t indentation_point = {0, i};
@@ -3450,7 +3466,7 @@ bool ce_vim_verb_unindent(CeVim_t* vim, const CeVimAction_t* action, CeRange_t m
 
           // figure out how much we can unindent
           for(int64_t s = 0; s < config_options->tab_width; s++){
-               if(isblank((int)(view->buffer->lines[i][s]))){
+               if(isblank((int)(ce_buffer_line(view->buffer, i)[s]))){
                     tab_width++;
                }else{
                     break;
@@ -3487,8 +3503,8 @@ bool ce_vim_verb_join(CeVim_t* vim, const CeVimAction_t* action, CeRange_t motio
           ce_buffer_remove_string_change(view->buffer, beginning_of_next_line, whitespace_len, cursor, *cursor, false);
      }
 
-     bool insert_space = (strlen(view->buffer->lines[cursor->y + 1]) > 0);
-     CePoint_t point = {ce_utf8_strlen(view->buffer->lines[cursor->y]), cursor->y};
+     bool insert_space = (strlen(ce_buffer_line(view->buffer, cursor->y + 1)) > 0);
+     CePoint_t point = {ce_buffer_line_len(view->buffer, cursor->y), cursor->y};
      ce_vim_join_next_line(view->buffer, cursor->y, *cursor, true);
 
      if(insert_space){
@@ -3509,7 +3525,7 @@ bool ce_vim_verb_flip_case(CeVim_t* vim, const CeVimAction_t* action, CeRange_t
           if(!ce_buffer_contains_point(view->buffer, motion_range.start)){
                motion_range.start = ce_buffer_advance_point(view->buffer, motion_range.start, 1);
                continue;
-          }else if(view->buffer->lines[motion_range.start.y][0] == 0){
+          }else if(ce_buffer_line(view->buffer, motion_range.start.y)[0] == 0){
                motion_range.start = ce_buffer_advance_point(view->buffer, motion_range.start, 1);
                continue;
           }
@@ -3543,7 +3559,7 @@ bool ce_vim_verb_set_mark(CeVim_t* vim, const CeVimAction_t* action, CeRange_t m
 }
 
 static bool change_number(CeView_t* view, CePoint_t* cursor, CePoint_t point, int64_t delta){
-     char* start = ce_utf8_iterate_to(view->buffer->lines[point.y], point.x);
+     char* start = ce_buffer_line_iterate_to(view->buffer, point.y, point.x);
      char* itr = start;
      while(*itr && !isdigit((int)(*itr))){
           itr++;
@@ -3552,7 +3568,7 @@ static bool change_number(CeView_t* view, CePoint_t* cursor, CePoint_t point, in
      if(!(*itr)) return false;
 
      // loop backward if we are inside a number, checking for the beginning or for the negative sign
-     while(itr > view->buffer->lines[point.y]){
+     while(itr > ce_buffer_line(view->buffer, point.y)){
           itr--;
           if(!isdigit((int)(*itr))){
                if(*itr == '-') break;
@@ -3561,14 +3577,14 @@ static bool change_number(CeView_t* view, CePoint_t* cursor, CePoint_t point, in
           }
      }
 
-     if(itr < view->buffer->lines[point.y]) itr = view->buffer->lines[point.y];
+     if(itr < ce_buffer_line(view->buffer, point.y)) itr = ce_buffer_line(view->buffer, point.y);
 
      char* end = NULL;
      int64_t value = strtol(itr, &end, 10);
      value += delta;
      assert(end);
 
-     int64_t distance_to_number = ce_utf8_strlen_between(view->buffer->lines[point.y], itr) - 1;
+     int64_t distance_to_number = ce_utf8_strlen_between(ce_buffer_line(view->buffer, point.y), itr) - 1;
 
      int64_t number_len = 0;
      if(*end){
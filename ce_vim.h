@@ -118,6 +118,7 @@ typedef enum{
 typedef struct CeVimBufferData_t{
      CePoint_t marks[CE_ASCII_PRINTABLE_CHARACTERS];
      int64_t motion_column;
+     CeMatchIndex_t search_matches; // of the last search, kept up to date while it is highlighted
 }CeVimBufferData_t;
 
 typedef enum{
@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <ctype.h>
+#include <limits.h>
 #include <locale.h>
 #include <signal.h>
 #include <stdlib.h>
@@ -60,6 +61,18 @@ static const char* keyname_str(int key) {
     return "UNKNOWN";
 }
 
+static void format_memory_size(char* string, int64_t string_size, int64_t bytes){
+     if(bytes >= 1024 * 1024 * 1024){
+          snprintf(string, string_size, "%.1fG", (double)(bytes) / (1024.0 * 1024.0 * 1024.0));
+     }else if(bytes >= 1024 * 1024){
+          snprintf(string, string_size, "%.1fM", (double)(bytes) / (1024.0 * 1024.0));
+     }else if(bytes >= 1024){
+          snprintf(string, string_size, "%.1fK", (double)(bytes) / 1024.0);
+     }else{
+          snprintf(string, string_size, "%"PRId64"B", bytes);
+     }
+}
+
 static void build_buffer_list(CeBuffer_t* buffer, CeBufferNode_t* head){
      char buffer_info[BUFSIZ];
      ce_buffer_empty(buffer);
@@ -81,7 +94,8 @@ static void build_buffer_list(CeBuffer_t* buffer, CeBufferNode_t* head){
 
      // build format string, OMG THIS IS SO UNREADABLE HOLY MOLY BATMAN
      char format_string[BUFSIZ];
-     snprintf(format_string, BUFSIZ, "%%5s %%-%"PRId64"s %%%"PRId64 PRId64, max_name_len, max_buffer_lines_digits);
+     snprintf(format_string, BUFSIZ, "%%5s %%-%"PRId64"s %%%"PRId64 PRId64" %%7s text %%7s undo", max_name_len,
+              max_buffer_lines_digits);
 
      // build buffer info
      itr = head;
@@ -89,8 +103,13 @@ static void build_buffer_list(CeBuffer_t* buffer, CeBufferNode_t* head){
           const char* buffer_flag_str = ce_buffer_status_get_str(itr->buffer->status);
           // if the current buffer is the one we are putthing this list together on, set it to readonly for visual sake
           if(itr->buffer == buffer) buffer_flag_str = ce_buffer_status_get_str(CE_BUFFER_STATUS_READONLY);
+          CeBufferMemory_t memory = ce_buffer_memory(itr->buffer);
+          char text_size[16];
+          char history_size[16];
+          format_memory_size(text_size, sizeof(text_size), memory.text_bytes);
+          format_memory_size(history_size, sizeof(history_size), memory.history_bytes);
           snprintf(buffer_info, BUFSIZ, format_string, buffer_flag_str, itr->buffer->name,
-                   itr->buffer->line_count);
+                   itr->buffer->line_count, text_size, history_size);
           buffer_append_on_new_line(buffer, buffer_info);
           itr = itr->next;
      }
@@ -128,7 +147,7 @@ static void build_yank_list(CeBuffer_t* buffer, CeVimYank_t* yanks){
                          int64_t last_line = buffer->line_count;
                          int64_t line_len = 0;
                          if(last_line) last_line--;
-                         if(buffer->lines[last_line]) line_len = ce_utf8_strlen(buffer->lines[last_line]);
+                         if(ce_buffer_line(buffer, last_line)) line_len = ce_buffer_line_len(buffer, last_line);
                          ce_buffer_insert_string(buffer, "\n\n", (CePoint_t){line_len, last_line});
                     }
                }
@@ -254,21 +273,45 @@ static void build_jump_list(CeBuffer_t* buffer, CeJumpList_t* jump_list){
      buffer->status = CE_BUFFER_STATUS_READONLY;
 }
 
-static uint64_t time_between_usec(struct timespec previous, struct timespec current){
-     return (current.tv_sec - previous.tv_sec) * 1000000LL +
-            ((current.tv_nsec - previous.tv_nsec)) / 1000;
-}
+static void build_profile_list(CeBuffer_t* buffer, CeClangD_t* clangd){
+     ce_buffer_empty(buffer);
+     char line[256];
+#if defined(ENABLE_PROFILE)
+     snprintf(line, 256, "// milliseconds over the last %" PRId64 " frames", ce_profile_frame_count());
+     buffer_append_on_new_line(buffer, line);
+     snprintf(line, 256, "%-18s %8s %9s %9s %9s", "stage", "frames", "p50", "p99", "max");
+     buffer_append_on_new_line(buffer, line);
+     for(int64_t i = 0; i < CE_PROFILE_STAGE_COUNT; i++){
+          CeProfileStageStats_t stats = ce_profile_stage_stats(i);
+          snprintf(line, 256, "%-18s %8" PRId64 " %9.3f %9.3f %9.3f", ce_profile_stage_name(i), stats.frame_count,
+                   (double)(stats.p50_usec) / 1000.0, (double)(stats.p99_usec) / 1000.0, (double)(stats.max_usec) / 1000.0);
+          buffer_append_on_new_line(buffer, line);
+     }
+#else
+     buffer_append_on_new_line(buffer, "// profiling isn't built in, build with ENABLE_PROFILE defined (make PROFILE=1)");
+#endif
 
-static int int_strneq(int* a, int* b, size_t len){
-     for(size_t i = 0; i < len; ++i){
-          if(!*a) return false;
-          if(!*b) return false;
-          if(*a != *b) return false;
-          a++;
-          b++;
+     if(clangd){
+          CeClangDStats_t stats = ce_clangd_stats(clangd);
+          buffer_append_on_new_line(buffer, "");
+          buffer_append_on_new_line(buffer, "// clangd");
+          snprintf(line, 256, "%-18s %8" PRIu64 " messages %12" PRIu64 " bytes, %" PRIu64 " dropped, %" PRIu64 " bytes of log skipped",
+                   "read", stats.messages_read, stats.bytes_read, stats.messages_dropped, stats.bytes_skipped);
+          buffer_append_on_new_line(buffer, line);
+          snprintf(line, 256, "%-18s %8" PRIu64 " notifications dropped while the queue was full", "queue",
+                   stats.notifications_dropped);
+          buffer_append_on_new_line(buffer, line);
+          snprintf(line, 256, "%-18s %8" PRIu64 " messages %12" PRIu64 " bytes", "written", stats.messages_written,
+                   stats.bytes_written);
+          buffer_append_on_new_line(buffer, line);
      }
 
-     return true;
+     buffer->status = CE_BUFFER_STATUS_READONLY;
+}
+
+static uint64_t time_between_usec(struct timespec previous, struct timespec current){
+     return (current.tv_sec - previous.tv_sec) * 1000000LL +
+            ((current.tv_nsec - previous.tv_nsec)) / 1000;
 }
 
 #if defined(DISPLAY_GUI)
@@ -316,563 +359,6 @@ static CePoint_t calculate_view_point_from_screen_point(CeView_t* view,
 }
 #endif
 
-void scroll_to_and_center_if_offscreen(CeView_t* view, CePoint_t point, CeConfigOptions_t* config_options){
-     view->cursor = point;
-     CePoint_t before_follow = view->scroll;
-     ce_view_follow_cursor(view, config_options->horizontal_scroll_off,
-                           config_options->vertical_scroll_off, config_options->tab_width);
-     if(!ce_points_equal(before_follow, view->scroll)){
-          ce_view_center(view);
-     }
-}
-
-bool handle_input_history_key(int key, CeHistory_t* history, CeBuffer_t* input_buffer, CePoint_t* cursor){
-     if(key == KEY_UP_ARROW){
-          char* prev = ce_history_previous(history);
-          if(prev){
-               ce_buffer_remove_string(input_buffer, (CePoint_t){0, 0}, ce_utf8_strlen(input_buffer->lines[0]));
-               ce_buffer_insert_string(input_buffer, prev, (CePoint_t){0, 0});
-          }
-          cursor->x = ce_utf8_strlen(input_buffer->lines[0]);
-          return true;
-     }
-
-     if(key == KEY_DOWN_ARROW){
-          char* next = ce_history_next(history);
-          ce_buffer_remove_string(input_buffer, (CePoint_t){0, 0}, ce_utf8_strlen(input_buffer->lines[0]));
-          if(next){
-               ce_buffer_insert_string(input_buffer, next, (CePoint_t){0, 0});
-          }
-          cursor->x = ce_utf8_strlen(input_buffer->lines[0]);
-          return true;
-     }
-
-     return false;
-}
-
-void app_handle_key(CeApp_t* app, CeView_t* view, int key){
-     if(key == KEY_INVALID) return;
-
-     if(key == KEY_RESIZE_EVENT){
-#if defined(DISPLAY_TERMINAL)
-          int terminal_width = 0;
-          int terminal_height = 0;
-          getmaxyx(stdscr, terminal_height, terminal_width);
-          ce_app_update_terminal_view(app, terminal_width, terminal_height);
-#endif
-          return;
-     }
-
-     if(app->last_vim_handle_result == CE_VIM_PARSE_IN_PROGRESS){
-          const CeRune_t* end = NULL;
-          int64_t parsed_multiplier = istrtol(app->vim.current_command, &end);
-          if(end) app->macro_multiplier = parsed_multiplier;
-     }
-
-     if(key == '.' && app->last_macro_register){
-          app->macro_multiplier = app->last_macro_multiplier;
-          app->replay_macro = true;
-          key = app->last_macro_register;
-     }
-
-     if(app->key_count == 0 &&
-        (app->last_vim_handle_result != CE_VIM_PARSE_IN_PROGRESS || app->macro_multiplier > 1) &&
-        app->last_vim_handle_result != CE_VIM_PARSE_CONSUME_ADDITIONAL_KEY &&
-        app->last_vim_handle_result != CE_VIM_PARSE_CONTINUE &&
-        app->vim.mode != CE_VIM_MODE_INSERT &&
-        app->vim.mode != CE_VIM_MODE_REPLACE){
-          if(key == 'q' && !app->replay_macro){ // TODO: make configurable
-               if(app->record_macro && ce_macros_is_recording(&app->macros)){
-                    ce_macros_end_recording(&app->macros);
-                    app->record_macro = false;
-                    return;
-               }else if(!app->record_macro){
-                    app->record_macro = true;
-                    return;
-               }
-          }
-
-          if(key == '@' && !app->record_macro && !app->replay_macro){
-               app->replay_macro = true;
-               app->vim.current_command[0] = 0;
-               return;
-          }
-
-          if(app->record_macro && !ce_macros_is_recording(&app->macros)){
-               ce_macros_begin_recording(&app->macros, key);
-               app->macro_multiplier = 1;
-               return;
-          }
-
-          if(app->replay_macro){
-               app->replay_macro = false;
-               CeRune_t* rune_string = ce_macros_get_register_string(&app->macros, key);
-               if(rune_string){
-                    for(int64_t i = 0; i < app->macro_multiplier; i++){
-                         CeRune_t* itr = rune_string;
-                         while(*itr){
-                              app_handle_key(app, view, *itr);
-
-                              // update the view if it has changed
-                              CeLayout_t* tab_layout = app->tab_list_layout->tab_list.current;
-                              if(tab_layout->tab.current->type == CE_LAYOUT_TYPE_VIEW){
-                                   view = &tab_layout->tab.current->view;
-                              }
-                              itr++;
-                         }
-                    }
-                    app->last_macro_register = key;
-                    app->last_macro_multiplier = app->macro_multiplier;
-                    app->macro_multiplier = 1;
-               }
-
-               free(rune_string);
-               return;
-          }
-     }
-
-     if(ce_macros_is_recording(&app->macros)){
-          ce_macros_record_key(&app->macros, key);
-     }
-
-     // as long as vim isn't in the middle of handling keys, in insert mode vim returns VKH_HANDLED_KEY
-     if(app->last_vim_handle_result != CE_VIM_PARSE_IN_PROGRESS &&
-        app->last_vim_handle_result != CE_VIM_PARSE_CONSUME_ADDITIONAL_KEY &&
-        app->last_vim_handle_result != CE_VIM_PARSE_CONTINUE &&
-        app->vim.mode != CE_VIM_MODE_INSERT &&
-        app->vim.mode != CE_VIM_MODE_REPLACE){
-          // append to keys
-          if(app->key_count < APP_MAX_KEY_COUNT){
-               app->keys[app->key_count] = key;
-               app->key_count++;
-
-               bool no_matches = true;
-               for(int64_t i = 0; i < app->key_binds.count; ++i){
-                    if(int_strneq(app->key_binds.binds[i].keys, app->keys, app->key_count)){
-                         no_matches = false;
-                         // if we have matches, but don't completely match, then wait for more keypresses,
-                         // otherwise, execute the action
-                         if(app->key_binds.binds[i].key_count == app->key_count){
-                              CeCommand_t* command = &app->key_binds.binds[i].command;
-                              CeCommandFunc_t* command_func = NULL;
-                              CeCommandEntry_t* entry = NULL;
-                              for(int64_t c = 0; c < app->command_entry_count; ++c){
-                                   entry = app->command_entries + c;
-                                   if(strcmp(entry->name, command->name) == 0){
-                                        command_func = entry->func;
-                                        break;
-                                   }
-                              }
-
-                              if(command_func){
-                                   CeCommandStatus_t cs = command_func(command, app);
-
-                                   app->key_count = 0;
-                                   app->vim.current_command[0] = 0;
-
-                                   switch(cs){
-                                   default:
-                                        return;
-                                   case CE_COMMAND_NO_ACTION:
-                                        break;
-                                   case CE_COMMAND_FAILURE:
-                                        ce_log("'%s' failed\n", entry->name);
-                                        return;
-                                   case CE_COMMAND_PRINT_HELP:
-                                        ce_app_message(app, "%s: %s\n", entry->name, entry->description);
-                                        return;
-                                   }
-                              }else{
-                                   ce_app_message(app, "unknown command: '%s'", command->name);
-                              }
-
-                              app->key_count = 0;
-                              break;
-                         }else{
-                              return;
-                         }
-                    }
-               }
-
-               if(no_matches){
-                    app->vim.current_command[0] = 0;
-                    for(int64_t i = 0; i < app->key_count - 1; ++i){
-                         ce_vim_append_key(&app->vim, app->keys[i]);
-                    }
-
-                    app->key_count = 0;
-               }
-          }
-     }
-
-     CeComplete_t* app_complete = ce_app_is_completing(app);
-     bool clangd_is_completing = (app->clangd_completion.start.x >= 0 &&
-                                  app->clangd_completion.start.y >= 0);
-
-     if(view){
-          if(key == KEY_CARRIAGE_RETURN) key = CE_NEWLINE;
-          if(key == CE_NEWLINE && !app->input_complete_func && view->buffer == app->buffer_list_buffer){
-               CeBufferNode_t* itr = app->buffer_node_head;
-               int64_t index = 0;
-               while(itr){
-                    if(index == view->cursor.y){
-                         ce_view_switch_buffer(view, itr->buffer, &app->vim, &app->config_options, true);
-                         break;
-                    }
-                    itr = itr->next;
-                    index++;
-               }
-          }else if(key == CE_NEWLINE && !app->input_complete_func && view->buffer == app->yank_list_buffer){
-               // TODO: move to command
-               app->edit_register = -1;
-               int64_t line = view->cursor.y;
-               CeVimYank_t* selected_yank = NULL;
-               for(int64_t i = 0; i < CE_ASCII_PRINTABLE_CHARACTERS; i++){
-                    CeVimYank_t* yank = app->vim.yanks + i;
-                    if(yank->text != NULL){
-                         int64_t line_count = 2;
-                         line_count += ce_util_count_string_lines(yank->text);
-                         line -= line_count;
-                         if(line <= 0){
-                              app->edit_register = i;
-                              selected_yank = yank;
-                              break;
-                         }
-                    }
-               }
-
-               if(app->edit_register >= 0){
-                    ce_app_input(app, "Edit Yank", edit_yank_input_complete_func);
-                    ce_buffer_insert_string(app->input_view.buffer, selected_yank->text, (CePoint_t){0, 0});
-                    app->input_view.cursor.y = app->input_view.buffer->line_count;
-                    if(app->input_view.cursor.y) app->input_view.cursor.y--;
-                    app->input_view.cursor.x = ce_utf8_strlen(app->input_view.buffer->lines[app->input_view.cursor.y]);
-               }
-          }else if(key == CE_NEWLINE && !app->input_complete_func && view->buffer == app->macro_list_buffer){
-               // TODO: move to command
-               app->edit_register = -1;
-               int64_t line = view->cursor.y;
-               char* macro_string = NULL;
-               for(int64_t i = 0; i < CE_ASCII_PRINTABLE_CHARACTERS; i++){
-                    CeRuneNode_t* rune_node = app->macros.rune_head[i];
-                    if(rune_node){
-                         line -= 2;
-                         if(line <= 2){
-                              app->edit_register = i;
-                              CeRune_t* rune_string = ce_rune_node_string(rune_node);
-                              macro_string = ce_rune_string_to_char_string(rune_string);
-                              free(rune_string);
-                              break;
-                         }
-                    }
-               }
-
-               if(app->edit_register >= 0){
-                    ce_app_input(app, "Edit Macro", edit_macro_input_complete_func);
-                    ce_buffer_insert_string(app->input_view.buffer, macro_string, (CePoint_t){0, 0});
-                    app->input_view.cursor.y = app->input_view.buffer->line_count;
-                    if(app->input_view.cursor.y) app->input_view.cursor.y--;
-                    app->input_view.cursor.x = ce_utf8_strlen(app->input_view.buffer->lines[app->input_view.cursor.y]);
-                    free(macro_string);
-               }
-          }else if(key == CE_NEWLINE && app->input_complete_func){
-               if(app->vim.mode == CE_VIM_MODE_INSERT && app_complete){
-                    apply_completion_to_buffer(app_complete, app->input_view.buffer, 0, &app->input_view.cursor);
-               }
-               app->vim.mode = CE_VIM_MODE_NORMAL;
-               CeInputCompleteFunc* input_complete_func = app->input_complete_func;
-               app->input_complete_func = NULL;
-               if(app->input_view.buffer->line_count && strlen(app->input_view.buffer->lines[0])){
-                    input_complete_func(app, app->input_view.buffer);
-               }
-          }else if((app_complete || clangd_is_completing) &&
-                   key == app->config_options.apply_completion_key &&
-                   app->vim.mode == CE_VIM_MODE_INSERT){
-               if(app_complete &&
-                  apply_completion_to_buffer(app_complete, app->input_view.buffer, 0,
-                                             &app->input_view.cursor)){
-                    // TODO: compress with other similar code elsewhere
-                    if(app->input_complete_func == load_file_input_complete_func){
-                         char* base_directory = buffer_base_directory(view->buffer);
-                         complete_files(&app->input_complete, app->input_view.buffer->lines[0], base_directory);
-                         free(base_directory);
-                         build_complete_list(app->complete_list_buffer, &app->input_complete);
-                    }else{
-                         ce_complete_match(&app->input_complete, app->input_view.buffer->lines[0]);
-                         build_complete_list(app->complete_list_buffer, &app->input_complete);
-                    }
-
-                    return;
-               }else if(clangd_is_completing){
-                  apply_completion_to_buffer(app->clangd_completion.complete, view->buffer,
-                                             app->clangd_completion.start.x,
-                                             &view->cursor);
-                   app->clangd_completion.start = (CePoint_t){-1, -1};
-               }
-          }else if(key == app->config_options.cycle_next_completion_key){
-               if(app->vim.mode == CE_VIM_MODE_INSERT){
-                    if(app_complete){
-                         ce_complete_next_match(app_complete);
-                         build_complete_list(app->complete_list_buffer, app_complete);
-                         return;
-                    }
-
-                    if(app->clangd_completion.start.x >= 0 &&
-                       app->clangd_completion.start.y >= 0){
-                         ce_complete_next_match(app->clangd_completion.complete);
-                         build_complete_list(app->clangd_completion.buffer,
-                                             app->clangd_completion.complete);
-                         return;
-                    }
-               }
-          }else if(key == app->config_options.cycle_prev_completion_key){
-               if(app->vim.mode == CE_VIM_MODE_INSERT){
-                    if(app_complete){
-                         ce_complete_previous_match(app_complete);
-                         build_complete_list(app->complete_list_buffer, app_complete);
-                         return;
-                    }
-                    if(app->clangd_completion.start.x >= 0 &&
-                       app->clangd_completion.start.y >= 0){
-                         ce_complete_previous_match(app->clangd_completion.complete);
-                         build_complete_list(app->clangd_completion.buffer,
-                                             app->clangd_completion.complete);
-                         return;
-                    }
-               }
-          }else if(key == KEY_ESCAPE && app->input_complete_func && app->vim.mode == CE_VIM_MODE_NORMAL){ // Escape
-               ce_history_reset_current(&app->command_history);
-               ce_history_reset_current(&app->search_history);
-               app->input_complete_func = NULL;
-
-               if(app_complete) ce_complete_reset(app_complete);
-               return;
-          }else if(key == 'd' && view->buffer == app->buffer_list_buffer){ // Escape
-               CeBufferNode_t* itr = app->buffer_node_head;
-               int64_t buffer_index = 0;
-               while(itr){
-                    if(buffer_index == view->cursor.y) break;
-                    buffer_index++;
-                    itr = itr->next;
-               }
-
-               if(buffer_index == view->cursor.y){
-                    if(itr->buffer == app->buffer_list_buffer ||
-                       itr->buffer == app->yank_list_buffer ||
-                       itr->buffer == app->complete_list_buffer ||
-                       itr->buffer == app->macro_list_buffer ||
-                       itr->buffer == app->mark_list_buffer ||
-                       itr->buffer == app->jump_list_buffer ||
-                       itr->buffer == app->shell_command_buffer ||
-                       itr->buffer == g_ce_log_buffer ||
-                       itr->buffer == app->message_view.buffer ||
-                       itr->buffer == app->clangd_diagnostics_buffer ||
-                       itr->buffer == app->clangd_references_buffer ||
-                       itr->buffer == app->clangd_completion.buffer ||
-                       itr->buffer == app->clangd.buffer ||
-                       itr->buffer == app->input_view.buffer){
-                         ce_app_message(app, "cannot delete buffer '%s'", itr->buffer->name);
-                    }else{
-                         // find all the views showing this buffer and switch to a different view
-                         for(int64_t t = 0; t < app->tab_list_layout->tab_list.tab_count; t++){
-                              CeLayoutBufferInViewsResult_t result = ce_layout_buffer_in_views(app->tab_list_layout->tab_list.tabs[t], itr->buffer);
-                              for(int64_t i = 0; i < result.layout_count; i++){
-                                   result.layouts[i]->view.buffer = app->buffer_list_buffer;
-                              }
-                         }
-
-                         ce_clangd_file_close(&app->clangd, itr->buffer);
-                         ce_buffer_node_delete(&app->buffer_node_head, itr->buffer);
-                    }
-               }
-          }else if(app->input_complete_func){
-
-               // TODO: how are we going to let this be supported through customization
-               if(app->input_complete_func == command_input_complete_func && app->input_view.buffer->line_count){
-                    handle_input_history_key(key, &app->command_history, app->input_view.buffer, &app->input_view.cursor);
-               }else if(app->input_complete_func == search_input_complete_func && app->input_view.buffer->line_count){
-                    handle_input_history_key(key, &app->search_history, app->input_view.buffer, &app->input_view.cursor);
-               }
-
-               CeAppBufferData_t* buffer_data = app->input_view.buffer->app_data;
-               app->last_vim_handle_result = ce_vim_handle_key(&app->vim, &app->input_view, &app->input_view.cursor,
-                                                               &app->visual, key, &buffer_data->vim, &app->config_options);
-
-               if(app->vim.mode == CE_VIM_MODE_INSERT && app->input_view.buffer->line_count){
-                    if(app->input_complete_func == load_file_input_complete_func){
-                         char* base_directory = buffer_base_directory(view->buffer);
-                         complete_files(&app->input_complete, app->input_view.buffer->lines[0], base_directory);
-                         free(base_directory);
-                         build_complete_list(app->complete_list_buffer, &app->input_complete);
-                    }else{
-                         ce_complete_match(&app->input_complete, app->input_view.buffer->lines[0]);
-                         build_complete_list(app->complete_list_buffer, &app->input_complete);
-                    }
-               }
-          // TODO: Make completion key configurable
-          }else if((app->vim.mode == CE_VIM_MODE_NORMAL || app->vim.mode == CE_VIM_MODE_INSERT) &&
-                   key == app->config_options.clangd_trigger_completion_key &&
-                   app->clangd.buffer != NULL){
-               ce_vim_insert_mode(&app->vim);
-               ce_clangd_request_auto_complete(&app->clangd, view->buffer, view->cursor);
-               app->clangd_completion.initiate = view->cursor;
-          }else{
-               // TODO: how are we going to let this be supported through customization
-               CeAppBufferData_t* buffer_data = view->buffer->app_data;
-
-               app->last_vim_handle_result = ce_vim_handle_key(&app->vim, view, &view->cursor, &app->visual,
-                                                               key, &buffer_data->vim, &app->config_options);
-
-               // A "jump" is one of the following commands: "'", "`", "G", "/", "?", "n",
-               // "N", "%", "(", ")", "[[", "]]", "{", "}", ":s", ":tag", "L", "M", "H" and
-               if(app->vim.current_action.verb.function == ce_vim_verb_motion){
-                    if(app->vim.current_action.motion.function == ce_vim_motion_mark ||
-                       app->vim.current_action.motion.function == ce_vim_motion_end_of_file ||
-                       app->vim.current_action.motion.function == ce_vim_motion_search_next ||
-                       app->vim.current_action.motion.function == ce_vim_motion_search_prev ||
-                       app->vim.current_action.motion.function == ce_vim_motion_match_pair){
-                         CeAppViewData_t* view_data = view->user_data;
-                         CeJumpList_t* jump_list = &view_data->jump_list;
-                         CeDestination_t destination = {};
-                         destination.point = view->cursor;
-                         strncpy(destination.filepath, view->buffer->name, MAX_PATH_LEN);
-                         ce_jump_list_insert(jump_list, destination);
-                    }
-
-                    if(app->vim.current_action.motion.function == ce_vim_motion_search_word_forward ||
-                       app->vim.current_action.motion.function == ce_vim_motion_search_word_backward ||
-                       app->vim.current_action.motion.function == ce_vim_motion_search_next ||
-                       app->vim.current_action.motion.function == ce_vim_motion_search_prev){
-                         app->highlight_search = true;
-                    }
-               }
-
-               if(app->last_vim_handle_result == CE_VIM_PARSE_COMPLETE &&
-                  app->vim.current_action.repeatable){
-                    app->last_macro_register = 0;
-               }
-
-               if(app->clangd_completion.start.x >= 0 &&
-                  app->clangd_completion.start.y >= 0){
-                    if(app->vim.mode == CE_VIM_MODE_INSERT){
-                         if((!ce_point_after(view->cursor, app->clangd_completion.start) &&
-                            !ce_points_equal(view->cursor, app->clangd_completion.start)) ||
-                            view->cursor.y != app->clangd_completion.start.y){
-                              app->clangd_completion.start = (CePoint_t){-1, -1};
-                         }else{
-                              int64_t match_len = view->cursor.x - app->clangd_completion.start.x;
-                              char* match = ce_buffer_dupe_string(view->buffer, app->clangd_completion.start, match_len);
-                              ce_complete_match(app->clangd_completion.complete, match);
-                              free(match);
-                              build_complete_list(app->clangd_completion.buffer,
-                                                  app->clangd_completion.complete);
-                              build_clangd_completion_view(&app->clangd_completion.view,
-                                                           app->clangd_completion.start,
-                                                           view,
-                                                           app->clangd_completion.buffer,
-                                                           &app->config_options,
-                                                           &app->terminal_rect);
-                         }
-
-                    }else{
-                         app->clangd_completion.start = (CePoint_t){-1, -1};
-                    }
-               }
-          }
-     }else{
-          if(key == KEY_ESCAPE){
-               CeLayout_t* tab_layout = app->tab_list_layout->tab_list.current;
-               CeLayout_t* current_layout = tab_layout->tab.current;
-               CeRect_t layout_rect = {};
-
-               switch(current_layout->type){
-               default:
-                    assert(!"unexpected current layout type");
-                    return;
-               case CE_LAYOUT_TYPE_LIST:
-                    layout_rect = current_layout->list.rect;
-                    break;
-               case CE_LAYOUT_TYPE_TAB:
-                    layout_rect = current_layout->tab.rect;
-                    break;
-               case CE_LAYOUT_TYPE_TAB_LIST:
-                    layout_rect = current_layout->tab_list.rect;
-                    break;
-               }
-
-               tab_layout->tab.current = ce_layout_find_at(tab_layout, (CePoint_t){layout_rect.left, layout_rect.top});
-               return;
-          }
-     }
-
-     // incremental search
-     if(view && app->input_complete_func == search_input_complete_func){
-          if(strcmp(app->input_view.buffer->name, "Search") == 0){
-               if(app->input_view.buffer->line_count && view->buffer->line_count && strlen(app->input_view.buffer->lines[0])){
-                    CePoint_t match_point = ce_buffer_search_forward(view->buffer, view->cursor, app->input_view.buffer->lines[0]);
-                    if(match_point.x >= 0){
-                         scroll_to_and_center_if_offscreen(view, match_point, &app->config_options);
-                    }else{
-                         view->cursor = app->search_start;
-                    }
-               }else{
-                    view->cursor = app->search_start;
-               }
-          }else if(strcmp(app->input_view.buffer->name, "Reverse Search") == 0){
-               if(app->input_view.buffer->line_count && view->buffer->line_count && strlen(app->input_view.buffer->lines[0])){
-                    CePoint_t match_point = ce_buffer_search_backward(view->buffer, view->cursor, app->input_view.buffer->lines[0]);
-                    if(match_point.x >= 0){
-                         scroll_to_and_center_if_offscreen(view, match_point, &app->config_options);
-                    }else{
-                         view->cursor = app->search_start;
-                    }
-               }else{
-                    view->cursor = app->search_start;
-               }
-          }else if(strcmp(app->input_view.buffer->name, "Regex Search") == 0){
-               if(app->input_view.buffer->line_count && view->buffer->line_count && strlen(app->input_view.buffer->lines[0])){
-                    CeRegex_t regex = NULL;
-                    CeRegexResult_t regex_result = ce_regex_init(app->input_view.buffer->lines[0],
-                                                                 &regex);
-                    if(regex_result.error_message != NULL){
-                         ce_log("ce_regex_init() failed: '%s'", regex_result.error_message);
-                         free(regex_result.error_message);
-                    }else{
-                         CeRegexSearchResult_t result = ce_buffer_regex_search_forward(view->buffer, view->cursor, regex);
-                         if(result.point.x >= 0){
-                              scroll_to_and_center_if_offscreen(view, result.point, &app->config_options);
-                         }else{
-                              view->cursor = app->search_start;
-                         }
-                         ce_regex_free(regex);
-                    }
-               }else{
-                    view->cursor = app->search_start;
-               }
-          }else if(strcmp(app->input_view.buffer->name, "Regex Reverse Search") == 0){
-               if(app->input_view.buffer->line_count && view->buffer->line_count && strlen(app->input_view.buffer->lines[0])){
-                    CeRegex_t regex = NULL;
-                    CeRegexResult_t regex_result = ce_regex_init(app->input_view.buffer->lines[0],
-                                                                 &regex);
-                    if(regex_result.error_message != NULL){
-                         ce_log("ce_regex_init() failed: '%s'", regex_result.error_message);
-                         free(regex_result.error_message);
-                    }else{
-                         CeRegexSearchResult_t result = ce_buffer_regex_search_backward(view->buffer, view->cursor, regex);
-                         if(result.point.x >= 0){
-                              scroll_to_and_center_if_offscreen(view, result.point, &app->config_options);
-                         }else{
-                              view->cursor = app->search_start;
-                         }
-                         ce_regex_free(regex);
-                    }
-               }else{
-                    view->cursor = app->search_start;
-               }
-          }
-     }
-}
-
 void print_help(char* program){
      printf("usage  : %s [options] [file]\n", program);
      printf("options:\n");
@@ -954,310 +440,14 @@ int main(int argc, char* argv[]){
           if(!user_config_init(&app.user_config, config_filepath)) return 1;
           app.user_config.init_func(&app);
      }else{
-          // default config
-
-          // config options
-          CeConfigOptions_t* config_options = &app.config_options;
-          config_options->tab_width = 5;
-          config_options->horizontal_scroll_off = 10;
-          config_options->vertical_scroll_off = 0;
-          config_options->insert_spaces_on_tab = true;
-          config_options->line_number = CE_LINE_NUMBER_NONE;
-          config_options->completion_line_limit = 15;
-          config_options->message_display_time_usec = 5000000; // 5 seconds
-          config_options->apply_completion_key = CE_TAB;
-          config_options->popup_view_height = 12;
-          config_options->cycle_next_completion_key = ce_ctrl_key('n');
-          config_options->cycle_prev_completion_key = ce_ctrl_key('p');
-          config_options->show_line_extends_passed_view_as = '>';
-
-          config_options->color_defs[CE_COLOR_BLACK].red = 32;
-          config_options->color_defs[CE_COLOR_BLACK].green = 32;
-          config_options->color_defs[CE_COLOR_BLACK].blue = 32;
-
-          config_options->color_defs[CE_COLOR_RED].red = 137;
-          config_options->color_defs[CE_COLOR_RED].green = 56;
-          config_options->color_defs[CE_COLOR_RED].blue = 56;
-
-          config_options->color_defs[CE_COLOR_GREEN].red = 69;
-          config_options->color_defs[CE_COLOR_GREEN].green = 123;
-          config_options->color_defs[CE_COLOR_GREEN].blue = 77;
-
-          config_options->color_defs[CE_COLOR_YELLOW].red = 150;
-          config_options->color_defs[CE_COLOR_YELLOW].green = 111;
-          config_options->color_defs[CE_COLOR_YELLOW].blue = 78;
-
-          config_options->color_defs[CE_COLOR_BLUE].red = 70;
-          config_options->color_defs[CE_COLOR_BLUE].green = 107;
-          config_options->color_defs[CE_COLOR_BLUE].blue = 138;
-
-          config_options->color_defs[CE_COLOR_MAGENTA].red = 116;
-          config_options->color_defs[CE_COLOR_MAGENTA].green = 90;
-          config_options->color_defs[CE_COLOR_MAGENTA].blue = 160;
-
-          config_options->color_defs[CE_COLOR_CYAN].red = 55;
-          config_options->color_defs[CE_COLOR_CYAN].green = 125;
-          config_options->color_defs[CE_COLOR_CYAN].blue = 108;
-
-          config_options->color_defs[CE_COLOR_WHITE].red = 42;
-          config_options->color_defs[CE_COLOR_WHITE].green = 42;
-          config_options->color_defs[CE_COLOR_WHITE].blue = 42;
-
-          config_options->color_defs[CE_COLOR_BRIGHT_BLACK].red = 36;
-          config_options->color_defs[CE_COLOR_BRIGHT_BLACK].green = 36;
-          config_options->color_defs[CE_COLOR_BRIGHT_BLACK].blue = 36;
-
-          config_options->color_defs[CE_COLOR_BRIGHT_RED].red = 157;
-          config_options->color_defs[CE_COLOR_BRIGHT_RED].green = 110;
-          config_options->color_defs[CE_COLOR_BRIGHT_RED].blue = 127;
-
-          config_options->color_defs[CE_COLOR_BRIGHT_GREEN].red = 110;
-          config_options->color_defs[CE_COLOR_BRIGHT_GREEN].green = 137;
-          config_options->color_defs[CE_COLOR_BRIGHT_GREEN].blue = 106;
-
-          config_options->color_defs[CE_COLOR_BRIGHT_YELLOW].red = 156;
-          config_options->color_defs[CE_COLOR_BRIGHT_YELLOW].green = 148;
-          config_options->color_defs[CE_COLOR_BRIGHT_YELLOW].blue = 95;
-
-          config_options->color_defs[CE_COLOR_BRIGHT_BLUE].red = 114;
-          config_options->color_defs[CE_COLOR_BRIGHT_BLUE].green = 151;
-          config_options->color_defs[CE_COLOR_BRIGHT_BLUE].blue = 179;
-
-          config_options->color_defs[CE_COLOR_BRIGHT_MAGENTA].red = 147;
-          config_options->color_defs[CE_COLOR_BRIGHT_MAGENTA].green = 108;
-          config_options->color_defs[CE_COLOR_BRIGHT_MAGENTA].blue = 151;
-
-          config_options->color_defs[CE_COLOR_BRIGHT_CYAN].red = 124;
-          config_options->color_defs[CE_COLOR_BRIGHT_CYAN].green = 166;
-          config_options->color_defs[CE_COLOR_BRIGHT_CYAN].blue = 145;
-
-          config_options->color_defs[CE_COLOR_BRIGHT_WHITE].red = 255;
-          config_options->color_defs[CE_COLOR_BRIGHT_WHITE].green = 255;
-          config_options->color_defs[CE_COLOR_BRIGHT_WHITE].blue = 255;
-
-          config_options->color_defs[CE_COLOR_FOREGROUND].red = 218;
-          config_options->color_defs[CE_COLOR_FOREGROUND].green = 218;
-          config_options->color_defs[CE_COLOR_FOREGROUND].blue = 218;
-
-          config_options->color_defs[CE_COLOR_BACKGROUND].red = 25;
-          config_options->color_defs[CE_COLOR_BACKGROUND].green = 25;
-          config_options->color_defs[CE_COLOR_BACKGROUND].blue = 25;
-
-          // GUI options
-          config_options->gui_window_width = 1024;
-          config_options->gui_window_height = 768;
-          config_options->gui_font_size = 16;
-          config_options->gui_font_line_separation = 1;
-          strncpy(config_options->gui_font_path, "Inconsolata-SemiBold.ttf", MAX_PATH_LEN);
-          config_options->mouse_wheel_line_scroll = 5;
-
-          // keybinds
-          CeKeyBindDef_t normal_mode_bind_defs[] = {
-               {{'\\', 'q'},             "quit"},
-               {{ce_ctrl_key('w'), 'h'}, "select_adjacent_layout left"},
-               {{ce_ctrl_key('w'), 'l'}, "select_adjacent_layout right"},
-               {{ce_ctrl_key('w'), 'k'}, "select_adjacent_layout up"},
-               {{ce_ctrl_key('w'), 'j'}, "select_adjacent_layout down"},
-               {{ce_ctrl_key('s')},      "save_buffer"},
-               {{'\\', 'b'},             "show_buffers"},
-               {{ce_ctrl_key('f')},      "load_file"},
-               {{'/'},                   "search forward"},
-               {{'?'},                   "search backward"},
-               {{':'},                   "command"},
-               {{'g', 't'},              "select_adjacent_tab right"},
-               {{'g', 'T'},              "select_adjacent_tab left"},
-               {{'\\', '/'},             "regex_search forward"},
-               {{'\\', '?'},             "regex_search backward"},
-               {{'g', 'r'},              "redraw"},
-               {{'\\', 'f'},             "reload_file"},
-               {{ce_ctrl_key('b')},      "switch_buffer"},
-               {{ce_ctrl_key('o')},      "jump_list previous"},
-               {{ce_ctrl_key('i')},      "jump_list next"},
-               {{'K'},                   "man_page_on_word_under_cursor"},
-               {{'Z', 'Z'},              "wq"},
-          };
-
-          ce_convert_bind_defs(&app.key_binds, normal_mode_bind_defs, sizeof(normal_mode_bind_defs) / sizeof(normal_mode_bind_defs[0]));
-
-          // syntax
-          {
-               CeSyntaxDef_t* syntax_defs = malloc(CE_SYNTAX_COLOR_COUNT * sizeof(*syntax_defs));
-               syntax_defs[CE_SYNTAX_COLOR_NORMAL].fg = CE_COLOR_DEFAULT;
-               syntax_defs[CE_SYNTAX_COLOR_NORMAL].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_TYPE].fg = CE_COLOR_BRIGHT_BLUE;
-               syntax_defs[CE_SYNTAX_COLOR_TYPE].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_KEYWORD].fg = CE_COLOR_BLUE;
-               syntax_defs[CE_SYNTAX_COLOR_KEYWORD].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_CONTROL].fg = CE_COLOR_YELLOW;
-               syntax_defs[CE_SYNTAX_COLOR_CONTROL].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_CAPS_VAR].fg = CE_COLOR_MAGENTA;
-               syntax_defs[CE_SYNTAX_COLOR_CAPS_VAR].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_COMMENT].fg = CE_COLOR_GREEN;
-               syntax_defs[CE_SYNTAX_COLOR_COMMENT].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_STRING].fg = CE_COLOR_RED;
-               syntax_defs[CE_SYNTAX_COLOR_STRING].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_CHAR_LITERAL].fg = CE_COLOR_RED;
-               syntax_defs[CE_SYNTAX_COLOR_CHAR_LITERAL].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_NUMBER_LITERAL].fg = CE_COLOR_MAGENTA;
-               syntax_defs[CE_SYNTAX_COLOR_NUMBER_LITERAL].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_PREPROCESSOR].fg = CE_COLOR_BRIGHT_MAGENTA;
-               syntax_defs[CE_SYNTAX_COLOR_PREPROCESSOR].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_TRAILING_WHITESPACE].fg = CE_COLOR_RED;
-               syntax_defs[CE_SYNTAX_COLOR_TRAILING_WHITESPACE].bg = CE_COLOR_RED;
-               syntax_defs[CE_SYNTAX_COLOR_VISUAL].fg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_VISUAL].bg = CE_COLOR_WHITE;
-               syntax_defs[CE_SYNTAX_COLOR_CURRENT_LINE].fg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_CURRENT_LINE].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_DIFF_ADD].fg = CE_COLOR_GREEN;
-               syntax_defs[CE_SYNTAX_COLOR_DIFF_ADD].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_DIFF_REMOVE].fg = CE_COLOR_RED;
-               syntax_defs[CE_SYNTAX_COLOR_DIFF_REMOVE].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_DIFF_HEADER].fg = CE_COLOR_MAGENTA;
-               syntax_defs[CE_SYNTAX_COLOR_DIFF_HEADER].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_DIFF_COMMENT].fg = CE_COLOR_BLUE;
-               syntax_defs[CE_SYNTAX_COLOR_DIFF_COMMENT].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_COMPLETE_SELECTED].fg = CE_COLOR_BLACK;
-               syntax_defs[CE_SYNTAX_COLOR_COMPLETE_SELECTED].bg = CE_COLOR_YELLOW;
-               syntax_defs[CE_SYNTAX_COLOR_COMPLETE_MATCH].fg = CE_COLOR_BRIGHT_BLUE;
-               syntax_defs[CE_SYNTAX_COLOR_COMPLETE_MATCH].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-               syntax_defs[CE_SYNTAX_COLOR_LINE_NUMBER].fg = CE_COLOR_DEFAULT;
-               syntax_defs[CE_SYNTAX_COLOR_LINE_NUMBER].bg = CE_COLOR_DEFAULT;
-               syntax_defs[CE_SYNTAX_COLOR_MULTIPLE_CURSOR_INACTIVE].fg = CE_COLOR_DEFAULT;
-               syntax_defs[CE_SYNTAX_COLOR_MULTIPLE_CURSOR_INACTIVE].bg = CE_COLOR_RED;
-               syntax_defs[CE_SYNTAX_COLOR_MULTIPLE_CURSOR_ACTIVE].fg = CE_COLOR_DEFAULT;
-               syntax_defs[CE_SYNTAX_COLOR_MULTIPLE_CURSOR_ACTIVE].bg = CE_COLOR_GREEN;
-               syntax_defs[CE_SYNTAX_COLOR_LINE_EXTENDS_PASSED_VIEW].fg = CE_COLOR_YELLOW;
-               syntax_defs[CE_SYNTAX_COLOR_LINE_EXTENDS_PASSED_VIEW].bg = CE_SYNTAX_USE_CURRENT_COLOR;
-
-               app.config_options.ui_fg_color = CE_COLOR_BRIGHT_WHITE;
-               app.config_options.ui_bg_color = CE_COLOR_WHITE;
-               app.config_options.message_fg_color = CE_COLOR_BLUE;
-               app.config_options.message_bg_color = CE_COLOR_WHITE;
-
-               app.syntax_defs = syntax_defs;
-          }
+          ce_app_init_default_config(&app);
      }
 
      memset(&app.clangd, 0, sizeof(app.clangd));
      app.clangd_completion.start = (CePoint_t){-1, -1};
      app.clangd_completion.initiate = (CePoint_t){-1, -1};
 
-     // init buffers
-     {
-          app.buffer_list_buffer = new_buffer();
-          app.bind_list_buffer = new_buffer();
-          app.yank_list_buffer = new_buffer();
-          app.complete_list_buffer = new_buffer();
-          app.macro_list_buffer = new_buffer();
-          app.mark_list_buffer = new_buffer();
-          app.jump_list_buffer = new_buffer();
-          app.shell_command_buffer = new_buffer();
-          CeBuffer_t* scratch_buffer = new_buffer();
-
-          ce_buffer_alloc(app.buffer_list_buffer, 1, "[buffers]");
-          ce_buffer_node_insert(&app.buffer_node_head, app.buffer_list_buffer);
-          ce_buffer_alloc(app.bind_list_buffer, 1, "[binds]");
-          ce_buffer_node_insert(&app.buffer_node_head, app.bind_list_buffer);
-          ce_buffer_alloc(app.yank_list_buffer, 1, "[yanks]");
-          ce_buffer_node_insert(&app.buffer_node_head, app.yank_list_buffer);
-          ce_buffer_alloc(app.complete_list_buffer, 1, "[completions]");
-          ce_buffer_node_insert(&app.buffer_node_head, app.complete_list_buffer);
-          ce_buffer_alloc(app.macro_list_buffer, 1, "[macros]");
-          ce_buffer_node_insert(&app.buffer_node_head, app.macro_list_buffer);
-          ce_buffer_alloc(app.mark_list_buffer, 1, "[marks]");
-          ce_buffer_node_insert(&app.buffer_node_head, app.mark_list_buffer);
-          ce_buffer_alloc(app.jump_list_buffer, 1, "[jumps]");
-          ce_buffer_node_insert(&app.buffer_node_head, app.jump_list_buffer);
-          ce_buffer_alloc(app.shell_command_buffer, 1, "[shell command]");
-          ce_buffer_node_insert(&app.buffer_node_head, app.shell_command_buffer);
-          ce_buffer_alloc(scratch_buffer, 1, "scratch");
-          ce_buffer_node_insert(&app.buffer_node_head, scratch_buffer);
-
-          app.buffer_list_buffer->status = CE_BUFFER_STATUS_NONE;
-          app.bind_list_buffer->status = CE_BUFFER_STATUS_NONE;
-          app.yank_list_buffer->status = CE_BUFFER_STATUS_NONE;
-          app.complete_list_buffer->status = CE_BUFFER_STATUS_NONE;
-          app.macro_list_buffer->status = CE_BUFFER_STATUS_NONE;
-          app.mark_list_buffer->status = CE_BUFFER_STATUS_NONE;
-          app.jump_list_buffer->status = CE_BUFFER_STATUS_NONE;
-          app.shell_command_buffer->status = CE_BUFFER_STATUS_NONE;
-          scratch_buffer->status = CE_BUFFER_STATUS_NONE;
-
-          app.buffer_list_buffer->no_line_numbers = true;
-          app.bind_list_buffer->no_line_numbers = true;
-          app.yank_list_buffer->no_line_numbers = true;
-          app.complete_list_buffer->no_line_numbers = true;
-          app.macro_list_buffer->no_line_numbers = true;
-          app.mark_list_buffer->no_line_numbers = true;
-          app.jump_list_buffer->no_line_numbers = true;
-          app.shell_command_buffer->no_line_numbers = true;
-
-          app.complete_list_buffer->no_highlight_current_line = true;
-
-          CeAppBufferData_t* buffer_data = app.complete_list_buffer->app_data;
-          buffer_data->syntax_function = ce_syntax_highlight_completions;
-
-          buffer_data = app.buffer_list_buffer->app_data;
-          buffer_data->syntax_function = ce_syntax_highlight_c;
-          buffer_data = app.bind_list_buffer->app_data;
-          buffer_data->syntax_function = ce_syntax_highlight_c;
-          buffer_data = app.yank_list_buffer->app_data;
-          buffer_data->syntax_function = ce_syntax_highlight_c;
-          buffer_data = app.macro_list_buffer->app_data;
-          buffer_data->syntax_function = ce_syntax_highlight_c;
-          buffer_data = app.mark_list_buffer->app_data;
-          buffer_data->syntax_function = ce_syntax_highlight_c;
-          buffer_data = app.jump_list_buffer->app_data;
-          buffer_data->syntax_function = ce_syntax_highlight_c;
-          buffer_data = app.shell_command_buffer->app_data;
-          buffer_data->syntax_function = ce_syntax_highlight_plain;
-          buffer_data = scratch_buffer->app_data;
-          buffer_data->syntax_function = ce_syntax_highlight_c;
-
-          if(ls_clangd){
-               app.clangd.buffer = new_buffer();
-               app.clangd_diagnostics_buffer = new_buffer();
-               app.clangd_references_buffer = new_buffer();
-               app.clangd_completion.buffer = new_buffer();
-
-               ce_buffer_alloc(app.clangd.buffer, 1, "[clangd]");
-               ce_buffer_node_insert(&app.buffer_node_head, app.clangd.buffer);
-               ce_buffer_alloc(app.clangd_completion.buffer, 1, "[clangd completions]");
-               ce_buffer_node_insert(&app.buffer_node_head, app.clangd_completion.buffer);
-               ce_buffer_alloc(app.clangd_diagnostics_buffer, 1, "[clangd diagnostics]");
-               ce_buffer_node_insert(&app.buffer_node_head, app.clangd_diagnostics_buffer);
-               ce_buffer_alloc(app.clangd_references_buffer, 1, "[clangd references]");
-               ce_buffer_node_insert(&app.buffer_node_head, app.clangd_references_buffer);
-
-               app.clangd.buffer->status = CE_BUFFER_STATUS_NONE;
-               app.clangd_completion.buffer->status = CE_BUFFER_STATUS_NONE;
-               app.clangd_diagnostics_buffer->status = CE_BUFFER_STATUS_NONE;
-               app.clangd_references_buffer->status = CE_BUFFER_STATUS_NONE;
-               app.clangd.buffer->no_line_numbers = true;
-               app.clangd_completion.buffer->no_line_numbers = true;
-               app.clangd_diagnostics_buffer->no_line_numbers = true;
-               app.clangd_references_buffer->no_line_numbers = true;
-
-               buffer_data = app.clangd.buffer->app_data;
-               buffer_data->syntax_function = ce_syntax_highlight_plain;
-               buffer_data = app.clangd_completion.buffer->app_data;
-               buffer_data->syntax_function = ce_syntax_highlight_completions;
-               buffer_data = app.clangd_diagnostics_buffer->app_data;
-               buffer_data->syntax_function = ce_syntax_highlight_c;
-               buffer_data = app.clangd_references_buffer->app_data;
-               buffer_data->syntax_function = ce_syntax_highlight_plain;
-
-               app.clangd_completion.view.buffer = app.clangd_completion.buffer;
-          }
-
-          app.discovered_filepath_count = 0;
-          app.shell_command_buffer_should_scroll = false;
-          app.shell_command_thread_should_die = false;
-#if defined(PLATFORM_WINDOWS)
-          app.shell_command_thread = INVALID_HANDLE_VALUE;
-          app.shell_command_thread_id = -1;
-#endif
-     }
+     ce_app_init_buffers(&app, ls_clangd);
 
  #if defined(DISPLAY_TERMINAL)
      // init ncurses
@@ -1313,7 +503,16 @@ int main(int argc, char* argv[]){
               return 1;
           }
 
-          gui.window_surface = SDL_GetWindowSurface(gui.window);
+          // SDL's software renderer just turns our quads back into blits, so without acceleration blit them ourselves
+          gui.renderer = SDL_CreateRenderer(gui.window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+          if(gui.renderer == NULL){
+              ce_log("SDL_CreateRenderer() failed: %s, drawing to the window surface\n", SDL_GetError());
+              gui.window_surface = SDL_GetWindowSurface(gui.window);
+              if(gui.window_surface == NULL){
+                  ce_log("SDL_GetWindowSurface() failed: %s\n", SDL_GetError());
+                  return 1;
+              }
+          }
 
           rc = TTF_Init();
           if (rc < 0) {
@@ -1328,7 +527,6 @@ int main(int argc, char* argv[]){
               return 1;
           }
 
-          TTF_SetFontHinting(gui.font, TTF_HINTING_MONO);
           app.gui = &gui;
      }
 #endif
@@ -1380,11 +578,14 @@ int main(int argc, char* argv[]){
                ce_free_list_dir_result(&list_dir_result);
 #else
                CeBuffer_t* buffer = new_buffer();
-               if(ce_buffer_load_file(buffer, argv[i])){
+               if(ce_app_load_file(&app, buffer, argv[i])){
                     ce_buffer_node_insert(&app.buffer_node_head, buffer);
                     determine_buffer_syntax(buffer);
                     initial_buffer = app.buffer_node_head->buffer;
-                    if(!ce_clangd_file_open(&app.clangd, buffer)){
+
+                    // buffers still loading are opened in clangd once they are done
+                    CeAppBufferData_t* buffer_data = buffer->app_data;
+                    if(!buffer_data->loading && !ce_clangd_file_open(&app.clangd, buffer)){
                          return 1;
                     }
                }else{
@@ -1434,21 +635,50 @@ int main(int argc, char* argv[]){
 
 #if defined(DISPLAY_TERMINAL)
      pipe(g_shell_command_ready_fds);
+     ce_syntax_background_start(g_shell_command_ready_fds[1]);
 
      // Draw the terminal before the loop in case we don't get any input immediately.
      ce_draw_term(&app);
 #elif defined(DISPLAY_GUI)
+     ce_syntax_background_start(-1);
      MouseState_t mouse_state = {};
 #endif
 
      struct timespec current_draw_time = {};
      uint64_t time_since_last_message_usec = 0;
+     bool search_scan_pending = false;
 
      // main loop
      while(!app.quit){
+          // sleep until something happens, unless the search index still has lines to scan. If a message is up, wake up
+          // when it expires
+          int wait_ms = -1;
+          if(search_scan_pending){
+               wait_ms = 0;
+          }else if(app.message_mode){
+#if defined(PLATFORM_WINDOWS)
+               timespec_get(&current_draw_time, TIME_UTC);
+#else
+               clock_gettime(CLOCK_MONOTONIC, &current_draw_time);
+#endif
+               time_since_last_message_usec = time_between_usec(app.message_time, current_draw_time);
+               wait_ms = 0;
+               if(time_since_last_message_usec <= app.config_options.message_display_time_usec){
+                    uint64_t message_left_ms = (app.config_options.message_display_time_usec - time_since_last_message_usec) / 1000 + 1;
+                    wait_ms = (message_left_ms > INT_MAX) ? INT_MAX : (int)(message_left_ms);
+               }
+          }
+
+          // wake up when edits are due to be sent to clangd
+          int64_t clangd_flush_usec = ce_clangd_next_flush_usec(&app.clangd);
+          if(clangd_flush_usec >= 0){
+               int clangd_flush_ms = (int)((clangd_flush_usec + 999) / 1000);
+               if(wait_ms < 0 || clangd_flush_ms < wait_ms) wait_ms = clangd_flush_ms;
+          }
+
  #if defined(DISPLAY_TERMINAL)
           // TODO: add shell command buffer
-          int input_fd_count = 2; // stdin and terminal_ready_fd
+          int input_fd_count = 3; // stdin, terminal_ready_fd and clangd's responses
           struct pollfd input_fds[input_fd_count];
 
           // populate fd array
@@ -1459,24 +689,25 @@ int main(int argc, char* argv[]){
                input_fds[0].events = POLLIN;
                input_fds[1].fd = g_shell_command_ready_fds[0];
                input_fds[1].events = POLLIN;
+               input_fds[2].fd = ce_clangd_wake_fd(&app.clangd); // poll() skips it when it's -1
+               input_fds[2].events = POLLIN;
           }
 
-          int poll_rc = poll(input_fds, input_fd_count, 10);
-          switch(poll_rc){
-          default:
-               break;
-          case -1:
+          int poll_rc = poll(input_fds, input_fd_count, wait_ms);
+
+          // curses' resize signal interrupts poll, and it has a KEY_RESIZE waiting for us that isn't on stdin
+          bool interrupted = (poll_rc == -1);
+          if(interrupted){
                assert(errno == EINTR);
-          case 0:
-               continue;
+               errno = 0;
           }
 
-          bool check_stdin = false;
+          ce_app_loop_stats_wakeup(&app.loop_stats);
 
-          if(poll_rc < 0 || input_fds[0].revents != 0){
-               check_stdin = true;
-          }
+          bool check_stdin = (interrupted || input_fds[0].revents != 0);
 
+          // the background threads write to this pipe when they have something for us
+          bool background_ready = false;
           if(input_fds[1].revents != 0){
                char buffer[BUFSIZ];
                int rc;
@@ -1488,9 +719,25 @@ int main(int argc, char* argv[]){
                     errno = 0;
                     continue;
                }
+               background_ready = true;
           }
+
+          // clangd has no way to wake us when there isn't a wake fd, so look every time then
+          bool clangd_ready = (input_fds[2].fd < 0 || input_fds[2].revents != 0);
+#elif defined(DISPLAY_GUI)
+          // the background threads can't wake up SDL, so check on them at least once a frame
+          if(wait_ms < 0 || wait_ms > DRAW_USEC_LIMIT / 1000) wait_ms = DRAW_USEC_LIMIT / 1000;
+          SDL_WaitEventTimeout(NULL, wait_ms);
+          ce_app_loop_stats_wakeup(&app.loop_stats);
+          bool background_ready = true;
+          bool clangd_ready = true;
 #endif
 
+          // only redraw when this wakeup changed something we show
+          bool dirty = search_scan_pending || background_ready;
+          if(ce_app_update_file_load(&app)) dirty = true;
+          if(ce_syntax_background_update()) dirty = true;
+
           if(app.message_mode){
 #if defined(PLATFORM_WINDOWS)
                timespec_get(&current_draw_time, TIME_UTC);
@@ -1500,6 +747,7 @@ int main(int argc, char* argv[]){
                time_since_last_message_usec = time_between_usec(app.message_time, current_draw_time);
                if(time_since_last_message_usec > app.config_options.message_display_time_usec){
                     app.message_mode = false;
+                    dirty = true;
                }
           }
 
@@ -1515,9 +763,16 @@ int main(int argc, char* argv[]){
                break;
           }
 
+          bool handled_input = false;
+
 #if defined(DISPLAY_TERMINAL)
           int key = KEY_INVALID;
-          if(check_stdin) { key = getch(); }
+          if(check_stdin){
+               // don't block if the signal wasn't a resize after all
+               if(interrupted) nodelay(stdscr, TRUE);
+               key = getch();
+               if(interrupted) nodelay(stdscr, FALSE);
+          }
 
 #elif defined(DISPLAY_GUI)
           bool check_stdin = false;
@@ -1528,6 +783,7 @@ int main(int argc, char* argv[]){
           SDL_Event event;
           memset(&event, 0, sizeof(event));
           while(SDL_PollEvent(&event)){
+               handled_input = true;
                switch(event.type){
                case SDL_QUIT:
                     app.quit = true;
@@ -1640,7 +896,7 @@ int main(int argc, char* argv[]){
           if(window_resized){
               SDL_GetWindowSize(gui.window, &gui.window_width, &gui.window_height);
               ce_log("window resized to: %d, %d\n", gui.window_width, gui.window_height);
-              gui.window_surface = SDL_GetWindowSurface(gui.window);
+              if(gui.renderer == NULL) gui.window_surface = SDL_GetWindowSurface(gui.window);
               int calculated_terminal_width = gui.window_width / (gui.font_point_size / 2);
               int calculated_terminal_height = gui.window_height / (gui.font_point_size + gui.font_line_separation);
               ce_app_update_terminal_view(&app, calculated_terminal_width, calculated_terminal_height);
@@ -1658,20 +914,21 @@ int main(int argc, char* argv[]){
 
           if (key != KEY_INVALID) {
               app.message_mode = false;
-
-              CeBuffer_t* latest_buffer_before_input = view->buffer;
-              CeBufferChangeNode_t* lastest_change_before_input = view->buffer->change_node;
+              handled_input = true;
 
               // handle input from the user
+              CE_PROFILE_BEGIN(handle_key_timer, CE_PROFILE_STAGE_HANDLE_KEY);
               app_handle_key(&app, view, key);
-
-              if(latest_buffer_before_input == view->buffer &&
-                 view->buffer->change_node != lastest_change_before_input){
-                   ce_clangd_file_report_changes(&app.clangd, view->buffer, lastest_change_before_input);
-              }
+              CE_PROFILE_END(handle_key_timer);
           }
 
-          ce_app_handle_clangd_response(&app);
+          // tell clangd about edits once they have had a moment to pile up
+          ce_clangd_flush_changes(&app.clangd, false);
+
+          // responses can jump to a new buffer or bring up views, so treat them like input
+          CE_PROFILE_BEGIN(clangd_timer, CE_PROFILE_STAGE_CLANGD_RESPONSE);
+          if(clangd_ready && ce_app_handle_clangd_response(&app)) handled_input = true;
+          CE_PROFILE_END(clangd_timer);
 
           // update refs to view and tab_layout
           tab_layout = app.tab_list_layout->tab_list.current;
@@ -1696,33 +953,43 @@ int main(int argc, char* argv[]){
                if(app.input_complete_func) input_view_overlay(&app.input_view, view);
           }
 
-          // update any list buffers if they are in view
-          if(ce_layout_buffer_in_view(tab_layout, app.buffer_list_buffer)){
+          if(handled_input) dirty = true;
+
+          // the highlighted search pattern may have just changed, keep scanning for it while we are awake
+          search_scan_pending = ce_app_update_search_matches(&app);
+
+          // update any list buffers if they are in view. Buffers grow from background threads too, but everything else
+          // in these lists only changes with input
+          if(dirty && ce_layout_buffer_in_view(tab_layout, app.buffer_list_buffer)){
                build_buffer_list(app.buffer_list_buffer, app.buffer_node_head);
           }
 
-          if(ce_layout_buffer_in_view(tab_layout, app.bind_list_buffer)){
+          if(handled_input && ce_layout_buffer_in_view(tab_layout, app.bind_list_buffer)){
                build_bind_list(app.bind_list_buffer, &app.key_binds);
           }
 
-          if(ce_layout_buffer_in_view(tab_layout, app.yank_list_buffer)){
+          if(handled_input && ce_layout_buffer_in_view(tab_layout, app.yank_list_buffer)){
                build_yank_list(app.yank_list_buffer, app.vim.yanks);
           }
 
-          if(ce_layout_buffer_in_view(tab_layout, app.macro_list_buffer)){
+          if(handled_input && ce_layout_buffer_in_view(tab_layout, app.macro_list_buffer)){
                build_macro_list(app.macro_list_buffer, &app.macros);
           }
 
-          if(view && ce_layout_buffer_in_view(tab_layout, app.mark_list_buffer)){
+          if(handled_input && view && ce_layout_buffer_in_view(tab_layout, app.mark_list_buffer)){
                CeAppBufferData_t* buffer_data = view->buffer->app_data;
                build_mark_list(app.mark_list_buffer, &buffer_data->vim);
           }
 
-          if(view && ce_layout_buffer_in_view(tab_layout, app.jump_list_buffer)){
+          if(handled_input && view && ce_layout_buffer_in_view(tab_layout, app.jump_list_buffer)){
                CeAppViewData_t* view_data = view->user_data;
                build_jump_list(app.jump_list_buffer, &view_data->jump_list);
           }
 
+          if(dirty && ce_layout_buffer_in_view(tab_layout, app.profile_buffer)){
+               build_profile_list(app.profile_buffer, ls_clangd ? &app.clangd : NULL);
+          }
+
           if(view){
                CeLayout_t* shell_command_layout = ce_layout_buffer_in_view(tab_layout, app.shell_command_buffer);
                if(shell_command_layout){
@@ -1740,7 +1007,7 @@ int main(int argc, char* argv[]){
 
                if(ls_clangd){
                     CeLayout_t* clangd_diagnostics_layout = ce_layout_buffer_in_view(tab_layout, app.clangd_diagnostics_buffer);
-                    if(clangd_diagnostics_layout){
+                    if(clangd_diagnostics_layout && handled_input){
                         build_clangd_diagnostics_buffer(clangd_diagnostics_layout->view.buffer,
                                                         view->buffer);
                         app.last_goto_buffer = clangd_diagnostics_layout->view.buffer;
@@ -1753,15 +1020,36 @@ int main(int argc, char* argv[]){
                }
           }
 
+          if(!dirty) continue;
+
+          struct timespec draw_start = {};
+#if defined(PLATFORM_WINDOWS)
+          timespec_get(&draw_start, TIME_UTC);
+#else
+          clock_gettime(CLOCK_MONOTONIC, &draw_start);
+#endif
+
+          CE_PROFILE_BEGIN(draw_timer, CE_PROFILE_STAGE_DRAW);
  #if defined(DISPLAY_TERMINAL)
           ce_draw_term(&app);
  #elif defined(DISPLAY_GUI)
           ce_draw_gui(&app, &gui);
-          SDL_Delay(0);
  #endif
+          CE_PROFILE_END(draw_timer);
+          CE_PROFILE_FRAME_END();
+
+#if defined(PLATFORM_WINDOWS)
+          timespec_get(&current_draw_time, TIME_UTC);
+#else
+          clock_gettime(CLOCK_MONOTONIC, &current_draw_time);
+#endif
+          ce_app_loop_stats_frame(&app.loop_stats, time_between_usec(draw_start, current_draw_time));
      }
 
      // cleanup
+     ce_app_cancel_file_load(&app);
+     ce_syntax_background_stop();
+
      if(config_filepath){
           app.user_config.free_func(&app);
           user_config_free(&app.user_config);
@@ -1790,14 +1078,19 @@ int main(int argc, char* argv[]){
      ce_history_free(&app.search_history);
 
      ce_app_clear_filepath_cache(&app);
+     ce_regex_cache_clear();
 
      ce_buffer_node_free(&app.buffer_node_head);
+     ce_draw_color_list_free(&app.draw_color_list);
+     ce_range_list_free(&app.draw_range_list);
 
 #if defined(DISPLAY_TERMINAL)
+     ce_draw_term_free();
      endwin();
 #elif defined(DISPLAY_GUI)
-    TTF_CloseFont(gui.font);
+    gui_free_font(&gui);
     TTF_Quit();
+    if(gui.renderer) SDL_DestroyRenderer(gui.renderer);
     SDL_DestroyWindow(gui.window);
     SDL_Quit();
 #endif
@@ -1,9 +1,14 @@
 #include "test.h"
 #include "ce.h"
+#include "ce_syntax.h"
+#include "ce_profile.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <locale.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <unistd.h>
 
 const char* g_multiline_string = "0123456789\nabcdefghij\nklmnopqrst";
 const char* g_multiline_string_with_empty_line = "0123456789\n\nabcdefghij\nklmnopqrst";
@@ -32,9 +37,9 @@ TEST(buffer_load_string){
 
      EXPECT(buffer.lines);
      EXPECT(buffer.line_count == 3);
-     EXPECT(strcmp(buffer.lines[0], "0123456789") == 0);
-     EXPECT(strcmp(buffer.lines[1], "abcdefghij") == 0);
-     EXPECT(strcmp(buffer.lines[2], "klmnopqrst") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "0123456789") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "abcdefghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "klmnopqrst") == 0);
 
      ce_buffer_free(&buffer);
 }
@@ -46,14 +51,920 @@ TEST(buffer_load_file){
 
      EXPECT(buffer.lines);
      EXPECT(buffer.line_count == 4);
-     EXPECT(strcmp(buffer.lines[0], "this is just") == 0);
-     EXPECT(strcmp(buffer.lines[1], "a file used") == 0);
-     EXPECT(strcmp(buffer.lines[2], "for unittesting") == 0);
-     EXPECT(strcmp(buffer.lines[3], "isn't that neato?") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "this is just") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "a file used") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "for unittesting") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 3), "isn't that neato?") == 0);
 
      ce_buffer_free(&buffer);
 }
 
+TEST(buffer_load_file_copy_on_write){
+     const char* filename = "test_ce_load.txt";
+     FILE* file = fopen(filename, "wb");
+     EXPECT(file);
+     fputs("first\nsecond\n\nno newline at the end", file);
+     fclose(file);
+
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_file(&buffer, filename));
+     remove(filename);
+
+     EXPECT(buffer.line_count == 4);
+     EXPECT(buffer.mapping);
+
+     // lines are only copied out of the mapping once they are read
+     int64_t text_bytes = ce_buffer_memory(&buffer).text_bytes;
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "first") == 0);
+     EXPECT(ce_buffer_memory(&buffer).text_bytes == text_bytes + (int64_t)(strlen("first")) + 1);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "second") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 3), "no newline at the end") == 0);
+
+     // editing a line doesn't touch the lines around it
+     char* mapped_second = ce_buffer_line(&buffer, 1);
+     EXPECT(ce_buffer_insert_string(&buffer, "1st ", (CePoint_t){0, 0}));
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "1st first") == 0);
+     EXPECT(ce_buffer_line(&buffer, 1) == mapped_second);
+     EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){3, 1}, 4));
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "sec") == 0);
+     EXPECT(buffer.line_count == 3);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "no newline at the end") == 0);
+     EXPECT(ce_buffer_remove_lines(&buffer, 0, 2));
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "no newline at the end") == 0);
+
+     ce_buffer_free(&buffer);
+     EXPECT(buffer.mapping == NULL);
+
+     // files with nulls in them are refused
+     file = fopen(filename, "wb");
+     EXPECT(file);
+     fwrite("abc\ndef\0ghi\n", 1, 12, file);
+     fclose(file);
+     EXPECT(!ce_buffer_load_file(&buffer, filename));
+     EXPECT(buffer.lines == NULL);
+     remove(filename);
+}
+
+TEST(buffer_load_file_truncated_on_disk){
+     const char* filename = "test_ce_truncate.txt";
+     FILE* file = fopen(filename, "wb");
+     EXPECT(file);
+     fputs("first\n", file);
+     for(int i = 0; i < 12288; i++) fputc('a', file);
+     fputs("\nlast\n", file);
+     fclose(file);
+
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_file(&buffer, filename));
+     EXPECT(buffer.line_count == 3);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "first") == 0);
+
+     // the pages behind the lines we haven't read yet are gone, so they come back empty rather than faulting
+     EXPECT(truncate(filename, 0) == 0);
+     EXPECT(strlen(ce_buffer_line(&buffer, 1)) == 0);
+     EXPECT(strlen(ce_buffer_line(&buffer, 2)) == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "first") == 0);
+     EXPECT(ce_buffer_insert_string(&buffer, "still editable", (CePoint_t){0, 2}));
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "still editable") == 0);
+
+     // and what is left saves back over the file
+     EXPECT(ce_buffer_save(&buffer));
+     ce_buffer_free(&buffer);
+     EXPECT(ce_buffer_load_file(&buffer, filename));
+     EXPECT(buffer.line_count == 3);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "first") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "still editable") == 0);
+
+     // truncated before the load gets to scan it, the load fails and leaves the buffer readonly
+     CeBufferFileLoad_t load;
+     EXPECT(ce_buffer_file_load_begin(&buffer, &load, filename));
+     EXPECT(truncate(filename, 0) == 0);
+     EXPECT(!ce_buffer_file_load_step(&load, load.mapping_size));
+     EXPECT(load.truncated);
+     EXPECT(ce_buffer_file_load_take(&buffer, &load));
+     EXPECT(buffer.status == CE_BUFFER_STATUS_READONLY);
+     ce_buffer_free(&buffer);
+     remove(filename);
+}
+
+TEST(buffer_load_string_splits_and_validates_utf8){
+     // put multi-byte runes across every 16 and 32 byte chunk boundary the line splitter might use
+     char string[256] = {};
+     int64_t len = 0;
+     for(int64_t i = 0; i < 60; i++){
+          if(i % 20 == 19){
+               string[len++] = CE_NEWLINE;
+          }else{
+               memcpy(string + len, "\xE2\x82\xAC", 3); // euro sign
+               len += 3;
+          }
+     }
+
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, string, g_name));
+     EXPECT(buffer.line_count == 4);
+     EXPECT(ce_buffer_line_len(&buffer, 0) == 19);
+     EXPECT(ce_buffer_line_len(&buffer, 2) == 19);
+     EXPECT(ce_buffer_get_rune(&buffer, (CePoint_t){18, 2}) == 0x20AC);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 3), "") == 0);
+     ce_buffer_free(&buffer);
+
+     // a continuation byte that doesn't continue anything, deep into a chunk of ascii
+     EXPECT(!ce_buffer_load_string(&buffer, "0123456789abcdefghijklmnopqrstuvwxyz\n01234\x80", g_name));
+     // a lead byte that is followed by ascii instead of its continuation byte
+     EXPECT(!ce_buffer_load_string(&buffer, "0123456789abcdefghijklmnopqrstu\xC3zzzz", g_name));
+     // the string ends half way through a rune
+     EXPECT(!ce_buffer_load_string(&buffer, "abc\xE2\x82", g_name));
+     EXPECT(buffer.lines == NULL);
+}
+
+TEST(buffer_file_load_in_steps){
+     const char* filename = "test_ce_load.txt";
+     FILE* file = fopen(filename, "wb");
+     EXPECT(file);
+     fputs("first \xE2\x82\xAC\nsecond\nthird line\n", file);
+     fclose(file);
+
+     CeBuffer_t buffer = {};
+     CeBufferFileLoad_t load = {};
+     EXPECT(ce_buffer_file_load_begin(&buffer, &load, filename));
+     EXPECT(buffer.line_count == 1);
+     EXPECT(buffer.status == CE_BUFFER_STATUS_READONLY);
+
+     // the euro sign straddles the first two steps
+     EXPECT(ce_buffer_file_load_step(&load, 7));
+     EXPECT(!ce_buffer_file_load_take(&buffer, &load));
+     EXPECT(buffer.line_count == 1);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "") == 0);
+
+     EXPECT(ce_buffer_file_load_step(&load, 7));
+     EXPECT(!ce_buffer_file_load_take(&buffer, &load));
+     EXPECT(buffer.line_count == 1);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "first \xE2\x82\xAC") == 0);
+     EXPECT(ce_buffer_file_load_percent(&load) == 50);
+
+     while(!ce_buffer_file_load_take(&buffer, &load)){
+          EXPECT(ce_buffer_file_load_step(&load, 7));
+     }
+     EXPECT(buffer.line_count == 3);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "second") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "third line") == 0);
+     EXPECT(buffer.status == CE_BUFFER_STATUS_NONE);
+     ce_buffer_free(&buffer);
+
+     // cancelling keeps the lines loaded so far, but the buffer stays readonly
+     EXPECT(ce_buffer_file_load_begin(&buffer, &load, filename));
+     EXPECT(ce_buffer_file_load_step(&load, 20));
+     ce_buffer_file_load_cancel(&buffer, &load);
+     EXPECT(buffer.line_count == 2);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "second") == 0);
+     EXPECT(buffer.status == CE_BUFFER_STATUS_READONLY);
+     ce_buffer_free(&buffer);
+     remove(filename);
+}
+
+TEST(buffer_save){
+     const char* filename = "test_ce_save.txt";
+     FILE* file = fopen(filename, "wb");
+     EXPECT(file);
+     fputs("old contents\n", file);
+     fclose(file);
+     chmod(filename, 0640);
+     struct stat original_statbuf;
+     EXPECT(stat(filename, &original_statbuf) == 0);
+
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_file(&buffer, filename));
+     EXPECT(ce_buffer_insert_string(&buffer, "new\ncontents, ", (CePoint_t){0, 0}));
+     EXPECT(ce_buffer_save(&buffer));
+     EXPECT(buffer.status == CE_BUFFER_STATUS_NONE);
+
+     // the file is replaced, but keeps its owner and permissions
+     struct stat statbuf;
+     EXPECT(stat(filename, &statbuf) == 0);
+     EXPECT((statbuf.st_mode & 0777) == 0640);
+     EXPECT(statbuf.st_uid == original_statbuf.st_uid);
+     EXPECT(statbuf.st_gid == original_statbuf.st_gid);
+     EXPECT(buffer.file_modified_time == statbuf.st_mtime);
+
+     // the buffer still points into the mapping of the old file, which has to survive the save
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "contents, old contents") == 0);
+     ce_buffer_free(&buffer);
+
+     EXPECT(ce_buffer_load_file(&buffer, filename));
+     EXPECT(buffer.line_count == 2);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "new") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "contents, old contents") == 0);
+     ce_buffer_free(&buffer);
+     remove(filename);
+
+     // a new file gets the permissions open() would have given it, not the temp file's
+     mode_t mask = umask(022);
+     EXPECT(ce_buffer_load_string(&buffer, "new file", filename));
+     EXPECT(ce_buffer_save(&buffer));
+     EXPECT(stat(filename, &statbuf) == 0);
+     EXPECT((statbuf.st_mode & 0777) == 0644);
+     umask(mask);
+     ce_buffer_free(&buffer);
+     remove(filename);
+}
+
+TEST(buffer_save_in_place){
+     const char* filename = "test_ce_save_in_place.txt";
+     const char* link_filename = "test_ce_save_in_place_link.txt";
+     char long_line[3 * 4096];
+     memset(long_line, 'a', sizeof(long_line) - 1);
+     long_line[sizeof(long_line) - 1] = 0;
+
+     FILE* file = fopen(filename, "wb");
+     EXPECT(file);
+     fprintf(file, "first\n%s\nlast", long_line);
+     fclose(file);
+
+     // a hard link makes us write over the same inode, which truncates the file the buffer is mapped from
+     unlink(link_filename);
+     EXPECT(link(filename, link_filename) == 0);
+     struct stat original_statbuf;
+     EXPECT(stat(filename, &original_statbuf) == 0);
+
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_file(&buffer, filename));
+     EXPECT(buffer.mapping);
+     EXPECT(ce_buffer_insert_string(&buffer, "1st ", (CePoint_t){0, 0}));
+     EXPECT(ce_buffer_save(&buffer));
+     EXPECT(buffer.mapping == NULL);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), long_line) == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "last") == 0);
+     ce_buffer_free(&buffer);
+
+     struct stat statbuf;
+     EXPECT(stat(filename, &statbuf) == 0);
+     EXPECT(statbuf.st_ino == original_statbuf.st_ino);
+
+     EXPECT(ce_buffer_load_file(&buffer, link_filename));
+     EXPECT(buffer.line_count == 3);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "1st first") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), long_line) == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "last") == 0);
+     ce_buffer_free(&buffer);
+     remove(link_filename);
+     remove(filename);
+}
+
+TEST(buffer_literal_search){
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, "\xC2\xA2" "ab \xC2\xA2" "ab\nab at the start\nno match", g_name));
+
+     CePoint_t match = ce_buffer_search_forward(&buffer, (CePoint_t){0, 0}, "\xC2\xA2" "ab");
+     EXPECT(match.x == 0 && match.y == 0);
+     match = ce_buffer_search_forward(&buffer, (CePoint_t){1, 0}, "\xC2\xA2" "ab");
+     EXPECT(match.x == 4 && match.y == 0);
+     match = ce_buffer_search_forward(&buffer, (CePoint_t){5, 0}, "ab");
+     EXPECT(match.x == 5 && match.y == 0);
+     match = ce_buffer_search_forward(&buffer, (CePoint_t){6, 0}, "ab");
+     EXPECT(match.x == 0 && match.y == 1);
+     match = ce_buffer_search_forward(&buffer, (CePoint_t){1, 1}, "ab");
+     EXPECT(match.x == -1 && match.y == -1);
+
+     // backwards, matches may start on the start point and run passed it, and can be at the start of a line
+     match = ce_buffer_search_backward(&buffer, (CePoint_t){4, 0}, "\xC2\xA2" "ab");
+     EXPECT(match.x == 4 && match.y == 0);
+     match = ce_buffer_search_backward(&buffer, (CePoint_t){3, 0}, "\xC2\xA2" "ab");
+     EXPECT(match.x == 0 && match.y == 0);
+     match = ce_buffer_search_backward(&buffer, (CePoint_t){3, 2}, "ab");
+     EXPECT(match.x == 0 && match.y == 1);
+     match = ce_buffer_search_backward(&buffer, (CePoint_t){3, 2}, "zz");
+     EXPECT(match.x == -1 && match.y == -1);
+
+     // walking every match on a line gives rune offsets
+     CeSearch_t search;
+     ce_search_init(&search, "ab");
+     CeSearchLineItr_t line_itr;
+     ce_search_line_begin(&line_itr, ce_buffer_line(&buffer, 0));
+     EXPECT(ce_search_line_next(&search, &line_itr) == 1);
+     EXPECT(ce_search_line_next(&search, &line_itr) == 5);
+     EXPECT(ce_search_line_next(&search, &line_itr) == -1);
+
+     ce_buffer_free(&buffer);
+}
+
+TEST(regex_match_all){
+     CeRegex_t regex = NULL;
+     CeRegexResult_t regex_result = ce_regex_init("^a|b+", &regex);
+     EXPECT(regex_result.error_message == NULL);
+
+     CeRegexMatch_t matches[8];
+     int64_t match_count = 0;
+     regex_result = ce_regex_match_all(regex, "abbxbab", 0, matches, 8, &match_count);
+     EXPECT(regex_result.error_message == NULL);
+     EXPECT(match_count == 4);
+     EXPECT(regex_result.match_start == 0 && regex_result.match_length == 1);
+     EXPECT(matches[1].start == 1 && matches[1].length == 2);
+     EXPECT(matches[2].start == 4 && matches[2].length == 1);
+     EXPECT(matches[3].start == 6 && matches[3].length == 1);
+
+     // starting partway through still knows it isn't at the beginning of the line
+     regex_result = ce_regex_match_all(regex, "aab", 1, matches, 8, &match_count);
+     EXPECT(match_count == 1);
+     EXPECT(matches[0].start == 2 && matches[0].length == 1);
+
+     // stops when the output is full
+     regex_result = ce_regex_match_all(regex, "abbxbab", 0, matches, 2, &match_count);
+     EXPECT(match_count == 2);
+
+     regex_result = ce_regex_match_all(regex, "xyz", 0, matches, 8, &match_count);
+     EXPECT(match_count == 0);
+     EXPECT(regex_result.match_start == CE_REGEX_NO_MATCH);
+     ce_regex_free(regex);
+
+     // empty matches don't get stuck
+     EXPECT(ce_regex_init("x*", &regex).error_message == NULL);
+     regex_result = ce_regex_match_all(regex, "axb", 0, matches, 8, &match_count);
+     EXPECT(match_count == 4);
+     EXPECT(matches[1].start == 1 && matches[1].length == 1);
+     ce_regex_free(regex);
+}
+
+TEST(regex_cache){
+     CeRegex_t first = NULL;
+     EXPECT(ce_regex_cache_get("ab+", &first).error_message == NULL);
+     CeRegex_t again = NULL;
+     EXPECT(ce_regex_cache_get("ab+", &again).error_message == NULL);
+     EXPECT(first == again);
+
+     // bad expressions report the error every time and aren't cached
+     CeRegexResult_t regex_result = ce_regex_cache_get("(ab", &again);
+     EXPECT(regex_result.error_message != NULL);
+     free(regex_result.error_message);
+
+     // keep using the first expression while filling the cache, then push it out
+     char expression[32];
+     for(int64_t i = 0; i < CE_REGEX_CACHE_SIZE - 1; i++){
+          snprintf(expression, sizeof(expression), "x%ld", i);
+          EXPECT(ce_regex_cache_get(expression, &again).error_message == NULL);
+          EXPECT(ce_regex_cache_get("ab+", &again).error_message == NULL);
+          EXPECT(first == again);
+     }
+     for(int64_t i = 0; i < CE_REGEX_CACHE_SIZE; i++){
+          snprintf(expression, sizeof(expression), "y%ld", i);
+          EXPECT(ce_regex_cache_get(expression, &again).error_message == NULL);
+     }
+     EXPECT(ce_regex_cache_get("ab+", &again).error_message == NULL);
+     CeRegexResult_t match = ce_regex_match(again, "xabb");
+     EXPECT(match.match_start == 1 && match.match_length == 3);
+
+     ce_regex_cache_clear();
+}
+
+TEST(buffer_regex_search){
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, "\xC2\xA2" "ab \xC2\xA2" "abb\nab at the start\nno match", g_name));
+
+     CeRegex_t regex = NULL;
+     EXPECT(ce_regex_init("ab+", &regex).error_message == NULL);
+
+     // results are in runes, not bytes
+     CeRegexSearchResult_t result = ce_buffer_regex_search_forward(&buffer, (CePoint_t){0, 0}, regex);
+     EXPECT(result.point.x == 1 && result.point.y == 0 && result.length == 2);
+     result = ce_buffer_regex_search_forward(&buffer, (CePoint_t){2, 0}, regex);
+     EXPECT(result.point.x == 5 && result.point.y == 0 && result.length == 3);
+     result = ce_buffer_regex_search_forward(&buffer, (CePoint_t){6, 0}, regex);
+     EXPECT(result.point.x == 0 && result.point.y == 1 && result.length == 2);
+     result = ce_buffer_regex_search_forward(&buffer, (CePoint_t){1, 1}, regex);
+     EXPECT(result.point.x == -1 && result.point.y == -1);
+
+     // backwards, matches have to start before the start point
+     result = ce_buffer_regex_search_backward(&buffer, (CePoint_t){5, 0}, regex);
+     EXPECT(result.point.x == 1 && result.point.y == 0 && result.length == 2);
+     result = ce_buffer_regex_search_backward(&buffer, (CePoint_t){6, 0}, regex);
+     EXPECT(result.point.x == 5 && result.point.y == 0 && result.length == 3);
+     result = ce_buffer_regex_search_backward(&buffer, (CePoint_t){3, 2}, regex);
+     EXPECT(result.point.x == 0 && result.point.y == 1);
+     result = ce_buffer_regex_search_backward(&buffer, (CePoint_t){1, 0}, regex);
+     EXPECT(result.point.x == -1 && result.point.y == -1);
+     ce_regex_free(regex);
+
+     // anchors only match at the real start of the line
+     EXPECT(ce_regex_init("^ab", &regex).error_message == NULL);
+     result = ce_buffer_regex_search_forward(&buffer, (CePoint_t){1, 0}, regex);
+     EXPECT(result.point.x == 0 && result.point.y == 1);
+     result = ce_buffer_regex_search_backward(&buffer, (CePoint_t){3, 2}, regex);
+     EXPECT(result.point.x == 0 && result.point.y == 1);
+     ce_regex_free(regex);
+
+     ce_buffer_free(&buffer);
+}
+
+static bool match_index_matches_fresh_scan(CeMatchIndex_t* index, CeBuffer_t* buffer){
+     CeMatchIndex_t fresh = {};
+     ce_match_index_set_pattern(&fresh, buffer, index->pattern, index->regex);
+     ce_match_index_scan(&fresh, buffer, buffer->line_count);
+
+     // the index either kept up with the whole buffer, or had to start over
+     ce_match_index_sync(index, buffer);
+     bool same = (index->scanned_line_count == 0 || index->scanned_line_count == buffer->line_count);
+     ce_match_index_scan(index, buffer, buffer->line_count);
+     same = same && ce_match_index_count(index) == ce_match_index_count(&fresh);
+     for(int64_t i = 0; same && i < ce_match_index_count(&fresh); i++){
+          CeMatch_t a = ce_match_index_get(index, i);
+          CeMatch_t b = ce_match_index_get(&fresh, i);
+          same = ce_points_equal(a.point, b.point) && a.length == b.length;
+     }
+
+     ce_match_index_free(&fresh);
+     return same;
+}
+
+TEST(match_index){
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, "\xC2\xA2" "aaa \xC2\xA2" "ab\nno match\naab", g_name));
+
+     CeMatchIndex_t index = {};
+     EXPECT(ce_match_index_set_pattern(&index, &buffer, "aa", false));
+     EXPECT(!ce_match_index_scan(&index, &buffer, 1));
+     EXPECT(ce_match_index_count(&index) == 2);
+     EXPECT(ce_match_index_scan(&index, &buffer, 2));
+     EXPECT(ce_match_index_is_complete(&index, &buffer));
+
+     // overlapping matches are kept, offsets are in runes
+     EXPECT(ce_match_index_count(&index) == 3);
+     EXPECT(ce_points_equal(ce_match_index_get(&index, 0).point, (CePoint_t){1, 0}));
+     EXPECT(ce_points_equal(ce_match_index_get(&index, 1).point, (CePoint_t){2, 0}));
+     EXPECT(ce_points_equal(ce_match_index_get(&index, 2).point, (CePoint_t){0, 2}));
+     EXPECT(ce_match_index_lower_bound(&index, (CePoint_t){2, 0}) == 1);
+     EXPECT(ce_match_index_lower_bound(&index, (CePoint_t){3, 0}) == 2);
+     EXPECT(ce_match_index_lower_bound(&index, (CePoint_t){1, 2}) == 3);
+
+     // typing more of the pattern narrows the matches we have
+     EXPECT(ce_match_index_set_pattern(&index, &buffer, "aab", false));
+     EXPECT(ce_match_index_count(&index) == 1);
+     EXPECT(ce_points_equal(ce_match_index_get(&index, 0).point, (CePoint_t){0, 2}));
+     EXPECT(ce_match_index_get(&index, 0).length == 3);
+
+     EXPECT(ce_match_index_set_pattern(&index, &buffer, "a+b", true));
+     ce_match_index_scan(&index, &buffer, buffer.line_count);
+     EXPECT(ce_match_index_count(&index) == 2);
+     EXPECT(ce_points_equal(ce_match_index_get(&index, 0).point, (CePoint_t){6, 0}));
+     EXPECT(ce_match_index_get(&index, 0).length == 2);
+     EXPECT(ce_match_index_get(&index, 1).length == 3);
+
+     // empty matches in front of a line's real ones don't hide them
+     EXPECT(ce_match_index_set_pattern(&index, &buffer, "b*", true));
+     ce_match_index_scan(&index, &buffer, buffer.line_count);
+     EXPECT(ce_match_index_count(&index) == 2);
+     EXPECT(ce_points_equal(ce_match_index_get(&index, 0).point, (CePoint_t){7, 0}));
+     EXPECT(ce_points_equal(ce_match_index_get(&index, 1).point, (CePoint_t){2, 2}));
+
+     EXPECT(!ce_match_index_set_pattern(&index, &buffer, "", false));
+     EXPECT(index.pattern == NULL);
+
+     ce_match_index_free(&index);
+     ce_buffer_free(&buffer);
+}
+
+TEST(match_index_follows_changes){
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, "ab ab\nab\n\nxab\nabab\nab", g_name));
+
+     CeMatchIndex_t index = {};
+     EXPECT(ce_match_index_set_pattern(&index, &buffer, "ab", false));
+     EXPECT(ce_match_index_scan(&index, &buffer, buffer.line_count));
+
+     const char* strings[] = {"a", "b", "ab", "\n", "ab\nab", "x\n\nb", "\xC2\xA2"};
+     int64_t string_count = sizeof(strings) / sizeof(strings[0]);
+     CePoint_t cursor = {};
+     srand(7);
+     for(int64_t i = 0; i < 2000; i++){
+          int64_t y = rand() % buffer.line_count;
+          int64_t line_len = ce_utf8_strlen(ce_buffer_line(&buffer, y));
+          CePoint_t point = {line_len ? rand() % (line_len + 1) : 0, y};
+
+          switch(rand() % 7){
+          case 0:
+          case 1:
+               ce_buffer_insert_string_change(&buffer, strdup(strings[rand() % string_count]), point, &cursor,
+                                              point, false);
+               break;
+          case 2:
+          {
+               int64_t remove_len = 1 + rand() % 4;
+               if(ce_buffer_range_len(&buffer, point, ce_buffer_end_point(&buffer)) > remove_len){
+                    ce_buffer_remove_string_change(&buffer, point, remove_len, &cursor, point, false);
+               }
+          } break;
+          case 3:
+               ce_buffer_undo(&buffer, &cursor);
+               break;
+          case 4:
+               ce_buffer_redo(&buffer, &cursor);
+               break;
+          case 6:
+          {
+               // type and backspace a rune at a time, the way insert mode does, so the changes get folded together
+               int64_t type_count = 1 + rand() % 4;
+               for(int64_t t = 0; t < type_count; t++){
+                    ce_buffer_insert_string_change(&buffer, strdup((rand() % 2) ? "a" : "b"), point, &cursor,
+                                                   point, t > 0);
+                    point.x++;
+               }
+               if(rand() % 2){
+                    point.x--;
+                    ce_buffer_remove_string_change(&buffer, point, 1, &cursor, point, true);
+               }
+          } break;
+          case 5:
+               // sometimes let a few changes pile up before syncing
+               if(rand() % 2) continue;
+               // edits that don't record a change force a re-scan
+               if(rand() % 8 == 0) ce_buffer_insert_string(&buffer, "ab", point);
+               break;
+          }
+
+          if(rand() % 3 == 0) continue;
+          if(!match_index_matches_fresh_scan(&index, &buffer)){
+               EXPECT(!"match index is out of sync with the buffer");
+               break;
+          }
+     }
+
+     ce_match_index_free(&index);
+     ce_buffer_free(&buffer);
+}
+
+// byte offset of a line and rune in a plain string, to check edits against something other than a CeBuffer_t
+static int64_t string_point_offset(const char* string, CePoint_t point){
+     const char* itr = string;
+     for(int64_t y = 0; y < point.y; y++){
+          itr = strchr(itr, CE_NEWLINE);
+          if(!itr) return -1;
+          itr++;
+     }
+     for(int64_t x = 0; x < point.x; x++){
+          if(!*itr) return -1;
+          int64_t bytes_consumed = 0;
+          ce_utf8_decode(itr, &bytes_consumed);
+          itr += bytes_consumed;
+     }
+     return itr - string;
+}
+
+// ce_buffer_dupe() adds a newline for an empty last line, so join the lines as they are
+static char* buffer_join_lines(CeBuffer_t* buffer){
+     int64_t length = 0;
+     for(int64_t y = 0; y < buffer->line_count; y++) length += strlen(ce_buffer_line(buffer, y)) + 1;
+     char* string = malloc(length + 1);
+     char* itr = string;
+     for(int64_t y = 0; y < buffer->line_count; y++){
+          if(y > 0) *itr++ = CE_NEWLINE;
+          int64_t line_length = strlen(ce_buffer_line(buffer, y));
+          memcpy(itr, ce_buffer_line(buffer, y), line_length);
+          itr += line_length;
+     }
+     *itr = 0;
+     return string;
+}
+
+static char* string_apply_edits(char* string, const CeBufferEdits_t* edits){
+     for(int64_t i = 0; i < edits->count && string; i++){
+          const CeBufferEdit_t* edit = edits->elements + i;
+          int64_t start = string_point_offset(string, edit->start);
+          int64_t end = string_point_offset(string, edit->end);
+          char* applied = NULL;
+          if(start >= 0 && end >= start){
+               int64_t text_len = strlen(edit->text);
+               int64_t rest_len = strlen(string + end);
+               applied = malloc(start + text_len + rest_len + 1);
+               memcpy(applied, string, start);
+               memcpy(applied + start, edit->text, text_len);
+               memcpy(applied + start + text_len, string + end, rest_len + 1);
+          }
+          free(string);
+          string = applied;
+     }
+     return string;
+}
+
+TEST(buffer_edits_since_folded_changes){
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, "hello world", g_name));
+
+     CePoint_t cursor = {};
+     EXPECT(ce_buffer_insert_string_change(&buffer, strdup("a"), (CePoint_t){5, 0}, &cursor, (CePoint_t){6, 0}, false));
+     CeBufferChangeMark_t mark = {};
+     ce_buffer_change_mark(&mark, &buffer);
+     char* shadow = buffer_join_lines(&buffer);
+
+     // typing more folds into the marked change, only the new runes come back
+     EXPECT(ce_buffer_insert_string_change(&buffer, strdup("\xC2\xA2"), (CePoint_t){6, 0}, &cursor, (CePoint_t){7, 0}, true));
+     EXPECT(ce_buffer_insert_string_change(&buffer, strdup("c"), (CePoint_t){7, 0}, &cursor, (CePoint_t){8, 0}, true));
+     EXPECT(buffer.change_node->coalesced_count == 2);
+     CeBufferEdits_t edits = {};
+     EXPECT(ce_buffer_edits_since(&buffer, &mark, &edits));
+     EXPECT(edits.count == 1);
+     EXPECT(ce_points_equal(edits.elements[0].start, (CePoint_t){6, 0}));
+     EXPECT(ce_points_equal(edits.elements[0].end, (CePoint_t){6, 0}));
+     EXPECT(strcmp(edits.elements[0].text, "\xC2\xA2" "c") == 0);
+     shadow = string_apply_edits(shadow, &edits);
+     ce_buffer_edits_free(&edits);
+     char* string = buffer_join_lines(&buffer);
+     EXPECT(shadow && strcmp(shadow, string) == 0);
+     free(string);
+
+     // backspacing and deleting forward around a marked removal is one range
+     EXPECT(ce_buffer_remove_string_change(&buffer, (CePoint_t){3, 0}, 1, &cursor, (CePoint_t){3, 0}, false));
+     ce_buffer_change_mark(&mark, &buffer);
+     EXPECT(ce_buffer_remove_string_change(&buffer, (CePoint_t){2, 0}, 1, &cursor, (CePoint_t){2, 0}, true));
+     EXPECT(ce_buffer_remove_string_change(&buffer, (CePoint_t){2, 0}, 1, &cursor, (CePoint_t){2, 0}, true));
+     EXPECT(ce_buffer_edits_since(&buffer, &mark, &edits));
+     EXPECT(edits.count == 1);
+     EXPECT(ce_points_equal(edits.elements[0].start, (CePoint_t){2, 0}));
+     EXPECT(ce_points_equal(edits.elements[0].end, (CePoint_t){4, 0}));
+     EXPECT(edits.elements[0].text[0] == 0);
+     ce_buffer_edits_free(&edits);
+
+     // undoing the grown change only reverts the part that was there when it was marked
+     EXPECT(ce_buffer_undo(&buffer, &cursor));
+     EXPECT(ce_buffer_edits_since(&buffer, &mark, &edits));
+     EXPECT(edits.count == 1);
+     EXPECT(ce_points_equal(edits.elements[0].start, (CePoint_t){3, 0}));
+     EXPECT(strcmp(edits.elements[0].text, "l") == 0);
+     ce_buffer_edits_free(&edits);
+
+     // edits that weren't recorded can't be known
+     ce_buffer_change_mark(&mark, &buffer);
+     EXPECT(ce_buffer_insert_string(&buffer, "x", (CePoint_t){0, 0}));
+     EXPECT(!ce_buffer_edits_since(&buffer, &mark, &edits));
+     EXPECT(edits.count == 0);
+
+     free(shadow);
+     ce_buffer_free(&buffer);
+}
+
+// when an undone change is thrown away for a new one, nothing is left to say what happened since a mark on it
+static bool change_history_has_mark(CeBuffer_t* buffer, const CeBufferChangeMark_t* mark){
+     if(!mark->change_node) return true;
+     for(CeBufferChangeNode_t* itr = buffer->change_root; itr; itr = itr->next){
+          if(itr == mark->change_node && itr->index == mark->change_index) return true;
+     }
+     return false;
+}
+
+TEST(buffer_edits_since_follow_changes){
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, "ab ab\nab\n\nxab\nabab\nab", g_name));
+
+     CeBufferChangeMark_t mark = {};
+     ce_buffer_change_mark(&mark, &buffer);
+     char* shadow = buffer_join_lines(&buffer);
+     bool unrecorded = false;
+
+     const char* strings[] = {"a", "b", "ab", "\n", "ab\nab", "x\n\nb", "\xC2\xA2"};
+     int64_t string_count = sizeof(strings) / sizeof(strings[0]);
+     CePoint_t cursor = {};
+     srand(11);
+     for(int64_t i = 0; i < 2000; i++){
+          int64_t y = rand() % buffer.line_count;
+          int64_t line_len = ce_utf8_strlen(ce_buffer_line(&buffer, y));
+          CePoint_t point = {line_len ? rand() % (line_len + 1) : 0, y};
+
+          switch(rand() % 7){
+          case 0:
+          case 1:
+               ce_buffer_insert_string_change(&buffer, strdup(strings[rand() % string_count]), point, &cursor,
+                                              point, false);
+               break;
+          case 2:
+          {
+               int64_t remove_len = 1 + rand() % 4;
+               if(ce_buffer_range_len(&buffer, point, ce_buffer_end_point(&buffer)) > remove_len){
+                    ce_buffer_remove_string_change(&buffer, point, remove_len, &cursor, point, rand() % 2);
+               }
+          } break;
+          case 3:
+               ce_buffer_undo(&buffer, &cursor);
+               break;
+          case 4:
+               ce_buffer_redo(&buffer, &cursor);
+               break;
+          case 5:
+          {
+               // type a rune at a time, syncing part way through so the marked change keeps growing
+               int64_t type_count = 1 + rand() % 4;
+               for(int64_t t = 0; t < type_count; t++){
+                    ce_buffer_insert_string_change(&buffer, strdup((rand() % 2) ? "a" : "\xC2\xA2"), point, &cursor,
+                                                   point, t > 0);
+                    point.x++;
+                    if(rand() % 3 == 0) break;
+               }
+          } break;
+          case 6:
+          {
+               // backspace and delete forward a rune at a time
+               int64_t delete_count = 1 + rand() % 3;
+               for(int64_t d = 0; d < delete_count; d++){
+                    if(ce_buffer_range_len(&buffer, point, ce_buffer_end_point(&buffer)) <= 1) break;
+                    if(rand() % 2 && point.x > 0) point.x--;
+                    ce_buffer_remove_string_change(&buffer, point, 1, &cursor, point, d > 0);
+               }
+               if(rand() % 16 == 0){
+                    ce_buffer_insert_string(&buffer, "ab", point);
+                    unrecorded = true;
+               }
+          } break;
+          }
+
+          if(rand() % 3 == 0) continue;
+
+          CeBufferEdits_t edits = {};
+          if(ce_buffer_edits_since(&buffer, &mark, &edits)){
+               shadow = string_apply_edits(shadow, &edits);
+               ce_buffer_edits_free(&edits);
+          }else{
+               EXPECT(unrecorded || !change_history_has_mark(&buffer, &mark));
+               free(shadow);
+               shadow = buffer_join_lines(&buffer);
+          }
+          unrecorded = false;
+          ce_buffer_change_mark(&mark, &buffer);
+
+          char* string = buffer_join_lines(&buffer);
+          bool same = shadow && strcmp(shadow, string) == 0;
+          free(string);
+          if(!same){
+               EXPECT(!"edits don't reproduce the buffer");
+               break;
+          }
+     }
+
+     free(shadow);
+     ce_buffer_free(&buffer);
+}
+
+static int64_t change_node_count(CeBuffer_t* buffer){
+     int64_t count = 0;
+     for(CeBufferChangeNode_t* itr = buffer->change_root; itr; itr = itr->next) count++;
+     return count;
+}
+
+TEST(buffer_undo_coalesces_single_rune_edits){
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, "hello world", g_name));
+
+     // typing a rune at a time ends up as one change
+     CePoint_t cursor = {5, 0};
+     const char* typed = "abc";
+     for(int64_t i = 0; typed[i]; i++){
+          char rune[2] = {typed[i], 0};
+          CePoint_t point = {5 + i, 0};
+          EXPECT(ce_buffer_insert_string_change(&buffer, strdup(rune), point, &cursor, (CePoint_t){6 + i, 0}, i > 0));
+     }
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "helloabc world") == 0);
+     EXPECT(change_node_count(&buffer) == 2);
+     EXPECT(strcmp(buffer.change_node->change.string, "abc") == 0);
+     EXPECT(buffer.change_node->coalesced_count == 2);
+
+     // backspacing through it and deleting forward fold into their own change
+     EXPECT(ce_buffer_remove_string_change(&buffer, (CePoint_t){7, 0}, 1, &cursor, (CePoint_t){7, 0}, false));
+     EXPECT(ce_buffer_remove_string_change(&buffer, (CePoint_t){6, 0}, 1, &cursor, (CePoint_t){6, 0}, true));
+     EXPECT(ce_buffer_remove_string_change(&buffer, (CePoint_t){6, 0}, 1, &cursor, (CePoint_t){6, 0}, true));
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "helloaworld") == 0);
+     EXPECT(change_node_count(&buffer) == 3);
+     EXPECT(strcmp(buffer.change_node->change.string, "bc ") == 0);
+     EXPECT(buffer.change_node->change.location.x == 6);
+
+     // unchained changes, newlines and changes that don't touch stay separate
+     EXPECT(ce_buffer_insert_string_change(&buffer, strdup("x"), (CePoint_t){0, 0}, &cursor, (CePoint_t){1, 0}, false));
+     EXPECT(ce_buffer_insert_string_change(&buffer, strdup("\n"), (CePoint_t){1, 0}, &cursor, (CePoint_t){0, 1}, true));
+     EXPECT(ce_buffer_insert_string_change(&buffer, strdup("y"), (CePoint_t){3, 1}, &cursor, (CePoint_t){4, 1}, true));
+     EXPECT(change_node_count(&buffer) == 6);
+
+     // nothing is folded into the change the buffer was saved at
+     buffer.save_at_change_node = buffer.change_node;
+     EXPECT(ce_buffer_insert_string_change(&buffer, strdup("z"), (CePoint_t){4, 1}, &cursor, (CePoint_t){5, 1}, true));
+     EXPECT(change_node_count(&buffer) == 7);
+
+     // undo and redo behave the same as if every rune was its own change, chains are undone together
+     EXPECT(ce_buffer_undo(&buffer, &cursor));
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "helloaworld") == 0);
+     EXPECT(buffer.line_count == 1);
+     EXPECT(ce_buffer_undo(&buffer, &cursor));
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "helloabc world") == 0);
+     EXPECT(cursor.x == 8 && cursor.y == 0);
+     EXPECT(ce_buffer_undo(&buffer, &cursor));
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "hello world") == 0);
+     EXPECT(cursor.x == 5 && cursor.y == 0);
+     EXPECT(ce_buffer_redo(&buffer, &cursor));
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "helloabc world") == 0);
+     EXPECT(cursor.x == 8 && cursor.y == 0);
+     EXPECT(ce_buffer_redo(&buffer, &cursor));
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "helloaworld") == 0);
+
+     ce_buffer_free(&buffer);
+}
+
+TEST(buffer_undo_history_trims_to_memory_limit){
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, "", g_name));
+     buffer.change_memory_limit = 4 * CE_CHANGE_ARENA_BLOCK_SIZE;
+
+     int64_t change_count = 20000;
+     CePoint_t cursor = {};
+     for(int64_t i = 0; i < change_count; i++){
+          CePoint_t point = {0, i};
+          EXPECT(ce_buffer_insert_string_change(&buffer, strdup("a change that is long enough to add up\n"), point,
+                                                &cursor, (CePoint_t){0, i + 1}, false));
+     }
+     EXPECT(buffer.line_count == change_count + 1);
+     EXPECT(ce_buffer_memory(&buffer).history_bytes <= buffer.change_memory_limit);
+
+     // only the newest history is left to undo, and all of it can be redone
+     int64_t undo_count = 0;
+     while(buffer.change_node != buffer.change_root){
+          EXPECT(ce_buffer_undo(&buffer, &cursor));
+          undo_count++;
+     }
+     EXPECT(undo_count > 0 && undo_count < change_count);
+     EXPECT(buffer.line_count == (change_count - undo_count) + 1);
+     while(ce_buffer_redo(&buffer, &cursor));
+     EXPECT(buffer.line_count == change_count + 1);
+
+     ce_buffer_free(&buffer);
+}
+
+TEST(buffer_undo_long_chain){
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, "", g_name));
+     buffer.change_memory_limit = 1024 * 1024 * 1024;
+
+     // a replace_all over a big file chains a change per match, more than would fit on the stack one frame each
+     int64_t change_count = 300000;
+     CePoint_t cursor = {};
+     for(int64_t i = 0; i < change_count; i++){
+          CePoint_t point = {0, i};
+          EXPECT(ce_buffer_insert_string_change(&buffer, strdup("ab\n"), point, &cursor, (CePoint_t){0, i + 1}, i > 0));
+     }
+     EXPECT(buffer.line_count == change_count + 1);
+
+     EXPECT(ce_buffer_undo(&buffer, &cursor));
+     EXPECT(buffer.line_count == 1);
+     EXPECT(buffer.change_node == buffer.change_root);
+     EXPECT(cursor.x == 0 && cursor.y == 0);
+
+     EXPECT(ce_buffer_redo(&buffer, &cursor));
+     EXPECT(buffer.line_count == change_count + 1);
+     EXPECT(cursor.y == change_count);
+     EXPECT(!ce_buffer_redo(&buffer, &cursor));
+
+     ce_buffer_free(&buffer);
+}
+
+TEST(buffer_storage_edits_match){
+     CeBuffer_t array_buffer = {};
+     CeBuffer_t gap_buffer = {};
+     ce_buffer_set_storage(&array_buffer, CE_BUFFER_STORAGE_LINE_ARRAY);
+     ce_buffer_set_storage(&gap_buffer, CE_BUFFER_STORAGE_LINE_GAP);
+     EXPECT(ce_buffer_load_string(&array_buffer, g_multiline_string, g_name));
+     EXPECT(ce_buffer_load_string(&gap_buffer, g_multiline_string, g_name));
+
+     // the same splits, joins and line removals scattered around both buffers, so the gap moves both ways and grows
+     CePoint_t array_cursor = {};
+     CePoint_t gap_cursor = {};
+     uint32_t seed = 7;
+     for(int64_t i = 0; i < 500; i++){
+          seed = (seed * 1103515245u) + 12345u;
+          int64_t y = (seed >> 8) % array_buffer.line_count;
+          CePoint_t point = {0, y};
+          if(i % 3 == 2 && array_buffer.line_count > 2){
+               EXPECT(ce_buffer_remove_string_change(&array_buffer, point, 1, &array_cursor, point, false));
+               EXPECT(ce_buffer_remove_string_change(&gap_buffer, point, 1, &gap_cursor, point, false));
+          }else{
+               EXPECT(ce_buffer_insert_string_change(&array_buffer, strdup("one\ntwo\n"), point, &array_cursor, point, false));
+               EXPECT(ce_buffer_insert_string_change(&gap_buffer, strdup("one\ntwo\n"), point, &gap_cursor, point, false));
+          }
+          if(i == 250) ce_buffer_set_storage(&gap_buffer, CE_BUFFER_STORAGE_LINE_ARRAY);
+          if(i == 400) ce_buffer_set_storage(&gap_buffer, CE_BUFFER_STORAGE_LINE_GAP);
+     }
+     EXPECT(array_buffer.line_gap_start == array_buffer.line_count);
+     EXPECT(array_buffer.line_gap_end == array_buffer.line_capacity);
+
+     char* array_string = buffer_join_lines(&array_buffer);
+     char* gap_string = buffer_join_lines(&gap_buffer);
+     EXPECT(array_buffer.line_count == gap_buffer.line_count);
+     EXPECT(strcmp(array_string, gap_string) == 0);
+     free(array_string);
+     free(gap_string);
+
+     while(gap_buffer.change_node->prev) EXPECT(ce_buffer_undo(&gap_buffer, &gap_cursor));
+     gap_string = buffer_join_lines(&gap_buffer);
+     EXPECT(strcmp(gap_string, g_multiline_string) == 0);
+     free(gap_string);
+
+     ce_buffer_free(&array_buffer);
+     ce_buffer_free(&gap_buffer);
+}
+
 TEST(buffer_empty){
      CeBuffer_t buffer = {};
      ce_buffer_load_string(&buffer, g_multiline_string, g_name);
@@ -145,9 +1056,9 @@ TEST(buffer_insert_string_one_line){
 
      EXPECT(buffer.lines);
      EXPECT(buffer.line_count == 3);
-     EXPECT(strcmp(buffer.lines[0], "0123456789") == 0);
-     EXPECT(strcmp(buffer.lines[1], "abtacocdefghij") == 0);
-     EXPECT(strcmp(buffer.lines[2], "klmnopqrst") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "0123456789") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "abtacocdefghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "klmnopqrst") == 0);
 
      ce_buffer_free(&buffer);
 }
@@ -160,10 +1071,10 @@ TEST(buffer_insert_string_two_lines){
 
      EXPECT(buffer.lines);
      EXPECT(buffer.line_count == 4);
-     EXPECT(strcmp(buffer.lines[0], "012345taco") == 0);
-     EXPECT(strcmp(buffer.lines[1], "cat6789") == 0);
-     EXPECT(strcmp(buffer.lines[2], "abcdefghij") == 0);
-     EXPECT(strcmp(buffer.lines[3], "klmnopqrst") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "012345taco") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "cat6789") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "abcdefghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 3), "klmnopqrst") == 0);
 
      ce_buffer_free(&buffer);
 }
@@ -176,11 +1087,11 @@ TEST(buffer_insert_string_three_lines){
 
      EXPECT(buffer.lines);
      EXPECT(buffer.line_count == 5);
-     EXPECT(strcmp(buffer.lines[0], "0123456789") == 0);
-     EXPECT(strcmp(buffer.lines[1], "abcdefgtaco") == 0);
-     EXPECT(strcmp(buffer.lines[2], "cat") == 0);
-     EXPECT(strcmp(buffer.lines[3], "pizzahij") == 0);
-     EXPECT(strcmp(buffer.lines[4], "klmnopqrst") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "0123456789") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "abcdefgtaco") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "cat") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 3), "pizzahij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 4), "klmnopqrst") == 0);
 
      ce_buffer_free(&buffer);
 }
@@ -193,10 +1104,10 @@ TEST(buffer_insert_string_newline){
 
      EXPECT(buffer.lines);
      EXPECT(buffer.line_count == 4);
-     EXPECT(strcmp(buffer.lines[0], "0123456789") == 0);
-     EXPECT(strcmp(buffer.lines[1], "abcdefg") == 0);
-     EXPECT(strcmp(buffer.lines[2], "hij") == 0);
-     EXPECT(strcmp(buffer.lines[3], "klmnopqrst") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "0123456789") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "abcdefg") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "hij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 3), "klmnopqrst") == 0);
 
      ce_buffer_free(&buffer);
 }
@@ -209,10 +1120,10 @@ TEST(buffer_insert_string_newline_at_end_of_line){
 
      EXPECT(buffer.lines);
      EXPECT(buffer.line_count == 4);
-     EXPECT(strcmp(buffer.lines[0], "0123456789") == 0);
-     EXPECT(strcmp(buffer.lines[1], "") == 0);
-     EXPECT(strcmp(buffer.lines[2], "abcdefghij") == 0);
-     EXPECT(strcmp(buffer.lines[3], "klmnopqrst") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "0123456789") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "abcdefghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 3), "klmnopqrst") == 0);
 
      ce_buffer_free(&buffer);
 }
@@ -225,9 +1136,9 @@ TEST(buffer_insert_string_on_empty_line){
 
      EXPECT(buffer.lines);
      EXPECT(buffer.line_count == 3);
-     EXPECT(strcmp(buffer.lines[0], "first line") == 0);
-     EXPECT(strcmp(buffer.lines[1], "inserted") == 0);
-     EXPECT(strcmp(buffer.lines[2], "third line") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "first line") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "inserted") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "third line") == 0);
 
      ce_buffer_free(&buffer);
 }
@@ -237,7 +1148,7 @@ TEST(buffer_remove_string_portion_of_line){
      ce_buffer_load_string(&buffer, g_multiline_string, g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){3, 0}, 5));
      EXPECT(buffer.line_count == 3);
-     EXPECT(strcmp(buffer.lines[0], "01289") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "01289") == 0);
 }
 
 TEST(buffer_remove_string_entire_line){
@@ -245,7 +1156,7 @@ TEST(buffer_remove_string_entire_line){
      ce_buffer_load_string(&buffer, g_multiline_string, g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){0, 0}, 10));
      EXPECT(buffer.line_count == 3);
-     EXPECT(strcmp(buffer.lines[0], "") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "") == 0);
 }
 
 TEST(buffer_remove_string_entire_line_plus_newline){
@@ -253,7 +1164,7 @@ TEST(buffer_remove_string_entire_line_plus_newline){
      ce_buffer_load_string(&buffer, g_multiline_string, g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){0, 0}, 11));
      EXPECT(buffer.line_count == 2);
-     EXPECT(strcmp(buffer.lines[0], "abcdefghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "abcdefghij") == 0);
 }
 
 TEST(buffer_remove_string_entire_line_multiple){
@@ -261,7 +1172,7 @@ TEST(buffer_remove_string_entire_line_multiple){
      ce_buffer_load_string(&buffer, g_multiline_string, g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){0, 0}, 21));
      EXPECT(buffer.line_count == 2);
-     EXPECT(strcmp(buffer.lines[0], "") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "") == 0);
 }
 
 TEST(buffer_remove_string_entire_line_multiple_with_newline){
@@ -269,7 +1180,7 @@ TEST(buffer_remove_string_entire_line_multiple_with_newline){
      ce_buffer_load_string(&buffer, g_multiline_string, g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){0, 0}, 22));
      EXPECT(buffer.line_count == 1);
-     EXPECT(strcmp(buffer.lines[0], "klmnopqrst") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "klmnopqrst") == 0);
 }
 
 TEST(buffer_remove_string_across_line){
@@ -277,7 +1188,7 @@ TEST(buffer_remove_string_across_line){
      ce_buffer_load_string(&buffer, g_multiline_string, g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){5, 0}, 10));
      EXPECT(buffer.line_count == 2);
-     EXPECT(strcmp(buffer.lines[0], "01234efghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "01234efghij") == 0);
 }
 
 TEST(buffer_remove_string_join){
@@ -285,7 +1196,7 @@ TEST(buffer_remove_string_join){
      ce_buffer_load_string(&buffer, g_multiline_string, g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){10, 0}, 1));
      EXPECT(buffer.line_count == 2);
-     EXPECT(strcmp(buffer.lines[0], "0123456789abcdefghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "0123456789abcdefghij") == 0);
 }
 
 TEST(buffer_remove_string_up_to_join){
@@ -293,7 +1204,7 @@ TEST(buffer_remove_string_up_to_join){
      ce_buffer_load_string(&buffer, g_multiline_string, g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){8, 0}, 3));
      EXPECT(buffer.line_count == 2);
-     EXPECT(strcmp(buffer.lines[0], "01234567abcdefghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "01234567abcdefghij") == 0);
 }
 
 TEST(buffer_remove_string_join_plus){
@@ -301,7 +1212,7 @@ TEST(buffer_remove_string_join_plus){
      ce_buffer_load_string(&buffer, g_multiline_string, g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){10, 0}, 5));
      EXPECT(buffer.line_count == 2);
-     EXPECT(strcmp(buffer.lines[0], "0123456789efghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "0123456789efghij") == 0);
 }
 
 TEST(buffer_remove_string_join_minus){
@@ -309,7 +1220,7 @@ TEST(buffer_remove_string_join_minus){
      ce_buffer_load_string(&buffer, g_multiline_string, g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){8, 0}, 5));
      EXPECT(buffer.line_count == 2);
-     EXPECT(strcmp(buffer.lines[0], "01234567cdefghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "01234567cdefghij") == 0);
 }
 
 TEST(buffer_remove_string_empty_line){
@@ -317,8 +1228,8 @@ TEST(buffer_remove_string_empty_line){
      ce_buffer_load_string(&buffer, g_multiline_string_with_empty_line, g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){0, 1}, 1));
      EXPECT(buffer.line_count == 3);
-     EXPECT(strcmp(buffer.lines[0], "0123456789") == 0);
-     EXPECT(strcmp(buffer.lines[1], "abcdefghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "0123456789") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "abcdefghij") == 0);
 }
 
 TEST(buffer_remove_string_empty_line_plus){
@@ -326,8 +1237,8 @@ TEST(buffer_remove_string_empty_line_plus){
      ce_buffer_load_string(&buffer, g_multiline_string_with_empty_line, g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){0, 1}, 3));
      EXPECT(buffer.line_count == 3);
-     EXPECT(strcmp(buffer.lines[0], "0123456789") == 0);
-     EXPECT(strcmp(buffer.lines[1], "cdefghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "0123456789") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "cdefghij") == 0);
 }
 
 TEST(buffer_remove_string_empty_line_minus){
@@ -335,7 +1246,7 @@ TEST(buffer_remove_string_empty_line_minus){
      ce_buffer_load_string(&buffer, g_multiline_string_with_empty_line, g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){8, 0}, 5));
      EXPECT(buffer.line_count == 2);
-     EXPECT(strcmp(buffer.lines[0], "01234567bcdefghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "01234567bcdefghij") == 0);
 }
 
 TEST(buffer_remove_string_last_empty_line){
@@ -344,9 +1255,9 @@ TEST(buffer_remove_string_last_empty_line){
      ce_buffer_insert_string(&buffer, "\n", (CePoint_t){10, 2});
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){10, 2}, 1));
      EXPECT(buffer.line_count == 3);
-     EXPECT(strcmp(buffer.lines[0], "0123456789") == 0);
-     EXPECT(strcmp(buffer.lines[1], "abcdefghij") == 0);
-     EXPECT(strcmp(buffer.lines[2], "klmnopqrst") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "0123456789") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 1), "abcdefghij") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 2), "klmnopqrst") == 0);
 }
 
 TEST(buffer_remove_string_end_of_line_to_beginning_of_line){
@@ -354,7 +1265,7 @@ TEST(buffer_remove_string_end_of_line_to_beginning_of_line){
      ce_buffer_load_string(&buffer, "if(a){\n   int tacos = 5;\n}", g_name);
      EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){6, 0}, 19));
      EXPECT(buffer.line_count == 1);
-     EXPECT(strcmp(buffer.lines[0], "if(a){}") == 0);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), "if(a){}") == 0);
 }
 
 TEST(buffer_dupe_string_portion_of_line){
@@ -579,10 +1490,438 @@ TEST(util_visible_index_to_string_index){
      EXPECT(ce_util_visible_index_to_string_index(tabbed_string, 33, tab_width) == 12);
 }
 
+TEST(buffer_line_rune_cache){
+     // build a line long enough to have checkpoints, with multi-byte runes sprinkled throughout
+     char line[1024] = {};
+     for(int64_t i = 0; i < 200; i++){
+          strcat(line, (i % 3 == 0) ? "¢" : "a");
+     }
+
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, line, g_name));
+     EXPECT(ce_buffer_line_len(&buffer, 0) == 200);
+     EXPECT(ce_buffer_get_rune(&buffer, (CePoint_t){150, 0}) == 0xA2);
+     EXPECT(ce_buffer_get_rune(&buffer, (CePoint_t){151, 0}) == 'a');
+     EXPECT(ce_buffer_line_rune_index(&buffer, 0, ce_buffer_line_iterate_to(&buffer, 0, 130)) == 130);
+     EXPECT(ce_buffer_line_iterate_to(&buffer, 0, 200) == ce_buffer_line(&buffer, 0) + strlen(ce_buffer_line(&buffer, 0)));
+     EXPECT(ce_buffer_line_iterate_to(&buffer, 0, 201) == NULL);
+
+     // editing the line has to invalidate the cache
+     EXPECT(ce_buffer_insert_string(&buffer, "b", (CePoint_t){10, 0}));
+     EXPECT(ce_buffer_line_len(&buffer, 0) == 201);
+     EXPECT(ce_buffer_get_rune(&buffer, (CePoint_t){151, 0}) == 0xA2);
+
+     EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){10, 0}, 1));
+     EXPECT(ce_buffer_line_len(&buffer, 0) == 200);
+     EXPECT(ce_buffer_get_rune(&buffer, (CePoint_t){150, 0}) == 0xA2);
+
+     // splitting the line
+     EXPECT(ce_buffer_insert_string(&buffer, "\n", (CePoint_t){99, 0}));
+     EXPECT(buffer.line_count == 2);
+     EXPECT(ce_buffer_line_len(&buffer, 0) == 99);
+     EXPECT(ce_buffer_line_len(&buffer, 1) == 101);
+     EXPECT(ce_buffer_get_rune(&buffer, (CePoint_t){51, 1}) == 0xA2);
+
+     // and joining it back up
+     EXPECT(ce_buffer_remove_string(&buffer, (CePoint_t){99, 0}, 1));
+     EXPECT(buffer.line_count == 1);
+     EXPECT(ce_buffer_line_len(&buffer, 0) == 200);
+     EXPECT(strcmp(ce_buffer_line(&buffer, 0), line) == 0);
+
+     ce_buffer_free(&buffer);
+}
+
+static void syntax_defs_init(CeSyntaxDef_t* syntax_defs){
+     for(int64_t i = 0; i < CE_SYNTAX_COLOR_COUNT; i++){
+          syntax_defs[i].fg = i + 1;
+          syntax_defs[i].bg = CE_COLOR_DEFAULT;
+     }
+     syntax_defs[CE_SYNTAX_COLOR_NORMAL].fg = CE_COLOR_DEFAULT;
+}
+
+// the fg color the highlighter left in effect at the start of the view
+static int syntax_view_start_fg(CeView_t* view, CeSyntaxHighlightFunc_t* highlight, CeSyntaxDef_t* syntax_defs){
+     CeRangeList_t range_list = {};
+     CeDrawColorList_t draw_color_list = {};
+     highlight(view, &range_list, &draw_color_list, syntax_defs, NULL);
+     int fg = CE_COLOR_DEFAULT;
+     if(draw_color_list.count > 0 && draw_color_list.colors[0].point.x == 0 && draw_color_list.colors[0].point.y == view->scroll.y){
+          fg = draw_color_list.colors[0].fg;
+     }
+     ce_draw_color_list_free(&draw_color_list);
+     return fg;
+}
+
+static bool syntax_highlight_matches_fresh(CeView_t* view, CeSyntaxHighlightFunc_t* highlight, CeSyntaxDef_t* syntax_defs){
+     char* text = ce_buffer_dupe(view->buffer);
+     CeBuffer_t fresh = {};
+     ce_buffer_load_string(&fresh, text, g_name);
+     free(text);
+     CeView_t fresh_view = *view;
+     fresh_view.buffer = &fresh;
+
+     CeRangeList_t range_list = {};
+     CeDrawColorList_t draw_color_list = {};
+     CeDrawColorList_t fresh_draw_color_list = {};
+     highlight(view, &range_list, &draw_color_list, syntax_defs, NULL);
+     highlight(&fresh_view, &range_list, &fresh_draw_color_list, syntax_defs, NULL);
+
+     bool same = (draw_color_list.count == fresh_draw_color_list.count);
+     for(int64_t i = 0; same && i < draw_color_list.count; i++){
+          CeDrawColor_t* a = draw_color_list.colors + i;
+          CeDrawColor_t* b = fresh_draw_color_list.colors + i;
+          same = (a->fg == b->fg && a->bg == b->bg && ce_points_equal(a->point, b->point));
+     }
+
+     ce_draw_color_list_free(&draw_color_list);
+     ce_draw_color_list_free(&fresh_draw_color_list);
+     ce_syntax_cache_free(&fresh);
+     ce_buffer_free(&fresh);
+     return same;
+}
+
+TEST(syntax_cache_follows_changes){
+     CeSyntaxDef_t syntax_defs[CE_SYNTAX_COLOR_COUNT];
+     syntax_defs_init(syntax_defs);
+
+     // a comment longer than any fixed look back
+     int64_t comment_line_count = 3000;
+     char* string = malloc((comment_line_count * 4) + 64);
+     char* itr = string;
+     itr += sprintf(itr, "int a;\n/*\n");
+     for(int64_t i = 0; i < comment_line_count; i++) itr += sprintf(itr, "if\n");
+     sprintf(itr, "*/\nint b;");
+
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, string, g_name));
+     free(string);
+
+     CeView_t view = {};
+     view.buffer = &buffer;
+     view.rect = (CeRect_t){0, 79, 0, 9};
+     view.scroll.y = comment_line_count;
+     int comment_fg = syntax_defs[CE_SYNTAX_COLOR_COMMENT].fg;
+     EXPECT(syntax_view_start_fg(&view, ce_syntax_highlight_c, syntax_defs) == comment_fg);
+
+     // closing the comment early is seen from far below
+     CePoint_t cursor = {};
+     EXPECT(ce_buffer_insert_string_change(&buffer, strdup("*/"), (CePoint_t){2, 2}, &cursor, (CePoint_t){4, 2}, false));
+     EXPECT(syntax_view_start_fg(&view, ce_syntax_highlight_c, syntax_defs) != comment_fg);
+     EXPECT(ce_buffer_undo(&buffer, &cursor));
+     EXPECT(syntax_view_start_fg(&view, ce_syntax_highlight_c, syntax_defs) == comment_fg);
+
+     // edits from all over keep the cached state in line with highlighting from scratch
+     const char* strings[] = {"/*", "*/", "\n", "x", "\"/*\"", "// /*", "  ", "\n/* a\nb */\n"};
+     int64_t string_count = sizeof(strings) / sizeof(strings[0]);
+     srand(11);
+     for(int64_t i = 0; i < 300; i++){
+          int64_t y = rand() % buffer.line_count;
+          int64_t line_len = ce_utf8_strlen(ce_buffer_line(&buffer, y));
+          CePoint_t point = {line_len ? rand() % (line_len + 1) : 0, y};
+
+          switch(rand() % 5){
+          default:
+               ce_buffer_insert_string_change(&buffer, strdup(strings[rand() % string_count]), point, &cursor, point,
+                                              rand() % 2);
+               break;
+          case 2:
+               if(ce_buffer_range_len(&buffer, point, ce_buffer_end_point(&buffer)) > 3){
+                    ce_buffer_remove_string_change(&buffer, point, 1 + rand() % 3, &cursor, point, rand() % 2);
+               }
+               break;
+          case 3:
+               ce_buffer_undo(&buffer, &cursor);
+               break;
+          case 4:
+               // edits that don't record a change start the cache over
+               if(rand() % 4 == 0) ce_buffer_insert_string(&buffer, "/*", point);
+               else ce_buffer_redo(&buffer, &cursor);
+               break;
+          }
+
+          view.cursor = point;
+          view.scroll.y = (rand() % 2) ? rand() % buffer.line_count : (y > 4 ? y - 4 : 0);
+          if(!syntax_highlight_matches_fresh(&view, ce_syntax_highlight_c, syntax_defs)){
+               EXPECT(!"syntax cache is out of sync with the buffer");
+               break;
+          }
+     }
+
+     ce_syntax_cache_free(&buffer);
+     ce_buffer_free(&buffer);
+}
+
+TEST(syntax_python_docstring_state){
+     CeSyntaxDef_t syntax_defs[CE_SYNTAX_COLOR_COUNT];
+     syntax_defs_init(syntax_defs);
+
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, "def f():\n    \"\"\"doc\n    string\n    \"\"\"\n    return 1", g_name));
+
+     CeView_t view = {};
+     view.buffer = &buffer;
+     view.rect = (CeRect_t){0, 79, 0, 0};
+     view.scroll.y = 2;
+     EXPECT(syntax_view_start_fg(&view, ce_syntax_highlight_python, syntax_defs) == syntax_defs[CE_SYNTAX_COLOR_STRING].fg);
+     view.scroll.y = 4;
+     EXPECT(syntax_view_start_fg(&view, ce_syntax_highlight_python, syntax_defs) != syntax_defs[CE_SYNTAX_COLOR_STRING].fg);
+
+     ce_syntax_cache_free(&buffer);
+     ce_buffer_free(&buffer);
+}
+
+static int syntax_fg_at(CeDrawColorList_t* draw_color_list, CePoint_t point){
+     int fg = CE_COLOR_DEFAULT;
+     for(int64_t i = 0; i < draw_color_list->count; i++){
+          if(ce_point_after(draw_color_list->colors[i].point, point)) break;
+          fg = draw_color_list->colors[i].fg;
+     }
+     return fg;
+}
+
+TEST(syntax_tokens_after_multibyte_runes){
+     CeSyntaxDef_t syntax_defs[CE_SYNTAX_COLOR_COUNT];
+     syntax_defs_init(syntax_defs);
+
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, "s = \"hééllo\"; int café_t; /* é */ return", g_name));
+
+     CeView_t view = {};
+     view.buffer = &buffer;
+     view.rect = (CeRect_t){0, 79, 0, 0};
+
+     CeRangeList_t range_list = {};
+     CeDrawColorList_t draw_color_list = {};
+     ce_syntax_highlight_c(&view, &range_list, &draw_color_list, syntax_defs, NULL);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){4, 0}) == syntax_defs[CE_SYNTAX_COLOR_STRING].fg);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){11, 0}) == syntax_defs[CE_SYNTAX_COLOR_STRING].fg);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){12, 0}) == CE_COLOR_DEFAULT);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){14, 0}) == syntax_defs[CE_SYNTAX_COLOR_TYPE].fg);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){18, 0}) == CE_COLOR_DEFAULT);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){26, 0}) == syntax_defs[CE_SYNTAX_COLOR_COMMENT].fg);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){34, 0}) == syntax_defs[CE_SYNTAX_COLOR_CONTROL].fg);
+     ce_draw_color_list_free(&draw_color_list);
+
+     ce_syntax_cache_free(&buffer);
+     ce_buffer_free(&buffer);
+}
+
+TEST(syntax_keywords_match_whole_identifiers){
+     CeSyntaxDef_t syntax_defs[CE_SYNTAX_COLOR_COUNT];
+     syntax_defs_init(syntax_defs);
+
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, "assert as asserts xas done", g_name));
+
+     CeView_t view = {};
+     view.buffer = &buffer;
+     view.rect = (CeRect_t){0, 79, 0, 0};
+
+     // a keyword that starts with a shorter one, like "as" and "assert", still matches
+     CeRangeList_t range_list = {};
+     CeDrawColorList_t draw_color_list = {};
+     int keyword_fg = syntax_defs[CE_SYNTAX_COLOR_KEYWORD].fg;
+     ce_syntax_highlight_python(&view, &range_list, &draw_color_list, syntax_defs, NULL);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){0, 0}) == keyword_fg);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){7, 0}) == keyword_fg);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){10, 0}) == CE_COLOR_DEFAULT);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){18, 0}) == CE_COLOR_DEFAULT);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){22, 0}) == CE_COLOR_DEFAULT);
+     ce_draw_color_list_free(&draw_color_list);
+
+     ce_syntax_highlight_bash(&view, &range_list, &draw_color_list, syntax_defs, NULL);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){22, 0}) == keyword_fg);
+     ce_draw_color_list_free(&draw_color_list);
+
+     ce_syntax_cache_free(&buffer);
+     ce_buffer_free(&buffer);
+}
+
+TEST(range_list_insert_sorted){
+     CeRangeList_t range_list = {};
+     EXPECT(ce_range_list_insert_sorted(&range_list, (CePoint_t){4, 1}, (CePoint_t){6, 1}));
+     EXPECT(ce_range_list_insert_sorted(&range_list, (CePoint_t){0, 0}, (CePoint_t){3, 0}));
+     EXPECT(ce_range_list_insert_sorted(&range_list, (CePoint_t){0, 3}, (CePoint_t){2, 4}));
+     EXPECT(ce_range_list_insert_sorted(&range_list, (CePoint_t){5, 0}, (CePoint_t){3, 1}));
+
+     // overlapping the ranges on either side isn't allowed
+     EXPECT(!ce_range_list_insert_sorted(&range_list, (CePoint_t){3, 0}, (CePoint_t){4, 0}));
+     EXPECT(!ce_range_list_insert_sorted(&range_list, (CePoint_t){7, 1}, (CePoint_t){0, 3}));
+
+     EXPECT(range_list.count == 4);
+     EXPECT(ce_points_equal(range_list.ranges[0].start, (CePoint_t){0, 0}));
+     EXPECT(ce_points_equal(range_list.ranges[1].start, (CePoint_t){5, 0}));
+     EXPECT(ce_points_equal(range_list.ranges[2].start, (CePoint_t){4, 1}));
+     EXPECT(ce_points_equal(range_list.ranges[3].start, (CePoint_t){0, 3}));
+     ce_range_list_free(&range_list);
+}
+
+TEST(syntax_draw_lists_reused_between_frames){
+     CeSyntaxDef_t syntax_defs[CE_SYNTAX_COLOR_COUNT];
+     syntax_defs_init(syntax_defs);
+
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, "int main(){\n     return 0; // done\n}\n\"str\" 0x5", g_name));
+
+     CeView_t view = {};
+     view.buffer = &buffer;
+     view.rect = (CeRect_t){0, 79, 0, 9};
+
+     CeRangeList_t range_list = {};
+     CeDrawColorList_t draw_color_list = {};
+     ce_range_list_insert(&range_list, (CePoint_t){5, 1}, (CePoint_t){2, 2});
+     ce_syntax_highlight_c(&view, &range_list, &draw_color_list, syntax_defs, NULL);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){7, 1}) == syntax_defs[CE_SYNTAX_COLOR_VISUAL].fg);
+     EXPECT(syntax_fg_at(&draw_color_list, (CePoint_t){0, 3}) == syntax_defs[CE_SYNTAX_COLOR_STRING].fg);
+
+     // the next frame fills the same memory
+     CeDrawColor_t* colors = draw_color_list.colors;
+     int64_t count = draw_color_list.count;
+     int64_t capacity = draw_color_list.capacity;
+     ce_draw_color_list_clear(&draw_color_list);
+     ce_syntax_highlight_c(&view, &range_list, &draw_color_list, syntax_defs, NULL);
+     EXPECT(draw_color_list.colors == colors);
+     EXPECT(draw_color_list.count == count);
+     EXPECT(draw_color_list.capacity == capacity);
+
+     ce_draw_color_list_free(&draw_color_list);
+     ce_range_list_free(&range_list);
+     ce_syntax_cache_free(&buffer);
+     ce_buffer_free(&buffer);
+}
+
+// waits for the background lexer to say it has lines, then takes them
+static bool syntax_background_wait(int ready_fd){
+     struct pollfd poll_fd = {ready_fd, POLLIN, 0};
+     if(poll(&poll_fd, 1, 5000) <= 0) return false;
+     char bytes[64];
+     if(read(ready_fd, bytes, sizeof(bytes)) <= 0) return false;
+     ce_syntax_background_update();
+     return true;
+}
+
+TEST(syntax_background_lexes_ahead_of_view){
+     CeSyntaxDef_t syntax_defs[CE_SYNTAX_COLOR_COUNT];
+     syntax_defs_init(syntax_defs);
+
+     int ready_fds[2];
+     EXPECT(pipe(ready_fds) == 0);
+     EXPECT(ce_syntax_background_start(ready_fds[1]));
+
+     // a comment too long to lex above the view while drawing
+     int64_t comment_line_count = CE_SYNTAX_SYNC_LEX_LINES * 5;
+     char* string = malloc((comment_line_count * 3) + 64);
+     char* itr = string;
+     itr += sprintf(itr, "int a;\n/*\n");
+     for(int64_t i = 0; i < comment_line_count; i++) itr += sprintf(itr, "if\n");
+     sprintf(itr, "*/\nint b;");
+
+     CeBuffer_t buffer = {};
+     EXPECT(ce_buffer_load_string(&buffer, string, g_name));
+
+     CeView_t view = {};
+     view.buffer = &buffer;
+     view.rect = (CeRect_t){0, 79, 0, 9};
+     view.scroll.y = comment_line_count;
+     int comment_fg = syntax_defs[CE_SYNTAX_COLOR_COMMENT].fg;
+
+     // the view is drawn right away without knowing it's in a comment, then again once the lexer catches up
+     EXPECT(syntax_view_start_fg(&view, ce_syntax_highlight_c, syntax_defs) != comment_fg);
+     CeSyntaxCache_t* cache = buffer.syntax_cache;
+     while(cache->valid_line_count <= view.scroll.y){
+          if(!syntax_background_wait(ready_fds[0])) break;
+     }
+     EXPECT(syntax_view_start_fg(&view, ce_syntax_highlight_c, syntax_defs) == comment_fg);
+
+     // it keeps going past the view
+     while(cache->valid_line_count < buffer.line_count){
+          if(!syntax_background_wait(ready_fds[0])) break;
+     }
+     EXPECT(cache->valid_line_count == buffer.line_count);
+
+     // lines lexed for a buffer that went away in the meantime are dropped
+     CeBuffer_t other_buffer = {};
+     EXPECT(ce_buffer_load_string(&other_buffer, string, g_name));
+     free(string);
+     CeView_t other_view = view;
+     other_view.buffer = &other_buffer;
+     syntax_view_start_fg(&other_view, ce_syntax_highlight_c, syntax_defs);
+     ce_syntax_cache_free(&other_buffer);
+     ce_buffer_free(&other_buffer);
+     EXPECT(syntax_background_wait(ready_fds[0]));
+
+     // as are lines lexed for a buffer that changed in the meantime
+     CePoint_t cursor = {};
+     EXPECT(ce_buffer_insert_string_change(&buffer, strdup("*/"), (CePoint_t){0, 2}, &cursor, (CePoint_t){2, 2}, false));
+     syntax_view_start_fg(&view, ce_syntax_highlight_c, syntax_defs);
+     EXPECT(ce_buffer_insert_string_change(&buffer, strdup(" "), (CePoint_t){0, 3}, &cursor, (CePoint_t){1, 3}, false));
+     EXPECT(syntax_background_wait(ready_fds[0]));
+     EXPECT(cache->valid_line_count <= 3);
+     while(cache->valid_line_count <= view.scroll.y){
+          if(!syntax_background_wait(ready_fds[0])) break;
+     }
+     EXPECT(syntax_view_start_fg(&view, ce_syntax_highlight_c, syntax_defs) != comment_fg);
+
+     ce_syntax_background_stop();
+     EXPECT(syntax_highlight_matches_fresh(&view, ce_syntax_highlight_c, syntax_defs));
+
+     close(ready_fds[0]);
+     close(ready_fds[1]);
+     ce_syntax_cache_free(&buffer);
+     ce_buffer_free(&buffer);
+}
+
+TEST(profile_percentile){
+     uint64_t samples[100];
+     for(int64_t i = 0; i < 100; i++) samples[i] = 100 - i;
+     EXPECT(ce_profile_percentile(samples, 100, 50) == 50);
+     EXPECT(ce_profile_percentile(samples, 100, 99) == 99);
+     EXPECT(ce_profile_percentile(samples, 100, 100) == 100);
+
+     uint64_t one_sample = 7;
+     EXPECT(ce_profile_percentile(&one_sample, 1, 50) == 7);
+     EXPECT(ce_profile_percentile(&one_sample, 1, 99) == 7);
+     EXPECT(ce_profile_percentile(NULL, 0, 50) == 0);
+}
+
+TEST(profile_stage_stats_only_count_frames_the_stage_ran_in){
+     ce_profile_reset();
+
+     for(int64_t i = 0; i < 10; i++){
+          CeProfileTimer_t timer = ce_profile_begin(CE_PROFILE_STAGE_DRAW);
+          if(i % 2 == 0){
+               CeProfileTimer_t syntax_timer = ce_profile_begin(CE_PROFILE_STAGE_SYNTAX);
+               ce_profile_end(&syntax_timer);
+          }
+          ce_profile_end(&timer);
+          ce_profile_frame_end();
+     }
+
+     // the frame still being recorded doesn't count
+     CeProfileTimer_t timer = ce_profile_begin(CE_PROFILE_STAGE_HANDLE_KEY);
+     ce_profile_end(&timer);
+
+     EXPECT(ce_profile_frame_count() == 10);
+     EXPECT(ce_profile_stage_stats(CE_PROFILE_STAGE_DRAW).frame_count == 10);
+     EXPECT(ce_profile_stage_stats(CE_PROFILE_STAGE_SYNTAX).frame_count == 5);
+     EXPECT(ce_profile_stage_stats(CE_PROFILE_STAGE_HANDLE_KEY).frame_count == 0);
+
+     CeProfileStageStats_t stats = ce_profile_stage_stats(CE_PROFILE_STAGE_DRAW);
+     EXPECT(stats.p50_usec <= stats.p99_usec);
+     EXPECT(stats.p99_usec <= stats.max_usec);
+
+     // the ring keeps the most recent frames once it wraps
+     for(int64_t i = 0; i < CE_PROFILE_FRAME_COUNT * 2; i++) ce_profile_frame_end();
+     EXPECT(ce_profile_frame_count() == CE_PROFILE_FRAME_COUNT - 1);
+     EXPECT(ce_profile_stage_stats(CE_PROFILE_STAGE_DRAW).frame_count == 0);
+
+     ce_profile_reset();
+}
+
 int main()
 {
      printf("we out here\n");
-     g_ce_log_buffer = malloc(sizeof(*g_ce_log_buffer));
+     g_ce_log_buffer = calloc(1, sizeof(*g_ce_log_buffer));
      ce_buffer_alloc(g_ce_log_buffer, 1, "[log]");
      ce_log_init("ce_test.log");
      setlocale(LC_ALL, "");
@@ -0,0 +1,157 @@
+#include "test.h"
+#include "ce.h"
+#include "ce_clangd_reader.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+// what a read() off clangd's stdout would have done
+static void reader_feed(CeClangDReader_t* reader, CeClangDStats_t* stats, const char* bytes, int64_t size){
+     while(size > 0){
+          ce_clangd_reader_reserve(reader, size);
+          char* dest = NULL;
+          int64_t span = ce_clangd_reader_free_span(reader, &dest);
+          if(span > size) span = size;
+          memcpy(dest, bytes, span);
+          ce_clangd_reader_commit(reader, span, stats);
+          bytes += span;
+          size -= span;
+     }
+}
+
+TEST(reader_messages_in_one_read){
+     CeClangDReader_t reader;
+     ce_clangd_reader_init(&reader);
+     CeClangDStats_t stats = {};
+
+     const char* bytes = "Content-Length: 7\r\n\r\n{\"a\":1}Content-Length: 2\r\n\r\n{}Content-Length: 7\r\n\r\n{\"b\":2}";
+     reader_feed(&reader, &stats, bytes, strlen(bytes));
+
+     const char* expected[] = {"{\"a\":1}", "{}", "{\"b\":2}"};
+     for(int i = 0; i < 3; i++){
+          char* message = ce_clangd_reader_next_message(&reader, &stats);
+          EXPECT(message && strcmp(message, expected[i]) == 0);
+          free(message);
+     }
+     EXPECT(ce_clangd_reader_next_message(&reader, &stats) == NULL);
+     EXPECT(stats.messages_read == 3);
+     EXPECT(stats.messages_dropped == 0);
+     EXPECT(stats.bytes_read == strlen(bytes));
+     EXPECT(reader.count == 0);
+     ce_clangd_reader_free(&reader);
+}
+
+TEST(reader_header_split_across_reads){
+     CeClangDReader_t reader;
+     ce_clangd_reader_init(&reader);
+     CeClangDStats_t stats = {};
+
+     // a byte at a time, so every part of the header and body ends a read at some point
+     const char* bytes = "Content-Length: 11\r\n\r\n{\"id\":1234}";
+     int64_t length = strlen(bytes);
+     int64_t message_count = 0;
+     for(int64_t i = 0; i < length; i++){
+          reader_feed(&reader, &stats, bytes + i, 1);
+          char* message = ce_clangd_reader_next_message(&reader, &stats);
+          if(message){
+               EXPECT(i == length - 1);
+               EXPECT(strcmp(message, "{\"id\":1234}") == 0);
+               message_count++;
+               free(message);
+          }
+     }
+     EXPECT(message_count == 1);
+     EXPECT(stats.bytes_skipped == 0);
+     ce_clangd_reader_free(&reader);
+}
+
+TEST(reader_skips_junk_between_messages){
+     CeClangDReader_t reader;
+     ce_clangd_reader_init(&reader);
+     CeClangDStats_t stats = {};
+
+     // clangd's log shares the pipe, and a header that starts in the junk has to survive the read boundary
+     const char* first = "I[12:00:00.000] clangd started\nContent-Length: 2\r\n\r\n{}V[12:00:00.001] indexing\nContent-Le";
+     const char* second = "ngth: 2\r\n\r\n[]trailing log";
+     reader_feed(&reader, &stats, first, strlen(first));
+
+     char* message = ce_clangd_reader_next_message(&reader, &stats);
+     EXPECT(message && strcmp(message, "{}") == 0);
+     free(message);
+     EXPECT(ce_clangd_reader_next_message(&reader, &stats) == NULL);
+
+     reader_feed(&reader, &stats, second, strlen(second));
+     message = ce_clangd_reader_next_message(&reader, &stats);
+     EXPECT(message && strcmp(message, "[]") == 0);
+     free(message);
+     EXPECT(ce_clangd_reader_next_message(&reader, &stats) == NULL);
+
+     EXPECT(stats.messages_read == 2);
+     EXPECT(stats.messages_dropped == 0);
+     // the trailing log is too short to rule out a header yet, so it is kept rather than skipped
+     EXPECT(stats.bytes_skipped == strlen("I[12:00:00.000] clangd started\n") + strlen("V[12:00:00.001] indexing\n"));
+     ce_clangd_reader_free(&reader);
+}
+
+TEST(reader_drops_oversized_content_length){
+     CeClangDReader_t reader;
+     ce_clangd_reader_init(&reader);
+     CeClangDStats_t stats = {};
+
+     // the bad header is dropped rather than reserved for, and the body behind it is skipped like any other junk
+     char bytes[256];
+     int length = snprintf(bytes, sizeof(bytes), "Content-Length: %" PRId64 "\r\n\r\n{\"huge\":true}Content-Length: 2\r\n\r\n{}",
+                           (int64_t)(CE_CLANGD_MAX_MESSAGE_SIZE) + 1);
+     reader_feed(&reader, &stats, bytes, length);
+
+     char* message = ce_clangd_reader_next_message(&reader, &stats);
+     EXPECT(message && strcmp(message, "{}") == 0);
+     free(message);
+     EXPECT(stats.messages_read == 1);
+     EXPECT(stats.messages_dropped == 1);
+     EXPECT(reader.capacity < CE_CLANGD_MAX_MESSAGE_SIZE);
+
+     // so is one that isn't a number at all
+     const char* bad = "Content-Length: lots\r\n\r\nContent-Length: 2\r\n\r\n[]";
+     reader_feed(&reader, &stats, bad, strlen(bad));
+     message = ce_clangd_reader_next_message(&reader, &stats);
+     EXPECT(message && strcmp(message, "[]") == 0);
+     free(message);
+     EXPECT(stats.messages_dropped == 2);
+     ce_clangd_reader_free(&reader);
+}
+
+TEST(reader_message_wraps_the_ring){
+     CeClangDReader_t reader;
+     ce_clangd_reader_init(&reader);
+     CeClangDStats_t stats = {};
+
+     // keep the next header in the ring as we frame each message, so it never empties and resets, and the messages
+     // start landing across its end
+     char body[1000];
+     memset(body, 'x', sizeof(body));
+     body[0] = '"';
+     body[sizeof(body) - 1] = '"';
+     char header[64];
+     int header_len = snprintf(header, sizeof(header), "Content-Length: %d\r\n\r\n", (int)(sizeof(body)));
+     reader_feed(&reader, &stats, header, header_len);
+     for(int i = 0; i < 500; i++){
+          reader_feed(&reader, &stats, body, sizeof(body));
+          reader_feed(&reader, &stats, header, header_len);
+          char* message = ce_clangd_reader_next_message(&reader, &stats);
+          EXPECT(message && strlen(message) == sizeof(body) && memcmp(message, body, sizeof(body)) == 0);
+          free(message);
+     }
+     EXPECT(stats.bytes_read > 2 * (uint64_t)(reader.capacity));
+     EXPECT(stats.messages_read == 500);
+     EXPECT(reader.count == header_len);
+     ce_clangd_reader_free(&reader);
+}
+
+int main(){
+     g_ce_log_buffer = calloc(1, sizeof(*g_ce_log_buffer));
+     ce_buffer_alloc(g_ce_log_buffer, 1, "[log]");
+     ce_log_init("ce_test_clangd_reader.log");
+     RUN_TESTS();
+}
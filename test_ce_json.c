@@ -1,8 +1,11 @@
 // gcc -Wall -Werror -std=gnu11 -ggdb3 ce_json.c test_ce_json.c -o test_ce_json
 #include "ce_json.h"
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 #define PRINT_LEN (1024 * 1024)
 
@@ -13,6 +16,89 @@ void print_obj(CeJsonObj_t* obj){
      free(printed_obj);
 }
 
+static double elapsed_ms(struct timespec start){
+     struct timespec end;
+     clock_gettime(CLOCK_MONOTONIC, &end);
+     return (double)(end.tv_sec - start.tv_sec) * 1000.0 + (double)(end.tv_nsec - start.tv_nsec) / 1000000.0;
+}
+
+// a completion response shaped like the ones clangd sends, with at least min_size bytes of items
+static char* build_completion_response(uint64_t min_size, int64_t* item_count){
+     CeJsonWriter_t writer = {};
+     ce_json_writer_begin_obj(&writer, NULL);
+     ce_json_writer_string(&writer, "jsonrpc", "2.0");
+     ce_json_writer_int(&writer, "id", 7);
+     ce_json_writer_begin_obj(&writer, "result");
+     ce_json_writer_boolean(&writer, "isIncomplete", false);
+     ce_json_writer_begin_array(&writer, "items");
+     *item_count = 0;
+     while(writer.length < min_size){
+          char label[64];
+          char insert_text[64];
+          snprintf(label, sizeof(label), " symbol_%" PRId64 "(int a, char* b)", *item_count);
+          snprintf(insert_text, sizeof(insert_text), "symbol_%" PRId64, *item_count);
+          ce_json_writer_begin_obj(&writer, NULL);
+          ce_json_writer_string(&writer, "label", label);
+          ce_json_writer_int(&writer, "kind", 3);
+          ce_json_writer_string(&writer, "detail", "int");
+          ce_json_writer_string(&writer, "insertText", insert_text);
+          ce_json_writer_int(&writer, "insertTextFormat", 2);
+          ce_json_writer_string(&writer, "filterText", insert_text);
+          ce_json_writer_string(&writer, "sortText", "3f7c0000symbol");
+          ce_json_writer_begin_obj(&writer, "textEdit");
+          ce_json_writer_begin_obj(&writer, "range");
+          ce_json_writer_begin_obj(&writer, "start");
+          ce_json_writer_int(&writer, "line", 120);
+          ce_json_writer_int(&writer, "character", 4);
+          ce_json_writer_end_obj(&writer);
+          ce_json_writer_begin_obj(&writer, "end");
+          ce_json_writer_int(&writer, "line", 120);
+          ce_json_writer_int(&writer, "character", 7);
+          ce_json_writer_end_obj(&writer);
+          ce_json_writer_end_obj(&writer);
+          ce_json_writer_string(&writer, "newText", insert_text);
+          ce_json_writer_end_obj(&writer);
+          ce_json_writer_begin_obj(&writer, "documentation");
+          ce_json_writer_string(&writer, "kind", "plaintext");
+          ce_json_writer_string(&writer, "value", "Does \"things\"\nwith a and b");
+          ce_json_writer_end_obj(&writer);
+          ce_json_writer_number(&writer, "score", 1.25);
+          ce_json_writer_end_obj(&writer);
+          (*item_count)++;
+     }
+     ce_json_writer_end_array(&writer);
+     ce_json_writer_end_obj(&writer);
+     ce_json_writer_end_obj(&writer);
+     return writer.string;
+}
+
+// looks up what the completion handling in ce_app.c does for every item
+static int64_t walk_completion_items(CeJsonObj_t* obj){
+     CeJsonFindResult_t result_find = ce_json_obj_find(obj, "result");
+     CeJsonObj_t* result_obj = ce_json_obj_get_obj(obj, &result_find);
+     if(result_obj == NULL){
+          return -1;
+     }
+     CeJsonFindResult_t items_find = ce_json_obj_find(result_obj, "items");
+     CeJsonArray_t* items_array = ce_json_obj_get_array(result_obj, &items_find);
+     if(items_array == NULL){
+          return -1;
+     }
+     int64_t found = 0;
+     for(int64_t i = 0; i < items_array->count; i++){
+          CeJsonObj_t* item = &items_array->values[i].obj;
+          CeJsonFindResult_t insert_text_find = ce_json_obj_find(item, "insertText");
+          CeJsonFindResult_t label_find = ce_json_obj_find(item, "label");
+          CeJsonFindResult_t detail_find = ce_json_obj_find(item, "detail");
+          if(ce_json_obj_get_string(item, &insert_text_find) &&
+             ce_json_obj_get_string(item, &label_find) &&
+             ce_json_obj_get_string(item, &detail_find)){
+               found++;
+          }
+     }
+     return found;
+}
+
 int main(int argc, char** argv){
      bool verbose = false;
 
@@ -43,6 +129,155 @@ int main(int argc, char** argv){
           ce_json_obj_free(&person);
      }
 
+     // Stream an object out without building it first.
+     {
+          CeJsonWriter_t writer = {};
+          ce_json_writer_begin_obj(&writer, NULL);
+          ce_json_writer_string(&writer, "jsonrpc", "2.0");
+          ce_json_writer_int(&writer, "id", 42);
+          ce_json_writer_begin_obj(&writer, "params");
+          ce_json_writer_string(&writer, "text", "int main(){\n\tputs(\"hi\\n\");\x01\n}");
+          ce_json_writer_begin_array(&writer, "changes");
+          ce_json_writer_number(&writer, NULL, 1.5);
+          ce_json_writer_boolean(&writer, NULL, true);
+          ce_json_writer_null(&writer, NULL);
+          ce_json_writer_begin_obj(&writer, NULL);
+          ce_json_writer_end_obj(&writer);
+          ce_json_writer_end_array(&writer);
+          ce_json_writer_end_obj(&writer);
+          ce_json_writer_end_obj(&writer);
+
+          const char* expected = "{\"jsonrpc\":\"2.0\",\"id\":42,\"params\":{"
+                                 "\"text\":\"int main(){\\n\\tputs(\\\"hi\\\\n\\\");\\u0001\\n}\","
+                                 "\"changes\":[1.5,true,null,{}]}}";
+          printf("written json:\n%s\n\n", writer.string);
+          if(writer.failed || strcmp(writer.string, expected) != 0){
+               printf("expected:\n%s\n", expected);
+               return 1;
+          }
+
+          CeJsonObj_t obj = {};
+          if(!ce_json_parse(writer.string, &obj, verbose)){
+               printf("failed to parse written json\n");
+               return 1;
+          }
+          print_obj(&obj);
+          ce_json_obj_free(&obj);
+
+          // a string bigger than the old fixed size message buffer
+          ce_json_writer_clear(&writer);
+          uint64_t big_len = 17 * 1024 * 1024;
+          char* big = malloc(big_len + 1);
+          memset(big, 'a', big_len);
+          big[big_len] = 0;
+          ce_json_writer_begin_obj(&writer, NULL);
+          ce_json_writer_string(&writer, "text", big);
+          ce_json_writer_end_obj(&writer);
+          free(big);
+          if(writer.failed || writer.length != big_len + strlen("{\"text\":\"\"}")){
+               printf("failed to write a %" PRIu64 " byte string\n", big_len);
+               return 1;
+          }
+          ce_json_writer_free(&writer);
+     }
+
+     // Parse into an arena, strings stay in the text with their escapes.
+     {
+          char json_str[] = "{ \"id\" : -12, \"ratio\" : 2.5e2, \"text\" : \"tab\\there \\\"q\\\" \\u00a2\\ud83d\\ude00\","
+                            "  \"list\" : [ [1, 2], {}, [], true, null ], \"empty\" : {} }";
+          CeJsonArena_t arena = {};
+          CeJsonObj_t obj = {};
+          if(!ce_json_parse_in_place(json_str, &obj, &arena, verbose)){
+               printf("failed to parse into an arena\n");
+               return 1;
+          }
+          CeJsonFindResult_t id_find = ce_json_obj_find(&obj, "id");
+          CeJsonFindResult_t ratio_find = ce_json_obj_find(&obj, "ratio");
+          CeJsonFindResult_t text_find = ce_json_obj_find(&obj, "text");
+          CeJsonFindResult_t list_find = ce_json_obj_find(&obj, "list");
+          double* id = ce_json_obj_get_number(&obj, &id_find);
+          double* ratio = ce_json_obj_get_number(&obj, &ratio_find);
+          char* text = (char*)(ce_json_obj_get_string(&obj, &text_find));
+          CeJsonArray_t* list = ce_json_obj_get_array(&obj, &list_find);
+          if(!id || *id != -12 || !ratio || *ratio != 250 || !text || !list || list->count != 5 ||
+             list->values[0].type != CE_JSON_TYPE_ARRAY || list->values[0].array.count != 2 ||
+             strcmp(text, "tab\\there \\\"q\\\" \\u00a2\\ud83d\\ude00") != 0 ||
+             strcmp(ce_json_unescape(text), "tab\there \"q\" \xC2\xA2\xF0\x9F\x98\x80") != 0){
+               printf("arena parse got the wrong values\n");
+               return 1;
+          }
+          ce_json_arena_free(&arena);
+
+          // big objects find their fields through a hash
+          CeJsonWriter_t writer = {};
+          ce_json_writer_begin_obj(&writer, NULL);
+          for(int64_t i = 0; i < 100; i++){
+               char name[32];
+               snprintf(name, sizeof(name), "field_%" PRId64, i);
+               ce_json_writer_int(&writer, name, i);
+          }
+          ce_json_writer_int(&writer, "field_7", -1);
+          ce_json_writer_end_obj(&writer);
+          if(!ce_json_parse_in_place(writer.string, &obj, &arena, verbose) || obj.lookup == NULL){
+               printf("failed to parse a big object\n");
+               return 1;
+          }
+          for(int64_t i = 0; i < 100; i++){
+               char name[32];
+               snprintf(name, sizeof(name), "field_%" PRId64, i);
+               CeJsonFindResult_t find = ce_json_obj_find(&obj, name);
+               double* number = ce_json_obj_get_number(&obj, &find);
+               if(!number || *number != i || find.index != i){
+                    printf("hashed lookup of %s failed\n", name);
+                    return 1;
+               }
+          }
+          CeJsonFindResult_t missing_find = ce_json_obj_find(&obj, "field_100");
+          if(missing_find.type != CE_JSON_TYPE_NONE){
+               printf("hashed lookup found a field that isn't there\n");
+               return 1;
+          }
+          ce_json_arena_free(&arena);
+          ce_json_writer_free(&writer);
+     }
+
+     // Parse a big completion response both ways.
+     {
+          int64_t item_count = 0;
+          char* response = build_completion_response(5 * 1024 * 1024, &item_count);
+          uint64_t response_len = strlen(response);
+          char* response_copy = malloc(response_len + 1);
+
+          struct timespec start;
+          clock_gettime(CLOCK_MONOTONIC, &start);
+          CeJsonObj_t tree_obj = {};
+          bool tree_parsed = ce_json_parse(response, &tree_obj, verbose);
+          int64_t tree_found = walk_completion_items(&tree_obj);
+          ce_json_obj_free(&tree_obj);
+          double tree_ms = elapsed_ms(start);
+
+          clock_gettime(CLOCK_MONOTONIC, &start);
+          memcpy(response_copy, response, response_len + 1);
+          CeJsonArena_t arena = {};
+          CeJsonObj_t arena_obj = {};
+          bool arena_parsed = ce_json_parse_in_place(response_copy, &arena_obj, &arena, verbose);
+          int64_t arena_found = walk_completion_items(&arena_obj);
+          uint64_t arena_bytes = arena.allocated_bytes;
+          ce_json_arena_free(&arena);
+          double arena_ms = elapsed_ms(start);
+
+          printf("bench: parse, walk and free a %" PRIu64 " byte completion response with %" PRId64 " items: "
+                 "tree %.2fms, arena %.2fms (%" PRIu64 " arena bytes)\n",
+                 response_len, item_count, tree_ms, arena_ms, arena_bytes);
+          free(response_copy);
+          free(response);
+          if(!tree_parsed || !arena_parsed || tree_found != item_count || arena_found != item_count){
+               printf("completion response parsed to %" PRId64 " and %" PRId64 " of %" PRId64 " items\n",
+                      tree_found, arena_found, item_count);
+               return 1;
+          }
+     }
+
      // Parse from string
      {
           const char* json_str =